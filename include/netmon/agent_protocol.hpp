@@ -0,0 +1,42 @@
+// netmon/agent_protocol.hpp
+// Wire format spoken between netmon-agent and its clients
+
+#ifndef NETMON_AGENT_PROTOCOL_HPP
+#define NETMON_AGENT_PROTOCOL_HPP
+
+#include <string>
+#include <vector>
+
+namespace netmon_plugins {
+
+// Requests larger than this are rejected by the agent
+constexpr size_t AGENT_MAX_REQUEST_SIZE = 64 * 1024;
+
+// One check invocation. The client writes the encoded request, shuts down
+// its write side, and reads the response until the agent closes the socket.
+struct AgentRequest {
+    int timeoutSeconds = 0;           // 0 = agent default
+    std::vector<std::string> args;    // args[0] is the check command
+};
+
+// A request whose first argument is this asks for the agent's execution
+// telemetry instead of running a check; an optional second argument names
+// the output format (nagios by default).
+constexpr const char* AGENT_STATS_COMMAND = "--stats";
+
+struct AgentResponse {
+    int exitCode = 3;
+    std::string output;
+};
+
+// Request: NUL-terminated fields, the timeout followed by each argument.
+std::string encodeAgentRequest(const AgentRequest& request);
+bool decodeAgentRequest(const std::string& data, AgentRequest& request);
+
+// Response: "<exit code>\n" followed by the check output verbatim.
+std::string encodeAgentResponse(const AgentResponse& response);
+bool decodeAgentResponse(const std::string& data, AgentResponse& response);
+
+} // namespace netmon_plugins
+
+#endif // NETMON_AGENT_PROTOCOL_HPP
@@ -0,0 +1,115 @@
+// netmon/config.hpp
+// netmon-plugins.conf settings, compiled check inventories and hot reload
+
+#ifndef NETMON_CONFIG_HPP
+#define NETMON_CONFIG_HPP
+
+#include "netmon/executor.hpp"
+#include "netmon/output_format.hpp"
+#include "netmon/scheduler.hpp"
+#include <ctime>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace netmon_plugins {
+
+// "[section]" headers and "key = value" lines; # and ; start comments.
+// Keys before any header land in section "". Malformed lines are reported
+// in errors as "line N: ..." and skipped.
+using IniSections = std::map<std::string, std::map<std::string, std::string>>;
+IniSections parseIni(std::istream& input, std::vector<std::string>& errors);
+
+// The settings of netmon-plugins.conf (config/netmon-plugins.conf.example)
+struct Settings {
+    int timeoutSeconds = 10;             // [defaults] timeout: check timeout
+    int httpTimeoutSeconds = 0;          // [http] timeout: of http checks; 0 = timeout
+    bool logEnabled = false;             // [logging] enabled
+    std::string logFile = "/var/log/netmon-plugins/checks.log";   // [logging] log_file
+};
+
+// Settings from an INI file; unset keys keep their defaults. Unknown
+// sections and keys and malformed values are reported in errors. Keys of
+// older example files that nothing honours ([defaults] plugin_dir and
+// verbose, [http] verify_ssl) are ignored and reported in warnings.
+Settings readSettings(std::istream& input, std::vector<std::string>& errors,
+                      std::vector<std::string>& warnings);
+
+// One check parsed, validated and bound to its plugin once, ready to run
+// any number of times without touching its argument strings again
+struct CompiledCheck {
+    ScheduledCheck check;                         // timeoutSeconds filled in from Settings
+    std::string key;                              // resultCacheKey(check.args)
+    std::shared_ptr<const PreparedCheck> prepared;
+};
+
+// Compile one check under settings. False with error set (the first line
+// of the plugin's complaint) if the plugin is unknown or rejects its
+// arguments.
+bool compileCheck(ScheduledCheck check, const Settings& settings, CompiledCheck& compiled,
+                  std::string& error);
+
+// Settings plus a compiled inventory, loaded together so that a reload
+// either replaces both or neither
+struct Configuration {
+    Settings settings;
+    std::vector<CompiledCheck> checks;
+    std::vector<std::string> errors;   // "FILE: line N: ..." or "FILE: ID: ..."
+    std::vector<std::string> warnings; // "FILE: ignoring ...", not fatal
+
+    bool ok() const { return errors.empty(); }
+};
+
+// Read configPath (settings) and inventoryPath (checks); either may be
+// empty to skip it. Every problem in either file is collected in errors.
+std::shared_ptr<const Configuration> loadConfiguration(const std::string& configPath,
+                                                       const std::string& inventoryPath);
+
+// Notices when any of a set of files is written, replaced or removed. On
+// Linux it watches their directories with inotify, so fd() can be polled
+// alongside other descriptors and saves by rename are seen; elsewhere it
+// compares modification times whenever changed() is called.
+class FileWatcher {
+public:
+    explicit FileWatcher(const std::vector<std::string>& paths);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Readable when changed() may have news; -1 without inotify
+    int fd() const { return inotifyFd; }
+
+    // True if a watched file changed since the last call. Never blocks.
+    bool changed();
+
+private:
+    std::vector<std::string> files;
+    std::vector<std::time_t> modified;      // Fallback: last seen mtimes
+    int inotifyFd = -1;
+    std::map<int, std::string> watchedDirs; // Watch descriptor -> directory
+};
+
+// The [logging] check log: one tab-separated line per finished check,
+// "TIME  CHECK  EXIT_CODE  LATENCY_MS  STATUS: message". Thread-safe.
+class ResultLog {
+public:
+    // Append to path from now on, closing any previous file; false (and
+    // log nothing) if it cannot be opened
+    bool open(const std::string& path);
+    void close();
+
+    void write(const ResultRecord& record);
+
+private:
+    std::mutex mutex;
+    std::ofstream out;
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_CONFIG_HPP
@@ -0,0 +1,157 @@
+// netmon/connection.hpp
+// Buffered TCP/TLS client connection shared by the network plugins
+
+#ifndef NETMON_CONNECTION_HPP
+#define NETMON_CONNECTION_HPP
+
+#include "netmon/deadline.hpp"
+#include "netmon/phase_timings.hpp"
+#include "netmon/socket_io.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace netmon_plugins {
+namespace net {
+
+struct ConnectOptions {
+    bool tls = false;               // Handshake right after connecting
+    std::string serverName;         // SNI name; defaults to the host
+    int attemptDelayMs = CONNECT_ATTEMPT_DELAY_MS;
+
+    // TLS, also for a later startTls(). Sessions are resumed from the
+    // last connection to the same server unless resumeSession is off,
+    // e.g. to be sure of seeing the certificate the server sends now.
+    bool verifyPeer = false;        // Chain and host name; fails the handshake
+    std::string caFile;             // Trusted CAs if verifying; system default if empty
+    bool resumeSession = true;
+};
+
+// One client connection: Happy Eyeballs connect across every resolved
+// address, optional TLS, and buffered reads. Every call honours the
+// CheckContext given to open(), so the whole conversation shares one
+// deadline and one cancellation token. Phase timings are reported to the
+// context's PhaseRecorder when the connection closes.
+//
+//   net::Connection conn;
+//   if (!conn.open(host, port, CheckContext::current().within(timeout))) {
+//       return critical(conn.error());
+//   }
+//   std::string line;
+//   conn.write("PING\r\n");
+//   conn.readLine(line);
+class Connection {
+public:
+    Connection() = default;
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+    Connection(Connection&& other) noexcept;
+    Connection& operator=(Connection&& other) noexcept;
+
+    // Connect (and handshake if options.tls); false with error() set on failure
+    bool open(const std::string& host, int port, const CheckContext& context,
+              const ConnectOptions& options = ConnectOptions());
+
+    // Upgrade an open plaintext connection, e.g. after STARTTLS
+    bool startTls(const std::string& serverName = "");
+
+    void close();
+    bool isOpen() const { return fd != INVALID_SOCKET_FD; }
+
+    // Keep-alive: detach() reports the phases of the exchange so far and
+    // drops its context while leaving the socket open; rebind() starts the
+    // next exchange under a new context, timed afresh with no resolution,
+    // connect or handshake (PhaseTimings::reused)
+    void detach();
+    void rebind(const CheckContext& context);
+
+    // Whether an idle connection can carry another request: open, nothing
+    // unread, and the peer has neither closed it nor sent anything unasked.
+    // Never waits.
+    bool stillOpen();
+    bool isTls() const;
+
+    // The TLS handshake resumed an earlier session instead of a full one
+    bool tlsResumed() const;
+
+    IoStatus write(const std::string& data);
+    IoStatus write(const char* data, size_t length);
+
+    // Append whatever arrives next (at least one byte) to out
+    IoStatus readSome(std::string& out);
+
+    // One line without its "\n" or "\r\n"; a final unterminated line is
+    // returned with CLOSED
+    IoStatus readLine(std::string& line);
+
+    // Everything up to and including delimiter
+    IoStatus readUntil(const std::string& delimiter, std::string& out);
+
+    // Exactly length bytes
+    IoStatus readExactly(size_t length, std::string& out);
+
+    // Everything until the peer closes; limit bounds the total size
+    IoStatus readAll(std::string& out, size_t limit = 16 * 1024 * 1024);
+
+    // Hand the buffered bytes (reading more if there are none) to consumer
+    // in place; it returns how many it used, and the rest stays buffered
+    // for the next read
+    IoStatus receive(const std::function<size_t(const char* data, size_t length)>& consumer);
+
+    // Status and description of the last failed call
+    IoStatus status() const { return lastStatus; }
+    const std::string& error() const { return lastError; }
+
+    // Numeric address that won the connect race, e.g. "2001:db8::1"
+    const std::string& peerAddress() const { return peer; }
+    const CheckContext& context() const { return checkContext; }
+
+    // Phases so far; total runs from open() to now (or to close())
+    PhaseTimings timings() const;
+
+    SocketFd socket() const { return fd; }
+#ifdef NETMON_SSL_ENABLED
+    SSL* tlsSession() const { return ssl; }
+#endif
+
+private:
+    IoStatus fill();
+    IoStatus fail(IoStatus status, const std::string& what);
+    void consume(size_t length, std::string& out);
+    void recordPhases();
+    void saveTlsSession();
+    std::string tlsSessionKey() const;
+
+    SocketFd fd = INVALID_SOCKET_FD;
+#ifdef NETMON_SSL_ENABLED
+    SSL* ssl = nullptr;
+#endif
+    CheckContext checkContext;
+    std::string host;
+    int port = 0;
+    std::string peer;
+    ConnectOptions tlsOptions;
+
+    // Monotonic timestamps: open() was called, and the peer was last
+    // waited on before its first byte (after connect, then after the first
+    // write)
+    PhaseTimings phases;
+    CheckClock::time_point opened{};
+    CheckClock::time_point awaitingSince{};
+    bool gotFirstByte = false;
+    bool timing = false;
+
+    // Received but not yet consumed: buffer[readOffset, buffer.size())
+    std::string buffer;
+    size_t readOffset = 0;
+
+    IoStatus lastStatus = IoStatus::OK;
+    std::string lastError;
+};
+
+} // namespace net
+} // namespace netmon_plugins
+
+#endif // NETMON_CONNECTION_HPP
@@ -0,0 +1,116 @@
+// netmon/connection_pool.hpp
+// Keep-alive pool of client connections shared by the checks of a process
+
+#ifndef NETMON_CONNECTION_POOL_HPP
+#define NETMON_CONNECTION_POOL_HPP
+
+#include "netmon/connection.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace netmon_plugins {
+namespace net {
+
+struct PoolLimits {
+    size_t maxPerHost = 8;                   // Open connections per key, idle or in use
+    size_t maxIdlePerHost = 4;               // Idle ones kept per key
+    std::chrono::seconds idleTimeout{30};    // Idle ones older than this are closed
+};
+
+// Idle connections kept open between checks, keyed by host, port and TLS
+// settings, so that checks polling the same API skip resolution, connect
+// and handshake. Thread-safe.
+//
+//   auto lease = ConnectionPool::shared().acquire(host, port, context, options);
+//   if (!lease) {
+//       return critical(lease.error());
+//   }
+//   lease->write(request);
+//   ... read the whole response ...
+//   lease.release(keepAlive);   // Closed instead if not
+class ConnectionPool {
+public:
+    explicit ConnectionPool(const PoolLimits& limits = PoolLimits());
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // The pool of this process, used by the HTTP client
+    static ConnectionPool& shared();
+
+    // A connection on loan from the pool. Unless release(true) is called
+    // after a complete exchange it is closed, not returned.
+    class Lease {
+    public:
+        Lease() = default;
+        ~Lease();
+
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+
+        explicit operator bool() const { return connection.isOpen(); }
+        Connection& operator*() { return connection; }
+        Connection* operator->() { return &connection; }
+
+        // Taken from the idle connections rather than opened for this lease
+        bool reused() const { return wasReused; }
+
+        // Why acquire() failed
+        const std::string& error() const { return failure.empty() ? connection.error() : failure; }
+
+        // Hand the connection back, to be kept for the next exchange if
+        // keepAlive and it is still open; closed otherwise
+        void release(bool keepAlive = false);
+
+    private:
+        friend class ConnectionPool;
+
+        ConnectionPool* pool = nullptr;
+        std::string key;
+        Connection connection;
+        bool wasReused = false;
+        std::string failure;
+    };
+
+    // An idle connection to host:port with the same TLS settings that is
+    // still open, rebound to context, or else a new one. With maxPerHost
+    // connections to the key already open, waits for one to be released
+    // until the context stops.
+    Lease acquire(const std::string& host, int port, const CheckContext& context,
+                  const ConnectOptions& options = ConnectOptions());
+
+    size_t idleCount() const;
+
+    // Close every idle connection
+    void clear();
+
+private:
+    struct IdleConnection {
+        Connection connection;
+        CheckClock::time_point since;
+    };
+
+    struct HostConnections {
+        std::vector<IdleConnection> idle;   // Most recently used last
+        size_t open = 0;                    // Idle plus on loan
+    };
+
+    void giveBack(const std::string& key, Connection& connection, bool keepAlive);
+    void evictExpired(CheckClock::time_point now, std::vector<Connection>& expired);
+
+    PoolLimits limits;
+    mutable std::mutex mutex;
+    std::condition_variable released;
+    std::map<std::string, HostConnections> hosts;
+};
+
+} // namespace net
+} // namespace netmon_plugins
+
+#endif // NETMON_CONNECTION_POOL_HPP
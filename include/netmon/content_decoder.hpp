@@ -0,0 +1,90 @@
+// netmon/content_decoder.hpp
+// Streaming decoder for HTTP content codings (gzip, deflate)
+
+#ifndef NETMON_CONTENT_DECODER_HPP
+#define NETMON_CONTENT_DECODER_HPP
+
+#include "netmon/http_parser.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#ifdef NETMON_ZLIB_ENABLED
+struct z_stream_s;
+#endif
+
+namespace netmon_plugins {
+
+// Decodes a body as it arrives and hands the decoded bytes on, so a
+// compressed response is never held whole in either form. Sits between
+// HttpResponseParser and the body consumer:
+//
+//   ContentDecoder decoder(ContentDecoder::codingOf(*parser.header("Content-Encoding")),
+//                          consumer);
+//   HttpResponseParser parser([&decoder](const char* data, size_t length) {
+//       return decoder.write(data, length);
+//   });
+//   ... once parser.complete(): decoder.finish() ...
+//
+// gzip and deflate need zlib (NETMON_ZLIB_ENABLED); without it only
+// IDENTITY is available.
+class ContentDecoder {
+public:
+    enum class Coding {
+        IDENTITY,
+        GZIP,           // RFC 1952, also x-gzip; concatenated members are joined
+        DEFLATE,        // zlib-wrapped (RFC 1950), or raw deflate as some servers send
+        UNSUPPORTED,    // Passed on undecoded, like IDENTITY
+    };
+
+    // The coding a Content-Encoding value names; IDENTITY for an empty one.
+    // Stacked codings ("gzip, br") are UNSUPPORTED.
+    static Coding codingOf(const std::string& contentEncoding);
+
+    // Accept-Encoding value listing the codings this build decodes; empty
+    // without zlib
+    static const char* acceptEncoding();
+
+    ContentDecoder(Coding coding, HttpResponseParser::BodyConsumer consumer);
+    ~ContentDecoder();
+
+    ContentDecoder(const ContentDecoder&) = delete;
+    ContentDecoder& operator=(const ContentDecoder&) = delete;
+
+    // Decode and pass on data; false if it is corrupt (error() says why)
+    // or the consumer stopped (error() is empty)
+    bool write(const char* data, size_t length);
+
+    // The body ended: false if the compressed stream did not
+    bool finish();
+
+    bool failed() const { return !failure.empty(); }
+    const std::string& error() const { return failure; }
+
+    Coding bodyCoding() const { return coding; }
+
+    // Bytes handed to the consumer so far
+    size_t decodedBytes() const { return decoded; }
+
+private:
+    bool fail(const std::string& what);
+
+    Coding coding;
+    HttpResponseParser::BodyConsumer consumer;
+    std::string failure;
+    size_t decoded = 0;
+
+#ifdef NETMON_ZLIB_ENABLED
+    bool start(bool raw);
+    bool inflateSome(const char* data, size_t length);
+
+    std::unique_ptr<z_stream_s> stream;
+    bool started = false;
+    bool ended = false;     // A complete stream (or gzip member) was read
+    std::string prefix;     // First bytes of a deflate body, to tell its wrapping
+#endif
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_CONTENT_DECODER_HPP
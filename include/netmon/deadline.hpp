@@ -0,0 +1,108 @@
+// netmon/deadline.hpp
+// Wall-clock deadlines and cancellation shared by every phase of a check
+
+#ifndef NETMON_DEADLINE_HPP
+#define NETMON_DEADLINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <utility>
+
+namespace netmon_plugins {
+
+class PhaseRecorder;
+
+using CheckClock = std::chrono::steady_clock;
+
+// A point in time by which a check must finish. A default-constructed
+// Deadline never expires.
+class Deadline {
+public:
+    Deadline() = default;
+
+    static Deadline after(std::chrono::milliseconds budget);
+    static Deadline afterSeconds(int seconds);
+
+    bool isSet() const { return set; }
+    bool expired() const;
+    CheckClock::time_point time() const { return at; }
+
+    // Budget the deadline was created with; zero if unset
+    std::chrono::milliseconds budget() const { return total; }
+
+    // Time left, clamped at zero; a large value if unset
+    std::chrono::milliseconds remaining() const;
+
+    // Milliseconds to hand to poll(): at most sliceMs (if > 0), 0 once
+    // expired, -1 (wait forever) only if unset and sliceMs <= 0
+    int pollTimeout(int sliceMs = -1) const;
+
+    // Whichever of the two deadlines comes first
+    Deadline earliest(const Deadline& other) const;
+
+private:
+    Deadline(CheckClock::time_point when, std::chrono::milliseconds budget)
+        : at(when), total(budget), set(true) {}
+
+    CheckClock::time_point at{};
+    std::chrono::milliseconds total{0};
+    bool set = false;
+};
+
+// Cooperative cancellation flag shared by copies of the token. Cancelling
+// is one-way and thread-safe.
+class CancellationToken {
+public:
+    CancellationToken() : state(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { state->store(true, std::memory_order_release); }
+    bool cancelled() const { return state->load(std::memory_order_acquire); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> state;
+};
+
+// Deadline and cancellation token of the check running on this thread.
+// Blocking helpers (name resolution, connect, TLS, reads and writes) stop
+// as soon as either fires, however the time was spent.
+struct CheckContext {
+    Deadline deadline;
+    CancellationToken token;
+
+    // Receives the phase timings of every connection the check makes; null
+    // outside the executor (netmon/phase_timings.hpp)
+    std::shared_ptr<PhaseRecorder> phases;
+
+    CheckContext() = default;
+    CheckContext(const Deadline& limit, const CancellationToken& cancel,
+                 std::shared_ptr<PhaseRecorder> recorder = nullptr)
+        : deadline(limit), token(cancel), phases(std::move(recorder)) {}
+
+    bool stopRequested() const { return token.cancelled() || deadline.expired(); }
+
+    // This context further limited to timeoutSeconds from now (if > 0), for
+    // code that still takes a per-call timeout
+    CheckContext within(int timeoutSeconds) const;
+
+    // Context installed on this thread by ScopedCheckContext; one that never
+    // expires if none is
+    static const CheckContext& current();
+};
+
+// Installs a CheckContext as current() for the lifetime of the scope
+class ScopedCheckContext {
+public:
+    explicit ScopedCheckContext(const CheckContext& context);
+    ~ScopedCheckContext();
+
+    ScopedCheckContext(const ScopedCheckContext&) = delete;
+    ScopedCheckContext& operator=(const ScopedCheckContext&) = delete;
+
+private:
+    const CheckContext* previous;
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_DEADLINE_HPP
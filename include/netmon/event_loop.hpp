@@ -0,0 +1,72 @@
+// netmon/event_loop.hpp
+// Readiness-based event loop (epoll on Linux, poll elsewhere)
+
+#ifndef NETMON_EVENT_LOOP_HPP
+#define NETMON_EVENT_LOOP_HPP
+
+#include "netmon/socket_io.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace netmon_plugins {
+
+// Single-threaded dispatcher of socket readiness. All methods except post()
+// must be called from the thread running the loop.
+class EventLoop {
+public:
+    enum Events : unsigned {
+        READABLE = 1,
+        WRITABLE = 2
+    };
+
+    // Errors and hang-ups are reported as READABLE | WRITABLE so that the
+    // handler's next recv/send sees them
+    using Handler = std::function<void(unsigned events)>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void add(SocketFd fd, unsigned events, Handler handler);
+    void modify(SocketFd fd, unsigned events);
+    void remove(SocketFd fd);
+    size_t size() const { return handlers.size(); }
+
+    // Wait up to timeoutMs (-1 = forever) and dispatch what is ready, then
+    // run posted tasks. Returns the number of handlers and tasks run.
+    int runOnce(int timeoutMs);
+
+    // Queue a task to run on the loop thread and wake the loop. Safe from
+    // any thread, including after the loop is gone (the task is dropped).
+    using Poster = std::function<void(std::function<void()>)>;
+    void post(std::function<void()> task);
+    Poster poster() const;
+
+private:
+    struct PostQueue;
+
+    // A descriptor's handler; generation tells a descriptor number reused
+    // within one dispatch pass apart from the registration it replaced
+    struct Registration {
+        unsigned events;
+        Handler handler;
+        uint64_t generation;
+    };
+
+    int runPosted();
+
+    std::unordered_map<SocketFd, Registration> handlers;
+    uint64_t nextGeneration = 0;
+    std::shared_ptr<PostQueue> posted;
+#ifdef __linux__
+    int epollFd = -1;
+#endif
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_EVENT_LOOP_HPP
@@ -0,0 +1,210 @@
+// netmon/executor.hpp
+// In-process check execution for multi-check hosts (agent, batch runner)
+
+#ifndef NETMON_EXECUTOR_HPP
+#define NETMON_EXECUTOR_HPP
+
+#include "netmon/deadline.hpp"
+#include "netmon/output_format.hpp"
+#include "netmon/plugin.hpp"
+#include "netmon/thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace netmon_plugins {
+
+class PluginTelemetry;   // netmon/telemetry.hpp
+
+// Outcome of a check run in-process: the exit code and the exact text a
+// standalone check_* executable would have printed.
+struct CheckOutcome {
+    int exitCode = static_cast<int>(ExitCode::UNKNOWN);
+    std::string output;
+    PerfMetrics perfdata;   // Metrics behind the perfdata part of output
+    std::string message;    // Status text without "STATUS: " and perfdata
+
+    CheckOutcome() = default;
+    CheckOutcome(int code, const std::string& text, PerfMetrics perf = PerfMetrics(),
+                 const std::string& msg = "")
+        : exitCode(code), output(text), perfdata(std::move(perf)), message(msg) {}
+};
+
+// An outcome as the output encoders (netmon/output_format.hpp) take it
+ResultRecord makeResultRecord(const std::string& check, const CheckOutcome& outcome,
+                              std::chrono::microseconds latency);
+
+// A check command line parsed once and runnable any number of times,
+// concurrently. Re-entrant plugins (ConfigurablePlugin) share one instance
+// and one immutable CheckConfig across runs; single-shot plugins are
+// validated once and get a fresh instance per run.
+class PreparedCheck {
+public:
+    // args[0] names the plugin as a command ("check_tcp",
+    // "/path/to/check_tcp" or just "tcp"). Throws std::invalid_argument for
+    // an unknown plugin, HelpRequested, or the plugin's own parse error.
+    explicit PreparedCheck(const std::vector<std::string>& args);
+
+    // Never throws: check errors become UNKNOWN outcomes. The context is
+    // installed as CheckContext::current() while the check runs, so the
+    // shared socket helpers stop at its deadline or when it is cancelled.
+    // Every run is recorded in ExecutionTelemetry::global().
+    CheckOutcome run() const;
+    CheckOutcome run(const CheckContext& context) const;
+
+    const std::string& pluginName() const { return name; }
+    const std::vector<std::string>& arguments() const { return args; }
+    bool isReentrant() const { return config != nullptr; }
+
+private:
+    std::string name;
+    std::vector<std::string> args;
+    std::unique_ptr<const Plugin> plugin;
+    std::shared_ptr<const CheckConfig> config;
+    PluginTelemetry* telemetry = nullptr;   // Of ExecutionTelemetry::global()
+};
+
+// Prepare a check, turning every failure into the outcome a standalone
+// executable would have produced (usage text for --help, UNKNOWN for bad
+// arguments). Returns nullptr and fills failure when nothing can be run.
+std::shared_ptr<const PreparedCheck> prepareCheck(const std::vector<std::string>& args,
+                                                  CheckOutcome& failure);
+
+using CheckCallback = std::function<void(CheckOutcome)>;
+
+// Run a prepared check on pool without blocking the caller. onDone is
+// called exactly once: with the check's outcome, or with timeoutOutcome()
+// the moment context.deadline passes, whichever comes first. In the latter
+// case the token is cancelled so the abandoned run stops at its next socket
+// wait. onDone runs on a pool worker or on the shared deadline thread and
+// must not block.
+void checkAsync(ThreadPool& pool, std::shared_ptr<const PreparedCheck> check,
+                const CheckContext& context, CheckCallback onDone);
+
+// Future-returning form; the future is ready by context.deadline at the
+// latest
+std::future<CheckOutcome> checkAsync(ThreadPool& pool,
+                                     std::shared_ptr<const PreparedCheck> check,
+                                     const CheckContext& context);
+
+// Single-flight execution of identical checks. While a check is in flight
+// under a key (see resultCacheKey() in netmon/result_cache.hpp), later
+// callers with the same key wait for its outcome instead of opening their
+// own connections. Every caller is still answered by its own deadline at
+// the latest. The shared run has no deadline of its own: it is cancelled
+// once every caller waiting on it, the first included, has given up, so a
+// caller with a later deadline than the first still gets its outcome.
+class CheckCoalescer {
+public:
+    CheckCoalescer();
+    ~CheckCoalescer();
+
+    CheckCoalescer(const CheckCoalescer&) = delete;
+    CheckCoalescer& operator=(const CheckCoalescer&) = delete;
+
+    // Same contract as the free checkAsync(): onDone is called exactly
+    // once, with the shared outcome or with timeoutOutcome() at
+    // context.deadline
+    void checkAsync(ThreadPool& pool, const std::string& key,
+                    std::shared_ptr<const PreparedCheck> check,
+                    const CheckContext& context, CheckCallback onDone);
+
+    // Blocking form for callers with a thread of their own (executeBatch):
+    // the first caller runs the check on its thread, later ones wait until
+    // it finishes or their deadline passes. Every caller, the first
+    // included, gets timeoutOutcome() once its deadline passes. The run
+    // goes on until the last of them gives up, so it still finishes for
+    // callers with later deadlines.
+    CheckOutcome run(const std::string& key, const PreparedCheck& check,
+                     const CheckContext& context);
+
+    uint64_t started() const { return startedCount.load(); }      // Checks actually run
+    uint64_t coalesced() const { return coalescedCount.load(); }  // Callers that joined one
+    size_t inFlight() const;
+
+private:
+    struct Flight;
+
+    std::shared_ptr<Flight> join(const std::string& key, bool& leader);
+    void finish(const std::string& key, const std::shared_ptr<Flight>& flight,
+                CheckOutcome outcome);
+
+    mutable std::mutex mutex;   // Guards flights
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+    std::atomic<uint64_t> startedCount{0};
+    std::atomic<uint64_t> coalescedCount{0};
+};
+
+// Prepare and run a check once. Never throws: argument and check errors
+// become UNKNOWN outcomes.
+CheckOutcome runCheck(const std::vector<std::string>& args);
+
+// Outcome reported for a check that exceeded its timeout
+CheckOutcome timeoutOutcome(int timeoutSeconds);
+CheckOutcome timeoutOutcome(const Deadline& deadline);
+
+// One check of a batch
+struct BatchCheck {
+    std::string id;                 // Label reported with the result
+    std::vector<std::string> args;  // As for runCheck()
+    int timeoutSeconds = 0;         // 0 = BatchOptions::defaultTimeoutSeconds
+
+    // Optional: the check already parsed (netmon/config.hpp compileCheck())
+    // and its resultCacheKey(); workers then leave args alone
+    std::shared_ptr<const PreparedCheck> prepared;
+    std::string key;
+};
+
+struct BatchOptions {
+    size_t concurrency = 16;        // Checks running at the same time
+    int defaultTimeoutSeconds = 10;
+    bool coalesce = true;           // Run identical checks once (CheckCoalescer)
+};
+
+struct BatchResult {
+    size_t index = 0;               // Position of the check in the batch
+    std::string id;
+    CheckOutcome outcome;
+    std::chrono::microseconds latency{0};
+    bool timedOut = false;
+};
+
+struct BatchSummary {
+    size_t completed = 0;
+    size_t timedOut = 0;            // Checks abandoned at their deadline
+    size_t coalesced = 0;           // Checks answered by an identical one in flight
+    int worstExitCode = 0;
+};
+
+using BatchResultHandler = std::function<void(const BatchResult&)>;
+
+// Run checks concurrently on at most options.concurrency workers. onResult
+// is called on the caller's thread as each check finishes, in completion
+// order. A check that exceeds its timeout is reported as UNKNOWN at its
+// deadline and its worker is replaced, so one hung target cannot stall the
+// rest of the batch.
+BatchSummary executeBatch(const std::vector<BatchCheck>& checks,
+                          const BatchOptions& options,
+                          const BatchResultHandler& onResult);
+
+// Split a command line into arguments. Supports single quotes, double
+// quotes and backslash escapes; throws std::invalid_argument on an
+// unterminated quote.
+std::vector<std::string> splitCommandLine(const std::string& line);
+
+// Parse one line of a batch file: "[label:] plugin [args...]". Returns
+// false for blank and comment (#) lines. Without a label, id is left
+// empty for the caller to fill in (netmon-batch uses the line number).
+bool parseBatchLine(const std::string& line, BatchCheck& check);
+
+} // namespace netmon_plugins
+
+#endif // NETMON_EXECUTOR_HPP
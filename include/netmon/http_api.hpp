@@ -4,12 +4,73 @@
 #ifndef NETMON_HTTP_API_HPP
 #define NETMON_HTTP_API_HPP
 
+#include "netmon/http_parser.hpp"
+#include "netmon/socket_io.hpp"
 #include <string>
+#include <vector>
 
 namespace netmon_plugins {
 
-// Make HTTP GET request and return response body
-std::string httpGet(const std::string& host, int port, const std::string& path, 
+// One HTTP/1.1 request. Host, User-Agent, Accept and Accept-Encoding are
+// sent unless set in headers; Content-Length is always computed from body.
+struct HttpRequest {
+    std::string method = "GET";
+    std::string host;
+    int port = 80;
+    std::string path = "/";
+    std::vector<HttpHeader> headers;
+    std::string body;
+    int timeoutSeconds = 10;
+
+    // Ask for gzip or deflate (when built with zlib) and decode the body
+    // as it arrives; the consumer and body always see the decoded bytes
+    bool decompress = true;
+
+    bool useSSL = false;
+    bool verifyPeer = false;     // Chain and host name of the server certificate
+    std::string caFile;          // Trusted CAs if verifying; system default if empty
+
+    HttpRequest& header(const std::string& name, const std::string& value);
+    HttpRequest& basicAuth(const std::string& username, const std::string& password);
+    HttpRequest& bearerToken(const std::string& token);
+};
+
+struct HttpResponse {
+    int statusCode = 0;          // 0 if no response head arrived
+    std::string reason;
+    std::vector<HttpHeader> headers;
+    std::string body;            // Empty when streamed to a consumer
+
+    // OK once the whole response arrived; otherwise error says why, and
+    // the fields hold whatever arrived before
+    IoStatus status = IoStatus::OK;
+    std::string error;
+    bool truncated = false;      // Body cut at MAX_HTTP_RESPONSE_BODY
+    bool decompressed = false;   // Body arrived compressed; headers still say how
+
+    bool complete() const { return status == IoStatus::OK; }
+
+    // Value of the first field called name (any case); null if absent
+    const std::string* header(const std::string& name) const;
+};
+
+// Largest body httpRequest() keeps in HttpResponse::body
+constexpr size_t MAX_HTTP_RESPONSE_BODY = 16 * 1024 * 1024;
+
+// Send request on a connection from the shared keep-alive pool and read
+// the response, all within request.timeoutSeconds of the current check's
+// context. A reused connection the server closed meanwhile is replaced
+// transparently for idempotent methods.
+HttpResponse httpRequest(const HttpRequest& request);
+
+// The same, handing the body to consumer as it arrives instead of keeping
+// it; consumer returning false abandons the response
+HttpResponse httpRequest(const HttpRequest& request,
+                         const HttpResponseParser::BodyConsumer& consumer);
+
+// Make HTTP GET request and return response body. Unless the whole response
+// arrived in time, the body is empty and statusCode is 0.
+std::string httpGet(const std::string& host, int port, const std::string& path,
                    bool useSSL, int timeout, int& statusCode);
 
 // Make HTTP GET request with authentication
@@ -20,4 +81,3 @@ std::string httpGetAuth(const std::string& host, int port, const std::string& pa
 } // namespace netmon_plugins
 
 #endif // NETMON_HTTP_API_HPP
-
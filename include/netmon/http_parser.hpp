@@ -0,0 +1,126 @@
+// netmon/http_parser.hpp
+// Incremental HTTP/1.1 response parser
+
+#ifndef NETMON_HTTP_PARSER_HPP
+#define NETMON_HTTP_PARSER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace netmon_plugins {
+
+struct HttpHeader {
+    std::string name;
+    std::string value;
+};
+
+// Value of the first field in headers called name (any case); null if absent
+const std::string* findHeader(const std::vector<HttpHeader>& headers, const std::string& name);
+
+// Parses one response from bytes pushed in as they arrive, without
+// buffering the body: each piece of it is handed to the consumer as a
+// slice of the input. The end of the body is found from Content-Length,
+// chunked transfer coding or the peer closing, and parsing stops there, so
+// bytes after it are left for the next response on a kept-alive
+// connection. Interim 1xx responses are skipped.
+//
+//   HttpResponseParser parser([&](const char* data, size_t length) {
+//       body.append(data, length);
+//       return true;
+//   });
+//   while (!parser.done()) {
+//       size_t used = parser.feed(data, length);   // Keep data[used..] for later
+//       ... on EOF: parser.finish() ...
+//   }
+class HttpResponseParser {
+public:
+    // Receives the (de-chunked) body; returning false stops parsing
+    using BodyConsumer = std::function<bool(const char* data, size_t length)>;
+
+    explicit HttpResponseParser(BodyConsumer consumer = nullptr);
+
+    // Ready for another response, keeping the consumer
+    void reset();
+
+    // The request was HEAD: the response has a head only
+    void expectNoBody() { noBody = true; }
+
+    // Parse from data; returns how many bytes belong to this response,
+    // which is fewer than length once it is complete or has failed
+    size_t feed(const char* data, size_t length);
+
+    // The peer closed the connection: ends a body delimited by closing,
+    // anything else still incomplete fails
+    void finish();
+
+    bool headComplete() const { return headParsed; }
+    bool complete() const { return state == State::COMPLETE; }
+    bool failed() const { return state == State::FAILED; }
+    bool done() const { return complete() || failed(); }
+    const std::string& error() const { return failure; }
+
+    int statusCode() const { return status; }
+    const std::string& reason() const { return reasonPhrase; }
+    const std::vector<HttpHeader>& headers() const { return fields; }
+
+    const std::string* header(const std::string& name) const { return findHeader(fields, name); }
+
+    bool chunked() const { return isChunked; }
+    size_t bodyBytes() const { return bodyLength; }
+
+    // Complete, and neither side asked to close the connection
+    bool keepAlive() const;
+
+    // Longest status line, header or trailer section, and chunk size line
+    static constexpr size_t MAX_HEAD_SIZE = 64 * 1024;
+
+private:
+    enum class State {
+        STATUS_LINE,
+        HEADERS,
+        BODY_LENGTH,        // remaining bytes left
+        BODY_UNTIL_CLOSE,
+        CHUNK_SIZE,
+        CHUNK_DATA,         // remaining bytes of this chunk left
+        CHUNK_END,          // CRLF after the chunk data
+        TRAILERS,
+        COMPLETE,
+        FAILED,
+    };
+
+    bool lineState() const;
+    void handleLine();
+    void parseStatusLine();
+    void parseHeaderLine();
+    void startBody();
+    void parseChunkSize();
+    bool deliver(const char* data, size_t length);
+    void fail(const std::string& what);
+
+    BodyConsumer consumer;
+    bool noBody = false;
+    State state = State::STATUS_LINE;
+    std::string failure;
+
+    // Line being assembled across feeds, and head bytes seen so far
+    std::string line;
+    size_t headBytes = 0;
+
+    int status = 0;
+    int minorVersion = 1;
+    std::string reasonPhrase;
+    std::vector<HttpHeader> fields;
+    bool headParsed = false;
+    bool isChunked = false;
+    bool closeDelimited = false;
+    bool closeRequested = false;
+    bool keepAliveOffered = false;   // HTTP/1.0 "Connection: keep-alive"
+    unsigned long long remaining = 0;
+    size_t bodyLength = 0;
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_HTTP_PARSER_HPP
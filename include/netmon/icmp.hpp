@@ -0,0 +1,35 @@
+// netmon/icmp.hpp
+// ICMP echo (ping) shared by check_ping and check_fping
+
+#ifndef NETMON_ICMP_HPP
+#define NETMON_ICMP_HPP
+
+#include "netmon/deadline.hpp"
+#include <chrono>
+#include <string>
+
+namespace netmon_plugins {
+
+struct EchoStats {
+    int packetsSent = 0;
+    int packetsReceived = 0;
+    double minRTT = 0.0;         // Milliseconds, over the replies received
+    double maxRTT = 0.0;
+    double avgRTT = 0.0;
+    double packetLoss = 0.0;     // Percent of the packets sent
+};
+
+// Send count echo requests to host (IPv4), one every interval, and wait up
+// to replyTimeout for each reply. Requests are in flight together: every
+// outstanding reply timeout sits on one timer wheel and a single poll()
+// collects the replies, so a lost packet delays nothing but itself. Stops
+// early when context does. Throws std::runtime_error when the host cannot
+// be resolved or the ICMP socket cannot be opened (raw sockets need root
+// on Linux).
+EchoStats pingEcho(const std::string& host, int count, std::chrono::milliseconds interval,
+                   std::chrono::milliseconds replyTimeout,
+                   const CheckContext& context = CheckContext::current());
+
+} // namespace netmon_plugins
+
+#endif // NETMON_ICMP_HPP
@@ -0,0 +1,52 @@
+// netmon/metrics_exporter.hpp
+// Prometheus /metrics page of the latest result of every scheduled check
+
+#ifndef NETMON_METRICS_EXPORTER_HPP
+#define NETMON_METRICS_EXPORTER_HPP
+
+#include "netmon/output_format.hpp"
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace netmon_plugins {
+
+// Latest result of each check, kept as rendered Prometheus samples:
+// netmon_check_status, netmon_check_latency_seconds and the
+// netmon_perfdata families, all labelled with the check id. update() renders only
+// the check that changed; render() joins the stored samples into the page
+// once per change and hands out that copy until the next one, so a scrape
+// never runs or re-formats a check. Thread-safe.
+class MetricsExporter {
+public:
+    // Replace everything exported for record.check
+    void update(const ResultRecord& record);
+
+    // Stop exporting a check; false if it was not exported
+    bool remove(const std::string& check);
+
+    // Text exposition format 0.0.4, families sorted by name with their
+    // HELP/TYPE lines, samples within a family sorted by check
+    std::string render() const;
+
+    size_t checks() const;
+
+private:
+    void drop(const std::string& check);   // Caller holds mutex
+
+    mutable std::mutex mutex;
+    // family -> check -> sample lines
+    std::map<std::string, std::map<std::string, std::string>> families;
+    std::map<std::string, std::vector<std::string>> familiesOf;   // check -> families
+    mutable std::string page;
+    mutable bool stale = true;
+};
+
+// Content-Type of render()'s output
+constexpr const char* PROMETHEUS_CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+
+} // namespace netmon_plugins
+
+#endif // NETMON_METRICS_EXPORTER_HPP
@@ -0,0 +1,202 @@
+// netmon/options.hpp
+// Declarative command-line options: one constexpr table per plugin drives
+// parsing and the generated usage text
+
+#ifndef NETMON_OPTIONS_HPP
+#define NETMON_OPTIONS_HPP
+
+#include "netmon/threshold.hpp"
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace netmon_plugins {
+
+// One entry of an option table, independent of the type it fills in.
+// Build entries with option(), flag(), custom() and positional() below
+// rather than by hand.
+struct OptionSpec {
+    char shortName;          // 'H' for -H; '\0' if there is none
+    const char* longName;    // "hostname" for --hostname; nullptr if none
+    const char* valueName;   // "HOST" in the usage text; nullptr for flags
+    const char* help;
+
+    // Store value (nullptr for a flag) into the object being parsed; false
+    // if the value is malformed. May also throw std::invalid_argument.
+    bool (*apply)(void* target, const char* value);
+
+    // Append the default value, read from a default-constructed object, to
+    // out; nullptr or nothing appended if there is none worth showing
+    void (*describeDefault)(const void* target, std::string& out);
+
+    // Neither name: takes every argument that is not an option, in order
+    constexpr bool isPositional() const { return shortName == '\0' && longName == nullptr; }
+};
+
+// An option of Config. The type only ties a table to the struct it fills.
+template <typename Config>
+struct Option : OptionSpec {};
+
+namespace options_detail {
+
+template <typename Member>
+struct MemberTraits;
+
+template <typename Owner, typename Field>
+struct MemberTraits<Field Owner::*> {
+    using OwnerType = Owner;
+    using FieldType = Field;
+};
+
+template <auto Member>
+using OwnerOf = typename MemberTraits<decltype(Member)>::OwnerType;
+template <auto Member>
+using FieldOf = typename MemberTraits<decltype(Member)>::FieldType;
+
+// Field parsers; false if text is not a complete, in-range value
+bool parseValue(const char* text, int& value);
+bool parseValue(const char* text, long long& value);
+bool parseValue(const char* text, double& value);
+bool parseValue(const char* text, std::string& value);
+bool parseValue(const char* text, ThresholdRange& value);
+bool parseValue(const char* text, std::vector<std::string>& value);   // Appends
+
+void describeValue(int value, std::string& out);
+void describeValue(long long value, std::string& out);
+void describeValue(double value, std::string& out);
+void describeValue(const std::string& value, std::string& out);
+void describeValue(const ThresholdRange& value, std::string& out);
+inline void describeValue(const std::vector<std::string>&, std::string&) {}
+
+template <auto Member>
+bool assignValue(void* target, const char* value) {
+    return parseValue(value, static_cast<OwnerOf<Member>*>(target)->*Member);
+}
+
+template <auto Member, auto Value>
+bool assignConstant(void* target, const char*) {
+    static_cast<OwnerOf<Member>*>(target)->*Member = Value;
+    return true;
+}
+
+template <auto Member>
+void describeMember(const void* target, std::string& out) {
+    describeValue(static_cast<const OwnerOf<Member>*>(target)->*Member, out);
+}
+
+template <typename Function>
+struct CustomTraits;
+
+template <typename Config>
+struct CustomTraits<bool (*)(Config&, const char*)> {
+    using ConfigType = Config;
+};
+
+template <auto Parse>
+using CustomConfig = typename CustomTraits<decltype(Parse)>::ConfigType;
+
+template <auto Parse>
+bool applyCustom(void* target, const char* value) {
+    return Parse(*static_cast<CustomConfig<Parse>*>(target), value);
+}
+
+// The table-independent parts, shared by every instantiation below
+void parseOptionTable(const OptionSpec* const* table, size_t count,
+                      const std::vector<std::string>& args, void* target);
+std::vector<std::string> canonicalOptionTable(const OptionSpec* const* table, size_t count,
+                                              const std::vector<std::string>& args);
+std::string formatOptionTable(const char* synopsis, const OptionSpec* const* table,
+                              size_t count, const void* defaults);
+
+} // namespace options_detail
+
+// -p/--port PORT stored in Member: int, long long, double, std::string,
+// ThresholdRange (a Nagios range), or std::vector<std::string> (appended
+// to on every use)
+template <auto Member>
+constexpr Option<options_detail::OwnerOf<Member>> option(char shortName, const char* longName,
+                                                         const char* valueName,
+                                                         const char* help) {
+    return {{shortName, longName, valueName, help, &options_detail::assignValue<Member>,
+             &options_detail::describeMember<Member>}};
+}
+
+// A flag taking no value that sets Member to Value (true by default)
+template <auto Member, auto Value = true>
+constexpr Option<options_detail::OwnerOf<Member>> flag(char shortName, const char* longName,
+                                                       const char* help) {
+    static_assert(std::is_convertible<decltype(Value), options_detail::FieldOf<Member>>::value,
+                  "flag value does not fit the field");
+    return {{shortName, longName, nullptr, help, &options_detail::assignConstant<Member, Value>,
+             nullptr}};
+}
+
+// An option whose value Parse(config, value) interprets itself, e.g. one
+// that sets several fields. Parse returns false (or throws
+// std::invalid_argument) for a bad value.
+template <auto Parse>
+constexpr Option<options_detail::CustomConfig<Parse>> custom(char shortName, const char* longName,
+                                                             const char* valueName,
+                                                             const char* help) {
+    return {{shortName, longName, valueName, help, &options_detail::applyCustom<Parse>, nullptr}};
+}
+
+// The non-option arguments, e.g. "PATH" into a std::vector<std::string>.
+// Without one in the table, a non-option argument is an error.
+template <auto Member>
+constexpr Option<options_detail::OwnerOf<Member>> positional(const char* valueName,
+                                                             const char* help) {
+    return {{'\0', nullptr, valueName, help, &options_detail::assignValue<Member>, nullptr}};
+}
+
+// Parse a command line (args[0] is the program name) into config, which
+// keeps the defaults of every option not given. Accepts "-p VALUE",
+// "-pVALUE", "--port VALUE" and "--port=VALUE"; "--" ends the options.
+// -h/--help throws HelpRequested unless the table defines them. Unknown
+// options, missing or malformed values and stray arguments throw
+// std::invalid_argument. Nothing is allocated beyond what storing the
+// values themselves takes.
+template <typename Config, size_t N>
+void parseOptions(const Option<Config> (&table)[N], const std::vector<std::string>& args,
+                  Config& config) {
+    const OptionSpec* specs[N];
+    for (size_t i = 0; i < N; i++) {
+        specs[i] = &table[i];
+    }
+    options_detail::parseOptionTable(specs, N, args, &config);
+}
+
+// args spelled the same way whatever the order and form of its options:
+// "--port=80 -H a", "-p80 -Ha" and "-H a -p 80" all become
+// {args[0], "--hostname", "a", "--port", "80"}. Value options go first, in
+// table order. Flags and custom() options keep their order among
+// themselves, since several may write the same field. Non-option
+// arguments go last, after "--". This assumes that each option() entry
+// has a field of its own. Values are not checked. Throws as parseOptions()
+// does for an unknown option, a missing value or a stray argument.
+template <typename Config, size_t N>
+std::vector<std::string> canonicalOptions(const Option<Config> (&table)[N],
+                                          const std::vector<std::string>& args) {
+    const OptionSpec* specs[N];
+    for (size_t i = 0; i < N; i++) {
+        specs[i] = &table[i];
+    }
+    return options_detail::canonicalOptionTable(specs, N, args);
+}
+
+// "Usage: SYNOPSIS\nOptions:\n" and one aligned line per option, with the
+// defaults of a default-constructed Config and a closing -h/--help line
+template <typename Config, size_t N>
+std::string formatUsage(const char* synopsis, const Option<Config> (&table)[N]) {
+    const OptionSpec* specs[N];
+    for (size_t i = 0; i < N; i++) {
+        specs[i] = &table[i];
+    }
+    const Config defaults{};
+    return options_detail::formatOptionTable(synopsis, specs, N, &defaults);
+}
+
+} // namespace netmon_plugins
+
+#endif // NETMON_OPTIONS_HPP
@@ -0,0 +1,73 @@
+// netmon/output_format.hpp
+// Check result encoders: Nagios text, JSON lines, Prometheus, InfluxDB and binary
+
+#ifndef NETMON_OUTPUT_FORMAT_HPP
+#define NETMON_OUTPUT_FORMAT_HPP
+
+#include "netmon/perfdata.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace netmon_plugins {
+
+enum class OutputFormat {
+    NAGIOS,       // "STATUS: message | perfdata"
+    JSON,         // One JSON object per line
+    PROMETHEUS,   // Text exposition format 0.0.4
+    INFLUX,       // InfluxDB line protocol
+    BINARY        // Length-prefixed records, see encodeResult()
+};
+
+// "nagios", "json", "prometheus", "influx" or "binary"
+bool parseOutputFormat(const std::string& name, OutputFormat& format);
+std::string outputFormatToString(OutputFormat format);
+
+// One finished check, as the encoders see it
+struct ResultRecord {
+    std::string check;                      // Check id or plugin name
+    int exitCode = 3;
+    std::string message;                    // Status text without perfdata
+    PerfMetrics metrics;
+    std::chrono::microseconds latency{0};
+    std::chrono::system_clock::time_point timestamp;   // When it finished
+};
+
+// Append one record to out.
+//
+// JSON:       {"check":..,"status":"OK","exit_code":0,"message":..,
+//              "latency_ms":..,"timestamp":..,"metrics":[{"label":..,..}]}
+// Prometheus: netmon_check_status{check=".."} 0, netmon_check_latency_seconds
+//             and per metric netmon_perfdata[_seconds|_bytes|_percent|_total]
+//             {check="..",label=".."}, with ms/us scaled to seconds and KB..TB
+//             to bytes; other units land in netmon_perfdata with a unit label
+// Influx:     netmon,check=.. exit_code=0i,latency=..,<label>=.. <ns>
+// Binary:     little-endian; u32 length of the rest, u8 version (1),
+//             u8 exit code, u16+bytes check, u16+bytes message, i64 unix
+//             time in us, u32 latency in us, u16 metric count, then per
+//             metric u8+bytes label, u8+bytes unit, f64 value, u8 flags
+//             (1 warn, 2 crit, 4 min, 8 max) and the fields flagged, in
+//             that order (u8+bytes for ranges, f64 for min/max)
+//
+// Prometheus needs every sample of a metric family on consecutive lines,
+// so streams of several checks should go through encodeResults() instead.
+void encodeResult(OutputFormat format, const ResultRecord& record, std::string& out);
+
+// Append several records; for Prometheus the samples are grouped by family
+void encodeResults(OutputFormat format, const std::vector<ResultRecord>& records,
+                   std::string& out);
+
+// Prometheus samples of one record as (family, sample line) pairs, lines
+// without their newline, in the order encodeResult() writes them
+std::vector<std::pair<std::string, std::string>> prometheusSamples(const ResultRecord& record);
+
+// Read one BINARY record from data; consumed is its full size. False if
+// data is truncated or not a version 1 record.
+bool decodeBinaryResult(const char* data, size_t size, ResultRecord& record, size_t& consumed);
+
+} // namespace netmon_plugins
+
+#endif // NETMON_OUTPUT_FORMAT_HPP
@@ -0,0 +1,64 @@
+// netmon/perfdata.hpp
+// Structured performance data: one metric per "label=value[UOM];warn;crit;min;max"
+
+#ifndef NETMON_PERFDATA_HPP
+#define NETMON_PERFDATA_HPP
+
+#include "netmon/small_vector.hpp"
+#include "netmon/threshold.hpp"
+#include <string>
+#include <utility>
+
+namespace netmon_plugins {
+
+// One performance data field. value is NaN for "U" (undetermined).
+struct PerfMetric {
+    std::string label;
+    double value = 0.0;
+    std::string unit;       // "", "s", "ms", "us", "%", "B", "KB", "MB", "GB", "TB" or "c"
+    std::string warn;       // Threshold range as written, empty if none
+    std::string crit;
+    bool hasMin = false;
+    bool hasMax = false;
+    double min = 0.0;
+    double max = 0.0;
+
+    PerfMetric() = default;
+    PerfMetric(std::string name, double v, std::string uom = "")
+        : label(std::move(name)), value(v), unit(std::move(uom)) {}
+
+    // Builder-style setters, e.g.
+    // PerfMetric("time", 0.25, "s").thresholds(1, 5).range(0, 10)
+    PerfMetric& thresholds(const std::string& warning, const std::string& critical);
+    PerfMetric& thresholds(double warning, double critical);
+    PerfMetric& thresholds(const Thresholds& limits);
+    PerfMetric& minimum(double value);
+    PerfMetric& maximum(double value);
+    PerfMetric& range(double low, double high) { return minimum(low).maximum(high); }
+};
+
+// The metrics of one check. Most checks report a handful, which stay
+// inside the result without a heap allocation.
+using PerfMetrics = SmallVector<PerfMetric, 8>;
+
+// Split a plugin's perfdata string into metrics. Malformed fields are
+// skipped; returns false if any were.
+bool parsePerfdata(const std::string& text, PerfMetrics& metrics);
+
+// The Nagios text form, quoting labels that need it. Values are written
+// in plain decimal with at most six fractional digits, as Nagios
+// graphers expect.
+std::string formatPerfdata(const PerfMetrics& metrics);
+
+// Same, appended to out without a leading separator
+void appendPerfdata(std::string& out, const PerfMetrics& metrics);
+
+// A perfdata number: plain decimal, at most six fractional digits
+std::string formatPerfValue(double value);
+
+// Shortest text that reads back as the same double ("0.25", "1e+20", "nan")
+std::string formatNumber(double value);
+
+} // namespace netmon_plugins
+
+#endif // NETMON_PERFDATA_HPP
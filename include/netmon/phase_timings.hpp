@@ -0,0 +1,84 @@
+// netmon/phase_timings.hpp
+// Per-phase latency of network connections, reported as perfdata
+
+#ifndef NETMON_PHASE_TIMINGS_HPP
+#define NETMON_PHASE_TIMINGS_HPP
+
+#include "netmon/perfdata.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace netmon_plugins {
+
+// Where the time of one connection went, measured on the monotonic
+// CheckClock. Phases that did not happen (no TLS, nothing received) are
+// zero and left out of recorded.
+struct PhaseTimings {
+    enum Phase : unsigned {
+        DNS = 1u << 0,
+        CONNECT = 1u << 1,
+        TLS = 1u << 2,
+        FIRST_BYTE = 1u << 3,
+    };
+
+    std::chrono::microseconds dns{0};         // Name resolution
+    std::chrono::microseconds connect{0};     // TCP connect, all attempts
+    std::chrono::microseconds tls{0};         // TLS handshake
+    std::chrono::microseconds firstByte{0};   // Request (or connect) to first byte
+    std::chrono::microseconds total{0};       // Resolution to close
+    bool reused = false;   // A kept-alive connection: no dns, connect or tls
+    unsigned recorded = 0; // Phase bits of the phases that happened
+
+    // dns_time, connect_time, tls_time and ttfb for the recorded phases,
+    // then total_time, as metrics in seconds
+    void appendMetrics(PerfMetrics& metrics) const;
+};
+
+// Collects the phases and traffic of every connection one check makes. It hangs off
+// the CheckContext, so net::Connection and TcpProbeEngine report into it
+// without the plugin passing anything along; the executor then appends
+// the totals to the check's perfdata. Thread-safe.
+class PhaseRecorder {
+public:
+    void record(const PhaseTimings& timings);
+
+    size_t connections() const { return count.load(std::memory_order_relaxed); }
+
+    // Those of them that were kept-alive connections rather than new ones
+    size_t reusedConnections() const { return reusedCount.load(std::memory_order_relaxed); }
+
+    // Payload bytes moved over those connections, TLS counted as plaintext
+    void addTraffic(size_t read, size_t written) {
+        readBytes.fetch_add(read, std::memory_order_relaxed);
+        writtenBytes.fetch_add(written, std::memory_order_relaxed);
+    }
+    uint64_t bytesRead() const { return readBytes.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const { return writtenBytes.load(std::memory_order_relaxed); }
+
+    // Sum of every recorded phase, with total set to checkTime (the
+    // check's own run time) rather than the sum of connection lifetimes.
+    // A phase counts as recorded if any connection went through it.
+    PhaseTimings summary(std::chrono::microseconds checkTime) const;
+
+private:
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> reusedCount{0};
+    std::atomic<unsigned> recordedPhases{0};
+    std::atomic<long long> dnsUs{0};
+    std::atomic<long long> connectUs{0};
+    std::atomic<long long> tlsUs{0};
+    std::atomic<long long> firstByteUs{0};
+    std::atomic<uint64_t> readBytes{0};
+    std::atomic<uint64_t> writtenBytes{0};
+};
+
+// Append the recorder's summary to a check's perfdata; unchanged if the
+// check made no connection
+void appendPhasePerfdata(PerfMetrics& perfdata, const PhaseRecorder& recorder,
+                         std::chrono::microseconds checkTime);
+
+} // namespace netmon_plugins
+
+#endif // NETMON_PHASE_TIMINGS_HPP
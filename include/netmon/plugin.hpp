@@ -4,9 +4,15 @@
 #ifndef NETMON_PLUGIN_HPP
 #define NETMON_PLUGIN_HPP
 
+#include "netmon/output_format.hpp"
+#include "netmon/perfdata.hpp"
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <exception>
+#include <type_traits>
+#include <utility>
 
 namespace netmon_plugins {
 
@@ -18,16 +24,40 @@ enum class ExitCode {
     UNKNOWN = 3
 };
 
-// Plugin result structure
+// Plugin result structure. perfdata is kept as typed metrics and only
+// turned into text when the result is written out.
 struct PluginResult {
     ExitCode code;
     std::string message;
-    std::string perfdata;
-    
-    PluginResult(ExitCode c = ExitCode::OK, 
-                 const std::string& msg = "", 
-                 const std::string& perf = "")
-        : code(c), message(msg), perfdata(perf) {}
+    PerfMetrics perfdata;
+
+    PluginResult(ExitCode c = ExitCode::OK,
+                 const std::string& msg = "",
+                 PerfMetrics perf = PerfMetrics())
+        : code(c), message(msg), perfdata(std::move(perf)) {}
+
+    // Perfdata given as Nagios text is parsed once, here; malformed
+    // fields are dropped
+    PluginResult(ExitCode c, const std::string& msg, const std::string& perf)
+        : code(c), message(msg) {
+        parsePerfdata(perf, perfdata);
+    }
+    PluginResult(ExitCode c, const std::string& msg, const char* perf)
+        : PluginResult(c, msg, std::string(perf)) {}
+};
+
+// Thrown by argument parsing when -h/--help is given. The caller decides
+// how to show getUsage(): check_* executables print it and exit 0,
+// in-process hosts return it as the check output.
+class HelpRequested : public std::exception {
+public:
+    const char* what() const noexcept override { return "help requested"; }
+};
+
+// Parsed, immutable settings of one check. Re-entrant plugins derive
+// their own configuration type from it.
+struct CheckConfig {
+    virtual ~CheckConfig() = default;
 };
 
 // Base plugin class
@@ -38,14 +68,150 @@ public:
     virtual void parseArguments(int argc, char* argv[]) = 0;
     virtual std::string getUsage() const = 0;
     virtual std::string getDescription() const = 0;
+
+    // Re-entrant interface. A plugin that supports it turns a command line
+    // (args[0] is the program name) into an immutable CheckConfig once, and
+    // check(config) may then run any number of times, concurrently, on the
+    // same instance. Plugins that only implement the single-shot interface
+    // above return nullptr here.
+    virtual std::shared_ptr<const CheckConfig> parseConfig(
+        const std::vector<std::string>& args) const;
+    virtual PluginResult check(const CheckConfig& config) const;
+
+    // args in a canonical spelling, so that command lines configuring the
+    // same check share a cache key (resultCacheKey()). Plugins with an
+    // option table return canonicalOptions(); the default keeps args as
+    // given.
+    virtual std::vector<std::string> canonicalArguments(
+        const std::vector<std::string>& args) const;
+};
+
+// Base for re-entrant plugins. Implement parse() and run(); the single-shot
+// parseArguments()/check() interface is derived from them.
+template <typename Config>
+class ConfigurablePlugin : public Plugin {
+    static_assert(std::is_base_of<CheckConfig, Config>::value,
+                  "Config must derive from CheckConfig");
+
+public:
+    // Parse a command line; throw HelpRequested for --help and
+    // std::invalid_argument (or a std::stoi error) for bad input
+    virtual Config parse(const std::vector<std::string>& args) const = 0;
+
+    // Run the check. Must not modify the plugin.
+    virtual PluginResult run(const Config& config) const = 0;
+
+    std::shared_ptr<const CheckConfig> parseConfig(
+        const std::vector<std::string>& args) const override {
+        return std::make_shared<const Config>(parse(args));
+    }
+
+    PluginResult check(const CheckConfig& config) const override {
+        return run(static_cast<const Config&>(config));
+    }
+
+    void parseArguments(int argc, char* argv[]) override {
+        config = parseConfig(std::vector<std::string>(argv, argv + argc));
+    }
+
+    PluginResult check() override {
+        if (!config) {
+            config = parseConfig({""});
+        }
+        return check(*config);
+    }
+
+private:
+    std::shared_ptr<const CheckConfig> config;
+};
+
+// Factory creating a fresh, unconfigured plugin instance
+using PluginFactory = std::unique_ptr<Plugin> (*)();
+
+// Plugin families, matching the groups in the plugin reference
+enum class PluginCategory {
+    System,
+    Network,
+    Database,
+    Application,
+    Hardware,
+    Specialized,
+    Utility
+};
+
+// Static metadata recorded for each plugin at registration time
+struct PluginInfo {
+    std::string name;             // Short name, e.g. "tcp" for check_tcp
+    PluginCategory category;
+    PluginFactory factory;
+};
+
+// Registry of every plugin linked into the current executable.
+// Plugins add themselves at static-init time via NETMON_REGISTER_PLUGIN,
+// so a binary that links several plugin objects can enumerate them and
+// construct any of them by name without spawning a process.
+class PluginRegistry {
+public:
+    static PluginRegistry& instance();
+
+    // Register a plugin; returns false if the name is already taken
+    bool add(const PluginInfo& info);
+
+    // Metadata for a plugin, or nullptr if the name is unknown
+    const PluginInfo* find(const std::string& name) const;
+
+    // Create a new plugin instance, or nullptr if the name is unknown
+    std::unique_ptr<Plugin> create(const std::string& name) const;
+
+    bool contains(const std::string& name) const;
+    std::vector<std::string> names() const;
+    size_t size() const { return plugins.size(); }
+
+    // All registered plugins sorted by name, optionally for one category
+    std::vector<const PluginInfo*> list() const;
+    std::vector<const PluginInfo*> list(PluginCategory category) const;
+
+private:
+    PluginRegistry() = default;
+    std::map<std::string, PluginInfo> plugins;
 };
 
 // Utility functions
 std::string exitCodeToString(ExitCode code);
+std::string categoryToString(PluginCategory category);
+std::string formatResult(const PluginResult& result);
 void printResult(const PluginResult& result);
 int executePlugin(Plugin& plugin);
 
+// Run a plugin and print its result in format, as check checkName
+int executePlugin(Plugin& plugin, OutputFormat format, const std::string& checkName);
+
+// One line per registered plugin: "check_<name>\t<category>\t<description>"
+std::string formatPluginList();
+
+// Map a command name such as "/usr/libexec/check_tcp" to a plugin name ("tcp")
+std::string pluginNameFromCommand(const std::string& command);
+
+// Entry point shared by the check_* executables and the multicall binary.
+// A standalone executable runs its only plugin; the multicall binary picks
+// the plugin from argv[0] ("check_tcp" symlink) or from its first argument
+// ("netmon tcp ..."). "--output-format FORMAT" (nagios, json, prometheus,
+// influx or binary) and the result cache options (netmon/result_cache.hpp)
+// are taken out of the arguments before the plugin sees them.
+int runPluginMain(int argc, char* argv[]);
+
 } // namespace netmon_plugins
 
-#endif // NETMON_PLUGIN_HPP
+// Register a plugin class with the PluginRegistry at static-init time.
+// category is one of the PluginCategory enumerators, e.g. Network.
+#define NETMON_REGISTER_PLUGIN(name, PluginClass, category)                     \
+    namespace {                                                                 \
+    [[maybe_unused]] const bool netmonPluginRegistered =                        \
+        ::netmon_plugins::PluginRegistry::instance().add(                       \
+            {name, ::netmon_plugins::PluginCategory::category,                  \
+             []() -> std::unique_ptr<::netmon_plugins::Plugin> {                \
+                 return std::make_unique<PluginClass>();                        \
+             }});                                                               \
+    }
 
+#endif // NETMON_PLUGIN_HPP
@@ -0,0 +1,139 @@
+// netmon/result_cache.hpp
+// Opt-in caching of check results, in memory (agent) or on disk (one-shot)
+
+#ifndef NETMON_RESULT_CACHE_HPP
+#define NETMON_RESULT_CACHE_HPP
+
+#include "netmon/executor.hpp"
+#include "netmon/output_format.hpp"
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace netmon_plugins {
+
+// How long a cached result may be served. Within ttl it is served as is;
+// for a further staleFor it is still served while one caller refreshes it
+// (stale-while-revalidate). A zero ttl disables caching.
+struct CachePolicy {
+    std::chrono::seconds ttl{0};
+    std::chrono::seconds staleFor{0};
+
+    bool enabled() const { return ttl.count() > 0; }
+};
+
+// Default directory of the file-backed cache used by one-shot executables
+constexpr const char* DEFAULT_CACHE_DIR = "/run/netmon/cache";
+
+// Take "--cache-ttl SEC", "--cache-stale SEC" and "--cache-dir DIR" (also
+// in "--option=value" form) out of args and into policy / directory, so
+// that the same argument vector works for every host. Throws
+// std::invalid_argument for a missing or negative value.
+void extractCacheOptions(std::vector<std::string>& args, CachePolicy& policy,
+                         std::string& directory);
+
+// Cache key for a check: the plugin name and its arguments after args[0],
+// so "/usr/lib/nagios/check_http -H a" and "http -H a" share an entry.
+// Plugins linked into this executable spell the arguments canonically
+// first (Plugin::canonicalArguments()), so "-p 80 -H a" and "--hostname=a
+// --port=80" share one too; other commands are keyed as given.
+std::string resultCacheKey(const std::vector<std::string>& args);
+
+enum class CacheState {
+    MISS,    // Nothing usable cached
+    FRESH,   // Within the ttl
+    STALE    // Past the ttl but within staleFor
+};
+
+struct CacheLookup {
+    CacheState state = CacheState::MISS;
+    CheckOutcome outcome;   // The cached outcome unless MISS
+    bool refresh = false;   // This caller should run the check and store() it
+};
+
+// Thread-safe in-memory cache for long-lived hosts. The least recently
+// used entry is dropped once maxEntries are cached.
+class ResultCache {
+public:
+    using Clock = CheckClock;
+
+    explicit ResultCache(size_t maxEntries = 4096);
+
+    // A MISS always asks for a refresh. A STALE entry asks exactly one
+    // caller to refresh it; the others keep getting the stale outcome until
+    // that caller stores a new one or calls abandon().
+    CacheLookup lookup(const std::string& key, const CachePolicy& policy,
+                       Clock::time_point now = Clock::now());
+
+    // Store a finished check. UNKNOWN outcomes (timeouts, plugin errors)
+    // are not cached, so the next caller retries instead.
+    void store(const std::string& key, const CheckOutcome& outcome,
+               Clock::time_point now = Clock::now());
+
+    // Give up a refresh claimed through lookup() without storing a result
+    void abandon(const std::string& key);
+
+    size_t size() const;
+    void clear();
+
+private:
+    struct Entry {
+        std::string key;
+        CheckOutcome outcome;
+        Clock::time_point stored;
+        bool refreshing = false;
+    };
+
+    void touch(std::list<Entry>::iterator it);
+
+    size_t capacity;
+    mutable std::mutex mutex;
+    std::list<Entry> entries;   // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+};
+
+// File-backed cache shared by the processes of one-shot executables. Each
+// entry is one BINARY record (netmon/output_format.hpp) named by a hash of
+// its key. A STALE entry is refreshed by whichever process first takes its
+// lock; the others serve the stale record. The lock is released by store()
+// or when the cache object is destroyed. Missing directories are created,
+// mode 0700. Every failure (unusable directory, unreadable file) reads as
+// a MISS, so a broken cache never breaks a check. On Windows it caches
+// nothing: every lookup is a MISS.
+class FileResultCache {
+public:
+    explicit FileResultCache(std::string directory = DEFAULT_CACHE_DIR);
+    ~FileResultCache();
+
+    FileResultCache(const FileResultCache&) = delete;
+    FileResultCache& operator=(const FileResultCache&) = delete;
+
+    // On FRESH or STALE, record is the cached result with record.check
+    // left as stored by the caller
+    CacheState lookup(const std::string& key, const CachePolicy& policy,
+                      ResultRecord& record, bool& refresh);
+
+    // Write record atomically; UNKNOWN results are not cached
+    bool store(const std::string& key, const ResultRecord& record);
+
+    // Why nothing will be cached, e.g. "cannot create /run/netmon: ...";
+    // empty while the directory is usable
+    const std::string& error() const { return problem; }
+
+private:
+    std::string pathFor(const std::string& key) const;
+    bool lockEntry(const std::string& path);
+    void unlock();
+
+    std::string dir;
+    std::string problem;
+    int lockFd = -1;
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_RESULT_CACHE_HPP
@@ -0,0 +1,103 @@
+// netmon/scheduler.hpp
+// Interval scheduling of a check inventory with deterministic phase spreading
+
+#ifndef NETMON_SCHEDULER_HPP
+#define NETMON_SCHEDULER_HPP
+
+#include "netmon/deadline.hpp"
+#include "netmon/timer_wheel.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace netmon_plugins {
+
+// One check of an inventory, run every interval
+struct ScheduledCheck {
+    std::string id;                       // Label reported with the result
+    std::vector<std::string> args;        // As for runCheck()
+    std::chrono::seconds interval{0};     // 0 = the scheduler's default
+    int timeoutSeconds = 0;               // 0 = the host's default
+};
+
+// "90", "90s", "5m" or "1h"; false for anything else, including zero
+bool parseInterval(const std::string& text, std::chrono::seconds& interval);
+
+// Parse one inventory line: "[INTERVAL] [label:] plugin [args...]", i.e. a
+// batch file line (see parseBatchLine()) optionally preceded by its
+// interval. Returns false for blank and comment lines; throws
+// std::invalid_argument for malformed ones.
+bool parseInventoryLine(const std::string& line, ScheduledCheck& check);
+
+// Read a whole inventory. Unlabeled checks get their line number as id.
+// Malformed lines are reported in errors and skipped.
+std::vector<ScheduledCheck> readInventory(std::istream& input, std::vector<std::string>& errors);
+
+// Where in its interval a check runs: a hash of its id and arguments, so
+// the same inventory always spreads the same way, across restarts and
+// hosts, instead of every check firing at :00
+std::chrono::milliseconds phaseOffset(const ScheduledCheck& check,
+                                      std::chrono::seconds interval);
+
+// First run strictly after now for a check with this offset and interval,
+// aligned to the Unix epoch
+std::chrono::system_clock::time_point alignedRun(std::chrono::system_clock::time_point now,
+                                                 std::chrono::milliseconds offset,
+                                                 std::chrono::seconds interval);
+
+struct SchedulerOptions {
+    std::chrono::seconds defaultInterval{60};
+    std::chrono::milliseconds tick{100};   // Timer wheel resolution
+};
+
+// Runs every check of an inventory at its interval on a timer wheel driven
+// by one thread. Runs keep their phase: the next run is due one interval
+// after the previous one was due, however long the check took.
+class Scheduler {
+public:
+    // Called on the scheduler thread when a check is due, with its index
+    // in the inventory. Must not block: hand the check to a pool.
+    using Dispatch = std::function<void(size_t index, const ScheduledCheck& check)>;
+
+    Scheduler(std::vector<ScheduledCheck> checks, Dispatch dispatch,
+              const SchedulerOptions& options = SchedulerOptions());
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // start() again after stop() resumes the same schedule
+    void start();
+    void stop();
+
+    const std::vector<ScheduledCheck>& checks() const { return inventory; }
+    size_t dispatched() const { return runs.load(); }
+
+private:
+    std::chrono::seconds intervalOf(const ScheduledCheck& check) const;
+    void arm(size_t index, CheckClock::time_point when);
+    void loop();
+
+    std::vector<ScheduledCheck> inventory;
+    Dispatch dispatch;
+    SchedulerOptions options;
+    TimerWheel wheel;              // Only touched by the scheduler thread once started
+    std::vector<TimerId> timers;   // Next run of each check, cancelled by stop()
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool stopping = false;
+    std::atomic<size_t> runs{0};
+    std::thread thread;
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_SCHEDULER_HPP
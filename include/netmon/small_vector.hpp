@@ -0,0 +1,222 @@
+// netmon/small_vector.hpp
+// Vector that keeps its first N elements inline, without a heap allocation
+
+#ifndef NETMON_SMALL_VECTOR_HPP
+#define NETMON_SMALL_VECTOR_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace netmon_plugins {
+
+// A sequence with the subset of the std::vector interface the framework
+// needs. Up to N elements live inside the object; past that they move to
+// the heap, as one block like a vector's.
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs inline capacity");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+
+    SmallVector(std::initializer_list<T> values) {
+        reserve(values.size());
+        for (const T& value : values) {
+            push_back(value);
+        }
+    }
+
+    SmallVector(const SmallVector& other) {
+        reserve(other.count);
+        for (const T& value : other) {
+            push_back(value);
+        }
+    }
+
+    SmallVector(SmallVector&& other) noexcept { takeFrom(other); }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.count);
+            for (const T& value : other) {
+                push_back(value);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            clear();
+            releaseHeap();
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        clear();
+        releaseHeap();
+    }
+
+    T* data() { return heap ? heap : inlineData(); }
+    const T* data() const { return heap ? heap : inlineData(); }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + count; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + count; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return heap ? heapCapacity : N; }
+    bool empty() const { return count == 0; }
+
+    // True while the elements still fit in the inline storage
+    bool isInline() const { return heap == nullptr; }
+
+    T& operator[](size_t index) { return data()[index]; }
+    const T& operator[](size_t index) const { return data()[index]; }
+
+    T& at(size_t index) {
+        if (index >= count) {
+            throw std::out_of_range("SmallVector index out of range");
+        }
+        return data()[index];
+    }
+    const T& at(size_t index) const {
+        if (index >= count) {
+            throw std::out_of_range("SmallVector index out of range");
+        }
+        return data()[index];
+    }
+
+    T& front() { return data()[0]; }
+    const T& front() const { return data()[0]; }
+    T& back() { return data()[count - 1]; }
+    const T& back() const { return data()[count - 1]; }
+
+    void reserve(size_t wanted) {
+        if (wanted > capacity()) {
+            grow(wanted);
+        }
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (count == capacity()) {
+            // Build the new element before moving the old ones out: the
+            // arguments may refer to one of them
+            size_t newCapacity = grownCapacity(count * 2);
+            T* moved = static_cast<T*>(::operator new(newCapacity * sizeof(T)));
+            T* slot;
+            try {
+                slot = new (moved + count) T(std::forward<Args>(args)...);
+            } catch (...) {
+                ::operator delete(moved);
+                throw;
+            }
+            relocate(moved, newCapacity);
+            count++;
+            return *slot;
+        }
+        T* slot = new (data() + count) T(std::forward<Args>(args)...);
+        count++;
+        return *slot;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() {
+        data()[--count].~T();
+    }
+
+    void clear() {
+        T* items = data();
+        for (size_t i = 0; i < count; i++) {
+            items[i].~T();
+        }
+        count = 0;
+    }
+
+    // Append every element of another sequence
+    template <typename Range>
+    void append(const Range& values) {
+        // Grow once up front so that appending this vector to itself never
+        // reads from storage a reallocation has already released
+        reserve(count + static_cast<size_t>(std::distance(std::begin(values), std::end(values))));
+        for (const auto& value : values) {
+            push_back(value);
+        }
+    }
+
+private:
+    T* inlineData() { return std::launder(reinterpret_cast<T*>(storage)); }
+    const T* inlineData() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+
+    void grow(size_t wanted) {
+        size_t newCapacity = grownCapacity(wanted);
+        relocate(static_cast<T*>(::operator new(newCapacity * sizeof(T))), newCapacity);
+    }
+
+    size_t grownCapacity(size_t wanted) const {
+        size_t newCapacity = capacity() * 2;
+        return newCapacity < wanted ? wanted : newCapacity;
+    }
+
+    // Moves the elements into a fresh block of newCapacity and adopts it
+    void relocate(T* moved, size_t newCapacity) {
+        T* items = data();
+        for (size_t i = 0; i < count; i++) {
+            new (moved + i) T(std::move(items[i]));
+            items[i].~T();
+        }
+        releaseHeap();
+        heap = moved;
+        heapCapacity = newCapacity;
+    }
+
+    void releaseHeap() {
+        ::operator delete(heap);
+        heap = nullptr;
+        heapCapacity = 0;
+    }
+
+    // Leaves other empty; this must be empty and inline
+    void takeFrom(SmallVector& other) {
+        if (other.heap) {
+            heap = other.heap;
+            heapCapacity = other.heapCapacity;
+            count = other.count;
+            other.heap = nullptr;
+            other.heapCapacity = 0;
+            other.count = 0;
+            return;
+        }
+        T* items = other.inlineData();
+        for (size_t i = 0; i < other.count; i++) {
+            new (inlineData() + i) T(std::move(items[i]));
+        }
+        count = other.count;
+        other.clear();
+    }
+
+    alignas(T) unsigned char storage[N * sizeof(T)];
+    T* heap = nullptr;
+    size_t heapCapacity = 0;
+    size_t count = 0;
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_SMALL_VECTOR_HPP
@@ -0,0 +1,141 @@
+// netmon/socket_io.hpp
+// Deadline-aware name resolution, connect, TLS handshake and socket I/O
+
+#ifndef NETMON_SOCKET_IO_HPP
+#define NETMON_SOCKET_IO_HPP
+
+#include "netmon/deadline.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef NETMON_SSL_ENABLED
+typedef struct ssl_st SSL;
+#endif
+
+namespace netmon_plugins {
+
+#ifdef _WIN32
+using SocketFd = std::uintptr_t;
+constexpr SocketFd INVALID_SOCKET_FD = ~static_cast<SocketFd>(0);   // INVALID_SOCKET
+#else
+using SocketFd = int;
+constexpr SocketFd INVALID_SOCKET_FD = -1;
+#endif
+
+// Why a socket operation gave up
+enum class IoStatus {
+    OK,
+    CLOSED,       // Peer closed the connection
+    TIMED_OUT,    // The context deadline passed
+    CANCELLED,    // The context token was cancelled
+    FAILED        // Resolution, connect or I/O error
+};
+
+const char* ioStatusToString(IoStatus status);
+
+// One resolved endpoint: address family plus the raw sockaddr bytes
+struct ResolvedAddress {
+    int family = 0;
+    std::string sockaddr;
+};
+
+using AddressList = std::vector<ResolvedAddress>;
+
+// Resolve a literal IPv4/IPv6 address without blocking; false for names
+bool resolveNumeric(const std::string& host, int port, AddressList& addresses);
+
+// Blocking resolution with no deadline, for resolver threads
+bool lookupAddresses(const std::string& host, int port, AddressList& addresses,
+                     std::string& error);
+
+// Lookups running at once on the shared resolver threads, and lookups
+// queued behind them before lookupAsync() refuses more
+constexpr size_t RESOLVER_THREADS = 8;
+constexpr size_t RESOLVER_QUEUE_LIMIT = 1024;
+
+using LookupCallback =
+    std::function<void(bool ok, AddressList& addresses, const std::string& error)>;
+
+// Resolve host on the shared resolver threads and pass the result to done
+// on one of them. A request still queued when wanted() turns false is
+// dropped without a lookup, so callers that gave up cost nothing once DNS
+// recovers. Returns false, and never calls done, if the queue is full.
+bool lookupAsync(const std::string& host, int port, std::function<bool()> wanted,
+                 LookupCallback done);
+
+// Open a non-blocking socket and start connecting it. Returns
+// INVALID_SOCKET_FD if that fails outright; otherwise poll the socket for
+// writability and call finishConnect().
+SocketFd startConnect(const ResolvedAddress& address);
+
+// OK once a started connect has succeeded, FAILED if it was refused
+IoStatus finishConnect(SocketFd fd);
+
+// Non-blocking primitives for event loops; they never wait. readAvailable
+// appends whatever is buffered (up to limit bytes in total) and returns OK,
+// CLOSED at end of stream or FAILED. writeAvailable reports how much of
+// data the kernel took.
+IoStatus readAvailable(SocketFd fd, std::string& into, size_t limit);
+IoStatus writeAvailable(SocketFd fd, const char* data, size_t length, size_t& written);
+
+// Look at fd without consuming anything or waiting: OK with pending set if
+// bytes are waiting, CLOSED if the peer has closed it, FAILED on error
+IoStatus peekSocket(SocketFd fd, bool& pending);
+
+// Every call below honours one CheckContext: the deadline bounds the total
+// time spent in it, and cancelling the token makes it return within a few
+// tens of milliseconds. Sockets are non-blocking throughout.
+
+// Resolve host before the deadline. Names are looked up with lookupAsync();
+// if the deadline passes first the lookup is abandoned.
+IoStatus resolveAddresses(const std::string& host, int port, const CheckContext& context,
+                          AddressList& addresses, std::string& error);
+
+// Head start each connect attempt gets before the next address is tried
+// in parallel (RFC 8305 "Connection Attempt Delay")
+constexpr int CONNECT_ATTEMPT_DELAY_MS = 250;
+
+// Reorder addresses so that address families alternate
+AddressList interleaveFamilies(const AddressList& addresses);
+
+// Happy Eyeballs connect: start on addresses[0], and every attemptDelayMs
+// (or as soon as any attempt fails, even with others pending) start on the
+// next address without abandoning the earlier ones. The first connection to complete wins; its
+// index is stored in winner if given.
+SocketFd connectAny(const AddressList& addresses, const CheckContext& context,
+                    int attemptDelayMs, IoStatus& status, size_t* winner);
+
+// Resolve host and open a connected TCP socket, racing its IPv6 and IPv4
+// addresses with connectAny(). Returns INVALID_SOCKET_FD and sets
+// status/error on failure.
+SocketFd connectTcp(const std::string& host, int port, const CheckContext& context,
+                    IoStatus& status, std::string& error);
+
+void closeSocket(SocketFd fd);
+
+// Wait until fd is readable (or writable); OK, TIMED_OUT, CANCELLED or FAILED
+IoStatus waitSocket(SocketFd fd, bool forWrite, const CheckContext& context);
+
+// Write all of data
+IoStatus sendAll(SocketFd fd, const char* data, size_t length, const CheckContext& context);
+
+// Read whatever is available, at most length bytes, waiting for at least
+// one byte. received is 0 unless the status is OK.
+IoStatus recvSome(SocketFd fd, char* buffer, size_t length, size_t& received,
+                  const CheckContext& context);
+
+#ifdef NETMON_SSL_ENABLED
+// TLS counterparts for an SSL object bound to a non-blocking socket
+IoStatus tlsHandshake(SSL* ssl, SocketFd fd, const CheckContext& context);
+IoStatus tlsSendAll(SSL* ssl, SocketFd fd, const char* data, size_t length,
+                    const CheckContext& context);
+IoStatus tlsRecvSome(SSL* ssl, SocketFd fd, char* buffer, size_t length, size_t& received,
+                     const CheckContext& context);
+#endif
+
+} // namespace netmon_plugins
+
+#endif // NETMON_SOCKET_IO_HPP
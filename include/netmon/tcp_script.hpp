@@ -0,0 +1,126 @@
+// netmon/tcp_script.hpp
+// Scripted banner/expect/send checks for line-based TCP protocols
+
+#ifndef NETMON_TCP_SCRIPT_HPP
+#define NETMON_TCP_SCRIPT_HPP
+
+#include "netmon/deadline.hpp"
+#include "netmon/event_loop.hpp"
+#include "netmon/phase_timings.hpp"
+#include "netmon/socket_io.hpp"
+#include "netmon/timer_wheel.hpp"
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace netmon_plugins {
+
+// One step of a protocol conversation
+struct ScriptStep {
+    enum class Action {
+        SEND,           // Write text
+        EXPECT_TEXT,    // Read until the data contains text
+        EXPECT_LINE,    // Read one line (the first starting with lineStart)
+        EXPECT_REPLY    // Read one numeric reply, folding "250-" continuations
+    };
+
+    Action action = Action::SEND;
+    std::string text;                   // Data to send, or text to wait for
+    std::vector<std::string> accept;    // Line/reply must start with one of these
+    std::string lineStart;              // EXPECT_LINE: skip lines not starting with it
+    std::string when;                   // Run only if the last reply starts with it
+};
+
+// A conversation for TcpProbeEngine, built fluently:
+//
+//   TcpScript().expectReply({"220"}).send("QUIT\r\n")
+//
+// Every expectation must be met in order for the probe to succeed.
+class TcpScript {
+public:
+    TcpScript& send(const std::string& data);
+    TcpScript& expect(const std::string& text);
+    TcpScript& expectLine(const std::vector<std::string>& accept,
+                          const std::string& lineStart = "");
+    TcpScript& expectReply(const std::vector<std::string>& accept);
+
+    // Make the step just added conditional on the last reply's prefix, e.g.
+    // send a password only after "331 Password required"
+    TcpScript& when(const std::string& replyPrefix);
+
+    const std::vector<ScriptStep>& steps() const { return script; }
+    bool empty() const { return script.empty(); }
+
+private:
+    std::vector<ScriptStep> script;
+};
+
+struct TcpProbe {
+    std::string host;
+    int port = 0;
+    TcpScript script;
+    AddressList addresses;   // Tried in this order instead of resolving host, if set
+};
+
+struct TcpProbeResult {
+    IoStatus status = IoStatus::FAILED;   // Transport outcome
+    bool connected = false;               // The TCP connection was established
+    bool matched = false;                 // Every expectation was met
+    size_t failedStep = 0;                // Step that failed, if any
+    std::string reply;                    // Last reply received, all lines of a folded one
+    std::string error;
+    PhaseTimings timings;                 // Also reported to the context's recorder
+
+    bool ok() const { return status == IoStatus::OK && matched; }
+};
+
+// Runs any number of TCP probes concurrently on the calling thread.
+// Connects are non-blocking, readiness comes from one EventLoop, and each
+// probe has its own deadline and cancellation token. Host names are
+// resolved with lookupAsync(); literal addresses never leave the loop.
+class TcpProbeEngine {
+public:
+    using Callback = std::function<void(const TcpProbeResult&)>;
+
+    TcpProbeEngine();
+    ~TcpProbeEngine();
+
+    TcpProbeEngine(const TcpProbeEngine&) = delete;
+    TcpProbeEngine& operator=(const TcpProbeEngine&) = delete;
+
+    // Queue a probe; done runs on the thread calling run()
+    void add(const TcpProbe& probe, const CheckContext& context, Callback done);
+
+    // Drive every queued probe to completion
+    void run();
+
+    size_t active() const { return probes.size(); }
+
+private:
+    struct Probe;
+
+    void start(Probe& probe);
+    void connectNext(Probe& probe);
+    void onConnect(Probe& probe, SocketFd attempt);
+    void onEvent(Probe& probe, unsigned events);
+    void advance(Probe& probe);
+    void finish(Probe& probe, IoStatus status, bool matched, const std::string& error);
+    void expireProbes();
+
+    EventLoop loop;
+    std::map<size_t, std::unique_ptr<Probe>> probes;
+    TimerWheel deadlines;          // Probe deadlines and connect staggering, 1 ms resolution
+    CheckClock::time_point lastCancelScan;
+    size_t nextId = 0;
+};
+
+// Run one scripted probe to completion under context
+TcpProbeResult runTcpScript(const std::string& host, int port, const TcpScript& script,
+                            const CheckContext& context);
+
+} // namespace netmon_plugins
+
+#endif // NETMON_TCP_SCRIPT_HPP
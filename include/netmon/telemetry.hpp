@@ -0,0 +1,125 @@
+// netmon/telemetry.hpp
+// Self-metrics of the check runner: per-plugin counters and latency histograms
+
+#ifndef NETMON_TELEMETRY_HPP
+#define NETMON_TELEMETRY_HPP
+
+#include "netmon/output_format.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace netmon_plugins {
+
+// HDR-style histogram of durations in microseconds. Values below 128 us
+// have a bucket each; above that every power of two is split into 64
+// buckets, so a quantile is within 1.6% of the true value from 1 us to
+// 19 hours (longer durations count as 19 hours). Recording is one relaxed
+// atomic increment per counter, so any number of threads may record while
+// others read.
+class LatencyHistogram {
+public:
+    void record(std::chrono::microseconds value);
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    std::chrono::microseconds sum() const;
+    std::chrono::microseconds max() const;
+
+    // Smallest value at or below which a fraction q (0..1) of the recorded
+    // values lie, to the histogram's precision; 0 if nothing was recorded
+    std::chrono::microseconds quantile(double q) const;
+
+    static constexpr size_t BUCKETS = 1984;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sumUs{0};
+    std::atomic<uint64_t> maxUs{0};
+};
+
+// What one run of a check cost
+struct RunSample {
+    std::chrono::microseconds duration{0};
+    int exitCode = 3;
+    bool threw = false;          // The plugin threw instead of returning
+    bool timedOut = false;       // Finished past its deadline or cancelled
+    uint64_t connections = 0;    // Connections opened through the network layer
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t rssGrowthKb = 0;    // Rise of the process peak RSS during the run
+};
+
+// Running totals for one plugin, updated lock-free
+class PluginTelemetry {
+public:
+    void record(const RunSample& sample);
+
+    std::atomic<uint64_t> runs{0};
+    std::array<std::atomic<uint64_t>, 4> byExitCode{};   // OK..UNKNOWN
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> exceptions{0};
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> rssGrowthKb{0};
+    LatencyHistogram duration;
+};
+
+// A copy of one plugin's totals at a point in time
+struct PluginStats {
+    std::string plugin;
+    uint64_t runs = 0;
+    std::array<uint64_t, 4> byExitCode{};
+    uint64_t timeouts = 0;
+    uint64_t exceptions = 0;
+    uint64_t connections = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t rssGrowthKb = 0;
+    std::chrono::microseconds durationSum{0};
+    std::chrono::microseconds p50{0};
+    std::chrono::microseconds p90{0};
+    std::chrono::microseconds p99{0};
+    std::chrono::microseconds max{0};
+};
+
+// Telemetry of every plugin run in this process. PreparedCheck records
+// each run here; plugins appear on their first run.
+class ExecutionTelemetry {
+public:
+    static ExecutionTelemetry& global();
+
+    // Totals of a plugin, created on first use. The reference stays valid
+    // for the life of the telemetry, so callers may keep it.
+    PluginTelemetry& plugin(const std::string& name);
+
+    // Every plugin that has run, sorted by name
+    std::vector<PluginStats> snapshot() const;
+
+private:
+    mutable std::mutex mutex;   // Guards plugins, not their counters
+    std::map<std::string, std::unique_ptr<PluginTelemetry>> plugins;
+};
+
+// Peak resident set size of this process in KB; 0 where unknown
+uint64_t peakRssKilobytes();
+
+// Append stats in format. Prometheus gets netmon_plugin_* families
+// labelled plugin="..." (durations as a summary) and
+// netmon_process_peak_rss_bytes; every other format gets one record per
+// plugin through encodeResult(), its counters and duration quantiles as
+// metrics and "PLUGIN: N runs, ..." as the message.
+void encodeTelemetry(OutputFormat format, const std::vector<PluginStats>& stats,
+                     std::string& out);
+
+} // namespace netmon_plugins
+
+#endif // NETMON_TELEMETRY_HPP
@@ -0,0 +1,57 @@
+// netmon/thread_pool.hpp
+// Fixed-size worker pool for running checks in-process
+
+#ifndef NETMON_THREAD_POOL_HPP
+#define NETMON_THREAD_POOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace netmon_plugins {
+
+class ThreadPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // maxQueued = 0 means the backlog is unbounded
+    explicit ThreadPool(size_t workers, size_t maxQueued = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task; returns false if the pool is stopping or the backlog is full
+    bool submit(std::function<void()> task);
+
+    // Queue a task that should be finished by deadline. A worker still
+    // running it after that is written off and a new one takes its place,
+    // so tasks that hang (a plugin ignoring its check's deadline) cannot use
+    // up the pool; the stuck thread leaves once its task returns.
+    bool submit(std::function<void()> task, Clock::time_point deadline);
+
+    // Stop accepting work, finish queued tasks and wait for the workers;
+    // written-off workers are left to finish on their own
+    void shutdown();
+
+    size_t size() const;                    // Workers, written-off ones excluded
+    size_t pending() const;
+    uint64_t replaced() const;              // Workers written off so far
+
+private:
+    struct State;
+
+    static void workerLoop(std::shared_ptr<State> state, size_t slot);
+    static void startWorker(const std::shared_ptr<State>& state);
+    void superviseLoop();
+
+    // Shared with the workers, which are detached: a stuck one may outlive
+    // the pool
+    std::shared_ptr<State> state;
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_THREAD_POOL_HPP
@@ -0,0 +1,78 @@
+// netmon/threshold.hpp
+// Nagios threshold ranges ("10", "10:", "~:10", "10:20", "@10:20")
+
+#ifndef NETMON_THRESHOLD_HPP
+#define NETMON_THRESHOLD_HPP
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace netmon_plugins {
+
+enum class ExitCode;   // netmon/plugin.hpp
+
+// One range in Nagios plugin syntax, compiled to two bounds and a flag so
+// that testing a value is two comparisons:
+//
+//   10      alert if < 0 or > 10
+//   10:     alert if < 10
+//   ~:10    alert if > 10
+//   10:20   alert if < 10 or > 20
+//   @10:20  alert if >= 10 and <= 20
+//
+// A default-constructed range is unset and never alerts.
+class ThresholdRange {
+public:
+    ThresholdRange() = default;
+
+    // Throw std::invalid_argument for malformed text or start > end
+    static ThresholdRange parse(std::string_view text);
+
+    // Same without throwing; range is untouched on failure
+    static bool tryParse(std::string_view text, ThresholdRange& range);
+
+    // Ranges for plain upper or lower limits, e.g. from legacy options
+    static ThresholdRange above(double limit);   // Alert if > limit ("~:limit")
+    static ThresholdRange below(double limit);   // Alert if < limit ("limit:")
+
+    bool isSet() const { return set; }
+    bool isInside() const { return inside; }
+    double start() const { return low; }
+    double end() const { return high; }
+
+    bool alerts(double value) const {
+        return set && ((value < low || value > high) != inside);
+    }
+
+    // Canonical range text for perfdata; empty if unset
+    std::string toString() const;
+
+private:
+    double low = 0.0;
+    double high = std::numeric_limits<double>::infinity();
+    bool inside = false;   // "@": alert inside the range instead of outside
+    bool set = false;
+};
+
+// A warning and a critical range, evaluated together
+struct Thresholds {
+    ThresholdRange warning;
+    ThresholdRange critical;
+
+    // CRITICAL, WARNING or OK for one value
+    ExitCode evaluate(double value) const;
+
+    // The worst state over many values, e.g. one per disk or process
+    ExitCode evaluate(const double* values, size_t count) const;
+};
+
+// Parse a comma-separated list such as "5,4,3" or "10:,~:20" into at most
+// maxRanges ranges, leaving empty items unset. Returns the number of items
+// or throws std::invalid_argument.
+size_t parseThresholdList(std::string_view text, ThresholdRange* ranges, size_t maxRanges);
+
+} // namespace netmon_plugins
+
+#endif // NETMON_THRESHOLD_HPP
@@ -0,0 +1,101 @@
+// netmon/timer_wheel.hpp
+// Hierarchical timer wheel for check intervals, retries and I/O deadlines
+
+#ifndef NETMON_TIMER_WHEEL_HPP
+#define NETMON_TIMER_WHEEL_HPP
+
+#include "netmon/deadline.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace netmon_plugins {
+
+// Handle of a scheduled timer, for cancel(). Stays harmless after the timer
+// has fired or been cancelled: a stale handle never matches a newer timer.
+using TimerId = uint64_t;
+constexpr TimerId NO_TIMER = 0;
+
+// Timers rounded up to a fixed tick and kept in four levels of 256 slots
+// each. Level 0 holds the next 256 ticks one slot per tick; each level up
+// covers 256 times the span of the one below, and its slots are spread
+// over the level below as time reaches them. Scheduling and cancelling are
+// O(1) whatever the number of timers; advancing costs one slot per tick
+// plus the occasional cascade, and skips idle stretches outright.
+//
+// With the default 1 ms tick the four levels span about 49 days; timers
+// beyond that wait on an overflow list. Not thread-safe: one thread owns
+// the wheel and calls advance(); callbacks run on that thread and may
+// schedule and cancel timers, including their own.
+class TimerWheel {
+public:
+    using Callback = std::function<void()>;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(1),
+                        CheckClock::time_point start = CheckClock::now());
+
+    // Fire callback at the first tick at or after when; past times fire on
+    // the next advance()
+    TimerId schedule(CheckClock::time_point when, Callback callback);
+
+    // Drop a pending timer. False if it already fired or was cancelled.
+    bool cancel(TimerId id);
+
+    // Run every timer due by now, in tick order. Returns how many ran.
+    size_t advance(CheckClock::time_point now = CheckClock::now());
+
+    // A time by which the next timer is due; possibly earlier when that
+    // timer still sits on an upper level, never later. time_point::max()
+    // if the wheel is empty. A caller can sleep until then and advance().
+    CheckClock::time_point nextExpiry() const;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    std::chrono::milliseconds tick() const { return tickLength; }
+
+private:
+    static constexpr unsigned LEVEL_BITS = 8;
+    static constexpr unsigned SLOTS = 1u << LEVEL_BITS;
+    static constexpr unsigned LEVELS = 4;
+    static constexpr uint32_t NIL = 0xffffffffu;
+
+    // Lists: LEVELS * SLOTS wheel slots, then the overflow and the list
+    // of timers being fired
+    static constexpr uint32_t OVERFLOW_LIST = LEVELS * SLOTS;
+    static constexpr uint32_t FIRING_LIST = OVERFLOW_LIST + 1;
+    static constexpr uint32_t FREE = FIRING_LIST + 1;
+
+    struct Node {
+        uint64_t expires = 0;        // Tick
+        Callback callback;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t list = FREE;
+        uint32_t generation = 0;
+    };
+
+    uint64_t tickOf(CheckClock::time_point when) const;
+    CheckClock::time_point timeOf(uint64_t tick) const;
+    void place(uint32_t index);
+    void link(uint32_t index, uint32_t list);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(uint32_t list);
+    uint64_t nextBoundary() const;
+
+    std::chrono::milliseconds tickLength;
+    CheckClock::time_point origin;
+    uint64_t current = 0;                   // Next tick to process
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+    std::array<uint32_t, FIRING_LIST + 1> heads;
+    std::array<size_t, LEVELS + 1> perLevel{};   // Timers per level, overflow last
+    size_t count = 0;
+};
+
+} // namespace netmon_plugins
+
+#endif // NETMON_TIMER_WHEEL_HPP
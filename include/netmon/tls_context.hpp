@@ -0,0 +1,72 @@
+// netmon/tls_context.hpp
+// Process-wide TLS client contexts and session cache
+
+#ifndef NETMON_TLS_CONTEXT_HPP
+#define NETMON_TLS_CONTEXT_HPP
+
+#ifdef NETMON_SSL_ENABLED
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_session_st SSL_SESSION;
+
+namespace netmon_plugins {
+namespace net {
+
+// One SSL_CTX per set of verification settings, created on first use and
+// kept for the life of the process, so CA certificates are read from disk
+// once; and the last resumable session per server, so the next connection
+// to it resumes (TLS 1.2 session IDs or TLS 1.3 tickets) instead of doing
+// a full handshake. net::Connection uses both. Thread-safe.
+class TlsClientCache {
+public:
+    static TlsClientCache& shared();
+
+    // Client context verifying the peer against caFile (the system default
+    // paths if empty), or not verifying at all; null if OpenSSL fails
+    SSL_CTX* context(bool verifyPeer, const std::string& caFile);
+
+    // A fresh copy of the session stored under key, which the caller must
+    // SSL_SESSION_free(); null if there is none
+    SSL_SESSION* session(const std::string& key);
+
+    // Keep a copy of session as the one to resume for key; null forgets key
+    void storeSession(const std::string& key, SSL_SESSION* session);
+
+    size_t sessionCount() const;
+    void clearSessions();
+
+    // Sessions kept at most; the oldest is dropped first
+    static constexpr size_t MAX_SESSIONS = 1024;
+
+private:
+    TlsClientCache() = default;
+
+    struct ContextDeleter {
+        void operator()(SSL_CTX* context) const;
+    };
+    // Sessions are kept DER-encoded: every handshake then starts from its
+    // own copy, and OpenSSL does not resume from a session object that an
+    // earlier connection still holds and has updated
+    struct StoredSession {
+        std::string der;
+        unsigned long long stored;
+    };
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::unique_ptr<SSL_CTX, ContextDeleter>> contexts;
+    std::map<std::string, StoredSession> sessions;
+    unsigned long long stores = 0;
+};
+
+} // namespace net
+} // namespace netmon_plugins
+
+#endif // NETMON_SSL_ENABLED
+
+#endif // NETMON_TLS_CONTEXT_HPP
@@ -89,19 +89,19 @@ public:
                 msg << " (" << workersBusy << " busy, " << workersIdle << " idle workers)";
             }
             
-            std::ostringstream perfdata;
-            if (totalAccesses >= 0) perfdata << "total_accesses=" << totalAccesses << " ";
-            if (totalKBytes >= 0) perfdata << "total_kbytes=" << totalKBytes << " ";
-            if (cpuLoad >= 0) perfdata << "cpu_load=" << cpuLoad << " ";
-            if (requestsPerSec >= 0) perfdata << "req_per_sec=" << requestsPerSec << " ";
-            if (bytesPerSec >= 0) perfdata << "bytes_per_sec=" << bytesPerSec << " ";
-            if (workersBusy >= 0) perfdata << "busy_workers=" << workersBusy << " ";
-            if (workersIdle >= 0) perfdata << "idle_workers=" << workersIdle;
+            netmon_plugins::PerfMetrics perfdata;
+            if (totalAccesses >= 0) perfdata.emplace_back("total_accesses", totalAccesses, "c");
+            if (totalKBytes >= 0) perfdata.emplace_back("total_kbytes", totalKBytes, "KB");
+            if (cpuLoad >= 0) perfdata.emplace_back("cpu_load", cpuLoad);
+            if (requestsPerSec >= 0) perfdata.emplace_back("req_per_sec", requestsPerSec);
+            if (bytesPerSec >= 0) perfdata.emplace_back("bytes_per_sec", bytesPerSec);
+            if (workersBusy >= 0) perfdata.emplace_back("busy_workers", workersBusy);
+            if (workersIdle >= 0) perfdata.emplace_back("idle_workers", workersIdle);
             
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::OK,
                 msg.str(),
-                perfdata.str()
+                std::move(perfdata)
             );
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
@@ -114,8 +114,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -158,9 +157,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    ApachePlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("apache", ApachePlugin, Application)
 
@@ -47,8 +47,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
                 if (i + 1 < argc) {
                     warningUpdates = std::stoi(argv[++i]);
@@ -78,9 +77,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    AptPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("apt", AptPlugin, Application)
 
@@ -27,8 +27,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--type") == 0) {
                 if (i + 1 < argc) {
                     clusterType = argv[++i];
@@ -58,9 +57,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    ClusterPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("cluster", ClusterPlugin, Application)
 
@@ -43,16 +43,19 @@ public:
                 path = "/v1/health/state/any";
             }
             
-            int statusCode = 0;
-            std::string response;
-            
-            // Consul uses X-Consul-Token header for authentication
-            // For now, we'll use basic HTTP GET (token auth can be added later)
-            response = netmon_plugins::httpGet(
-                hostname, port, path, false, timeoutSeconds, statusCode
-            );
+            netmon_plugins::HttpRequest request;
+            request.host = hostname;
+            request.port = port;
+            request.path = path;
+            request.timeoutSeconds = timeoutSeconds;
+            if (!token.empty()) {
+                request.header("X-Consul-Token", token);
+            }
+            netmon_plugins::HttpResponse reply = netmon_plugins::httpRequest(request);
+            const int statusCode = reply.statusCode;
+            const std::string& response = reply.body;
             
-            if (statusCode != 200 || response.empty()) {
+            if (!reply.complete() || statusCode != 200 || response.empty()) {
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::CRITICAL,
                     "Consul CRITICAL - Cannot connect to API or invalid response (status: " + 
@@ -119,13 +122,13 @@ public:
                 std::ostringstream msg;
                 msg << "Consul OK - " << memberCount << " cluster members";
                 
-                std::ostringstream perfdata;
-                perfdata << "members=" << memberCount;
+                netmon_plugins::PerfMetrics perfdata;
+                perfdata.emplace_back("members", memberCount);
                 
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::OK,
                     msg.str(),
-                    perfdata.str()
+                    std::move(perfdata)
                 );
             } else if (checkType == "services") {
                 // Count registered services
@@ -139,13 +142,13 @@ public:
                 std::ostringstream msg;
                 msg << "Consul OK - " << serviceCount << " services registered";
                 
-                std::ostringstream perfdata;
-                perfdata << "services=" << serviceCount;
+                netmon_plugins::PerfMetrics perfdata;
+                perfdata.emplace_back("services", serviceCount);
                 
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::OK,
                     msg.str(),
-                    perfdata.str()
+                    std::move(perfdata)
                 );
             }
             
@@ -164,8 +167,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -208,9 +210,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    ConsulPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("consul", ConsulPlugin, Application)
 
@@ -76,16 +76,16 @@ public:
                     );
                 }
                 
-                std::ostringstream perfdata;
-                perfdata << "nodes=" << nodeCount;
+                netmon_plugins::PerfMetrics perfdata;
+                perfdata.emplace_back("nodes", nodeCount);
                 if (!balanced.empty()) {
-                    perfdata << " balanced=" << balanced;
+                    perfdata.emplace_back("balanced", balanced == "true" ? 1 : 0);
                 }
                 
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::OK,
                     msg.str(),
-                    perfdata.str()
+                    std::move(perfdata)
                 );
             } else if (checkType == "nodes") {
                 // Parse node information
@@ -100,13 +100,13 @@ public:
                 std::ostringstream msg;
                 msg << "Couchbase OK - " << nodeCount << " nodes available";
                 
-                std::ostringstream perfdata;
-                perfdata << "nodes=" << nodeCount;
+                netmon_plugins::PerfMetrics perfdata;
+                perfdata.emplace_back("nodes", nodeCount);
                 
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::OK,
                     msg.str(),
-                    perfdata.str()
+                    std::move(perfdata)
                 );
             } else {
                 std::ostringstream msg;
@@ -127,8 +127,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -176,9 +175,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    CouchbasePlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("couchbase", CouchbasePlugin, Application)
 
@@ -85,16 +85,20 @@ private:
         if (host.empty() || host == "255.255.255.255") {
             serverAddr.sin_addr.s_addr = INADDR_BROADCAST;
         } else {
-            serverAddr.sin_addr.s_addr = inet_addr(host.c_str());
-            if (serverAddr.sin_addr.s_addr == INADDR_NONE) {
-                // Try DNS resolution
-                struct hostent* he = gethostbyname(host.c_str());
-                if (he == nullptr) {
-                    closesocket(sock);
-                    WSACleanup();
-                    return false;
-                }
-                memcpy(&serverAddr.sin_addr, he->h_addr_list[0], he->h_length);
+            // getaddrinfo rather than gethostbyname: checks share the
+            // process and gethostbyname returns a static buffer
+            struct addrinfo hints, *result;
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_DGRAM;
+
+            if (getaddrinfo(host.c_str(), "67", &hints, &result) == 0) {
+                memcpy(&serverAddr, result->ai_addr, result->ai_addrlen);
+                freeaddrinfo(result);
+            } else {
+                closesocket(sock);
+                WSACleanup();
+                return false;
             }
         }
         
@@ -263,8 +267,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -300,9 +303,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    DhcpPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("dhcp", DhcpPlugin, Network)
 
@@ -1,7 +1,10 @@
 // plugins/disk/check_disk.cpp
 // Disk space monitoring plugin
 
+#include "netmon/options.hpp"
 #include "netmon/plugin.hpp"
+#include "netmon/threshold.hpp"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -9,6 +12,7 @@
 #include <vector>
 #include <stdexcept>
 #include <cerrno>
+#include <cstdlib>
 
 #ifdef __APPLE__
 #include <sys/statvfs.h>
@@ -21,14 +25,51 @@
 
 namespace {
 
-class DiskPlugin : public netmon_plugins::Plugin {
-private:
-    double warningPercent = 10.0;    // Default: warn if < 10% free
-    double criticalPercent = 5.0;    // Default: critical if < 5% free
-    long long warningFree = -1;       // Warning if free < this (in MB)
-    long long criticalFree = -1;      // Critical if free < this (in MB)
+struct DiskConfig : netmon_plugins::CheckConfig {
+    // Free space limits as ranges over free MB and free percent; either
+    // one tripping is enough. Default: warn below 10%, critical below 5%.
+    netmon_plugins::Thresholds freeMb;
+    netmon_plugins::Thresholds freePercent{netmon_plugins::ThresholdRange::below(10.0),
+                                           netmon_plugins::ThresholdRange::below(5.0)};
     std::vector<std::string> paths;  // Paths to check
+};
 
+// "10%" or "500" (MB): alert when free space drops below it
+bool parseFreeLimit(const char* text, netmon_plugins::ThresholdRange& mb,
+                    netmon_plugins::ThresholdRange& percent) {
+    char* end = nullptr;
+    const double limit = std::strtod(text, &end);
+    if (end == text || limit < 0) {
+        return false;
+    }
+    if (end[0] == '%' && end[1] == '\0') {
+        percent = netmon_plugins::ThresholdRange::below(limit);
+    } else if (end[0] == '\0') {
+        mb = netmon_plugins::ThresholdRange::below(limit);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseWarning(DiskConfig& config, const char* text) {
+    return parseFreeLimit(text, config.freeMb.warning, config.freePercent.warning);
+}
+
+bool parseCritical(DiskConfig& config, const char* text) {
+    return parseFreeLimit(text, config.freeMb.critical, config.freePercent.critical);
+}
+
+constexpr netmon_plugins::Option<DiskConfig> OPTIONS[] = {
+    netmon_plugins::custom<parseWarning>('w', "warning", "THRESHOLD",
+                                         "Warning if free < THRESHOLD (MB or %, default: 10%)"),
+    netmon_plugins::custom<parseCritical>('c', "critical", "THRESHOLD",
+                                          "Critical if free < THRESHOLD (MB or %, default: 5%)"),
+    netmon_plugins::positional<&DiskConfig::paths>("PATH...", "Filesystems to check"),
+};
+
+class DiskPlugin : public netmon_plugins::ConfigurablePlugin<DiskConfig> {
+private:
     struct DiskInfo {
         std::string path;
         long long total;      // Total space in MB
@@ -38,7 +79,7 @@ private:
         double freePercent;   // Free percentage
     };
 
-    DiskInfo getDiskInfo(const std::string& path) {
+    static DiskInfo getDiskInfo(const std::string& path) {
         DiskInfo info;
         info.path = path;
         
@@ -80,7 +121,7 @@ private:
         return info;
     }
 
-    std::string formatSize(long long mb) {
+    static std::string formatSize(long long mb) {
         if (mb >= 1024) {
             return std::to_string(mb / 1024) + "GB";
         } else {
@@ -89,7 +130,8 @@ private:
     }
 
 public:
-    netmon_plugins::PluginResult check() override {
+    netmon_plugins::PluginResult run(const DiskConfig& config) const override {
+        std::vector<std::string> paths = config.paths;
         try {
             if (paths.empty()) {
                 // Default: check root filesystem
@@ -103,30 +145,23 @@ public:
             std::vector<DiskInfo> diskInfos;
             netmon_plugins::ExitCode overallCode = netmon_plugins::ExitCode::OK;
             std::ostringstream msg;
-            std::ostringstream perfdata;
+            netmon_plugins::PerfMetrics perfdata;
             
             for (const auto& path : paths) {
                 try {
                     DiskInfo info = getDiskInfo(path);
                     diskInfos.push_back(info);
                     
-                    bool isCritical = false;
-                    bool isWarning = false;
-                    
                     // Check thresholds
-                    if (criticalFree > 0 && info.available < criticalFree) {
-                        isCritical = true;
-                    } else if (criticalPercent > 0 && info.freePercent < criticalPercent) {
-                        isCritical = true;
-                    } else if (warningFree > 0 && info.available < warningFree) {
-                        isWarning = true;
-                    } else if (warningPercent > 0 && info.freePercent < warningPercent) {
-                        isWarning = true;
-                    }
+                    const netmon_plugins::ExitCode byMb =
+                        config.freeMb.evaluate(static_cast<double>(info.available));
+                    const netmon_plugins::ExitCode byPercent = config.freePercent.evaluate(info.freePercent);
+                    const netmon_plugins::ExitCode state = std::max(byMb, byPercent);
                     
-                    if (isCritical) {
+                    if (state == netmon_plugins::ExitCode::CRITICAL) {
                         overallCode = netmon_plugins::ExitCode::CRITICAL;
-                    } else if (isWarning && overallCode == netmon_plugins::ExitCode::OK) {
+                    } else if (state == netmon_plugins::ExitCode::WARNING &&
+                               overallCode == netmon_plugins::ExitCode::OK) {
                         overallCode = netmon_plugins::ExitCode::WARNING;
                     }
                     
@@ -137,15 +172,23 @@ public:
                     msg << path << ": " << formatSize(info.available) << " free ("
                         << std::fixed << std::setprecision(1) << info.freePercent << "% free)";
                     
-                    // Build performance data
-                    if (!perfdata.str().empty()) {
-                        perfdata << " ";
-                    }
-                    perfdata << path << "=" << info.used << "MB;" 
-                             << (warningFree > 0 ? warningFree : static_cast<long long>(info.total * (100.0 - warningPercent) / 100.0))
-                             << ";" 
-                             << (criticalFree > 0 ? criticalFree : static_cast<long long>(info.total * (100.0 - criticalPercent) / 100.0))
-                             << ";" << info.total << ";0";
+                    // Used space, with the free-space thresholds turned
+                    // into the used levels at which they trip
+                    auto usedLimit = [&info](const netmon_plugins::ThresholdRange& mb,
+                                             const netmon_plugins::ThresholdRange& percent) {
+                        if (mb.isSet()) {
+                            return std::to_string(info.total - static_cast<long long>(mb.start()));
+                        }
+                        if (percent.isSet()) {
+                            return std::to_string(static_cast<long long>(
+                                info.total * (100.0 - percent.start()) / 100.0));
+                        }
+                        return std::string();
+                    };
+                    perfdata.emplace_back(path, info.used, "MB")
+                        .thresholds(usedLimit(config.freeMb.warning, config.freePercent.warning),
+                                    usedLimit(config.freeMb.critical, config.freePercent.critical))
+                        .range(0, info.total);
                     
                 } catch (const std::exception& e) {
                     if (overallCode == netmon_plugins::ExitCode::OK) {
@@ -164,7 +207,7 @@ public:
             
             std::string resultMsg = "Disk " + statusStr + " - " + msg.str();
             
-            return netmon_plugins::PluginResult(overallCode, resultMsg, perfdata.str());
+            return netmon_plugins::PluginResult(overallCode, resultMsg, std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -173,44 +216,20 @@ public:
         }
     }
     
-    void parseArguments(int argc, char* argv[]) override {
-        for (int i = 1; i < argc; i++) {
-            if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
-            } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
-                if (i + 1 < argc) {
-                    std::string threshold = argv[++i];
-                    if (threshold.back() == '%') {
-                        warningPercent = std::stod(threshold.substr(0, threshold.length() - 1));
-                    } else {
-                        warningFree = std::stoll(threshold);
-                    }
-                }
-            } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--critical") == 0) {
-                if (i + 1 < argc) {
-                    std::string threshold = argv[++i];
-                    if (threshold.back() == '%') {
-                        criticalPercent = std::stod(threshold.substr(0, threshold.length() - 1));
-                    } else {
-                        criticalFree = std::stoll(threshold);
-                    }
-                }
-            } else if (argv[i][0] != '-') {
-                // Path argument
-                paths.push_back(argv[i]);
-            }
-        }
+    DiskConfig parse(const std::vector<std::string>& args) const override {
+        DiskConfig config;
+        netmon_plugins::parseOptions(OPTIONS, args, config);
+        return config;
+    }
+    
+    std::vector<std::string> canonicalArguments(
+        const std::vector<std::string>& args) const override {
+        return netmon_plugins::canonicalOptions(OPTIONS, args);
     }
     
     std::string getUsage() const override {
-        return "Usage: check_disk [options] [path1] [path2] ...\n"
-               "Options:\n"
-               "  -w, --warning THRESHOLD    Warning if free < THRESHOLD (MB or %, default: 10%)\n"
-               "  -c, --critical THRESHOLD    Critical if free < THRESHOLD (MB or %, default: 5%)\n"
-               "  -h, --help                 Show this help message\n"
-               "\n"
-               "If no paths are specified, checks the root filesystem.";
+        return netmon_plugins::formatUsage("check_disk [options] [path1] [path2] ...", OPTIONS) +
+               "\n\nIf no paths are specified, checks the root filesystem.";
     }
     
     std::string getDescription() const override {
@@ -220,9 +239,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    DiskPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("disk", DiskPlugin, System)
 
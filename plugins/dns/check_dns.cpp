@@ -140,10 +140,11 @@ public:
                 }
             }
             
-            std::ostringstream perfdata;
-            perfdata << "dns_resolution_time=0ms addresses=" << addresses.size();
+            netmon_plugins::PerfMetrics perfdata;
+            perfdata.emplace_back("dns_resolution_time", 0, "ms");
+            perfdata.emplace_back("addresses", addresses.size());
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -155,8 +156,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -194,9 +194,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    DnsPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("dns", DnsPlugin, Network)
 
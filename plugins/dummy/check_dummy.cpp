@@ -1,56 +1,48 @@
 // plugins/dummy/check_dummy.cpp
 // Dummy plugin for testing
 
+#include "netmon/options.hpp"
 #include "netmon/plugin.hpp"
-#include <iostream>
-#include <sstream>
-#include <cstring>
+#include <string>
+#include <vector>
 
 namespace {
 
-class DummyPlugin : public netmon_plugins::Plugin {
-private:
+struct DummyConfig : netmon_plugins::CheckConfig {
     int exitCode = 0;
     std::string message = "This is a dummy plugin";
+};
+
+constexpr netmon_plugins::Option<DummyConfig> OPTIONS[] = {
+    netmon_plugins::flag<&DummyConfig::exitCode, 0>('o', "ok", "Return OK status"),
+    netmon_plugins::flag<&DummyConfig::exitCode, 1>('w', "warning", "Return WARNING status"),
+    netmon_plugins::flag<&DummyConfig::exitCode, 2>('c', "critical", "Return CRITICAL status"),
+    netmon_plugins::flag<&DummyConfig::exitCode, 3>('u', "unknown", "Return UNKNOWN status"),
+    netmon_plugins::option<&DummyConfig::message>('m', "message", "MSG", "Set output message"),
+};
 
+class DummyPlugin : public netmon_plugins::ConfigurablePlugin<DummyConfig> {
 public:
-    netmon_plugins::PluginResult check() override {
+    netmon_plugins::PluginResult run(const DummyConfig& config) const override {
         return netmon_plugins::PluginResult(
-            static_cast<netmon_plugins::ExitCode>(exitCode),
-            message
+            static_cast<netmon_plugins::ExitCode>(config.exitCode),
+            config.message
         );
     }
     
-    void parseArguments(int argc, char* argv[]) override {
-        for (int i = 1; i < argc; i++) {
-            if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
-            } else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--ok") == 0) {
-                exitCode = 0;
-            } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
-                exitCode = 1;
-            } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--critical") == 0) {
-                exitCode = 2;
-            } else if (strcmp(argv[i], "-u") == 0 || strcmp(argv[i], "--unknown") == 0) {
-                exitCode = 3;
-            } else if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--message") == 0) {
-                if (i + 1 < argc) {
-                    message = argv[++i];
-                }
-            }
-        }
+    DummyConfig parse(const std::vector<std::string>& args) const override {
+        DummyConfig config;
+        netmon_plugins::parseOptions(OPTIONS, args, config);
+        return config;
+    }
+    
+    std::vector<std::string> canonicalArguments(
+        const std::vector<std::string>& args) const override {
+        return netmon_plugins::canonicalOptions(OPTIONS, args);
     }
     
     std::string getUsage() const override {
-        return "Usage: check_dummy [options]\n"
-               "Options:\n"
-               "  -o, --ok          Return OK status\n"
-               "  -w, --warning     Return WARNING status\n"
-               "  -c, --critical    Return CRITICAL status\n"
-               "  -u, --unknown     Return UNKNOWN status\n"
-               "  -m, --message MSG Set output message\n"
-               "  -h, --help        Show this help message";
+        return netmon_plugins::formatUsage("check_dummy [options]", OPTIONS);
     }
     
     std::string getDescription() const override {
@@ -60,9 +52,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    DummyPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("dummy", DummyPlugin, Utility)
 
@@ -60,10 +60,11 @@ private:
             msg << "Elasticsearch WARNING - Cluster \"" << clusterName << "\" status: YELLOW";
         }
         
-        std::ostringstream perfdata;
-        perfdata << "nodes=" << numberOfNodes << " data_nodes=" << numberOfDataNodes;
+        netmon_plugins::PerfMetrics perfdata;
+        perfdata.emplace_back("nodes", numberOfNodes);
+        perfdata.emplace_back("data_nodes", numberOfDataNodes);
         
-        return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+        return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
     }
 
 public:
@@ -95,8 +96,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -144,9 +144,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    ElasticsearchPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("elasticsearch", ElasticsearchPlugin, Application)
 
@@ -105,13 +105,13 @@ public:
                     std::ostringstream msg;
                     msg << "etcd OK - " << memberCount << " cluster members";
                     
-                    std::ostringstream perfdata;
-                    perfdata << "members=" << memberCount;
+                    netmon_plugins::PerfMetrics perfdata;
+                    perfdata.emplace_back("members", memberCount);
                     
                     return netmon_plugins::PluginResult(
                         netmon_plugins::ExitCode::OK,
                         msg.str(),
-                        perfdata.str()
+                        std::move(perfdata)
                     );
                 } else {
                     return netmon_plugins::PluginResult(
@@ -136,8 +136,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -175,9 +174,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    EtcdPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("etcd", EtcdPlugin, Application)
 
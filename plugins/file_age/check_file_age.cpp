@@ -127,13 +127,13 @@ public:
                 msg << " (exceeds warning threshold of " << formatAge(warningAge) << ")";
             }
 
-            std::ostringstream perfdata;
-            perfdata << "age=" << age << "s";
+            netmon_plugins::PerfMetrics perfdata;
+            netmon_plugins::PerfMetric& ageMetric = perfdata.emplace_back("age", age, "s");
             if (warningAge >= 0) {
-                perfdata << ";" << warningAge << ";" << criticalAge;
+                ageMetric.thresholds(warningAge, criticalAge);
             }
 
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -145,8 +145,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--file") == 0) {
                 if (i + 1 < argc) {
                     filePath = argv[++i];
@@ -211,9 +210,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    FileAgePlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("file_age", FileAgePlugin, System)
 
@@ -2,6 +2,7 @@
 // File count in directory monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/threshold.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
@@ -26,8 +27,7 @@ private:
     std::string directory;
     std::string pattern;
     bool recursive = false;
-    int warningCount = -1;
-    int criticalCount = -1;
+    netmon_plugins::Thresholds thresholds;
     bool countDirectories = false;
 
     bool isDirectory(const std::string& path) {
@@ -166,23 +166,17 @@ public:
                 msg << " matching pattern \"" << pattern << "\"";
             }
 
-            netmon_plugins::ExitCode code = netmon_plugins::ExitCode::OK;
-            
-            if (criticalCount >= 0 && count >= criticalCount) {
-                code = netmon_plugins::ExitCode::CRITICAL;
-                msg << " (exceeds critical threshold of " << criticalCount << ")";
-            } else if (warningCount >= 0 && count >= warningCount) {
-                code = netmon_plugins::ExitCode::WARNING;
-                msg << " (exceeds warning threshold of " << warningCount << ")";
+            netmon_plugins::ExitCode code = thresholds.evaluate(count);
+            if (code == netmon_plugins::ExitCode::CRITICAL) {
+                msg << " (outside critical range " << thresholds.critical.toString() << ")";
+            } else if (code == netmon_plugins::ExitCode::WARNING) {
+                msg << " (outside warning range " << thresholds.warning.toString() << ")";
             }
 
-            std::ostringstream perfdata;
-            perfdata << "count=" << count;
-            if (warningCount >= 0) {
-                perfdata << ";" << warningCount << ";" << criticalCount;
-            }
+            netmon_plugins::PerfMetrics perfdata;
+            perfdata.emplace_back("count", count).thresholds(thresholds);
 
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -194,8 +188,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--directory") == 0) {
                 if (i + 1 < argc) {
                     directory = argv[++i];
@@ -210,11 +203,11 @@ public:
                 countDirectories = true;
             } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
                 if (i + 1 < argc) {
-                    warningCount = std::stoi(argv[++i]);
+                    thresholds.warning = netmon_plugins::ThresholdRange::parse(argv[++i]);
                 }
             } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--critical") == 0) {
                 if (i + 1 < argc) {
-                    criticalCount = std::stoi(argv[++i]);
+                    thresholds.critical = netmon_plugins::ThresholdRange::parse(argv[++i]);
                 }
             } else if (directory.empty() && argv[i][0] != '-') {
                 directory = argv[i];
@@ -229,8 +222,8 @@ public:
                "  -p, --pattern PATTERN    File pattern to match (wildcards: *, ?)\n"
                "  -r, --recursive          Recursively count files in subdirectories\n"
                "  -D, --count-dirs         Count directories as well as files\n"
-               "  -w, --warning COUNT      Warning if file count >= COUNT\n"
-               "  -c, --critical COUNT     Critical if file count >= COUNT\n"
+               "  -w, --warning RANGE      Warning if file count is outside RANGE\n"
+               "  -c, --critical RANGE     Critical if file count is outside RANGE\n"
                "  -h, --help               Show this help message";
     }
     
@@ -241,9 +234,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    FileCountPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("file_count", FileCountPlugin, System)
 
@@ -129,13 +129,13 @@ public:
                 msg << " (exceeds warning threshold of " << formatSize(warningSize) << ")";
             }
 
-            std::ostringstream perfdata;
-            perfdata << "size=" << size << "B";
+            netmon_plugins::PerfMetrics perfdata;
+            netmon_plugins::PerfMetric& sizeMetric = perfdata.emplace_back("size", size, "B");
             if (warningSize >= 0) {
-                perfdata << ";" << warningSize << ";" << criticalSize;
+                sizeMetric.thresholds(warningSize, criticalSize);
             }
 
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -147,8 +147,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--file") == 0) {
                 if (i + 1 < argc) {
                     filePath = argv[++i];
@@ -183,9 +182,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    FileSizePlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("file_size", FileSizePlugin, System)
 
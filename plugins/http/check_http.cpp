@@ -1,7 +1,9 @@
 // plugins/http/check_http.cpp
 // HTTP/HTTPS service monitoring plugin
 
+#include "netmon/options.hpp"
 #include "netmon/plugin.hpp"
+#include "netmon/connection.hpp"
 #include "netmon/dependency_check.hpp"
 #include <iostream>
 #include <sstream>
@@ -9,34 +11,11 @@
 #include <cstring>
 #include <stdexcept>
 #include <string>
-
-#ifdef NETMON_SSL_ENABLED
-#include <openssl/ssl.h>
-#include <openssl/err.h>
-#endif
-
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#ifdef NETMON_SSL_ENABLED
-#pragma comment(lib, "libssl.lib")
-#pragma comment(lib, "libcrypto.lib")
-#endif
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
+#include <vector>
 
 namespace {
 
-class HttpPlugin : public netmon_plugins::Plugin {
-private:
+struct HttpConfig : netmon_plugins::CheckConfig {
     std::string hostname;
     int port = 80;
     std::string uri = "/";
@@ -45,8 +24,21 @@ private:
     std::string expectString;
     int warningTime = -1;
     int criticalTime = -1;
+};
+
+constexpr netmon_plugins::Option<HttpConfig> OPTIONS[] = {
+    netmon_plugins::option<&HttpConfig::hostname>('H', "hostname", "HOST", "Hostname or IP address"),
+    netmon_plugins::option<&HttpConfig::port>('p', "port", "PORT", "Port number"),
+    netmon_plugins::option<&HttpConfig::uri>('u', "uri", "PATH", "URI path"),
+    netmon_plugins::flag<&HttpConfig::useSSL>('S', "ssl", "Use HTTPS"),
+    netmon_plugins::option<&HttpConfig::expectString>('s', "string", "STR",
+                                                      "Expected string in response"),
+    netmon_plugins::option<&HttpConfig::timeoutSeconds>('t', "timeout", "SEC", "Timeout in seconds"),
+};
 
-    std::string httpRequest(const std::string& host, int portNum, const std::string& path) {
+class HttpPlugin : public netmon_plugins::ConfigurablePlugin<HttpConfig> {
+private:
+    static std::string httpRequest(const std::string& host, int portNum, const std::string& path) {
         std::ostringstream request;
         request << "GET " << path << " HTTP/1.1\r\n";
         request << "Host: " << host;
@@ -61,292 +53,47 @@ private:
         return request.str();
     }
 
-#ifdef NETMON_SSL_ENABLED
-    bool checkHttps(const std::string& host, int portNum, const std::string& path, int timeout) {
-        // Initialize OpenSSL
-        SSL_library_init();
-        SSL_load_error_strings();
-        OpenSSL_add_all_algorithms();
-        
-        // Create SSL context
-        SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
-        if (!ctx) {
-            return false;
-        }
-        
-        // Set minimum protocol version (if available)
-        #ifdef SSL_CTX_set_min_proto_version
-        SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
-        #endif
-        
-        // For HTTP monitoring, we can be more lenient with certificate verification
-        // Set verify mode but don't fail on verification errors for basic connectivity
-        SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
-        
-        // Create socket
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            SSL_CTX_free(ctx);
-            WSACleanup();
-            return false;
-        }
-        
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            SSL_CTX_free(ctx);
-            WSACleanup();
-            return false;
-        }
-        
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            SSL_CTX_free(ctx);
-            WSACleanup();
-            return false;
-        }
-        
-        freeaddrinfo(result);
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-            freeaddrinfo(result);
-            close(sock);
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        freeaddrinfo(result);
-#endif
-        
-        // Create SSL connection
-        SSL* ssl = SSL_new(ctx);
-        if (!ssl) {
-#ifdef _WIN32
-            closesocket(sock);
-            WSACleanup();
-#else
-            close(sock);
-#endif
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        SSL_set_fd(ssl, sock);
-        
-        // Set SNI (Server Name Indication) if available
-        #ifdef SSL_set_tlsext_host_name
-        SSL_set_tlsext_host_name(ssl, host.c_str());
-        #endif
-        
-        // Perform SSL handshake
-        int ssl_ret = SSL_connect(ssl);
-        if (ssl_ret <= 0) {
-            SSL_free(ssl);
-#ifdef _WIN32
-            closesocket(sock);
-            WSACleanup();
-#else
-            close(sock);
-#endif
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        // Send HTTP request
-        std::string request = httpRequest(host, portNum, path);
-        if (SSL_write(ssl, request.c_str(), static_cast<int>(request.length())) <= 0) {
-            SSL_free(ssl);
-#ifdef _WIN32
-            closesocket(sock);
-            WSACleanup();
-#else
-            close(sock);
-#endif
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        // Read response
-        char buffer[4096];
-        int bytes = SSL_read(ssl, buffer, sizeof(buffer) - 1);
-        
-        SSL_free(ssl);
-#ifdef _WIN32
-        closesocket(sock);
-        WSACleanup();
-#else
-        close(sock);
-#endif
-        SSL_CTX_free(ctx);
-        
-        if (bytes > 0) {
-            buffer[bytes] = '\0';
-            std::string response(buffer);
-            if (response.find("HTTP/1") != std::string::npos && 
-                response.find("200") != std::string::npos) {
-                if (expectString.empty() || response.find(expectString) != std::string::npos) {
-                    return true;
-                }
-            }
-        }
-        
-        return false;
-    }
-#endif
-
-    bool checkHttp(const std::string& host, int portNum, const std::string& path, bool ssl) {
-        // Use HTTPS if SSL is requested and available
-#ifdef NETMON_SSL_ENABLED
-        if (ssl) {
-            return checkHttps(host, portNum, path, timeoutSeconds);
-        }
-#endif
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-#endif
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-#ifdef _WIN32
-            WSACleanup();
-#endif
-            return false;
-        }
-        
-#ifdef _WIN32
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
+    static bool checkHttp(const HttpConfig& config, const std::string& host, int portNum,
+                          const std::string& path, bool ssl) {
+        netmon_plugins::net::ConnectOptions options;
+        options.tls = ssl;
+        netmon_plugins::net::Connection conn;
+        if (!conn.open(host, portNum,
+                       netmon_plugins::CheckContext::current().within(config.timeoutSeconds),
+                       options)) {
             return false;
         }
         
-        // Set timeout
-        DWORD timeout = timeoutSeconds * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeout, sizeof(timeout));
-#else
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        // Set timeout
-        struct timeval tv;
-        tv.tv_sec = timeoutSeconds;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-#endif
-        
-        // Connect
-#ifdef _WIN32
-        if (connect(sock, result->ai_addr, (int)result->ai_addrlen) < 0) {
-            closesocket(sock);
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        freeaddrinfo(result);
-        
         // Send HTTP request
-        std::string request = httpRequest(host, portNum, path);
-        if (send(sock, request.c_str(), (int)request.length(), 0) < 0) {
-            closesocket(sock);
-            WSACleanup();
-            return false;
-        }
-        
-        // Read response
-        char buffer[4096];
-        int bytes = recv(sock, buffer, sizeof(buffer) - 1, 0);
-        closesocket(sock);
-        WSACleanup();
-#else
-        if (connect(sock, result->ai_addr, result->ai_addrlen) < 0) {
-            close(sock);
-            freeaddrinfo(result);
+        if (conn.write(httpRequest(host, portNum, path)) != netmon_plugins::IoStatus::OK) {
             return false;
         }
-        freeaddrinfo(result);
         
-        // Send HTTP request
-        std::string request = httpRequest(host, portNum, path);
-        if (send(sock, request.c_str(), request.length(), 0) < 0) {
-            close(sock);
+        // Check for HTTP 200 OK
+        std::string statusLine;
+        if (conn.readLine(statusLine) != netmon_plugins::IoStatus::OK ||
+            statusLine.compare(0, 6, "HTTP/1") != 0 ||
+            statusLine.find(" 200") == std::string::npos) {
             return false;
         }
-        
-        // Read response
-        char buffer[4096];
-        int bytes = recv(sock, buffer, sizeof(buffer) - 1, 0);
-        close(sock);
-#endif
-        
-        if (bytes > 0) {
-            buffer[bytes] = '\0';
-            std::string response(buffer);
-            
-            // Check for HTTP 200 OK
-            if (response.find("HTTP/1") != std::string::npos && 
-                response.find("200") != std::string::npos) {
-                // Check for expected string if specified
-                if (expectString.empty() || response.find(expectString) != std::string::npos) {
-                    return true;
-                }
-            }
+        if (config.expectString.empty()) {
+            return true;
         }
         
-        return false;
+        // Check for expected string if specified
+        std::string response;
+        conn.readAll(response, 1024 * 1024);
+        return response.find(config.expectString) != std::string::npos;
     }
 
 public:
-    netmon_plugins::PluginResult check() override {
+    netmon_plugins::PluginResult run(const HttpConfig& config) const override {
+        const std::string& hostname = config.hostname;
+        const std::string& uri = config.uri;
+        // The SSL fallback below is per run, never written back to config
+        int port = config.port;
+        bool useSSL = config.useSSL;
+
         if (hostname.empty()) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -369,7 +116,7 @@ public:
         }
         
         try {
-            bool success = checkHttp(hostname, port, uri, useSSL);
+            bool success = checkHttp(config, hostname, port, uri, useSSL);
             
             if (success) {
                 std::ostringstream msg;
@@ -398,49 +145,20 @@ public:
         }
     }
     
-    void parseArguments(int argc, char* argv[]) override {
-        for (int i = 1; i < argc; i++) {
-            if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
-            } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
-                if (i + 1 < argc) {
-                    hostname = argv[++i];
-                }
-            } else if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--port") == 0) {
-                if (i + 1 < argc) {
-                    port = std::stoi(argv[++i]);
-                }
-            } else if (strcmp(argv[i], "-u") == 0 || strcmp(argv[i], "--uri") == 0) {
-                if (i + 1 < argc) {
-                    uri = argv[++i];
-                }
-            } else if (strcmp(argv[i], "-S") == 0 || strcmp(argv[i], "--ssl") == 0) {
-                useSSL = true;
-            } else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--string") == 0) {
-                if (i + 1 < argc) {
-                    expectString = argv[++i];
-                }
-            } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--timeout") == 0) {
-                if (i + 1 < argc) {
-                    timeoutSeconds = std::stoi(argv[++i]);
-                }
-            }
-        }
+    HttpConfig parse(const std::vector<std::string>& args) const override {
+        HttpConfig config;
+        netmon_plugins::parseOptions(OPTIONS, args, config);
+        return config;
+    }
+    
+    std::vector<std::string> canonicalArguments(
+        const std::vector<std::string>& args) const override {
+        return netmon_plugins::canonicalOptions(OPTIONS, args);
     }
     
     std::string getUsage() const override {
-        return "Usage: check_http -H HOSTNAME [options]\n"
-               "Options:\n"
-               "  -H, --hostname HOST    Hostname or IP address\n"
-               "  -p, --port PORT         Port number (default: 80)\n"
-               "  -u, --uri PATH          URI path (default: /)\n"
-               "  -S, --ssl               Use HTTPS\n"
-               "  -s, --string STR        Expected string in response\n"
-               "  -t, --timeout SEC       Timeout in seconds (default: 10)\n"
-               "  -h, --help              Show this help message\n"
-               "\n"
-               "Note: HTTPS support requires OpenSSL. Build with: make build ENABLE_SSL=ON";
+        return netmon_plugins::formatUsage("check_http -H HOSTNAME [options]", OPTIONS) +
+               "\n\nNote: HTTPS support requires OpenSSL. Build with: make build ENABLE_SSL=ON";
     }
     
     std::string getDescription() const override {
@@ -450,9 +168,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    HttpPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("http", HttpPlugin, Network)
 
@@ -109,13 +109,13 @@ public:
                     std::ostringstream msg;
                     msg << "InfluxDB OK - " << dbCount << " databases";
                     
-                    std::ostringstream perfdata;
-                    perfdata << "databases=" << dbCount;
+                    netmon_plugins::PerfMetrics perfdata;
+                    perfdata.emplace_back("databases", dbCount);
                     
                     return netmon_plugins::PluginResult(
                         netmon_plugins::ExitCode::OK,
                         msg.str(),
-                        perfdata.str()
+                        std::move(perfdata)
                     );
                 } else if (statusCode == 401 || statusCode == 403) {
                     return netmon_plugins::PluginResult(
@@ -145,8 +145,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -194,9 +193,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    InfluxdbPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("influxdb", InfluxdbPlugin, Application)
 
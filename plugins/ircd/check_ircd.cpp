@@ -2,26 +2,13 @@
 // IRC daemon monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/connection.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
 #include <stdexcept>
 #include <string>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
-
 namespace {
 
 class IrcdPlugin : public netmon_plugins::Plugin {
@@ -31,192 +18,33 @@ private:
     int timeoutSeconds = 10;
     std::string nickname = "monitor";
 
-    std::string readResponse(int sock) {
-        std::string response;
-        char buffer[1024];
-        
-#ifdef _WIN32
-        DWORD timeoutMs = timeoutSeconds * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        fd_set readSet;
-        FD_ZERO(&readSet);
-        FD_SET(sock, &readSet);
-        
-        struct timeval tv;
-        tv.tv_sec = timeoutSeconds;
-        tv.tv_usec = 0;
-        
-        if (select(0, &readSet, nullptr, nullptr, &tv) > 0) {
-            int received = recv(sock, buffer, sizeof(buffer) - 1, 0);
-            if (received > 0) {
-                buffer[received] = '\0';
-                response = buffer;
-            }
-        }
-#else
-        struct timeval tv;
-        tv.tv_sec = timeoutSeconds;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        
-        fd_set readSet;
-        FD_ZERO(&readSet);
-        FD_SET(sock, &readSet);
-        
-        if (select(sock + 1, &readSet, nullptr, nullptr, &tv) > 0) {
-            ssize_t received = recv(sock, buffer, sizeof(buffer) - 1, 0);
-            if (received > 0) {
-                buffer[received] = '\0';
-                response = buffer;
-            }
-        }
-#endif
-        
-        return response;
-    }
-
-    bool sendCommand(int sock, const std::string& command) {
-        std::string cmd = command + "\r\n";
-#ifdef _WIN32
-        return send(sock, cmd.c_str(), static_cast<int>(cmd.length()), 0) > 0;
-#else
-        return send(sock, cmd.c_str(), cmd.length(), 0) > 0;
-#endif
-    }
-
     bool checkIrcd(const std::string& host, int portNum, int timeout, const std::string& nick) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            WSACleanup();
-            return false;
-        }
-        
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            WSACleanup();
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        
-        // Read server greeting/motd
-        std::string response = readResponse(sock);
-        if (response.empty()) {
-            closesocket(sock);
-            WSACleanup();
+        netmon_plugins::net::Connection conn;
+        if (!conn.open(host, portNum, netmon_plugins::CheckContext::current().within(timeout))) {
             return false;
         }
         
-        // Send NICK command
-        if (!sendCommand(sock, "NICK " + nick)) {
-            closesocket(sock);
-            WSACleanup();
+        // Register straight away: some servers only greet once NICK/USER arrive
+        if (conn.write("NICK " + nick + "\r\nUSER " + nick + " 0 * :Monitoring Bot\r\n") !=
+            netmon_plugins::IoStatus::OK) {
             return false;
         }
         
-        // Send USER command
-        if (!sendCommand(sock, "USER " + nick + " 0 * :Monitoring Bot")) {
-            closesocket(sock);
-            WSACleanup();
-            return false;
-        }
-        
-        // Read response (should get welcome message)
-        response = readResponse(sock);
-        bool success = (response.find("001") != std::string::npos || 
-                       response.find("433") != std::string::npos); // Nick in use is also OK
-        
-        // Send QUIT
-        sendCommand(sock, "QUIT");
-        readResponse(sock);
-        
-        closesocket(sock);
-        WSACleanup();
-        return success;
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            return false;
-        }
-        
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-            freeaddrinfo(result);
-            close(sock);
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        
-        // Read server greeting/motd
-        std::string response = readResponse(sock);
-        if (response.empty()) {
-            close(sock);
-            return false;
-        }
-        
-        // Send NICK command
-        if (!sendCommand(sock, "NICK " + nick)) {
-            close(sock);
-            return false;
-        }
-        
-        // Send USER command
-        if (!sendCommand(sock, "USER " + nick + " 0 * :Monitoring Bot")) {
-            close(sock);
-            return false;
+        // Wait for the welcome (001); nick in use (433) is also OK
+        bool success = false;
+        std::string line;
+        while (!success && conn.readLine(line) == netmon_plugins::IoStatus::OK) {
+            if (line.compare(0, 5, "PING ") == 0) {
+                conn.write("PONG " + line.substr(5) + "\r\n");
+            } else if (line.compare(0, 5, "ERROR") == 0) {
+                break;
+            }
+            success = line.find(" 001 ") != std::string::npos ||
+                      line.find(" 433 ") != std::string::npos;
         }
         
-        // Read response (should get welcome message)
-        response = readResponse(sock);
-        bool success = (response.find("001") != std::string::npos || 
-                       response.find("433") != std::string::npos); // Nick in use is also OK
-        
-        // Send QUIT
-        sendCommand(sock, "QUIT");
-        readResponse(sock);
-        
-        close(sock);
+        conn.write("QUIT\r\n");
         return success;
-#endif
     }
 
 public:
@@ -257,8 +85,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -296,9 +123,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    IrcdPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("ircd", IrcdPlugin, Network)
 
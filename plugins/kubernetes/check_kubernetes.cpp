@@ -1,20 +1,20 @@
 // plugins/kubernetes/check_kubernetes.cpp
 // Kubernetes monitoring plugin
 
+#include "netmon/options.hpp"
 #include "netmon/plugin.hpp"
 #include "netmon/http_api.hpp"
 #include "netmon/json_utils.hpp"
 #include "netmon/dependency_check.hpp"
 #include <iostream>
 #include <sstream>
-#include <cstring>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace {
 
-class KubernetesPlugin : public netmon_plugins::Plugin {
-private:
+struct KubernetesConfig : netmon_plugins::CheckConfig {
     std::string hostname;
     int port = 6443;
     std::string token;
@@ -22,9 +22,36 @@ private:
     int timeoutSeconds = 10;
     bool useSSL = true;
     std::string checkType = "health"; // health, nodes, pods
+};
+
+constexpr netmon_plugins::Option<KubernetesConfig> OPTIONS[] = {
+    netmon_plugins::option<&KubernetesConfig::hostname>('H', "hostname", "HOST",
+                                                        "Kubernetes API server hostname"),
+    netmon_plugins::option<&KubernetesConfig::port>('p', "port", "PORT", "API server port"),
+    netmon_plugins::option<&KubernetesConfig::token>('t', "token", "TOKEN",
+                                                     "Bearer token for authentication"),
+    netmon_plugins::option<&KubernetesConfig::caCertPath>(
+        'C', "ca-cert", "FILE", "Verify the API server certificate against this CA"),
+    netmon_plugins::option<&KubernetesConfig::checkType>('c', "check", "TYPE",
+                                                         "Check type: health, nodes, pods"),
+    netmon_plugins::flag<&KubernetesConfig::useSSL>('S', "ssl", "Use HTTPS (the default)"),
+    netmon_plugins::flag<&KubernetesConfig::useSSL, false>('\0', "no-ssl",
+                                                          "Use HTTP instead of HTTPS"),
+    netmon_plugins::option<&KubernetesConfig::timeoutSeconds>('T', "timeout", "SECONDS",
+                                                              "Timeout in seconds"),
+};
 
+class KubernetesPlugin : public netmon_plugins::ConfigurablePlugin<KubernetesConfig> {
 public:
-    netmon_plugins::PluginResult check() override {
+    netmon_plugins::PluginResult run(const KubernetesConfig& config) const override {
+        const std::string& hostname = config.hostname;
+        const std::string& token = config.token;
+        const std::string& checkType = config.checkType;
+        const int timeoutSeconds = config.timeoutSeconds;
+        // The SSL fallback below is per run, never written back to config
+        int port = config.port;
+        bool useSSL = config.useSSL;
+
         if (hostname.empty()) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -57,26 +84,26 @@ public:
                 path = "/healthz";
             }
             
-            int statusCode = 0;
-            std::string response;
-            
+            netmon_plugins::HttpRequest request;
+            request.host = hostname;
+            request.port = port;
+            request.path = path;
+            request.useSSL = useSSL;
+            request.timeoutSeconds = timeoutSeconds;
+            request.verifyPeer = useSSL && !config.caCertPath.empty();
+            request.caFile = config.caCertPath;
             if (!token.empty()) {
-                // Use token authentication
-                // Note: httpGetAuth would need to support custom headers for Bearer token
-                // For now, we'll use basic HTTP GET and note that token auth needs implementation
-                response = netmon_plugins::httpGet(
-                    hostname, port, path, useSSL, timeoutSeconds, statusCode
-                );
-            } else {
-                response = netmon_plugins::httpGet(
-                    hostname, port, path, useSSL, timeoutSeconds, statusCode
-                );
+                request.bearerToken(token);
             }
+            netmon_plugins::HttpResponse reply = netmon_plugins::httpRequest(request);
+            const int statusCode = reply.statusCode;
+            const std::string& response = reply.body;
             
-            if (statusCode == 0 || response.empty()) {
+            if (!reply.complete() || statusCode == 0 || response.empty()) {
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::CRITICAL,
-                    "Kubernetes CRITICAL - Cannot connect to API server or invalid response"
+                    "Kubernetes CRITICAL - Cannot connect to API server or invalid response" +
+                    (reply.error.empty() ? std::string() : " (" + reply.error + ")")
                 );
             }
             
@@ -126,13 +153,13 @@ public:
                         msg << " (" << itemCount << " " << checkType << ")";
                     }
                     
-                    std::ostringstream perfdata;
-                    perfdata << checkType << "=" << itemCount;
+                    netmon_plugins::PerfMetrics perfdata;
+                    perfdata.emplace_back(checkType, itemCount);
                     
                     return netmon_plugins::PluginResult(
                         netmon_plugins::ExitCode::OK,
                         msg.str(),
-                        perfdata.str()
+                        std::move(perfdata)
                     );
                 } else if (statusCode == 401 || statusCode == 403) {
                     return netmon_plugins::PluginResult(
@@ -159,52 +186,20 @@ public:
         }
     }
     
-    void parseArguments(int argc, char* argv[]) override {
-        for (int i = 1; i < argc; i++) {
-            if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
-            } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
-                if (i + 1 < argc) {
-                    hostname = argv[++i];
-                }
-            } else if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--port") == 0) {
-                if (i + 1 < argc) {
-                    port = std::stoi(argv[++i]);
-                }
-            } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--token") == 0) {
-                if (i + 1 < argc) {
-                    token = argv[++i];
-                }
-            } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--check") == 0) {
-                if (i + 1 < argc) {
-                    checkType = argv[++i];
-                }
-            } else if (strcmp(argv[i], "-T") == 0 || strcmp(argv[i], "--timeout") == 0) {
-                if (i + 1 < argc) {
-                    timeoutSeconds = std::stoi(argv[++i]);
-                }
-            } else if (strcmp(argv[i], "-S") == 0 || strcmp(argv[i], "--ssl") == 0) {
-                useSSL = true;
-            } else if (strcmp(argv[i], "--no-ssl") == 0) {
-                useSSL = false;
-            }
-        }
+    KubernetesConfig parse(const std::vector<std::string>& args) const override {
+        KubernetesConfig config;
+        netmon_plugins::parseOptions(OPTIONS, args, config);
+        return config;
+    }
+    
+    std::vector<std::string> canonicalArguments(
+        const std::vector<std::string>& args) const override {
+        return netmon_plugins::canonicalOptions(OPTIONS, args);
     }
     
     std::string getUsage() const override {
-        return "Usage: check_kubernetes -H <hostname> [options]\n"
-               "Options:\n"
-               "  -H, --hostname HOST     Kubernetes API server hostname\n"
-               "  -p, --port PORT         API server port (default: 6443)\n"
-               "  -t, --token TOKEN       Bearer token for authentication\n"
-               "  -c, --check TYPE        Check type: health, nodes, pods (default: health)\n"
-               "  -S, --ssl               Use HTTPS (default: true)\n"
-               "  --no-ssl                Use HTTP instead of HTTPS\n"
-               "  -T, --timeout SECONDS   Timeout in seconds (default: 10)\n"
-               "  -h, --help              Show this help message\n"
-               "\n"
-               "Note: Token authentication requires OpenSSL for HTTPS connections.";
+        return netmon_plugins::formatUsage("check_kubernetes -H <hostname> [options]", OPTIONS) +
+               "\n\nNote: Token authentication requires OpenSSL for HTTPS connections.";
     }
     
     std::string getDescription() const override {
@@ -214,9 +209,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    KubernetesPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("kubernetes", KubernetesPlugin, Application)
 
@@ -2,6 +2,7 @@
 // System load average monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/threshold.hpp"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -25,8 +26,7 @@ namespace {
 
 class LoadPlugin : public netmon_plugins::Plugin {
 private:
-    double warning1 = -1.0, warning5 = -1.0, warning15 = -1.0;
-    double critical1 = -1.0, critical5 = -1.0, critical15 = -1.0;
+    netmon_plugins::Thresholds thresholds[3];   // 1, 5 and 15 minute averages
     int numProcessors = 1;
 
     void getLoadAverage(double& load1, double& load5, double& load15) {
@@ -98,6 +98,15 @@ private:
 #endif
     }
 
+    // "1min,5min,15min" ranges; a single range applies to all three
+    void parseTriple(const char* text, netmon_plugins::ThresholdRange netmon_plugins::Thresholds::*which) {
+        netmon_plugins::ThresholdRange ranges[3];
+        size_t count = netmon_plugins::parseThresholdList(text, ranges, 3);
+        for (size_t i = 0; i < 3; i++) {
+            thresholds[i].*which = ranges[count == 1 ? 0 : i];
+        }
+    }
+
 public:
     netmon_plugins::PluginResult check() override {
         try {
@@ -110,48 +119,31 @@ public:
                 << load1 << ", " << load5 << ", " << load15 
                 << " (" << numProcessors << " processors)";
             
-            // Check thresholds
-            if (critical1 > 0 && load1 >= critical1) {
-                code = netmon_plugins::ExitCode::CRITICAL;
-                msg.str("");
-                msg << "CRITICAL - load average: " << load1 << ", " << load5 << ", " << load15
-                    << " (1min load >= " << critical1 << ")";
-            } else if (critical5 > 0 && load5 >= critical5) {
-                code = netmon_plugins::ExitCode::CRITICAL;
-                msg.str("");
-                msg << "CRITICAL - load average: " << load1 << ", " << load5 << ", " << load15
-                    << " (5min load >= " << critical5 << ")";
-            } else if (critical15 > 0 && load15 >= critical15) {
-                code = netmon_plugins::ExitCode::CRITICAL;
-                msg.str("");
-                msg << "CRITICAL - load average: " << load1 << ", " << load5 << ", " << load15
-                    << " (15min load >= " << critical15 << ")";
-            } else if (warning1 > 0 && load1 >= warning1) {
-                code = netmon_plugins::ExitCode::WARNING;
-                msg.str("");
-                msg << "WARNING - load average: " << load1 << ", " << load5 << ", " << load15
-                    << " (1min load >= " << warning1 << ")";
-            } else if (warning5 > 0 && load5 >= warning5) {
-                code = netmon_plugins::ExitCode::WARNING;
-                msg.str("");
-                msg << "WARNING - load average: " << load1 << ", " << load5 << ", " << load15
-                    << " (5min load >= " << warning5 << ")";
-            } else if (warning15 > 0 && load15 >= warning15) {
-                code = netmon_plugins::ExitCode::WARNING;
-                msg.str("");
-                msg << "WARNING - load average: " << load1 << ", " << load5 << ", " << load15
-                    << " (15min load >= " << warning15 << ")";
+            // Check thresholds: any critical average beats any warning one
+            const double loads[3] = {load1, load5, load15};
+            static const char* const periods[3] = {"1min", "5min", "15min"};
+            for (const bool critical : {true, false}) {
+                for (int i = 0; i < 3 && code == netmon_plugins::ExitCode::OK; i++) {
+                    const netmon_plugins::ThresholdRange& range =
+                        critical ? thresholds[i].critical : thresholds[i].warning;
+                    if (range.alerts(loads[i])) {
+                        code = critical ? netmon_plugins::ExitCode::CRITICAL
+                                        : netmon_plugins::ExitCode::WARNING;
+                        msg.str("");
+                        msg << netmon_plugins::exitCodeToString(code) << " - load average: "
+                            << load1 << ", " << load5 << ", " << load15
+                            << " (" << periods[i] << " load outside range " << range.toString() << ")";
+                    }
+                }
             }
             
-            std::ostringstream perfdata;
-            perfdata << "load1=" << std::fixed << std::setprecision(2) << load1;
-            if (warning1 > 0) perfdata << ";" << warning1 << ";" << critical1;
-            perfdata << " load5=" << load5;
-            if (warning5 > 0) perfdata << ";" << warning5 << ";" << critical5;
-            perfdata << " load15=" << load15;
-            if (warning15 > 0) perfdata << ";" << warning15 << ";" << critical15;
+            netmon_plugins::PerfMetrics perfdata;
+            static const char* const labels[3] = {"load1", "load5", "load15"};
+            for (int i = 0; i < 3; i++) {
+                perfdata.emplace_back(labels[i], loads[i]).thresholds(thresholds[i]);
+            }
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -163,43 +155,14 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
                 if (i + 1 < argc) {
-                    std::string threshold = argv[++i];
-                    size_t comma1 = threshold.find(',');
-                    size_t comma2 = threshold.find(',', comma1 + 1);
-                    
-                    if (comma1 != std::string::npos) {
-                        warning1 = std::stod(threshold.substr(0, comma1));
-                        if (comma2 != std::string::npos) {
-                            warning5 = std::stod(threshold.substr(comma1 + 1, comma2 - comma1 - 1));
-                            warning15 = std::stod(threshold.substr(comma2 + 1));
-                        } else {
-                            warning5 = std::stod(threshold.substr(comma1 + 1));
-                        }
-                    } else {
-                        warning1 = std::stod(threshold);
-                    }
+                    parseTriple(argv[++i], &netmon_plugins::Thresholds::warning);
                 }
             } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--critical") == 0) {
                 if (i + 1 < argc) {
-                    std::string threshold = argv[++i];
-                    size_t comma1 = threshold.find(',');
-                    size_t comma2 = threshold.find(',', comma1 + 1);
-                    
-                    if (comma1 != std::string::npos) {
-                        critical1 = std::stod(threshold.substr(0, comma1));
-                        if (comma2 != std::string::npos) {
-                            critical5 = std::stod(threshold.substr(comma1 + 1, comma2 - comma1 - 1));
-                            critical15 = std::stod(threshold.substr(comma2 + 1));
-                        } else {
-                            critical5 = std::stod(threshold.substr(comma1 + 1));
-                        }
-                    } else {
-                        critical1 = std::stod(threshold);
-                    }
+                    parseTriple(argv[++i], &netmon_plugins::Thresholds::critical);
                 }
             }
         }
@@ -208,8 +171,8 @@ public:
     std::string getUsage() const override {
         return "Usage: check_load [options]\n"
                "Options:\n"
-               "  -w, --warning THRESHOLD    Warning threshold (1min,5min,15min or single value)\n"
-               "  -c, --critical THRESHOLD   Critical threshold (1min,5min,15min or single value)\n"
+               "  -w, --warning RANGES       Warning ranges (1min,5min,15min or one for all)\n"
+               "  -c, --critical RANGES      Critical ranges (1min,5min,15min or one for all)\n"
                "  -h, --help                 Show this help message\n"
                "\n"
                "Note: On Windows, load is approximated from CPU utilization.";
@@ -222,9 +185,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    LoadPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("load", LoadPlugin, System)
 
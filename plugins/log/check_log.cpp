@@ -136,16 +136,16 @@ public:
                 code = netmon_plugins::ExitCode::WARNING;
             }
 
-            std::ostringstream perfdata;
-            perfdata << "matches=" << matchCount;
+            netmon_plugins::PerfMetrics perfdata;
+            netmon_plugins::PerfMetric& matches = perfdata.emplace_back("matches", matchCount);
             if (warningCount >= 0) {
-                perfdata << ";" << warningCount << ";" << criticalCount;
+                matches.thresholds(warningCount, criticalCount);
             }
             if (fileSize >= 0) {
-                perfdata << " size=" << fileSize << "B";
+                perfdata.emplace_back("size", fileSize, "B");
             }
 
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -157,8 +157,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--file") == 0) {
                 if (i + 1 < argc) {
                     logFile = argv[++i];
@@ -210,9 +209,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    LogPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("log", LogPlugin, System)
 
@@ -2,6 +2,7 @@
 // Memcached monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/connection.hpp"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -9,20 +10,6 @@
 #include <stdexcept>
 #include <string>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
-
 namespace {
 
 class MemcachedPlugin : public netmon_plugins::Plugin {
@@ -32,111 +19,20 @@ private:
     int timeoutSeconds = 10;
     bool checkStats = true;
 
-    bool connectToMemcached(const std::string& host, int portNum, int timeout, int& sock) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            WSACleanup();
-            return false;
-        }
-        
-        sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            WSACleanup();
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        return true;
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            return false;
-        }
-        
-        sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-            freeaddrinfo(result);
-            close(sock);
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        return true;
-#endif
-    }
-
-    std::string sendCommand(int sock, const std::string& command) {
-        std::string cmd = command + "\r\n";
-        
-#ifdef _WIN32
-        if (send(sock, cmd.c_str(), static_cast<int>(cmd.length()), 0) < 0) {
-            return "";
-        }
-        
-        char buffer[8192];
-        std::string response;
-        int bytes;
-        while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-            buffer[bytes] = '\0';
-            response += buffer;
-            if (response.find("END\r\n") != std::string::npos) {
-                break;
-            }
-        }
-#else
-        if (send(sock, cmd.c_str(), cmd.length(), 0) < 0) {
+    // Send a command and collect its reply up to the closing "END"
+    std::string sendCommand(netmon_plugins::net::Connection& conn, const std::string& command) {
+        if (conn.write(command + "\r\n") != netmon_plugins::IoStatus::OK) {
             return "";
         }
         
-        char buffer[8192];
         std::string response;
-        ssize_t bytes;
-        while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-            buffer[bytes] = '\0';
-            response += buffer;
-            if (response.find("END\r\n") != std::string::npos) {
+        std::string line;
+        while (conn.readLine(line) == netmon_plugins::IoStatus::OK) {
+            response += line + "\r\n";
+            if (line == "END" || line.find("ERROR") != std::string::npos) {
                 break;
             }
         }
-#endif
-        
         return response;
     }
 
@@ -170,8 +66,8 @@ public:
         }
         
         try {
-            int sock = 0;
-            if (!connectToMemcached(hostname, port, timeoutSeconds, sock)) {
+            netmon_plugins::net::Connection sock;
+            if (!sock.open(hostname, port, netmon_plugins::CheckContext::current().within(timeoutSeconds))) {
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::CRITICAL,
                     "Memcached CRITICAL - Cannot connect to " + hostname + ":" + std::to_string(port)
@@ -181,12 +77,7 @@ public:
             // Send stats command
             std::string statsResponse = sendCommand(sock, "stats");
             
-#ifdef _WIN32
-            closesocket(sock);
-            WSACleanup();
-#else
-            close(sock);
-#endif
+            sock.close();
             
             if (statsResponse.empty() || statsResponse.find("STAT") == std::string::npos) {
                 return netmon_plugins::PluginResult(
@@ -215,20 +106,20 @@ public:
                 << currItems << " items, " << std::fixed << std::setprecision(2) 
                 << hitRatio << "% hit ratio";
             
-            std::ostringstream perfdata;
-            perfdata << "connections=" << currConnections 
-                     << " total_connections=" << totalConnections
-                     << " items=" << currItems
-                     << " bytes=" << bytes
-                     << " hit_ratio=" << std::fixed << std::setprecision(2) << hitRatio << "%"
-                     << " hits=" << getHits
-                     << " misses=" << getMisses
-                     << " evictions=" << evictions;
+            netmon_plugins::PerfMetrics perfdata;
+            perfdata.emplace_back("connections", currConnections);
+            perfdata.emplace_back("total_connections", totalConnections, "c");
+            perfdata.emplace_back("items", currItems);
+            perfdata.emplace_back("bytes", bytes, "B");
+            perfdata.emplace_back("hit_ratio", hitRatio, "%");
+            perfdata.emplace_back("hits", getHits, "c");
+            perfdata.emplace_back("misses", getMisses, "c");
+            perfdata.emplace_back("evictions", evictions, "c");
             
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::OK,
                 msg.str(),
-                perfdata.str()
+                std::move(perfdata)
             );
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
@@ -241,8 +132,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -275,9 +165,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    MemcachedPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("memcached", MemcachedPlugin, Application)
 
@@ -4,25 +4,13 @@
 #include "netmon/plugin.hpp"
 #include "netmon/http_api.hpp"
 #include "netmon/json_utils.hpp"
+#include "netmon/connection.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
 #include <stdexcept>
 #include <string>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#endif
-
 namespace {
 
 class MongodbPlugin : public netmon_plugins::Plugin {
@@ -88,93 +76,14 @@ public:
             // Try direct TCP connection to MongoDB port
             // MongoDB uses a binary protocol, so we can only check connectivity
             try {
-#ifdef _WIN32
-                WSADATA wsaData;
-                WSAStartup(MAKEWORD(2, 2), &wsaData);
-                
-                struct addrinfo hints, *result;
-                memset(&hints, 0, sizeof(hints));
-                hints.ai_family = AF_UNSPEC;
-                hints.ai_socktype = SOCK_STREAM;
-                
-                std::string portStr = std::to_string(port);
-                if (getaddrinfo(hostname.c_str(), portStr.c_str(), &hints, &result) != 0) {
-                    WSACleanup();
-                    return netmon_plugins::PluginResult(
-                        netmon_plugins::ExitCode::CRITICAL,
-                        "MongoDB CRITICAL - Cannot resolve hostname"
-                    );
-                }
-                
-                SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-                if (sock == INVALID_SOCKET) {
-                    freeaddrinfo(result);
-                    WSACleanup();
-                    return netmon_plugins::PluginResult(
-                        netmon_plugins::ExitCode::CRITICAL,
-                        "MongoDB CRITICAL - Cannot create socket"
-                    );
-                }
-                
-                DWORD timeoutMs = timeoutSeconds * 1000;
-                setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-                setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-                
-                if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-                    freeaddrinfo(result);
-                    closesocket(sock);
-                    WSACleanup();
+                netmon_plugins::net::Connection sock;
+                if (!sock.open(hostname, port, netmon_plugins::CheckContext::current().within(timeoutSeconds))) {
                     return netmon_plugins::PluginResult(
                         netmon_plugins::ExitCode::CRITICAL,
                         "MongoDB CRITICAL - Cannot connect to " + hostname + ":" + std::to_string(port)
                     );
                 }
                 
-                freeaddrinfo(result);
-                closesocket(sock);
-                WSACleanup();
-#else
-                struct addrinfo hints, *result;
-                memset(&hints, 0, sizeof(hints));
-                hints.ai_family = AF_UNSPEC;
-                hints.ai_socktype = SOCK_STREAM;
-                
-                std::string portStr = std::to_string(port);
-                if (getaddrinfo(hostname.c_str(), portStr.c_str(), &hints, &result) != 0) {
-                    return netmon_plugins::PluginResult(
-                        netmon_plugins::ExitCode::CRITICAL,
-                        "MongoDB CRITICAL - Cannot resolve hostname"
-                    );
-                }
-                
-                int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-                if (sock < 0) {
-                    freeaddrinfo(result);
-                    return netmon_plugins::PluginResult(
-                        netmon_plugins::ExitCode::CRITICAL,
-                        "MongoDB CRITICAL - Cannot create socket"
-                    );
-                }
-                
-                struct timeval tv;
-                tv.tv_sec = timeoutSeconds;
-                tv.tv_usec = 0;
-                setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-                setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-                
-                if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-                    freeaddrinfo(result);
-                    close(sock);
-                    return netmon_plugins::PluginResult(
-                        netmon_plugins::ExitCode::CRITICAL,
-                        "MongoDB CRITICAL - Cannot connect to " + hostname + ":" + std::to_string(port)
-                    );
-                }
-                
-                freeaddrinfo(result);
-                close(sock);
-#endif
-                
                 std::ostringstream msg;
                 msg << "MongoDB OK - Port " << port << " is accepting connections";
                 return netmon_plugins::PluginResult(
@@ -193,8 +102,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -237,9 +145,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    MongodbPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("mongodb", MongodbPlugin, Application)
 
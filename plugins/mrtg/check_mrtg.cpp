@@ -43,8 +43,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--file") == 0) {
                 if (i + 1 < argc) {
                     logFile = argv[++i];
@@ -74,9 +73,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    MrtgPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("mrtg", MrtgPlugin, Application)
 
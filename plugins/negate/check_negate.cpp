@@ -85,8 +85,7 @@ public:
         
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--command") == 0) {
                 if (i + 1 < argc) {
                     command = argv[++i];
@@ -123,9 +122,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    NegatePlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("negate", NegatePlugin, Utility)
 
@@ -43,12 +43,19 @@ public:
                 path = "/v1/status/leader";
             }
             
-            int statusCode = 0;
-            std::string response = netmon_plugins::httpGet(
-                hostname, port, path, false, timeoutSeconds, statusCode
-            );
+            netmon_plugins::HttpRequest request;
+            request.host = hostname;
+            request.port = port;
+            request.path = path;
+            request.timeoutSeconds = timeoutSeconds;
+            if (!token.empty()) {
+                request.header("X-Nomad-Token", token);
+            }
+            netmon_plugins::HttpResponse reply = netmon_plugins::httpRequest(request);
+            const int statusCode = reply.statusCode;
+            const std::string& response = reply.body;
             
-            if (statusCode != 200 || response.empty()) {
+            if (!reply.complete() || statusCode != 200 || response.empty()) {
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::CRITICAL,
                     "Nomad CRITICAL - Cannot connect to API or invalid response (status: " + 
@@ -93,13 +100,13 @@ public:
                 std::ostringstream msg;
                 msg << "Nomad OK - " << jobCount << " jobs";
                 
-                std::ostringstream perfdata;
-                perfdata << "jobs=" << jobCount;
+                netmon_plugins::PerfMetrics perfdata;
+                perfdata.emplace_back("jobs", jobCount);
                 
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::OK,
                     msg.str(),
-                    perfdata.str()
+                    std::move(perfdata)
                 );
             } else if (checkType == "nodes") {
                 // Count nodes
@@ -113,13 +120,13 @@ public:
                 std::ostringstream msg;
                 msg << "Nomad OK - " << nodeCount << " nodes";
                 
-                std::ostringstream perfdata;
-                perfdata << "nodes=" << nodeCount;
+                netmon_plugins::PerfMetrics perfdata;
+                perfdata.emplace_back("nodes", nodeCount);
                 
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::OK,
                     msg.str(),
-                    perfdata.str()
+                    std::move(perfdata)
                 );
             }
             
@@ -138,8 +145,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -182,9 +188,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    NomadPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("nomad", NomadPlugin, Application)
 
@@ -53,22 +53,20 @@ public:
                 << " >= " << warningStratum;
         }
 
-        std::ostringstream perfdata;
-        perfdata << "ntp_stratum=" << result.stratum;
+        netmon_plugins::PerfMetrics perfdata;
+        netmon_plugins::PerfMetric& stratum = perfdata.emplace_back("ntp_stratum", result.stratum);
         if (warningStratum > 0) {
-            perfdata << ";" << warningStratum << ";" << criticalStratum;
+            stratum.thresholds(warningStratum, criticalStratum);
         }
-        perfdata << " ntp_offset=" << std::fixed << std::setprecision(3)
-                 << result.offset_seconds << "s";
+        perfdata.emplace_back("ntp_offset", result.offset_seconds, "s");
 
-        return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+        return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
     }
 
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -111,8 +109,4 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    NtpPeerPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("ntp_peer", NtpPeerPlugin, Network)
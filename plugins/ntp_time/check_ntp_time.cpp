@@ -46,16 +46,15 @@ public:
             msg << "NTP time WARNING - offset " << offset << "s";
         }
 
-        std::ostringstream perfdata;
-        perfdata << "ntp_time_offset=" << std::fixed << std::setprecision(3) << offset << "s";
-        return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+        netmon_plugins::PerfMetrics perfdata;
+        perfdata.emplace_back("ntp_time_offset", offset, "s");
+        return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
     }
 
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -98,8 +97,4 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    NtpTimePlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("ntp_time", NtpTimePlugin, Network)
@@ -84,11 +84,13 @@ public:
                     << ": RX " << stats.rxBytes << " bytes, TX " << stats.txBytes << " bytes";
             }
             
-            std::ostringstream perfdata;
-            perfdata << "rx_bytes=" << stats.rxBytes << " tx_bytes=" << stats.txBytes
-                     << " rx_packets=" << stats.rxPackets << " tx_packets=" << stats.txPackets;
+            netmon_plugins::PerfMetrics perfdata;
+            perfdata.emplace_back("rx_bytes", stats.rxBytes, "B");
+            perfdata.emplace_back("tx_bytes", stats.txBytes, "B");
+            perfdata.emplace_back("rx_packets", stats.rxPackets, "c");
+            perfdata.emplace_back("tx_packets", stats.txPackets, "c");
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -100,8 +102,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--interface") == 0) {
                 if (i + 1 < argc) {
                     interface = argv[++i];
@@ -147,9 +148,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    NwstatPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("nwstat", NwstatPlugin, Specialized)
 
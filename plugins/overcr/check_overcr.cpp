@@ -70,13 +70,14 @@ public:
                     << "% of commit limit used (threshold: " << warningPercent << "%)";
             }
             
-            std::ostringstream perfdata;
-            perfdata << "overcommit=" << std::fixed << std::setprecision(1) << overcommitRatio << "%";
+            netmon_plugins::PerfMetrics perfdata;
+            netmon_plugins::PerfMetric& overcommit =
+                perfdata.emplace_back("overcommit", overcommitRatio, "%");
             if (warningPercent > 0) {
-                perfdata << ";" << warningPercent << ";" << criticalPercent;
+                overcommit.thresholds(warningPercent, criticalPercent);
             }
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -88,8 +89,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
                 if (i + 1 < argc) {
                     warningPercent = std::stod(argv[++i]);
@@ -119,9 +119,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    OvercrPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("overcr", OvercrPlugin, Specialized)
 
@@ -106,17 +106,17 @@ public:
                 msg << "Status endpoint responding";
             }
             
-            std::ostringstream perfdata;
-            if (activeProcesses >= 0) perfdata << "active_processes=" << activeProcesses << " ";
-            if (idleProcesses >= 0) perfdata << "idle_processes=" << idleProcesses << " ";
-            if (totalProcesses >= 0) perfdata << "total_processes=" << totalProcesses << " ";
-            if (maxActiveProcesses >= 0) perfdata << "max_active_processes=" << maxActiveProcesses << " ";
-            if (maxChildrenReached >= 0) perfdata << "max_children_reached=" << maxChildrenReached;
+            netmon_plugins::PerfMetrics perfdata;
+            if (activeProcesses >= 0) perfdata.emplace_back("active_processes", activeProcesses);
+            if (idleProcesses >= 0) perfdata.emplace_back("idle_processes", idleProcesses);
+            if (totalProcesses >= 0) perfdata.emplace_back("total_processes", totalProcesses);
+            if (maxActiveProcesses >= 0) perfdata.emplace_back("max_active_processes", maxActiveProcesses);
+            if (maxChildrenReached >= 0) perfdata.emplace_back("max_children_reached", maxChildrenReached, "c");
             
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::OK,
                 msg.str(),
-                perfdata.str()
+                std::move(perfdata)
             );
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
@@ -129,8 +129,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -176,9 +175,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    PhpfpmPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("phpfpm", PhpfpmPlugin, Application)
 
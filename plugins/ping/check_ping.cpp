@@ -2,6 +2,8 @@
 // ICMP ping monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/icmp.hpp"
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -9,24 +11,11 @@
 #include <stdexcept>
 #include <vector>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <iphlpapi.h>
-#include <icmpapi.h>
-#pragma comment(lib, "iphlpapi.lib")
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <netinet/ip_icmp.h>
-#include <arpa/inet.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <netdb.h>
-#endif
-
 namespace {
 
+// Spacing of the echo requests; replies are awaited concurrently
+constexpr int PACKET_INTERVAL_MS = 200;
+
 class PingPlugin : public netmon_plugins::Plugin {
 private:
     std::string hostname;
@@ -37,178 +26,6 @@ private:
     double warningPL = -1.0;      // Warning if packet loss > this (%)
     double criticalPL = -1.0;     // Critical if packet loss > this (%)
 
-    struct PingResult {
-        int packetsSent;
-        int packetsReceived;
-        double minRTT;
-        double maxRTT;
-        double avgRTT;
-        double packetLoss;
-    };
-
-    PingResult pingHost(const std::string& host, int count, int timeout) {
-        PingResult result = {0, 0, 0.0, 0.0, 0.0, 0.0};
-        
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        // Resolve hostname
-        struct hostent* hostEntry = gethostbyname(host.c_str());
-        if (!hostEntry) {
-            throw std::runtime_error("Failed to resolve hostname: " + host);
-        }
-        
-        IPAddr destIP = *((IPAddr*)hostEntry->h_addr_list[0]);
-        
-        HANDLE hIcmpFile = IcmpCreateFile();
-        if (hIcmpFile == INVALID_HANDLE_VALUE) {
-            WSACleanup();
-            throw std::runtime_error("Failed to create ICMP handle");
-        }
-        
-        char sendData[32] = "Data Buffer";
-        DWORD replySize = sizeof(ICMP_ECHO_REPLY) + sizeof(sendData);
-        char* replyBuffer = new char[replySize];
-        
-        result.packetsSent = count;
-        double totalRTT = 0.0;
-        double minRTT = 999999.0;
-        double maxRTT = 0.0;
-        
-        for (int i = 0; i < count; i++) {
-            DWORD dwRetVal = IcmpSendEcho(hIcmpFile, destIP, sendData, sizeof(sendData),
-                                          nullptr, replyBuffer, replySize, timeout * 1000);
-            
-            if (dwRetVal != 0) {
-                ICMP_ECHO_REPLY* echoReply = (ICMP_ECHO_REPLY*)replyBuffer;
-                if (echoReply->Status == 0) {
-                    result.packetsReceived++;
-                    double rtt = echoReply->RoundTripTime;
-                    totalRTT += rtt;
-                    if (rtt < minRTT) minRTT = rtt;
-                    if (rtt > maxRTT) maxRTT = rtt;
-                }
-            }
-        }
-        
-        delete[] replyBuffer;
-        IcmpCloseHandle(hIcmpFile);
-        WSACleanup();
-        
-        if (result.packetsReceived > 0) {
-            result.avgRTT = totalRTT / result.packetsReceived;
-            result.minRTT = minRTT;
-            result.maxRTT = maxRTT;
-        }
-        result.packetLoss = ((result.packetsSent - result.packetsReceived) * 100.0) / result.packetsSent;
-#else
-        // Create raw socket (requires root privileges)
-        int sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
-        if (sock < 0) {
-            throw std::runtime_error("Failed to create ICMP socket (requires root privileges)");
-        }
-        
-        // Resolve hostname
-        struct hostent* hostEntry = gethostbyname(host.c_str());
-        if (!hostEntry) {
-            close(sock);
-            throw std::runtime_error("Failed to resolve hostname: " + host);
-        }
-        
-        struct sockaddr_in destAddr;
-        memset(&destAddr, 0, sizeof(destAddr));
-        destAddr.sin_family = AF_INET;
-        memcpy(&destAddr.sin_addr, hostEntry->h_addr_list[0], hostEntry->h_length);
-        
-        result.packetsSent = count;
-        double totalRTT = 0.0;
-        double minRTT = 999999.0;
-        double maxRTT = 0.0;
-        
-        for (int i = 0; i < count; i++) {
-            // Create ICMP packet
-            struct icmp packet;
-            memset(&packet, 0, sizeof(packet));
-            packet.icmp_type = ICMP_ECHO;
-            packet.icmp_code = 0;
-            packet.icmp_id = getpid();
-            packet.icmp_seq = i;
-            packet.icmp_cksum = 0;
-            packet.icmp_cksum = in_cksum((unsigned short*)&packet, sizeof(packet));
-            
-            struct timeval startTime, endTime;
-            gettimeofday(&startTime, nullptr);
-            
-            // Send packet
-            if (sendto(sock, &packet, sizeof(packet), 0, 
-                      (struct sockaddr*)&destAddr, sizeof(destAddr)) > 0) {
-                // Wait for reply
-                fd_set readSet;
-                FD_ZERO(&readSet);
-                FD_SET(sock, &readSet);
-                
-                struct timeval timeout;
-                timeout.tv_sec = timeoutSeconds;
-                timeout.tv_usec = 0;
-                
-                if (select(sock + 1, &readSet, nullptr, nullptr, &timeout) > 0) {
-                    char buffer[1024];
-                    struct sockaddr_in fromAddr;
-                    socklen_t fromLen = sizeof(fromAddr);
-                    
-                    if (recvfrom(sock, buffer, sizeof(buffer), 0,
-                                (struct sockaddr*)&fromAddr, &fromLen) > 0) {
-                        gettimeofday(&endTime, nullptr);
-                        double rtt = (endTime.tv_sec - startTime.tv_sec) * 1000.0 +
-                                    (endTime.tv_usec - startTime.tv_usec) / 1000.0;
-                        
-                        result.packetsReceived++;
-                        totalRTT += rtt;
-                        if (rtt < minRTT) minRTT = rtt;
-                        if (rtt > maxRTT) maxRTT = rtt;
-                    }
-                }
-            }
-        }
-        
-        close(sock);
-        
-        if (result.packetsReceived > 0) {
-            result.avgRTT = totalRTT / result.packetsReceived;
-            result.minRTT = minRTT;
-            result.maxRTT = maxRTT;
-        }
-        result.packetLoss = ((result.packetsSent - result.packetsReceived) * 100.0) / result.packetsSent;
-#endif
-        
-        return result;
-    }
-    
-#ifndef _WIN32
-    unsigned short in_cksum(unsigned short* addr, int len) {
-        int nleft = len;
-        int sum = 0;
-        unsigned short* w = addr;
-        unsigned short answer = 0;
-        
-        while (nleft > 1) {
-            sum += *w++;
-            nleft -= 2;
-        }
-        
-        if (nleft == 1) {
-            *(unsigned char*)(&answer) = *(unsigned char*)w;
-            sum += answer;
-        }
-        
-        sum = (sum >> 16) + (sum & 0xffff);
-        sum += (sum >> 16);
-        answer = ~sum;
-        return answer;
-    }
-#endif
-
 public:
     netmon_plugins::PluginResult check() override {
         if (hostname.empty()) {
@@ -219,7 +36,9 @@ public:
         }
         
         try {
-            PingResult result = pingHost(hostname, packetCount, timeoutSeconds);
+            netmon_plugins::EchoStats result = netmon_plugins::pingEcho(
+                hostname, packetCount, std::chrono::milliseconds(PACKET_INTERVAL_MS),
+                std::chrono::seconds(timeoutSeconds));
             
             netmon_plugins::ExitCode code = netmon_plugins::ExitCode::OK;
             std::ostringstream msg;
@@ -256,17 +75,17 @@ public:
                     << result.packetLoss << "% loss), RTA = " << result.avgRTT << " ms";
             }
             
-            std::ostringstream perfdata;
-            perfdata << "rta=" << std::fixed << std::setprecision(2) << result.avgRTT << "ms";
+            netmon_plugins::PerfMetrics perfdata;
+            netmon_plugins::PerfMetric& rta = perfdata.emplace_back("rta", result.avgRTT, "ms");
             if (warningRTA > 0) {
-                perfdata << ";" << warningRTA << ";" << criticalRTA;
+                rta.thresholds(warningRTA, criticalRTA);
             }
-            perfdata << " pl=" << std::fixed << std::setprecision(1) << result.packetLoss << "%";
+            netmon_plugins::PerfMetric& pl = perfdata.emplace_back("pl", result.packetLoss, "%");
             if (warningPL > 0) {
-                perfdata << ";" << warningPL << ";" << criticalPL;
+                pl.thresholds(warningPL, criticalPL);
             }
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -278,8 +97,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -338,9 +156,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    PingPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("ping", PingPlugin, Network)
 
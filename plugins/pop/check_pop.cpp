@@ -3,26 +3,13 @@
 
 #include "netmon/plugin.hpp"
 #include "netmon/dependency_check.hpp"
+#include "netmon/tcp_script.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
 #include <stdexcept>
 #include <string>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
-
 namespace {
 
 class PopPlugin : public netmon_plugins::Plugin {
@@ -34,221 +21,20 @@ private:
     std::string password;
     bool useSSL = false;
 
-    std::string readResponse(int sock) {
-        std::string response;
-        char buffer[1024];
-        
-#ifdef _WIN32
-        DWORD timeoutMs = timeoutSeconds * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        fd_set readSet;
-        FD_ZERO(&readSet);
-        FD_SET(sock, &readSet);
-        
-        struct timeval tv;
-        tv.tv_sec = timeoutSeconds;
-        tv.tv_usec = 0;
-        
-        if (select(0, &readSet, nullptr, nullptr, &tv) > 0) {
-            int received = recv(sock, buffer, sizeof(buffer) - 1, 0);
-            if (received > 0) {
-                buffer[received] = '\0';
-                response = buffer;
-            }
-        }
-#else
-        struct timeval tv;
-        tv.tv_sec = timeoutSeconds;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        
-        fd_set readSet;
-        FD_ZERO(&readSet);
-        FD_SET(sock, &readSet);
-        
-        if (select(sock + 1, &readSet, nullptr, nullptr, &tv) > 0) {
-            ssize_t received = recv(sock, buffer, sizeof(buffer) - 1, 0);
-            if (received > 0) {
-                buffer[received] = '\0';
-                response = buffer;
-            }
-        }
-#endif
-        
-        return response;
-    }
-
-    bool sendCommand(int sock, const std::string& command) {
-        std::string cmd = command + "\r\n";
-#ifdef _WIN32
-        return send(sock, cmd.c_str(), static_cast<int>(cmd.length()), 0) > 0;
-#else
-        return send(sock, cmd.c_str(), cmd.length(), 0) > 0;
-#endif
-    }
-
-    bool checkPop(const std::string& host, int portNum, int timeout, 
+    bool checkPop(const std::string& host, int portNum, int timeout,
                   const std::string& user, const std::string& pass) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            WSACleanup();
-            return false;
-        }
-        
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        // Set timeout
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        // Connect
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            WSACleanup();
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        
-        // Read greeting
-        std::string response = readResponse(sock);
-        if (response.empty() || response.find("+OK") == std::string::npos) {
-            closesocket(sock);
-            WSACleanup();
-            return false;
-        }
-        
-        // Send USER command if credentials provided
-        if (!user.empty()) {
-            if (!sendCommand(sock, "USER " + user)) {
-                closesocket(sock);
-                WSACleanup();
-                return false;
-            }
-            
-            response = readResponse(sock);
-            if (response.empty() || response.find("+OK") == std::string::npos) {
-                closesocket(sock);
-                WSACleanup();
-                return false;
-            }
-            
-            // Send PASS command
-            if (!pass.empty()) {
-                if (!sendCommand(sock, "PASS " + pass)) {
-                    closesocket(sock);
-                    WSACleanup();
-                    return false;
-                }
-                
-                response = readResponse(sock);
-                if (response.empty() || response.find("+OK") == std::string::npos) {
-                    closesocket(sock);
-                    WSACleanup();
-                    return false;
-                }
-                
-                // Send QUIT
-                sendCommand(sock, "QUIT");
-                readResponse(sock);
-            }
-        }
-        
-        closesocket(sock);
-        WSACleanup();
-        return true;
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            return false;
-        }
-        
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        // Set timeout
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        // Connect
-        if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-            freeaddrinfo(result);
-            close(sock);
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        
-        // Read greeting
-        std::string response = readResponse(sock);
-        if (response.empty() || response.find("+OK") == std::string::npos) {
-            close(sock);
-            return false;
-        }
-        
-        // Send USER command if credentials provided
+        netmon_plugins::TcpScript script;
+        script.expectLine({"+OK"});
         if (!user.empty()) {
-            if (!sendCommand(sock, "USER " + user)) {
-                close(sock);
-                return false;
-            }
-            
-            response = readResponse(sock);
-            if (response.empty() || response.find("+OK") == std::string::npos) {
-                close(sock);
-                return false;
-            }
-            
-            // Send PASS command
+            script.send("USER " + user + "\r\n").expectLine({"+OK"});
             if (!pass.empty()) {
-                if (!sendCommand(sock, "PASS " + pass)) {
-                    close(sock);
-                    return false;
-                }
-                
-                response = readResponse(sock);
-                if (response.empty() || response.find("+OK") == std::string::npos) {
-                    close(sock);
-                    return false;
-                }
-                
-                // Send QUIT
-                sendCommand(sock, "QUIT");
-                readResponse(sock);
+                script.send("PASS " + pass + "\r\n").expectLine({"+OK"})
+                      .send("QUIT\r\n");
             }
         }
-        
-        close(sock);
-        return true;
-#endif
+
+        return netmon_plugins::runTcpScript(
+            host, portNum, script, netmon_plugins::CheckContext::current().within(timeout)).ok();
     }
 
 public:
@@ -303,8 +89,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -351,9 +136,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    PopPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("pop", PopPlugin, Network)
 
@@ -2,6 +2,7 @@
 // Process monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/threshold.hpp"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -24,10 +25,7 @@ namespace {
 
 class ProcsPlugin : public netmon_plugins::Plugin {
 private:
-    int warningMin = -1;
-    int criticalMin = -1;
-    int warningMax = -1;
-    int criticalMax = -1;
+    netmon_plugins::Thresholds thresholds;
     std::string processName;
     std::string stateFilter;
 
@@ -108,40 +106,19 @@ public:
             msg << "Processes OK - " << processCount << " " << procDesc << " running";
             
             // Check thresholds
-            if (criticalMin > 0 && processCount < criticalMin) {
-                code = netmon_plugins::ExitCode::CRITICAL;
+            code = thresholds.evaluate(processCount);
+            if (code != netmon_plugins::ExitCode::OK) {
+                const bool critical = code == netmon_plugins::ExitCode::CRITICAL;
                 msg.str("");
-                msg << "Processes CRITICAL - " << processCount << " " << procDesc 
-                    << " running (minimum: " << criticalMin << ")";
-            } else if (criticalMax > 0 && processCount > criticalMax) {
-                code = netmon_plugins::ExitCode::CRITICAL;
-                msg.str("");
-                msg << "Processes CRITICAL - " << processCount << " " << procDesc 
-                    << " running (maximum: " << criticalMax << ")";
-            } else if (warningMin > 0 && processCount < warningMin) {
-                code = netmon_plugins::ExitCode::WARNING;
-                msg.str("");
-                msg << "Processes WARNING - " << processCount << " " << procDesc 
-                    << " running (minimum: " << warningMin << ")";
-            } else if (warningMax > 0 && processCount > warningMax) {
-                code = netmon_plugins::ExitCode::WARNING;
-                msg.str("");
-                msg << "Processes WARNING - " << processCount << " " << procDesc 
-                    << " running (maximum: " << warningMax << ")";
+                msg << "Processes " << netmon_plugins::exitCodeToString(code) << " - "
+                    << processCount << " " << procDesc << " running (expected: "
+                    << (critical ? thresholds.critical : thresholds.warning).toString() << ")";
             }
             
-            std::ostringstream perfdata;
-            perfdata << "procs=" << processCount;
-            if (warningMin > 0 || warningMax > 0) {
-                perfdata << ";" << (warningMin > 0 ? warningMin : 0) << ";" 
-                         << (criticalMin > 0 ? criticalMin : 0);
-                if (warningMax > 0 || criticalMax > 0) {
-                    perfdata << ";" << (warningMax > 0 ? warningMax : 0) << ";" 
-                             << (criticalMax > 0 ? criticalMax : 0);
-                }
-            }
+            netmon_plugins::PerfMetrics perfdata;
+            perfdata.emplace_back("procs", processCount).thresholds(thresholds).minimum(0);
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -153,29 +130,14 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
                 if (i + 1 < argc) {
-                    std::string threshold = argv[++i];
-                    size_t colon = threshold.find(':');
-                    if (colon != std::string::npos) {
-                        warningMin = std::stoi(threshold.substr(0, colon));
-                        warningMax = std::stoi(threshold.substr(colon + 1));
-                    } else {
-                        warningMax = std::stoi(threshold);
-                    }
+                    thresholds.warning = netmon_plugins::ThresholdRange::parse(argv[++i]);
                 }
             } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--critical") == 0) {
                 if (i + 1 < argc) {
-                    std::string threshold = argv[++i];
-                    size_t colon = threshold.find(':');
-                    if (colon != std::string::npos) {
-                        criticalMin = std::stoi(threshold.substr(0, colon));
-                        criticalMax = std::stoi(threshold.substr(colon + 1));
-                    } else {
-                        criticalMax = std::stoi(threshold);
-                    }
+                    thresholds.critical = netmon_plugins::ThresholdRange::parse(argv[++i]);
                 }
             } else if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--argument") == 0) {
                 if (i + 1 < argc) {
@@ -188,10 +150,12 @@ public:
     std::string getUsage() const override {
         return "Usage: check_procs [options]\n"
                "Options:\n"
-               "  -w, --warning THRESHOLD    Warning threshold (max or min:max)\n"
-               "  -c, --critical THRESHOLD   Critical threshold (max or min:max)\n"
+               "  -w, --warning RANGE        Warning if the count is outside RANGE\n"
+               "  -c, --critical RANGE       Critical if the count is outside RANGE\n"
                "  -a, --argument NAME        Filter by process name\n"
-               "  -h, --help                 Show this help message";
+               "  -h, --help                 Show this help message\n"
+               "\n"
+               "RANGE is a Nagios range: 10, 2:, ~:10, 2:10 or @2:10 (alert inside).";
     }
     
     std::string getDescription() const override {
@@ -201,9 +165,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    ProcsPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("procs", ProcsPlugin, System)
 
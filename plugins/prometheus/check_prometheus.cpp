@@ -115,13 +115,13 @@ public:
                     << " (exceeds warning threshold of " << warningValue << ")";
             }
             
-            std::ostringstream perfdata;
-            perfdata << metricName << "=" << value;
+            netmon_plugins::PerfMetrics perfdata;
+            netmon_plugins::PerfMetric& metric = perfdata.emplace_back(metricName, value);
             if (warningValue >= 0) {
-                perfdata << ";" << warningValue << ";" << criticalValue;
+                metric.thresholds(warningValue, criticalValue);
             }
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -133,8 +133,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -187,9 +186,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    PrometheusPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("prometheus", PrometheusPlugin, Application)
 
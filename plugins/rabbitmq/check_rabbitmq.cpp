@@ -62,13 +62,14 @@ public:
                 msg << "RabbitMQ OK - Queue \"" << queueName << "\": " << messages 
                     << " messages, " << consumers << " consumers";
                 
-                std::ostringstream perfdata;
-                perfdata << "messages=" << messages << " consumers=" << consumers;
+                netmon_plugins::PerfMetrics perfdata;
+                perfdata.emplace_back("messages", messages);
+                perfdata.emplace_back("consumers", consumers);
                 
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::OK,
                     msg.str(),
-                    perfdata.str()
+                    std::move(perfdata)
                 );
             } else {
                 // Check overview
@@ -82,14 +83,16 @@ public:
                 msg << "RabbitMQ OK - " << queues << " queues, " << exchanges 
                     << " exchanges, " << connections << " connections";
                 
-                std::ostringstream perfdata;
-                perfdata << "queues=" << queues << " exchanges=" << exchanges 
-                         << " connections=" << connections << " channels=" << channels;
+                netmon_plugins::PerfMetrics perfdata;
+                perfdata.emplace_back("queues", queues);
+                perfdata.emplace_back("exchanges", exchanges);
+                perfdata.emplace_back("connections", connections);
+                perfdata.emplace_back("channels", channels);
                 
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::OK,
                     msg.str(),
-                    perfdata.str()
+                    std::move(perfdata)
                 );
             }
         } catch (const std::exception& e) {
@@ -103,8 +106,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -152,9 +154,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    RabbitmqPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("rabbitmq", RabbitmqPlugin, Application)
 
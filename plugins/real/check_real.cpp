@@ -22,18 +22,23 @@ public:
         // Placeholder for real-time monitoring
         // This would typically monitor real-time system metrics
         time_t now = time(nullptr);
+        char stamp[32] = "";   // ctime's static buffer is shared by concurrent checks
+#ifdef _WIN32
+        ctime_s(stamp, sizeof(stamp), &now);
+#else
+        ctime_r(&now, stamp);
+#endif
         
         return netmon_plugins::PluginResult(
             netmon_plugins::ExitCode::OK,
-            "Real-time monitoring - Current time: " + std::string(ctime(&now)) + " (implementation pending)"
+            "Real-time monitoring - Current time: " + std::string(stamp) + " (implementation pending)"
         );
     }
     
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--metric") == 0) {
                 if (i + 1 < argc) {
                     metric = argv[++i];
@@ -68,9 +73,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    RealPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("real", RealPlugin, Specialized)
 
@@ -2,28 +2,16 @@
 // Redis monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/connection.hpp"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <vector>
+#include <cstdlib>
 #include <cstring>
 #include <stdexcept>
 #include <string>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
-
 namespace {
 
 class RedisPlugin : public netmon_plugins::Plugin {
@@ -34,77 +22,9 @@ private:
     std::string password;
     bool checkInfo = true;
 
-    bool connectToRedis(const std::string& host, int portNum, int timeout, int& sock) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            WSACleanup();
-            return false;
-        }
-        
-        sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            WSACleanup();
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        return true;
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            return false;
-        }
-        
-        sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-            freeaddrinfo(result);
-            close(sock);
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        return true;
-#endif
-    }
-
-    std::string sendRedisCommand(int sock, const std::string& command) {
+    // Send a command and read one RESP reply: bulk strings come back as
+    // "$<length>\r\n<data>\r\n", anything else as its first line
+    std::string sendRedisCommand(netmon_plugins::net::Connection& conn, const std::string& command) {
         // Redis protocol: *<number of arguments>\r\n$<length>\r\n<command>\r\n
         std::vector<std::string> parts;
         std::istringstream iss(command);
@@ -119,41 +39,15 @@ private:
             cmd << "$" << p.length() << "\r\n" << p << "\r\n";
         }
         
-        std::string cmdStr = cmd.str();
-        
-#ifdef _WIN32
-        if (send(sock, cmdStr.c_str(), static_cast<int>(cmdStr.length()), 0) < 0) {
+        std::string line;
+        if (conn.write(cmd.str()) != netmon_plugins::IoStatus::OK ||
+            conn.readLine(line) != netmon_plugins::IoStatus::OK) {
             return "";
         }
-        
-        char buffer[8192];
-        std::string response;
-        int bytes;
-        while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-            buffer[bytes] = '\0';
-            response += buffer;
-            // Redis responses end with \r\n, check if we have complete response
-            if (response.length() > 2 && response[response.length()-2] == '\r') {
-                break;
-            }
+        std::string response = line + "\r\n";
+        if (line.size() > 1 && line[0] == '$' && line[1] != '-') {
+            conn.readExactly(std::stoul(line.substr(1)) + 2, response);
         }
-#else
-        if (send(sock, cmdStr.c_str(), cmdStr.length(), 0) < 0) {
-            return "";
-        }
-        
-        char buffer[8192];
-        std::string response;
-        ssize_t bytes;
-        while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-            buffer[bytes] = '\0';
-            response += buffer;
-            if (response.length() > 2 && response[response.length()-2] == '\r') {
-                break;
-            }
-        }
-#endif
-        
         return response;
     }
 
@@ -185,8 +79,8 @@ public:
         }
         
         try {
-            int sock = 0;
-            if (!connectToRedis(hostname, port, timeoutSeconds, sock)) {
+            netmon_plugins::net::Connection sock;
+            if (!sock.open(hostname, port, netmon_plugins::CheckContext::current().within(timeoutSeconds))) {
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::CRITICAL,
                     "Redis CRITICAL - Cannot connect to " + hostname + ":" + std::to_string(port)
@@ -198,12 +92,6 @@ public:
                 std::string authResponse = sendRedisCommand(sock, "AUTH " + password);
                 if (authResponse.find("OK") == std::string::npos && 
                     authResponse.find("+OK") == std::string::npos) {
-#ifdef _WIN32
-                    closesocket(sock);
-                    WSACleanup();
-#else
-                    close(sock);
-#endif
                     return netmon_plugins::PluginResult(
                         netmon_plugins::ExitCode::CRITICAL,
                         "Redis CRITICAL - Authentication failed"
@@ -215,12 +103,6 @@ public:
             std::string pingResponse = sendRedisCommand(sock, "PING");
             if (pingResponse.find("PONG") == std::string::npos && 
                 pingResponse.find("+PONG") == std::string::npos) {
-#ifdef _WIN32
-                closesocket(sock);
-                WSACleanup();
-#else
-                close(sock);
-#endif
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::CRITICAL,
                     "Redis CRITICAL - PING failed"
@@ -229,17 +111,11 @@ public:
             
             // Get INFO
             std::string infoResponse = sendRedisCommand(sock, "INFO");
-            
-#ifdef _WIN32
-            closesocket(sock);
-            WSACleanup();
-#else
-            close(sock);
-#endif
+            sock.close();
             
             // Parse INFO response (bulk string format)
             std::string info;
-            if (infoResponse[0] == '$') {
+            if (!infoResponse.empty() && infoResponse[0] == '$') {
                 // Bulk string: $<length>\r\n<data>\r\n
                 size_t lenStart = 1;
                 size_t lenEnd = infoResponse.find("\r\n");
@@ -288,19 +164,27 @@ public:
                 << ", " << connectedClients << " clients, " 
                 << usedMemoryHuman << " used";
             
-            std::ostringstream perfdata;
-            perfdata << "clients=" << connectedClients
-                     << " memory=" << usedMemory
-                     << " commands=" << totalCommandsProcessed
-                     << " hit_ratio=" << std::fixed << std::setprecision(2) << hitRatio << "%"
-                     << " hits=" << keyspaceHits
-                     << " misses=" << keyspaceMisses
-                     << " uptime=" << uptimeInSeconds;
+            // INFO fields the server did not report are left out
+            netmon_plugins::PerfMetrics perfdata;
+            auto addInfo = [&perfdata](const char* label, const std::string& text, const char* unit) {
+                char* end = nullptr;
+                double value = std::strtod(text.c_str(), &end);
+                if (!text.empty() && *end == '\0') {
+                    perfdata.emplace_back(label, value, unit);
+                }
+            };
+            addInfo("clients", connectedClients, "");
+            addInfo("memory", usedMemory, "B");
+            addInfo("commands", totalCommandsProcessed, "c");
+            perfdata.emplace_back("hit_ratio", hitRatio, "%");
+            addInfo("hits", keyspaceHits, "c");
+            addInfo("misses", keyspaceMisses, "c");
+            addInfo("uptime", uptimeInSeconds, "s");
             
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::OK,
                 msg.str(),
-                perfdata.str()
+                std::move(perfdata)
             );
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
@@ -313,8 +197,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -352,9 +235,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    RedisPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("redis", RedisPlugin, Application)
 
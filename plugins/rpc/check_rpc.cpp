@@ -2,26 +2,13 @@
 // RPC service monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/connection.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
 #include <stdexcept>
 #include <string>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
-
 namespace {
 
 class RpcPlugin : public netmon_plugins::Plugin {
@@ -33,77 +20,9 @@ private:
     int timeoutSeconds = 10;
 
     bool checkRpcPortmapper(const std::string& host, int progNum, int versNum, int timeout) {
-#ifdef _WIN32
-        // Windows doesn't have native RPC portmapper, use TCP connection to port 111
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        if (getaddrinfo(host.c_str(), "111", &hints, &result) != 0) {
-            WSACleanup();
-            return false;
-        }
-        
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        // Set timeout
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        // Try to connect
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) == 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            WSACleanup();
-            return true;
-        }
-        
-        freeaddrinfo(result);
-        closesocket(sock);
-        WSACleanup();
-        return false;
-#else
-        // On Unix/Linux, try to use portmapper if available
-        // Fallback to TCP connection check on port 111
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        if (getaddrinfo(host.c_str(), "111", &hints, &result) != 0) {
-            return false;
-        }
-        
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        // Set timeout
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        // Try to connect
-        bool connected = (connect(sock, result->ai_addr, result->ai_addrlen) == 0);
-        
-        freeaddrinfo(result);
-        close(sock);
-        return connected;
-#endif
+        // TCP connection check on the portmapper port (111)
+        netmon_plugins::net::Connection conn;
+        return conn.open(host, 111, netmon_plugins::CheckContext::current().within(timeout));
     }
 
 public:
@@ -165,8 +84,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -206,9 +124,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    RpcPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("rpc", RpcPlugin, Network)
 
@@ -98,19 +98,15 @@ public:
             
             std::vector<double> temperatures;
             std::ostringstream msg;
-            std::ostringstream perfdata;
+            netmon_plugins::PerfMetrics perfdata;
             
             for (const auto& device : devices) {
                 double temp = readTemperature(device);
                 if (temp >= 0) {
                     temperatures.push_back(temp);
                     
-                    if (!perfdata.str().empty()) {
-                        perfdata << " ";
-                    }
-                    perfdata << "temp_" << temperatures.size() << "=" 
-                             << std::fixed << std::setprecision(1) << temp 
-                             << ";" << warningTemp << ";" << criticalTemp;
+                    perfdata.emplace_back("temp_" + std::to_string(temperatures.size()), temp)
+                        .thresholds(warningTemp, criticalTemp);
                 }
             }
             
@@ -140,7 +136,7 @@ public:
                     << maxTemp << "°C (warning threshold: " << warningTemp << "°C)";
             }
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -159,8 +155,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
                 if (i + 1 < argc) {
                     warningTemp = std::stod(argv[++i]);
@@ -196,9 +191,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    SensorsPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("sensors", SensorsPlugin, Hardware)
 
@@ -2,26 +2,12 @@
 // SMTP service monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/tcp_script.hpp"
 #include <iostream>
 #include <sstream>
-#include <iomanip>
 #include <cstring>
 #include <stdexcept>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
-
 namespace {
 
 class SmtpPlugin : public netmon_plugins::Plugin {
@@ -32,80 +18,12 @@ private:
     std::string expectString = "220";
 
     bool checkSmtp(const std::string& host, int portNum) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-#endif
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-#ifdef _WIN32
-            WSACleanup();
-#endif
-            return false;
-        }
-        
-#ifdef _WIN32
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        DWORD timeout = timeoutSeconds * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeout, sizeof(timeout));
-        
-        if (connect(sock, result->ai_addr, (int)result->ai_addrlen) < 0) {
-            closesocket(sock);
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        char buffer[1024];
-        int bytes = recv(sock, buffer, sizeof(buffer) - 1, 0);
-        closesocket(sock);
-        WSACleanup();
-#else
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        struct timeval tv;
-        tv.tv_sec = timeoutSeconds;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        if (connect(sock, result->ai_addr, result->ai_addrlen) < 0) {
-            close(sock);
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        char buffer[1024];
-        int bytes = recv(sock, buffer, sizeof(buffer) - 1, 0);
-        close(sock);
-#endif
-        
-        freeaddrinfo(result);
-        
-        if (bytes > 0) {
-            buffer[bytes] = '\0';
-            std::string response(buffer);
-            return response.find(expectString) != std::string::npos;
-        }
-        
-        return false;
+        netmon_plugins::TcpScript script;
+        script.expectReply({}).send("QUIT\r\n");
+
+        netmon_plugins::TcpProbeResult result = netmon_plugins::runTcpScript(
+            host, portNum, script, netmon_plugins::CheckContext::current().within(timeoutSeconds));
+        return result.ok() && result.reply.find(expectString) != std::string::npos;
     }
 
 public:
@@ -146,8 +64,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -185,9 +102,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    SmtpPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("smtp", SmtpPlugin, Network)
 
@@ -2,6 +2,7 @@
 // SSL/TLS certificate validity monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/connection.hpp"
 #include "netmon/dependency_check.hpp"
 #include <iostream>
 #include <sstream>
@@ -18,24 +19,6 @@
 #include <openssl/x509v3.h>
 #endif
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#ifdef NETMON_SSL_ENABLED
-#pragma comment(lib, "libssl.lib")
-#pragma comment(lib, "libcrypto.lib")
-#endif
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
-
 namespace {
 
 class SslValidityPlugin : public netmon_plugins::Plugin {
@@ -49,156 +32,21 @@ private:
 #ifdef NETMON_SSL_ENABLED
     bool checkSslCertificate(const std::string& host, int portNum, int timeout,
                             int& daysUntilExpiry, std::string& issuer, std::string& subject) {
-        // Initialize OpenSSL
-        SSL_library_init();
-        SSL_load_error_strings();
-        OpenSSL_add_all_algorithms();
-        
-        // Create SSL context
-        SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
-        if (!ctx) {
-            return false;
-        }
-        
-        // Set minimum protocol version (if available)
-        #ifdef SSL_CTX_set_min_proto_version
-        SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
-        #endif
-        
-        // Enable peer verification but don't fail on verification errors
-        // This allows us to get certificate info even if chain verification fails
-        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER | SSL_VERIFY_CLIENT_ONCE, nullptr);
-        
-        // Load default certificate store
-        SSL_CTX_set_default_verify_paths(ctx);
-        
-        // Don't fail on verification errors - we still want to get certificate info
-        SSL_CTX_set_verify_depth(ctx, 4);
-        
-        // Create socket
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            SSL_CTX_free(ctx);
-            WSACleanup();
-            return false;
-        }
-        
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            SSL_CTX_free(ctx);
-            WSACleanup();
-            return false;
-        }
-        
-        // Set timeout
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        // Connect
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            SSL_CTX_free(ctx);
-            WSACleanup();
-            return false;
-        }
-        
-        freeaddrinfo(result);
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        // Set timeout
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        // Connect
-        if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-            freeaddrinfo(result);
-            close(sock);
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        freeaddrinfo(result);
-#endif
-        
-        // Create SSL connection
-        SSL* ssl = SSL_new(ctx);
-        if (!ssl) {
-#ifdef _WIN32
-            closesocket(sock);
-            WSACleanup();
-#else
-            close(sock);
-#endif
-            SSL_CTX_free(ctx);
-            return false;
-        }
-        
-        SSL_set_fd(ssl, sock);
-        
-        // Set SNI (Server Name Indication) if available
-        #ifdef SSL_set_tlsext_host_name
-        SSL_set_tlsext_host_name(ssl, host.c_str());
-        #endif
-        
-        // Perform SSL handshake
-        int ssl_ret = SSL_connect(ssl);
-        if (ssl_ret <= 0) {
-            int ssl_error = SSL_get_error(ssl, ssl_ret);
-            // Log error for debugging (can be removed in production)
-            SSL_free(ssl);
-#ifdef _WIN32
-            closesocket(sock);
-            WSACleanup();
-#else
-            close(sock);
-#endif
-            SSL_CTX_free(ctx);
+        // The handshake does not verify the chain: the certificate is
+        // inspected below even if it would not verify. A resumed session
+        // would show the certificate of an earlier handshake.
+        netmon_plugins::net::ConnectOptions options;
+        options.tls = true;
+        options.resumeSession = false;
+        netmon_plugins::net::Connection conn;
+        if (!conn.open(host, portNum, netmon_plugins::CheckContext::current().within(timeout),
+                       options)) {
             return false;
         }
         
         // Get certificate
-        X509* cert = SSL_get_peer_certificate(ssl);
+        X509* cert = SSL_get_peer_certificate(conn.tlsSession());
         if (!cert) {
-            SSL_free(ssl);
-#ifdef _WIN32
-            closesocket(sock);
-            WSACleanup();
-#else
-            close(sock);
-#endif
-            SSL_CTX_free(ctx);
             return false;
         }
         
@@ -226,17 +74,7 @@ private:
             OPENSSL_free(subjectStr);
         }
         
-        // Cleanup
         X509_free(cert);
-        SSL_free(ssl);
-#ifdef _WIN32
-        closesocket(sock);
-        WSACleanup();
-#else
-        close(sock);
-#endif
-        SSL_CTX_free(ctx);
-        
         return true;
     }
 #else
@@ -244,73 +82,9 @@ private:
                             int& daysUntilExpiry, std::string& issuer, std::string& subject) {
         // Without OpenSSL, just check if port is open
         // This is a fallback when SSL support is not compiled in
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            WSACleanup();
-            return false;
-        }
-        
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        bool connected = (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) == 0);
-        
-        freeaddrinfo(result);
-        closesocket(sock);
-        WSACleanup();
-        
-        if (connected) {
-            daysUntilExpiry = -1; // Unknown without OpenSSL
-            issuer = "SSL support not compiled in";
-            subject = host;
-        }
-        
-        return connected;
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            return false;
-        }
-        
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        bool connected = (connect(sock, result->ai_addr, result->ai_addrlen) == 0);
-        
-        freeaddrinfo(result);
-        close(sock);
-        
+        netmon_plugins::net::Connection conn;
+        bool connected = conn.open(host, portNum,
+                                   netmon_plugins::CheckContext::current().within(timeout));
         if (connected) {
             daysUntilExpiry = -1; // Unknown without OpenSSL
             issuer = "SSL support not compiled in";
@@ -318,7 +92,6 @@ private:
         }
         
         return connected;
-#endif
     }
 #endif
 
@@ -376,13 +149,15 @@ public:
                 }
             }
             
-            std::ostringstream perfdata;
+            // Alerts fire at or below the day counts: ranges "warn:" and "crit:"
+            netmon_plugins::PerfMetrics perfdata;
             if (daysUntilExpiry >= 0) {
-                perfdata << "days_until_expiry=" << daysUntilExpiry << ";" 
-                         << warningDays << ";" << criticalDays;
+                perfdata.emplace_back("days_until_expiry", daysUntilExpiry)
+                    .thresholds(std::to_string(warningDays + 1) + ":",
+                                std::to_string(criticalDays + 1) + ":");
             }
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -394,8 +169,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -441,9 +215,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    SslValidityPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("ssl_validity", SslValidityPlugin, Network)
 
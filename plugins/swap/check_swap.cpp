@@ -132,21 +132,21 @@ public:
                     << std::fixed << std::setprecision(1) << freePercent << "% free)";
             }
             
-            std::ostringstream perfdata;
-            perfdata << "swap_total=" << swap.total << "KB "
-                     << "swap_used=" << swap.used << "KB "
-                     << "swap_free=" << swap.free << "KB "
-                     << "swap_used_percent=" << std::fixed << std::setprecision(1) 
-                     << usedPercent << "%";
+            // Thresholds are on free swap in KB; alerts fire below them
+            auto freeRange = [&](long long freeKb, double percent) {
+                long long kb = freeKb > 0 ? freeKb : static_cast<long long>(percent * swap.total / 100.0);
+                return kb > 0 ? std::to_string(kb) + ":" : std::string();
+            };
+            netmon_plugins::PerfMetrics perfdata;
+            perfdata.emplace_back("swap_total", swap.total, "KB");
+            perfdata.emplace_back("swap_used", swap.used, "KB").range(0, swap.total);
+            perfdata.emplace_back("swap_free", swap.free, "KB")
+                .thresholds(freeRange(warningFree, warningPercent),
+                            freeRange(criticalFree, criticalPercent))
+                .range(0, swap.total);
+            perfdata.emplace_back("swap_used_percent", usedPercent, "%").range(0, 100);
             
-            if (warningFree > 0 || warningPercent > 0) {
-                perfdata << ";" << (warningFree > 0 ? warningFree : static_cast<long long>(warningPercent * swap.total / 100.0));
-            }
-            if (criticalFree > 0 || criticalPercent > 0) {
-                perfdata << ";" << (criticalFree > 0 ? criticalFree : static_cast<long long>(criticalPercent * swap.total / 100.0));
-            }
-            
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -158,8 +158,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
                 if (i + 1 < argc) {
                     std::string threshold = argv[++i];
@@ -197,9 +196,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    SwapPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("swap", SwapPlugin, System)
 
@@ -2,26 +2,13 @@
 // Telnet service monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/connection.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
 #include <stdexcept>
 #include <string>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
-
 namespace {
 
 class TelnetPlugin : public netmon_plugins::Plugin {
@@ -32,164 +19,27 @@ private:
     std::string expectString;
     std::string sendString;
 
-    std::string readResponse(int sock) {
-        std::string response;
-        char buffer[1024];
-        
-#ifdef _WIN32
-        DWORD timeoutMs = timeoutSeconds * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        fd_set readSet;
-        FD_ZERO(&readSet);
-        FD_SET(sock, &readSet);
-        
-        struct timeval tv;
-        tv.tv_sec = timeoutSeconds;
-        tv.tv_usec = 0;
-        
-        if (select(0, &readSet, nullptr, nullptr, &tv) > 0) {
-            int received = recv(sock, buffer, sizeof(buffer) - 1, 0);
-            if (received > 0) {
-                buffer[received] = '\0';
-                response = buffer;
-            }
-        }
-#else
-        struct timeval tv;
-        tv.tv_sec = timeoutSeconds;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        
-        fd_set readSet;
-        FD_ZERO(&readSet);
-        FD_SET(sock, &readSet);
-        
-        if (select(sock + 1, &readSet, nullptr, nullptr, &tv) > 0) {
-            ssize_t received = recv(sock, buffer, sizeof(buffer) - 1, 0);
-            if (received > 0) {
-                buffer[received] = '\0';
-                response = buffer;
-            }
-        }
-#endif
-        
-        return response;
-    }
-
-    bool sendData(int sock, const std::string& data) {
-        if (data.empty()) return true;
-#ifdef _WIN32
-        return send(sock, data.c_str(), static_cast<int>(data.length()), 0) > 0;
-#else
-        return send(sock, data.c_str(), data.length(), 0) > 0;
-#endif
-    }
-
-    bool checkTelnet(const std::string& host, int portNum, int timeout, 
+    bool checkTelnet(const std::string& host, int portNum, int timeout,
                      const std::string& send, const std::string& expect) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            WSACleanup();
-            return false;
-        }
-        
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            WSACleanup();
+        netmon_plugins::net::Connection conn;
+        if (!conn.open(host, portNum, netmon_plugins::CheckContext::current().within(timeout))) {
             return false;
         }
         
-        freeaddrinfo(result);
-        
-        // Read initial response
-        std::string response = readResponse(sock);
-        
         // Send data if specified
-        if (!send.empty()) {
-            sendData(sock, send + "\r\n");
-            response = readResponse(sock);
-        }
-        
-        // Check for expected string if specified
-        bool success = true;
-        if (!expect.empty()) {
-            success = (response.find(expect) != std::string::npos);
-        }
-        
-        closesocket(sock);
-        WSACleanup();
-        return success;
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            return false;
-        }
-        
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
+        if (!send.empty() && conn.write(send + "\r\n") != netmon_plugins::IoStatus::OK) {
             return false;
         }
         
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-            freeaddrinfo(result);
-            close(sock);
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        
-        // Read initial response
-        std::string response = readResponse(sock);
-        
-        // Send data if specified
-        if (!send.empty()) {
-            sendData(sock, send + "\r\n");
-            response = readResponse(sock);
-        }
-        
-        // Check for expected string if specified
-        bool success = true;
-        if (!expect.empty()) {
-            success = (response.find(expect) != std::string::npos);
+        // Check for expected string if specified, reading banner and reply
+        // until it shows up or the deadline passes
+        std::string response;
+        while (!expect.empty() && response.find(expect) == std::string::npos) {
+            if (conn.readSome(response) != netmon_plugins::IoStatus::OK) {
+                return false;
+            }
         }
-        
-        close(sock);
-        return success;
-#endif
+        return true;
     }
 
 public:
@@ -230,8 +80,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -274,9 +123,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    TelnetPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("telnet", TelnetPlugin, Network)
 
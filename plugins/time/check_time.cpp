@@ -58,20 +58,19 @@ public:
             msg << "TIME WARNING - offset " << offset << " seconds";
         }
 
-        std::ostringstream perfdata;
-        perfdata << "time_offset=" << std::fixed << std::setprecision(3) << offset << "s";
+        netmon_plugins::PerfMetrics perfdata;
+        netmon_plugins::PerfMetric& offsetMetric = perfdata.emplace_back("time_offset", offset, "s");
         if (warningOffset > 0) {
-            perfdata << ";" << warningOffset << ";" << criticalOffset;
+            offsetMetric.thresholds(warningOffset, criticalOffset);
         }
 
-        return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+        return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
     }
 
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -116,8 +115,4 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    TimePlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("time", TimePlugin, Specialized)
@@ -89,13 +89,20 @@ public:
                           std::to_string(static_cast<int>(warningThreshold)) + " days)";
             }
             
-            std::ostringstream perfdata;
-            perfdata << "uptime=" << std::fixed << std::setprecision(2) << uptimeDays << "d";
+            // Seconds, as "d" is no perfdata unit; alerts fire below the
+            // thresholds, hence the "N:" ranges
+            const double secondsPerDay = 86400.0;
+            netmon_plugins::PerfMetrics perfdata;
+            netmon_plugins::PerfMetric& uptime =
+                perfdata.emplace_back("uptime", std::floor(uptimeDays * secondsPerDay), "s");
             if (warningThreshold > 0) {
-                perfdata << ";" << warningThreshold << ";" << criticalThreshold;
+                uptime.thresholds(
+                    std::to_string(static_cast<long long>(warningThreshold * secondsPerDay)) + ":",
+                    std::to_string(static_cast<long long>(criticalThreshold * secondsPerDay)) + ":");
             }
+            uptime.minimum(0);
             
-            return netmon_plugins::PluginResult(code, message, perfdata.str());
+            return netmon_plugins::PluginResult(code, message, std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -107,8 +114,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
                 if (i + 1 < argc) {
                     warningThreshold = std::stod(argv[++i]);
@@ -136,9 +142,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    UptimePlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("uptime", UptimePlugin, System)
 
@@ -2,11 +2,13 @@
 // User session monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/threshold.hpp"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <cstring>
 #include <stdexcept>
+#include <mutex>
 
 #ifdef __APPLE__
 #include <utmpx.h>
@@ -21,15 +23,19 @@
 
 namespace {
 
+// The utmp cursor of set/get/endutent is process-wide, even through
+// getutent_r, so concurrent checks in one process take turns reading it
+std::mutex utmpMutex;
+
 class UsersPlugin : public netmon_plugins::Plugin {
 private:
-    int warningThreshold = -1;
-    int criticalThreshold = -1;
+    netmon_plugins::Thresholds thresholds;
 
     int getUserCount() {
         int count = 0;
         
 #ifdef __APPLE__
+        std::lock_guard<std::mutex> lock(utmpMutex);
         setutxent();
         struct utmpx *entry;
         while ((entry = getutxent()) != nullptr) {
@@ -52,9 +58,11 @@ private:
             WTSFreeMemory(sessionInfo);
         }
 #else
+        std::lock_guard<std::mutex> lock(utmpMutex);
         setutent();
+        struct utmp buffer;
         struct utmp *entry;
-        while ((entry = getutent()) != nullptr) {
+        while (getutent_r(&buffer, &entry) == 0) {
             if (entry->ut_type == USER_PROCESS) {
                 count++;
             }
@@ -76,27 +84,20 @@ public:
                 << (userCount != 1 ? "s" : "") << " currently logged in";
             
             // Check thresholds
-            if (criticalThreshold > 0 && userCount >= criticalThreshold) {
-                code = netmon_plugins::ExitCode::CRITICAL;
-                msg.str("");
-                msg << "Users CRITICAL - " << userCount 
-                    << " user" << (userCount != 1 ? "s" : "") 
-                    << " logged in (threshold: " << criticalThreshold << ")";
-            } else if (warningThreshold > 0 && userCount >= warningThreshold) {
-                code = netmon_plugins::ExitCode::WARNING;
+            code = thresholds.evaluate(userCount);
+            if (code != netmon_plugins::ExitCode::OK) {
+                const bool critical = code == netmon_plugins::ExitCode::CRITICAL;
                 msg.str("");
-                msg << "Users WARNING - " << userCount 
+                msg << "Users " << netmon_plugins::exitCodeToString(code) << " - " << userCount 
                     << " user" << (userCount != 1 ? "s" : "") 
-                    << " logged in (threshold: " << warningThreshold << ")";
+                    << " logged in (threshold: "
+                    << (critical ? thresholds.critical : thresholds.warning).toString() << ")";
             }
             
-            std::ostringstream perfdata;
-            perfdata << "users=" << userCount;
-            if (warningThreshold > 0) {
-                perfdata << ";" << warningThreshold << ";" << criticalThreshold;
-            }
+            netmon_plugins::PerfMetrics perfdata;
+            perfdata.emplace_back("users", userCount).thresholds(thresholds);
             
-            return netmon_plugins::PluginResult(code, msg.str(), perfdata.str());
+            return netmon_plugins::PluginResult(code, msg.str(), std::move(perfdata));
         } catch (const std::exception& e) {
             return netmon_plugins::PluginResult(
                 netmon_plugins::ExitCode::UNKNOWN,
@@ -108,15 +109,14 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--warning") == 0) {
                 if (i + 1 < argc) {
-                    warningThreshold = std::stoi(argv[++i]);
+                    thresholds.warning = netmon_plugins::ThresholdRange::parse(argv[++i]);
                 }
             } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--critical") == 0) {
                 if (i + 1 < argc) {
-                    criticalThreshold = std::stoi(argv[++i]);
+                    thresholds.critical = netmon_plugins::ThresholdRange::parse(argv[++i]);
                 }
             }
         }
@@ -125,8 +125,8 @@ public:
     std::string getUsage() const override {
         return "Usage: check_users [options]\n"
                "Options:\n"
-               "  -w, --warning COUNT    Warning if user count >= COUNT\n"
-               "  -c, --critical COUNT   Critical if user count >= COUNT\n"
+               "  -w, --warning RANGE    Warning if user count is outside RANGE\n"
+               "  -c, --critical RANGE   Critical if user count is outside RANGE\n"
                "  -h, --help            Show this help message";
     }
     
@@ -137,9 +137,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    UsersPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("users", UsersPlugin, System)
 
@@ -41,12 +41,19 @@ public:
                 path = "/v1/sys/health";
             }
             
-            int statusCode = 0;
-            std::string response = netmon_plugins::httpGet(
-                hostname, port, path, false, timeoutSeconds, statusCode
-            );
+            netmon_plugins::HttpRequest request;
+            request.host = hostname;
+            request.port = port;
+            request.path = path;
+            request.timeoutSeconds = timeoutSeconds;
+            if (!token.empty()) {
+                request.header("X-Vault-Token", token);
+            }
+            netmon_plugins::HttpResponse reply = netmon_plugins::httpRequest(request);
+            const int statusCode = reply.statusCode;
+            const std::string& response = reply.body;
             
-            if (statusCode == 0 || response.empty()) {
+            if (!reply.complete() || statusCode == 0 || response.empty()) {
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::CRITICAL,
                     "Vault CRITICAL - Cannot connect to API server"
@@ -140,8 +147,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -184,9 +190,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    VaultPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("vault", VaultPlugin, Application)
 
@@ -2,25 +2,13 @@
 // Apache Zookeeper monitoring plugin
 
 #include "netmon/plugin.hpp"
+#include "netmon/connection.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
 #include <stdexcept>
 #include <string>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#endif
-
 namespace {
 
 class ZookeeperPlugin : public netmon_plugins::Plugin {
@@ -30,112 +18,12 @@ private:
     int timeoutSeconds = 10;
     std::string checkType = "ruok"; // ruok, stat, mntr
 
-    bool connectToZookeeper(const std::string& host, int portNum, int timeout, int& sock) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            WSACleanup();
-            return false;
-        }
-        
-        sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            WSACleanup();
-            return false;
-        }
-        
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            WSACleanup();
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        return true;
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(portNum);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            return false;
-        }
-        
-        sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            return false;
-        }
-        
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-            freeaddrinfo(result);
-            close(sock);
-            return false;
-        }
-        
-        freeaddrinfo(result);
-        return true;
-#endif
-    }
-
-    std::string sendZookeeperCommand(int sock, const std::string& command) {
-        std::string cmd = command + "\n";
-        
-#ifdef _WIN32
-        if (send(sock, cmd.c_str(), static_cast<int>(cmd.length()), 0) < 0) {
-            return "";
-        }
-        
-        char buffer[4096];
+    // Four-letter commands are answered and then the server closes
+    std::string sendZookeeperCommand(netmon_plugins::net::Connection& conn, const std::string& command) {
         std::string response;
-        int bytes;
-        while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-            buffer[bytes] = '\0';
-            response += buffer;
-            // Zookeeper commands typically return single line responses
-            if (response.find('\n') != std::string::npos) {
-                break;
-            }
-        }
-#else
-        if (send(sock, cmd.c_str(), cmd.length(), 0) < 0) {
-            return "";
+        if (conn.write(command + "\n") == netmon_plugins::IoStatus::OK) {
+            conn.readAll(response, 1024 * 1024);
         }
-        
-        char buffer[4096];
-        std::string response;
-        ssize_t bytes;
-        while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-            buffer[bytes] = '\0';
-            response += buffer;
-            if (response.find('\n') != std::string::npos) {
-                break;
-            }
-        }
-#endif
-        
         return response;
     }
 
@@ -149,8 +37,8 @@ public:
         }
         
         try {
-            int sock = 0;
-            if (!connectToZookeeper(hostname, port, timeoutSeconds, sock)) {
+            netmon_plugins::net::Connection sock;
+            if (!sock.open(hostname, port, netmon_plugins::CheckContext::current().within(timeoutSeconds))) {
                 return netmon_plugins::PluginResult(
                     netmon_plugins::ExitCode::CRITICAL,
                     "Zookeeper CRITICAL - Cannot connect to " + hostname + ":" + std::to_string(port)
@@ -170,12 +58,7 @@ public:
             
             std::string response = sendZookeeperCommand(sock, command);
             
-#ifdef _WIN32
-            closesocket(sock);
-            WSACleanup();
-#else
-            close(sock);
-#endif
+            sock.close();
             
             if (response.empty()) {
                 return netmon_plugins::PluginResult(
@@ -230,8 +113,7 @@ public:
     void parseArguments(int argc, char* argv[]) override {
         for (int i = 1; i < argc; i++) {
             if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-                std::cout << getUsage() << std::endl;
-                std::exit(0);
+                throw netmon_plugins::HelpRequested();
             } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hostname") == 0) {
                 if (i + 1 < argc) {
                     hostname = argv[++i];
@@ -269,9 +151,5 @@ public:
 
 } // anonymous namespace
 
-int main(int argc, char* argv[]) {
-    ZookeeperPlugin plugin;
-    plugin.parseArguments(argc, argv);
-    return netmon_plugins::executePlugin(plugin);
-}
+NETMON_REGISTER_PLUGIN("zookeeper", ZookeeperPlugin, Application)
 
@@ -0,0 +1,928 @@
+// src/agent/netmon_agent.cpp
+// Long-lived daemon that runs checks in-process on behalf of a scheduler
+
+#include "netmon/agent_protocol.hpp"
+#include "netmon/config.hpp"
+#include "netmon/executor.hpp"
+#include "netmon/metrics_exporter.hpp"
+#include "netmon/plugin.hpp"
+#include "netmon/result_cache.hpp"
+#include "netmon/scheduler.hpp"
+#include "netmon/telemetry.hpp"
+#include "netmon/thread_pool.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using netmon_plugins::AgentRequest;
+using netmon_plugins::AgentResponse;
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+// Time a client has to send its request once connected
+const std::chrono::seconds REQUEST_TIME(1);
+
+// Time a client has to take its answer once it is ready
+const std::chrono::seconds REPLY_TIME(5);
+
+void handleStopSignal(int) {
+    stopRequested = 1;
+}
+
+struct AgentOptions {
+    std::string socketPath = "/run/netmon/agent.sock";
+    size_t workers = std::max(4u, std::thread::hardware_concurrency() * 4);
+    int defaultTimeout = 10;
+    bool timeoutSet = false;                   // -t given; overrides the config file
+    std::string configPath;                    // netmon-plugins.conf
+    netmon_plugins::CachePolicy cachePolicy;   // Default for requests that set none
+    std::string inventoryPath;                 // Checks to run on a schedule
+    std::chrono::seconds defaultInterval{60};
+    std::string metricsAddress;                // [HOST:]PORT serving /metrics
+    bool query = false;
+    std::vector<std::string> queryArgs;
+};
+
+std::string getUsage() {
+    return "Usage: netmon-agent [options]\n"
+           "       netmon-agent -q [options] [--] check_NAME [check args...]\n"
+           "Options:\n"
+           "  -s, --socket PATH     Unix socket path (default: /run/netmon/agent.sock)\n"
+           "  -w, --workers N       Worker threads running checks (default: 4 per CPU)\n"
+           "  -t, --timeout SEC     Check timeout when the request sets none (default:\n"
+           "                        [defaults] timeout of the config file, or 10)\n"
+           "  -c, --config FILE     Read settings from FILE (netmon-plugins.conf format);\n"
+           "                        FILE and the inventory are reloaded when they change\n"
+           "  --cache-ttl SEC       Serve repeated identical checks from memory for SEC\n"
+           "                        seconds (default: 0, no caching). Requests may set\n"
+           "                        their own --cache-ttl and --cache-stale.\n"
+           "  --cache-stale SEC     Keep serving an expired result for SEC more seconds\n"
+           "                        while one request refreshes it (default: 0)\n"
+           "  -i, --inventory FILE  Run the checks listed in FILE on a schedule, one\n"
+           "                        '[INTERVAL] [label:] plugin [args...]' per line\n"
+           "  --interval SEC        Interval for inventory lines that set none (default: 60)\n"
+           "  -m, --metrics [HOST:]PORT\n"
+           "                        Serve the latest scheduled results in Prometheus\n"
+           "                        format at http://HOST:PORT/metrics\n"
+           "  -q, --query           Send one check to a running agent and print its result\n"
+           "  --stats[=FORMAT]      Print a running agent's per-plugin run counts, timings\n"
+           "                        and traffic (nagios, json, prometheus, influx)\n"
+           "  -l, --list            List the plugins built into the agent\n"
+           "  -h, --help            Show this help message";
+}
+
+bool writeAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t sent = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        offset += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Read until EOF, the size limit, or the deadline, whichever comes first
+bool readAll(int fd, std::string& data, size_t limit, Clock::time_point deadline) {
+    char buffer[4096];
+    for (;;) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - Clock::now()).count();
+        if (remaining <= 0) {
+            return false;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, static_cast<int>(remaining));
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            return false;
+        }
+        ssize_t bytes = recv(fd, buffer, sizeof(buffer), 0);
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes < 0) {
+            return false;
+        }
+        if (bytes == 0) {
+            return true;
+        }
+        data.append(buffer, static_cast<size_t>(bytes));
+        if (data.size() > limit) {
+            return false;
+        }
+    }
+}
+
+// Largest HTTP request head accepted on the metrics port
+const size_t MAX_SCRAPE_HEAD = 8192;
+
+// The answer to one scrape, from the exporter's rendered page. Prometheus
+// opens a connection per scrape, so each is closed once answered.
+std::string metricsResponse(const std::string& head,
+                            const netmon_plugins::MetricsExporter& exporter) {
+    std::string status = "200 OK";
+    std::string type = netmon_plugins::PROMETHEUS_CONTENT_TYPE;
+    std::string body;
+    const bool get = head.compare(0, 4, "GET ") == 0;
+    const bool headOnly = head.compare(0, 5, "HEAD ") == 0;
+    const size_t target = head.find(' ') + 1;
+    const std::string path = head.substr(target, head.find_first_of(" ?\r", target) - target);
+    if (!get && !headOnly) {
+        status = "405 Method Not Allowed";
+    } else if (path != "/metrics") {
+        status = "404 Not Found";
+    } else {
+        body = exporter.render();
+        netmon_plugins::encodeTelemetry(netmon_plugins::OutputFormat::PROMETHEUS,
+                                        netmon_plugins::ExecutionTelemetry::global().snapshot(),
+                                        body);
+    }
+    if (status.compare(0, 3, "200") != 0) {
+        type = "text/plain";
+        body = status + "\n";
+    }
+    std::string response = "HTTP/1.1 " + status + "\r\n"
+                           "Content-Type: " + type + "\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n";
+    if (!headOnly) {
+        response += body;
+    }
+    return response;
+}
+
+int openMetricsListener(const std::string& address) {
+    std::string host;
+    std::string port = address;
+    const size_t colon = address.rfind(':');
+    if (colon != std::string::npos) {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+    }
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    struct addrinfo* result = nullptr;
+    int rc = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0) {
+        std::cerr << "netmon-agent: cannot resolve metrics address " << address << ": "
+                  << gai_strerror(rc) << std::endl;
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo* entry = result; entry && fd < 0; entry = entry->ai_next) {
+        fd = socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, entry->ai_addr, entry->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0 ||
+            !setNonBlocking(fd)) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+    if (fd < 0) {
+        std::cerr << "netmon-agent: cannot listen for metrics on " << address << ": "
+                  << std::strerror(errno) << std::endl;
+    }
+    return fd;
+}
+
+// Answers for client connections, posted by whichever thread finishes a
+// check (a pool worker or the deadline thread) and written out by the poll
+// loop, which a byte on the wake pipe rouses
+class Outbox {
+public:
+    Outbox() {
+        if (pipe(fds) != 0 || !setNonBlocking(fds[0]) || !setNonBlocking(fds[1])) {
+            fds[0] = fds[1] = -1;
+        }
+    }
+    ~Outbox() {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    Outbox(const Outbox&) = delete;
+    Outbox& operator=(const Outbox&) = delete;
+
+    bool ok() const { return fds[0] >= 0; }
+    int fd() const { return fds[0]; }
+
+    void post(uint64_t client, std::string data) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            answers.emplace_back(client, std::move(data));
+        }
+        // A full pipe already wakes the loop
+        const char byte = 0;
+        ssize_t ignored = write(fds[1], &byte, 1);
+        (void)ignored;
+    }
+
+    std::vector<std::pair<uint64_t, std::string>> take() {
+        char buffer[256];
+        while (read(fds[0], buffer, sizeof(buffer)) > 0) {
+        }
+        std::vector<std::pair<uint64_t, std::string>> taken;
+        std::lock_guard<std::mutex> lock(mutex);
+        taken.swap(answers);
+        return taken;
+    }
+
+private:
+    int fds[2] = {-1, -1};
+    std::mutex mutex;
+    std::vector<std::pair<uint64_t, std::string>> answers;
+};
+
+// A client waiting for its check result. checkAsync() guarantees exactly
+// one answer, from the worker or at the deadline; it goes through the
+// outbox, so answering never blocks the thread that gives it.
+class PendingCheck {
+public:
+    PendingCheck(std::shared_ptr<Outbox> clientOutbox, uint64_t clientId)
+        : outbox(std::move(clientOutbox)), client(clientId) {}
+
+    void answer(const netmon_plugins::CheckOutcome& outcome) {
+        AgentResponse response;
+        response.exitCode = outcome.exitCode;
+        response.output = outcome.output;
+        outbox->post(client, netmon_plugins::encodeAgentResponse(response));
+    }
+
+private:
+    std::shared_ptr<Outbox> outbox;
+    uint64_t client;
+};
+
+// A client socket, served by the poll loop without ever waiting on it:
+// the request is buffered until the client shuts down its write side (or,
+// for a scrape, until the end of the HTTP head), and the answer is written
+// as fast as the client takes it
+struct ClientConnection {
+    enum class State { READING, WAITING, WRITING };
+
+    int fd = -1;
+    bool scrape = false;          // On the metrics port
+    State state = State::READING;
+    Clock::time_point deadline;   // Of READING and WRITING
+    std::string data;             // The request as it arrives, then the answer
+    size_t written = 0;
+    int slot = -1;                // Index in the poll set of the current pass
+};
+
+enum class ReadProgress { MORE, COMPLETE, FAILED };
+
+ReadProgress readRequest(ClientConnection& client, size_t limit) {
+    char buffer[4096];
+    for (;;) {
+        ssize_t bytes = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK ? ReadProgress::MORE
+                                                           : ReadProgress::FAILED;
+        }
+        if (bytes == 0) {
+            return client.scrape ? ReadProgress::FAILED : ReadProgress::COMPLETE;
+        }
+        client.data.append(buffer, static_cast<size_t>(bytes));
+        if (client.data.size() > limit) {
+            return ReadProgress::FAILED;
+        }
+        if (client.scrape && client.data.find("\r\n\r\n") != std::string::npos) {
+            return ReadProgress::COMPLETE;
+        }
+    }
+}
+
+// Send what the socket takes; true once the client is done with, whether
+// all was sent or the client went away
+bool writeReply(ClientConnection& client) {
+    while (client.written < client.data.size()) {
+        ssize_t sent = send(client.fd, client.data.data() + client.written,
+                            client.data.size() - client.written, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0) {
+            return errno != EAGAIN && errno != EWOULDBLOCK;
+        }
+        client.written += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+void startReply(ClientConnection& client, std::string data) {
+    client.state = ClientConnection::State::WRITING;
+    client.data = std::move(data);
+    client.written = 0;
+    client.deadline = Clock::now() + REPLY_TIME;
+}
+
+bool fillSocketAddress(const std::string& path, struct sockaddr_un& addr) {
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+int runQuery(const AgentOptions& options) {
+    const int unknown = static_cast<int>(netmon_plugins::ExitCode::UNKNOWN);
+    if (options.queryArgs.empty()) {
+        std::cerr << getUsage() << std::endl;
+        return unknown;
+    }
+
+    struct sockaddr_un addr;
+    if (!fillSocketAddress(options.socketPath, addr)) {
+        std::cout << "UNKNOWN: Socket path too long: " << options.socketPath << std::endl;
+        return unknown;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cout << "UNKNOWN: Cannot reach netmon-agent at " << options.socketPath
+                  << " - " << std::strerror(errno) << std::endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return unknown;
+    }
+
+    AgentRequest request;
+    request.timeoutSeconds = options.defaultTimeout;
+    request.args = options.queryArgs;
+
+    // Allow the agent a moment past the check timeout to report it
+    auto deadline = Clock::now() + std::chrono::seconds(options.defaultTimeout + 5);
+    std::string reply;
+    bool ok = writeAll(fd, netmon_plugins::encodeAgentRequest(request)) &&
+              shutdown(fd, SHUT_WR) == 0 &&
+              readAll(fd, reply, 16 * 1024 * 1024, deadline);
+    close(fd);
+
+    AgentResponse response;
+    if (!ok || !netmon_plugins::decodeAgentResponse(reply, response)) {
+        std::cout << "UNKNOWN: No valid response from netmon-agent" << std::endl;
+        return unknown;
+    }
+    std::fwrite(response.output.data(), 1, response.output.size(), stdout);
+    return response.exitCode;
+}
+
+void logResult(netmon_plugins::ResultLog& log, const std::string& check,
+               const netmon_plugins::CheckOutcome& outcome, Clock::time_point started) {
+    log.write(netmon_plugins::makeResultRecord(
+        check, outcome,
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started)));
+}
+
+// Run one complete request; its answer reaches the client through pending
+void serveRequest(const std::string& data, std::shared_ptr<PendingCheck> pending,
+                  const AgentOptions& options, netmon_plugins::ThreadPool& pool,
+                  netmon_plugins::CheckCoalescer& coalescer,
+                  const std::shared_ptr<netmon_plugins::ResultCache>& cache,
+                  const std::shared_ptr<netmon_plugins::ResultLog>& log) {
+    AgentRequest request;
+    if (!netmon_plugins::decodeAgentRequest(data, request)) {
+        pending->answer(netmon_plugins::CheckOutcome(
+            static_cast<int>(netmon_plugins::ExitCode::UNKNOWN),
+            "UNKNOWN: Malformed agent request\n"));
+        return;
+    }
+
+    if (request.args[0] == netmon_plugins::AGENT_STATS_COMMAND) {
+        netmon_plugins::OutputFormat format = netmon_plugins::OutputFormat::NAGIOS;
+        if (request.args.size() > 1 &&
+            !netmon_plugins::parseOutputFormat(request.args[1], format)) {
+            pending->answer(netmon_plugins::CheckOutcome(
+                static_cast<int>(netmon_plugins::ExitCode::UNKNOWN),
+                "UNKNOWN: Unknown output format " + request.args[1] + "\n"));
+            return;
+        }
+        const auto snapshot = netmon_plugins::ExecutionTelemetry::global().snapshot();
+        std::string stats;
+        netmon_plugins::encodeTelemetry(format, snapshot, stats);
+        if (snapshot.empty() && format != netmon_plugins::OutputFormat::PROMETHEUS) {
+            stats = "OK: No checks have run yet\n";
+        }
+        pending->answer(netmon_plugins::CheckOutcome(
+            static_cast<int>(netmon_plugins::ExitCode::OK), stats));
+        return;
+    }
+
+    // The cache options travel with the check; the directory is for
+    // one-shot executables and means nothing here
+    netmon_plugins::CachePolicy policy = options.cachePolicy;
+    std::string cacheDir;
+    try {
+        netmon_plugins::extractCacheOptions(request.args, policy, cacheDir);
+    } catch (const std::exception& e) {
+        pending->answer(netmon_plugins::CheckOutcome(
+            static_cast<int>(netmon_plugins::ExitCode::UNKNOWN),
+            "UNKNOWN: Invalid arguments - " + std::string(e.what()) + "\n"));
+        return;
+    }
+
+    // Help, unknown plugins and bad arguments are answered right away
+    netmon_plugins::CheckOutcome failure;
+    auto check = netmon_plugins::prepareCheck(request.args, failure);
+    if (!check) {
+        pending->answer(failure);
+        return;
+    }
+
+    int timeout = request.timeoutSeconds > 0 ? request.timeoutSeconds : options.defaultTimeout;
+    netmon_plugins::CheckContext context(netmon_plugins::Deadline::afterSeconds(timeout),
+                                         netmon_plugins::CancellationToken());
+    // Identical checks already running are joined rather than repeated
+    const std::string key = netmon_plugins::resultCacheKey(request.args);
+    const std::string name = netmon_plugins::pluginNameFromCommand(request.args[0]);
+    const Clock::time_point started = Clock::now();
+    if (!policy.enabled()) {
+        coalescer.checkAsync(pool, key, check, context,
+                             [pending, log, name, started](netmon_plugins::CheckOutcome outcome) {
+                                 pending->answer(outcome);
+                                 logResult(*log, name, outcome, started);
+                             });
+        return;
+    }
+
+    netmon_plugins::CacheLookup cached = cache->lookup(key, policy);
+    if (cached.state != netmon_plugins::CacheState::MISS) {
+        pending->answer(cached.outcome);
+        if (!cached.refresh) {
+            return;
+        }
+        // Stale: the client has its answer, refresh in the background
+        pending.reset();
+    }
+    coalescer.checkAsync(pool, key, check, context,
+                         [pending, cache, log, key, name, started](
+                             netmon_plugins::CheckOutcome outcome) {
+                             cache->store(key, outcome);
+                             if (pending) {
+                                 pending->answer(outcome);
+                             }
+                             logResult(*log, name, outcome, started);
+                         });
+}
+
+// Settings and inventory in force; replaced as a whole on reload
+struct LoadedConfig {
+    std::shared_ptr<const netmon_plugins::Configuration> config;
+    int defaultTimeout = 10;
+};
+
+LoadedConfig loadConfig(const AgentOptions& options) {
+    LoadedConfig loaded;
+    loaded.config = netmon_plugins::loadConfiguration(options.configPath, options.inventoryPath);
+    for (const auto& error : loaded.config->errors) {
+        std::cerr << "netmon-agent: " << error << std::endl;
+    }
+    for (const auto& warning : loaded.config->warnings) {
+        std::cerr << "netmon-agent: warning: " << warning << std::endl;
+    }
+    loaded.defaultTimeout = options.timeoutSet ? options.defaultTimeout
+                                               : loaded.config->settings.timeoutSeconds;
+    return loaded;
+}
+
+int runServer(const AgentOptions& options) {
+    LoadedConfig loaded = loadConfig(options);
+    if (!loaded.config->ok()) {
+        return 1;
+    }
+
+    struct sockaddr_un addr;
+    if (!fillSocketAddress(options.socketPath, addr)) {
+        std::cerr << "netmon-agent: socket path too long: " << options.socketPath << std::endl;
+        return 1;
+    }
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "netmon-agent: socket: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    unlink(options.socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd, SOMAXCONN) != 0) {
+        std::cerr << "netmon-agent: cannot listen on " << options.socketPath << ": "
+                  << std::strerror(errno) << std::endl;
+        close(listenFd);
+        return 1;
+    }
+    chmod(options.socketPath.c_str(), 0660);
+
+    auto outbox = std::make_shared<Outbox>();
+    if (!outbox->ok() || !setNonBlocking(listenFd)) {
+        std::cerr << "netmon-agent: cannot set up the client loop: " << std::strerror(errno)
+                  << std::endl;
+        close(listenFd);
+        unlink(options.socketPath.c_str());
+        return 1;
+    }
+
+    int metricsFd = -1;
+    if (!options.metricsAddress.empty()) {
+        metricsFd = openMetricsListener(options.metricsAddress);
+        if (metricsFd < 0) {
+            close(listenFd);
+            unlink(options.socketPath.c_str());
+            return 1;
+        }
+        std::cerr << "netmon-agent: serving metrics on " << options.metricsAddress
+                  << "/metrics" << std::endl;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    std::cerr << "netmon-agent: serving "
+              << netmon_plugins::PluginRegistry::instance().size() << " plugins on "
+              << options.socketPath << " with " << options.workers << " workers" << std::endl;
+
+    {
+        auto cache = std::make_shared<netmon_plugins::ResultCache>();
+        auto exporter = std::make_shared<netmon_plugins::MetricsExporter>();
+        netmon_plugins::CheckCoalescer coalescer;   // Outlives the pool's tasks
+        netmon_plugins::ThreadPool pool(options.workers);
+
+        auto log = std::make_shared<netmon_plugins::ResultLog>();
+
+        // Scheduled results land in the cache, where queries can find them,
+        // in the exporter, labelled with their inventory id, and in the log.
+        // The dispatcher holds on to its configuration, so checks still
+        // running after a reload finish against the one they started with.
+        auto startScheduler = [&](const LoadedConfig& current) {
+            const auto config = current.config;
+            const int defaultTimeout = current.defaultTimeout;
+            std::vector<netmon_plugins::ScheduledCheck> checks;
+            for (const auto& compiled : config->checks) {
+                checks.push_back(compiled.check);
+            }
+            netmon_plugins::SchedulerOptions schedulerOptions;
+            schedulerOptions.defaultInterval = options.defaultInterval;
+            std::unique_ptr<netmon_plugins::Scheduler> scheduler(new netmon_plugins::Scheduler(
+                checks,
+                [&coalescer, &pool, cache, exporter, log, config, defaultTimeout](
+                    size_t index, const netmon_plugins::ScheduledCheck& check) {
+                    int timeout = check.timeoutSeconds > 0 ? check.timeoutSeconds
+                                                           : defaultTimeout;
+                    netmon_plugins::CheckContext context(
+                        netmon_plugins::Deadline::afterSeconds(timeout),
+                        netmon_plugins::CancellationToken());
+                    const std::string& key = config->checks[index].key;
+                    const std::string id = check.id;
+                    const Clock::time_point started = Clock::now();
+                    coalescer.checkAsync(
+                        pool, key, config->checks[index].prepared, context,
+                        [cache, exporter, log, key, id, started](
+                            netmon_plugins::CheckOutcome outcome) {
+                            cache->store(key, outcome);
+                            auto record = netmon_plugins::makeResultRecord(
+                                id, outcome,
+                                std::chrono::duration_cast<std::chrono::microseconds>(
+                                    Clock::now() - started));
+                            log->write(record);
+                            exporter->update(record);
+                        });
+                },
+                schedulerOptions));
+            if (config->settings.logEnabled && !log->open(config->settings.logFile)) {
+                std::cerr << "netmon-agent: cannot open log file "
+                          << config->settings.logFile << std::endl;
+            } else if (!config->settings.logEnabled) {
+                log->close();
+            }
+            if (!checks.empty()) {
+                std::cerr << "netmon-agent: scheduling " << checks.size() << " checks from "
+                          << options.inventoryPath << std::endl;
+                scheduler->start();
+            }
+            return scheduler;
+        };
+        std::unique_ptr<netmon_plugins::Scheduler> scheduler = startScheduler(loaded);
+        AgentOptions effective = options;
+        effective.defaultTimeout = loaded.defaultTimeout;
+
+        std::vector<std::string> watched;
+        for (const std::string& path : {options.configPath, options.inventoryPath}) {
+            if (!path.empty()) {
+                watched.push_back(path);
+            }
+        }
+        netmon_plugins::FileWatcher watcher(watched);
+
+        // Clients by id; answers posted to the outbox name the id, so one
+        // for a client that has gone away is dropped
+        std::map<uint64_t, ClientConnection> clients;
+        uint64_t nextClient = 0;
+
+        while (!stopRequested) {
+            std::vector<struct pollfd> pfds = {{listenFd, POLLIN, 0}, {metricsFd, POLLIN, 0},
+                                               {watcher.fd(), POLLIN, 0},
+                                               {outbox->fd(), POLLIN, 0}};
+            int timeout = 500;
+            Clock::time_point now = Clock::now();
+            for (auto& entry : clients) {
+                ClientConnection& client = entry.second;
+                client.slot = static_cast<int>(pfds.size());
+                // A client waiting for its answer is only watched for hanging up
+                short events = client.state == ClientConnection::State::READING ? POLLIN
+                               : client.state == ClientConnection::State::WRITING ? POLLOUT
+                                                                                  : 0;
+                pfds.push_back({client.fd, events, 0});
+                if (client.state != ClientConnection::State::WAITING) {
+                    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        client.deadline - now).count() + 1;
+                    timeout = static_cast<int>(std::max<long long>(
+                        0, std::min<long long>(timeout, left)));
+                }
+            }
+            int ready = poll(pfds.data(), pfds.size(), timeout);
+            // Without inotify the watcher compares mtimes on every pass
+            if (!watched.empty() && (watcher.fd() < 0 || (pfds[2].revents & POLLIN)) &&
+                watcher.changed()) {
+                LoadedConfig reloaded = loadConfig(options);
+                if (!reloaded.config->ok()) {
+                    std::cerr << "netmon-agent: keeping the previous configuration"
+                              << std::endl;
+                } else {
+                    scheduler->stop();
+                    for (const auto& old : loaded.config->checks) {
+                        bool kept = false;
+                        for (const auto& current : reloaded.config->checks) {
+                            kept = kept || current.check.id == old.check.id;
+                        }
+                        if (!kept) {
+                            exporter->remove(old.check.id);
+                        }
+                    }
+                    loaded = reloaded;
+                    effective.defaultTimeout = loaded.defaultTimeout;
+                    std::cerr << "netmon-agent: reloaded configuration" << std::endl;
+                    scheduler = startScheduler(loaded);
+                }
+            }
+            if (ready < 0) {
+                continue;
+            }
+
+            now = Clock::now();
+            for (auto it = clients.begin(); it != clients.end();) {
+                const uint64_t id = it->first;
+                ClientConnection& client = it->second;
+                const short revents = pfds[static_cast<size_t>(client.slot)].revents;
+                bool drop = false;
+                if (client.state == ClientConnection::State::READING &&
+                    (revents & (POLLIN | POLLHUP | POLLERR))) {
+                    ReadProgress progress = readRequest(
+                        client, client.scrape ? MAX_SCRAPE_HEAD
+                                              : netmon_plugins::AGENT_MAX_REQUEST_SIZE);
+                    if (progress == ReadProgress::COMPLETE && client.scrape) {
+                        startReply(client, metricsResponse(client.data, *exporter));
+                        drop = writeReply(client);
+                    } else if (progress == ReadProgress::COMPLETE) {
+                        client.state = ClientConnection::State::WAITING;
+                        std::string request;
+                        request.swap(client.data);
+                        serveRequest(request, std::make_shared<PendingCheck>(outbox, id),
+                                     effective, pool, coalescer, cache, log);
+                    } else if (progress == ReadProgress::FAILED) {
+                        // A bad scrape is dropped; an agent client is told
+                        drop = client.scrape;
+                        client.deadline = now;
+                    }
+                } else if (client.state == ClientConnection::State::WRITING &&
+                           (revents & (POLLOUT | POLLHUP | POLLERR))) {
+                    drop = writeReply(client);
+                } else if (client.state == ClientConnection::State::WAITING &&
+                           (revents & (POLLHUP | POLLERR))) {
+                    drop = true;
+                }
+                if (!drop && client.state == ClientConnection::State::READING &&
+                    client.deadline <= now && client.scrape) {
+                    drop = true;
+                } else if (!drop && client.state == ClientConnection::State::READING &&
+                           client.deadline <= now) {
+                    AgentResponse malformed;
+                    malformed.output = "UNKNOWN: Malformed agent request\n";
+                    startReply(client, netmon_plugins::encodeAgentResponse(malformed));
+                    drop = writeReply(client);
+                } else if (!drop && client.state == ClientConnection::State::WRITING &&
+                           client.deadline <= now) {
+                    drop = true;
+                }
+                if (drop) {
+                    close(client.fd);
+                    it = clients.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            for (auto& answer : outbox->take()) {
+                auto it = clients.find(answer.first);
+                if (it == clients.end() ||
+                    it->second.state != ClientConnection::State::WAITING) {
+                    continue;
+                }
+                startReply(it->second, std::move(answer.second));
+                if (writeReply(it->second)) {
+                    close(it->second.fd);
+                    clients.erase(it);
+                }
+            }
+
+            for (int index : {0, 1}) {
+                if (!(pfds[static_cast<size_t>(index)].revents & POLLIN)) {
+                    continue;
+                }
+                for (;;) {
+                    int clientFd = accept(pfds[static_cast<size_t>(index)].fd, nullptr, nullptr);
+                    if (clientFd < 0) {
+                        break;
+                    }
+                    if (!setNonBlocking(clientFd)) {
+                        close(clientFd);
+                        continue;
+                    }
+                    ClientConnection& client = clients[nextClient++];
+                    client.fd = clientFd;
+                    client.scrape = index == 1;
+                    client.deadline = Clock::now() + REQUEST_TIME;
+                }
+            }
+        }
+
+        for (auto& entry : clients) {
+            close(entry.second.fd);
+        }
+        scheduler->stop();
+        pool.shutdown();
+        std::cerr << "netmon-agent: ran " << coalescer.started() << " checks, "
+                  << coalescer.coalesced() << " coalesced into one already running"
+                  << std::endl;
+    }
+
+    if (metricsFd >= 0) {
+        close(metricsFd);
+    }
+    close(listenFd);
+    unlink(options.socketPath.c_str());
+    return 0;
+}
+
+bool parseArguments(int argc, char* argv[], AgentOptions& options) {
+    int i = 1;
+    for (; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            std::cout << getUsage() << std::endl;
+            std::exit(0);
+        } else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--socket") == 0) {
+            if (i + 1 < argc) {
+                options.socketPath = argv[++i];
+            }
+        } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--workers") == 0) {
+            if (i + 1 < argc) {
+                options.workers = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+            }
+        } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--timeout") == 0) {
+            if (i + 1 < argc) {
+                options.defaultTimeout = std::max(1, std::stoi(argv[++i]));
+                options.timeoutSet = true;
+            }
+        } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--config") == 0) {
+            if (i + 1 < argc) {
+                options.configPath = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--cache-ttl") == 0) {
+            if (i + 1 < argc) {
+                options.cachePolicy.ttl = std::chrono::seconds(std::max(0, std::stoi(argv[++i])));
+            }
+        } else if (strcmp(argv[i], "--cache-stale") == 0) {
+            if (i + 1 < argc) {
+                options.cachePolicy.staleFor =
+                    std::chrono::seconds(std::max(0, std::stoi(argv[++i])));
+            }
+        } else if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--inventory") == 0) {
+            if (i + 1 < argc) {
+                options.inventoryPath = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--interval") == 0) {
+            if (i + 1 < argc && !netmon_plugins::parseInterval(argv[++i], options.defaultInterval)) {
+                std::cerr << "netmon-agent: invalid interval " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--metrics") == 0) {
+            if (i + 1 < argc) {
+                options.metricsAddress = argv[++i];
+            }
+        } else if (strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--list") == 0) {
+            std::cout << netmon_plugins::formatPluginList() << std::flush;
+            std::exit(0);
+        } else if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--query") == 0) {
+            options.query = true;
+        } else if (strncmp(argv[i], "--stats", 7) == 0 &&
+                   (argv[i][7] == '\0' || argv[i][7] == '=')) {
+            options.query = true;
+            options.queryArgs = {netmon_plugins::AGENT_STATS_COMMAND};
+            if (argv[i][7] == '=') {
+                options.queryArgs.push_back(argv[i] + 8);
+            }
+        } else if (strcmp(argv[i], "--") == 0) {
+            i++;
+            break;
+        } else if (argv[i][0] != '-' && options.query) {
+            break;
+        } else {
+            std::cerr << "netmon-agent: unknown option " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    for (; i < argc; i++) {
+        options.queryArgs.push_back(argv[i]);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    AgentOptions options;
+    try {
+        if (!parseArguments(argc, argv, options)) {
+            std::cerr << getUsage() << std::endl;
+            return 3;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "netmon-agent: invalid argument - " << e.what() << std::endl;
+        return 3;
+    }
+
+    return options.query ? runQuery(options) : runServer(options);
+}
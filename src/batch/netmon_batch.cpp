@@ -0,0 +1,276 @@
+// src/batch/netmon_batch.cpp
+// Run a file of checks concurrently in one process and stream the results
+
+#include "netmon/config.hpp"
+#include "netmon/executor.hpp"
+#include "netmon/plugin.hpp"
+#include "netmon/telemetry.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BatchCliOptions {
+    std::string file = "-";
+    bool tabular = true;    // The default tab-separated lines
+    netmon_plugins::OutputFormat format = netmon_plugins::OutputFormat::JSON;
+    netmon_plugins::BatchOptions batch;
+    bool timeoutSet = false;   // -t given; overrides the config file
+    std::string configPath;
+    bool stats = false;        // --stats: per-plugin telemetry to stderr
+};
+
+std::string getUsage() {
+    return "Usage: netmon-batch [options] [FILE]\n"
+           "Runs every check listed in FILE (or stdin) concurrently and prints one\n"
+           "tab-separated line per check as it completes:\n"
+           "  id  exit_code  latency_ms  status_line  perfdata\n"
+           "\n"
+           "Each input line is '[label:] plugin [args...]'; blank lines and lines\n"
+           "starting with # are ignored. Unlabeled checks are identified by line number.\n"
+           "\n"
+           "Options:\n"
+           "  -j, --jobs N          Checks to run at the same time (default: 16)\n"
+           "  -t, --timeout SEC     Per-check timeout in seconds (default: [defaults]\n"
+           "                        timeout of the config file, or 10)\n"
+           "  -c, --config FILE     Read settings from FILE (netmon-plugins.conf format)\n"
+           "  -o, --output FORMAT   tsv (default), nagios, json, prometheus, influx\n"
+           "                        or binary; prometheus is written once all checks\n"
+           "                        have finished\n"
+           "  --no-coalesce         Run identical checks separately instead of once\n"
+           "  --stats               Write per-plugin run counts, timings and traffic\n"
+           "                        to stderr when done, in the output format\n"
+           "  -h, --help            Show this help message\n"
+           "\n"
+           "Exit status is the highest exit code of all checks.";
+}
+
+bool readChecks(std::istream& input, std::vector<netmon_plugins::BatchCheck>& checks) {
+    std::string line;
+    size_t lineNumber = 0;
+    bool ok = true;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        netmon_plugins::BatchCheck check;
+        try {
+            if (!netmon_plugins::parseBatchLine(line, check)) {
+                continue;
+            }
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "netmon-batch: line " << lineNumber << ": " << e.what() << std::endl;
+            ok = false;
+            continue;
+        }
+        if (check.id.empty()) {
+            check.id = std::to_string(lineNumber);
+        }
+        checks.push_back(std::move(check));
+    }
+    return ok;
+}
+
+// Single-line, tab-free rendering of the status part of a check's output
+std::string statusLine(const netmon_plugins::CheckOutcome& outcome, const std::string& perfdata) {
+    std::string text = outcome.output;
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) {
+        text.pop_back();
+    }
+    if (!perfdata.empty()) {
+        const std::string suffix = " | " + perfdata;
+        if (text.size() >= suffix.size() &&
+            text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            text.resize(text.size() - suffix.size());
+        }
+    }
+    std::replace(text.begin(), text.end(), '\n', ' ');
+    std::replace(text.begin(), text.end(), '\t', ' ');
+    return text;
+}
+
+void printTabular(const netmon_plugins::BatchResult& result) {
+    double latencyMs = static_cast<double>(result.latency.count()) / 1000.0;
+    const std::string perfdata = netmon_plugins::formatPerfdata(result.outcome.perfdata);
+    std::printf("%s\t%d\t%.3f\t%s\t%s\n",
+                result.id.c_str(),
+                result.outcome.exitCode,
+                latencyMs,
+                statusLine(result.outcome, perfdata).c_str(),
+                perfdata.c_str());
+    std::fflush(stdout);
+}
+
+void printEncoded(netmon_plugins::OutputFormat format, const netmon_plugins::BatchResult& result) {
+    std::string encoded;
+    netmon_plugins::encodeResult(
+        format, netmon_plugins::makeResultRecord(result.id, result.outcome, result.latency), encoded);
+    std::fwrite(encoded.data(), 1, encoded.size(), stdout);
+    std::fflush(stdout);
+}
+
+bool parseArguments(int argc, char* argv[], BatchCliOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            std::cout << getUsage() << std::endl;
+            std::exit(0);
+        } else if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) {
+            if (i + 1 < argc) {
+                options.batch.concurrency = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+            }
+        } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--timeout") == 0) {
+            if (i + 1 < argc) {
+                options.batch.defaultTimeoutSeconds = std::max(1, std::stoi(argv[++i]));
+                options.timeoutSet = true;
+            }
+        } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--config") == 0) {
+            if (i + 1 < argc) {
+                options.configPath = argv[++i];
+            }
+        } else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) {
+            if (i + 1 < argc) {
+                const std::string name = argv[++i];
+                options.tabular = name == "tsv";
+                if (!options.tabular && !netmon_plugins::parseOutputFormat(name, options.format)) {
+                    std::cerr << "netmon-batch: unknown output format " << name << std::endl;
+                    return false;
+                }
+            }
+        } else if (strcmp(argv[i], "--no-coalesce") == 0) {
+            options.batch.coalesce = false;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            options.stats = true;
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            options.file = argv[i];
+        } else {
+            std::cerr << "netmon-batch: unknown option " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    const int unknown = static_cast<int>(netmon_plugins::ExitCode::UNKNOWN);
+    BatchCliOptions options;
+    try {
+        if (!parseArguments(argc, argv, options)) {
+            std::cerr << getUsage() << std::endl;
+            return unknown;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "netmon-batch: invalid argument - " << e.what() << std::endl;
+        return unknown;
+    }
+
+    const auto config = netmon_plugins::loadConfiguration(options.configPath, "");
+    for (const auto& error : config->errors) {
+        std::cerr << "netmon-batch: " << error << std::endl;
+    }
+    for (const auto& warning : config->warnings) {
+        std::cerr << "netmon-batch: warning: " << warning << std::endl;
+    }
+    if (!config->ok()) {
+        return unknown;
+    }
+    const netmon_plugins::Settings& settings = config->settings;
+    if (!options.timeoutSet) {
+        options.batch.defaultTimeoutSeconds = settings.timeoutSeconds;
+    }
+    netmon_plugins::ResultLog log;
+    if (settings.logEnabled && !log.open(settings.logFile)) {
+        std::cerr << "netmon-batch: cannot open log file " << settings.logFile << std::endl;
+    }
+
+    std::vector<netmon_plugins::BatchCheck> checks;
+    bool parsed;
+    if (options.file == "-") {
+        parsed = readChecks(std::cin, checks);
+    } else {
+        std::ifstream input(options.file);
+        if (!input) {
+            std::cerr << "netmon-batch: cannot open " << options.file << std::endl;
+            return unknown;
+        }
+        parsed = readChecks(input, checks);
+    }
+    if (!parsed) {
+        return unknown;
+    }
+
+    // Parse every check once, up front. One its plugin rejects is left as
+    // is and reported with the plugin's complaint when its turn comes.
+    for (netmon_plugins::BatchCheck& check : checks) {
+        netmon_plugins::ScheduledCheck spec;
+        spec.id = check.id;
+        spec.args = check.args;
+        spec.timeoutSeconds = check.timeoutSeconds;
+        netmon_plugins::CompiledCheck compiled;
+        std::string error;
+        if (netmon_plugins::compileCheck(std::move(spec), settings, compiled, error)) {
+            check.timeoutSeconds = compiled.check.timeoutSeconds;
+            check.prepared = std::move(compiled.prepared);
+            check.key = std::move(compiled.key);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    // Prometheus groups samples by metric family, so it waits for the lot
+    std::vector<netmon_plugins::ResultRecord> collected;
+    auto print = [&](const netmon_plugins::BatchResult& result) {
+        log.write(netmon_plugins::makeResultRecord(result.id, result.outcome, result.latency));
+        if (options.tabular) {
+            printTabular(result);
+        } else if (options.format == netmon_plugins::OutputFormat::PROMETHEUS) {
+            collected.push_back(
+                netmon_plugins::makeResultRecord(result.id, result.outcome, result.latency));
+        } else {
+            printEncoded(options.format, result);
+        }
+    };
+    netmon_plugins::BatchSummary summary =
+        netmon_plugins::executeBatch(checks, options.batch, print);
+    if (!collected.empty()) {
+        std::string encoded;
+        netmon_plugins::encodeResults(netmon_plugins::OutputFormat::PROMETHEUS, collected, encoded);
+        std::fwrite(encoded.data(), 1, encoded.size(), stdout);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    std::cerr << "netmon-batch: " << summary.completed << " checks in "
+              << elapsed.count() << " ms";
+    if (summary.timedOut > 0) {
+        std::cerr << ", " << summary.timedOut << " timed out";
+    }
+    if (summary.coalesced > 0) {
+        std::cerr << ", " << summary.coalesced << " coalesced";
+    }
+    std::cerr << std::endl;
+
+    if (options.stats) {
+        std::string stats;
+        netmon_plugins::encodeTelemetry(
+            options.tabular ? netmon_plugins::OutputFormat::NAGIOS : options.format,
+            netmon_plugins::ExecutionTelemetry::global().snapshot(), stats);
+        std::fwrite(stats.data(), 1, stats.size(), stderr);
+    }
+
+    // Timed-out checks may still be running on detached workers; do not
+    // run static destructors underneath them.
+    if (summary.timedOut > 0) {
+        std::fflush(stdout);
+        std::fflush(stderr);
+        std::_Exit(summary.worstExitCode);
+    }
+    return summary.worstExitCode;
+}
@@ -0,0 +1,71 @@
+// src/common/agent_protocol.cpp
+// netmon-agent wire format implementation
+
+#include "netmon/agent_protocol.hpp"
+#include <cstdlib>
+
+namespace netmon_plugins {
+
+namespace {
+
+bool parseInt(const std::string& text, int& value) {
+    if (text.empty() || text.size() > 9) {
+        return false;
+    }
+    char* end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0') {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+} // namespace
+
+std::string encodeAgentRequest(const AgentRequest& request) {
+    std::string data = std::to_string(request.timeoutSeconds);
+    data.push_back('\0');
+    for (const auto& arg : request.args) {
+        data += arg;
+        data.push_back('\0');
+    }
+    return data;
+}
+
+bool decodeAgentRequest(const std::string& data, AgentRequest& request) {
+    if (data.empty() || data.back() != '\0' || data.size() > AGENT_MAX_REQUEST_SIZE) {
+        return false;
+    }
+
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (start < data.size()) {
+        size_t end = data.find('\0', start);
+        fields.emplace_back(data, start, end - start);
+        start = end + 1;
+    }
+
+    if (fields.size() < 2 || !parseInt(fields[0], request.timeoutSeconds) ||
+        request.timeoutSeconds < 0 || fields[1].empty()) {
+        return false;
+    }
+    request.args.assign(fields.begin() + 1, fields.end());
+    return true;
+}
+
+std::string encodeAgentResponse(const AgentResponse& response) {
+    return std::to_string(response.exitCode) + "\n" + response.output;
+}
+
+bool decodeAgentResponse(const std::string& data, AgentResponse& response) {
+    size_t newline = data.find('\n');
+    if (newline == std::string::npos ||
+        !parseInt(data.substr(0, newline), response.exitCode)) {
+        return false;
+    }
+    response.output = data.substr(newline + 1);
+    return true;
+}
+
+} // namespace netmon_plugins
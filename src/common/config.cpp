@@ -0,0 +1,322 @@
+// src/common/config.cpp
+// Configuration loading, inventory compilation and file watching
+
+#include "netmon/config.hpp"
+#include "netmon/plugin.hpp"
+#include "netmon/result_cache.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <sys/stat.h>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace netmon_plugins {
+
+namespace {
+
+std::string trim(const std::string& text) {
+    const size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+bool parseSeconds(const std::string& text, int& seconds) {
+    char* end = nullptr;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || value <= 0 || value > 86400) {
+        return false;
+    }
+    seconds = static_cast<int>(value);
+    return true;
+}
+
+bool parseFlag(const std::string& text, bool& flag) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "1" || lower == "true" || lower == "yes" || lower == "on") {
+        flag = true;
+    } else if (lower == "0" || lower == "false" || lower == "no" || lower == "off") {
+        flag = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Directory and file name of a path
+std::pair<std::string, std::string> splitPath(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    if (slash == std::string::npos) {
+        return {".", path};
+    }
+    return {slash == 0 ? "/" : path.substr(0, slash), path.substr(slash + 1)};
+}
+
+std::time_t modificationTime(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+}
+
+} // namespace
+
+IniSections parseIni(std::istream& input, std::vector<std::string>& errors) {
+    IniSections sections;
+    std::string section;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') {
+            continue;
+        }
+        if (line[0] == '[') {
+            if (line.back() != ']' || line.size() < 3) {
+                errors.push_back("line " + std::to_string(lineNumber) + ": malformed section header");
+                continue;
+            }
+            section = trim(line.substr(1, line.size() - 2));
+            sections[section];
+            continue;
+        }
+        const size_t equals = line.find('=');
+        if (equals == std::string::npos || trim(line.substr(0, equals)).empty()) {
+            errors.push_back("line " + std::to_string(lineNumber) + ": expected key = value");
+            continue;
+        }
+        sections[section][trim(line.substr(0, equals))] = trim(line.substr(equals + 1));
+    }
+    return sections;
+}
+
+Settings readSettings(std::istream& input, std::vector<std::string>& errors,
+                      std::vector<std::string>& warnings) {
+    Settings settings;
+    const IniSections sections = parseIni(input, errors);
+    for (const auto& section : sections) {
+        for (const auto& entry : section.second) {
+            const std::string& name = section.first;
+            const std::string& key = entry.first;
+            const std::string& value = entry.second;
+            bool valid = true;
+            if (name == "defaults" && key == "timeout") {
+                valid = parseSeconds(value, settings.timeoutSeconds);
+            } else if (name == "http" && key == "timeout") {
+                valid = parseSeconds(value, settings.httpTimeoutSeconds);
+            } else if ((name == "defaults" && (key == "plugin_dir" || key == "verbose")) ||
+                       (name == "http" && key == "verify_ssl")) {
+                // Shipped in older example files, so installed configs
+                // still carry them; no check honours them
+                warnings.push_back("ignoring unsupported setting [" + name + "] " + key);
+                continue;
+            } else if (name == "logging" && key == "enabled") {
+                valid = parseFlag(value, settings.logEnabled);
+            } else if (name == "logging" && key == "log_file") {
+                settings.logFile = value;
+            } else {
+                errors.push_back("unknown setting [" + name + "] " + key);
+                continue;
+            }
+            if (!valid) {
+                errors.push_back("invalid value for [" + name + "] " + key + ": " + value);
+            }
+        }
+    }
+    return settings;
+}
+
+bool compileCheck(ScheduledCheck check, const Settings& settings, CompiledCheck& compiled,
+                  std::string& error) {
+    CheckOutcome failure;
+    compiled.prepared = prepareCheck(check.args, failure);
+    if (!compiled.prepared) {
+        error = failure.output.substr(0, failure.output.find('\n'));
+        return false;
+    }
+    if (check.timeoutSeconds <= 0 && settings.httpTimeoutSeconds > 0 &&
+        pluginNameFromCommand(check.args[0]) == "http") {
+        check.timeoutSeconds = settings.httpTimeoutSeconds;
+    }
+    compiled.key = resultCacheKey(check.args);
+    compiled.check = std::move(check);
+    return true;
+}
+
+std::shared_ptr<const Configuration> loadConfiguration(const std::string& configPath,
+                                                       const std::string& inventoryPath) {
+    auto loaded = std::make_shared<Configuration>();
+    if (!configPath.empty()) {
+        std::ifstream input(configPath);
+        std::vector<std::string> errors;
+        std::vector<std::string> warnings;
+        if (!input) {
+            errors.push_back("cannot open");
+        } else {
+            loaded->settings = readSettings(input, errors, warnings);
+        }
+        for (const std::string& error : errors) {
+            loaded->errors.push_back(configPath + ": " + error);
+        }
+        for (const std::string& warning : warnings) {
+            loaded->warnings.push_back(configPath + ": " + warning);
+        }
+    }
+
+    if (!inventoryPath.empty()) {
+        std::ifstream input(inventoryPath);
+        std::vector<std::string> errors;
+        std::vector<ScheduledCheck> listed;
+        if (!input) {
+            errors.push_back("cannot open");
+        } else {
+            listed = readInventory(input, errors);
+        }
+        for (ScheduledCheck& check : listed) {
+            CompiledCheck compiled;
+            std::string error;
+            const std::string id = check.id;
+            if (compileCheck(std::move(check), loaded->settings, compiled, error)) {
+                loaded->checks.push_back(std::move(compiled));
+            } else {
+                errors.push_back(id + ": " + error);
+            }
+        }
+        for (const std::string& error : errors) {
+            loaded->errors.push_back(inventoryPath + ": " + error);
+        }
+    }
+    return loaded;
+}
+
+FileWatcher::FileWatcher(const std::vector<std::string>& paths) : files(paths) {
+    for (const std::string& path : files) {
+        modified.push_back(modificationTime(path));
+    }
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        return;
+    }
+    for (const std::string& path : files) {
+        const std::string dir = splitPath(path).first;
+        bool watched = false;
+        for (const auto& entry : watchedDirs) {
+            watched = watched || entry.second == dir;
+        }
+        if (watched) {
+            continue;
+        }
+        // Editors and config management often replace a file by rename
+        int wd = inotify_add_watch(inotifyFd, dir.c_str(),
+                                   IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE);
+        if (wd >= 0) {
+            watchedDirs[wd] = dir;
+        }
+    }
+    if (watchedDirs.empty()) {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+    }
+#endif
+}
+
+bool FileWatcher::changed() {
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        bool hit = false;
+        alignas(struct inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+                auto dir = watchedDirs.find(event->wd);
+                if (dir == watchedDirs.end() || event->len == 0) {
+                    continue;
+                }
+                const std::string name = event->name;
+                for (const std::string& path : files) {
+                    const auto parts = splitPath(path);
+                    hit = hit || (parts.first == dir->second && parts.second == name);
+                }
+            }
+        }
+        return hit;
+    }
+#endif
+    bool hit = false;
+    for (size_t i = 0; i < files.size(); i++) {
+        const std::time_t now = modificationTime(files[i]);
+        if (now != modified[i]) {
+            modified[i] = now;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+bool ResultLog::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (out.is_open()) {
+        out.close();
+    }
+    out.clear();
+    out.open(path, std::ios::app);
+    return out.is_open();
+}
+
+void ResultLog::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.close();
+}
+
+void ResultLog::write(const ResultRecord& record) {
+    std::string status;
+    encodeResult(OutputFormat::NAGIOS, record, status);
+    while (!status.empty() && status.back() == '\n') {
+        status.pop_back();
+    }
+    std::replace(status.begin(), status.end(), '\n', ' ');
+    std::replace(status.begin(), status.end(), '\t', ' ');
+
+    const std::time_t when = std::chrono::system_clock::to_time_t(record.timestamp);
+    struct tm utc;
+#ifdef _WIN32
+    gmtime_s(&utc, &when);
+#else
+    gmtime_r(&when, &utc);
+#endif
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+    char latency[32];
+    std::snprintf(latency, sizeof(latency), "%.3f",
+                  static_cast<double>(record.latency.count()) / 1000.0);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (out.is_open()) {
+        out << stamp << '\t' << record.check << '\t' << record.exitCode << '\t' << latency
+            << '\t' << status << '\n';
+        out.flush();
+    }
+}
+
+} // namespace netmon_plugins
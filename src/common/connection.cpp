@@ -0,0 +1,467 @@
+// src/common/connection.cpp
+// Buffered TCP/TLS client connection implementation
+
+#include "netmon/connection.hpp"
+#include "netmon/tls_context.hpp"
+#include <algorithm>
+#include <utility>
+
+#ifdef NETMON_SSL_ENABLED
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netdb.h>
+#endif
+
+namespace netmon_plugins {
+namespace net {
+
+namespace {
+
+// Bytes requested from the socket per read
+const size_t READ_CHUNK = 8192;
+
+std::chrono::microseconds since(CheckClock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(CheckClock::now() - start);
+}
+
+std::string numericAddress(const ResolvedAddress& address) {
+    char text[NI_MAXHOST] = "";
+    getnameinfo(reinterpret_cast<const struct sockaddr*>(address.sockaddr.data()),
+                static_cast<socklen_t>(address.sockaddr.size()),
+                text, sizeof(text), nullptr, 0, NI_NUMERICHOST);
+    return text;
+}
+
+} // namespace
+
+Connection::~Connection() {
+    close();
+}
+
+Connection::Connection(Connection&& other) noexcept {
+    *this = std::move(other);
+}
+
+Connection& Connection::operator=(Connection&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd = other.fd;
+        other.fd = INVALID_SOCKET_FD;
+#ifdef NETMON_SSL_ENABLED
+        ssl = other.ssl;
+        other.ssl = nullptr;
+#endif
+        checkContext = std::move(other.checkContext);
+        host = std::move(other.host);
+        port = other.port;
+        peer = std::move(other.peer);
+        tlsOptions = std::move(other.tlsOptions);
+        phases = other.phases;
+        opened = other.opened;
+        awaitingSince = other.awaitingSince;
+        gotFirstByte = other.gotFirstByte;
+        timing = other.timing;
+        other.timing = false;
+        buffer = std::move(other.buffer);
+        readOffset = other.readOffset;
+        other.readOffset = 0;
+        lastStatus = other.lastStatus;
+        lastError = std::move(other.lastError);
+    }
+    return *this;
+}
+
+bool Connection::open(const std::string& hostName, int portNumber, const CheckContext& context,
+                      const ConnectOptions& options) {
+    close();
+    checkContext = context;
+    host = hostName;
+    port = portNumber;
+    tlsOptions = options;
+    lastStatus = IoStatus::OK;
+    lastError.clear();
+    phases = PhaseTimings();
+    opened = CheckClock::now();
+    gotFirstByte = false;
+    timing = true;
+
+    AddressList addresses;
+    IoStatus status = resolveAddresses(hostName, portNumber, context, addresses, lastError);
+    phases.dns = since(opened);
+    phases.recorded |= PhaseTimings::DNS;
+    if (status != IoStatus::OK) {
+        lastStatus = status;
+        recordPhases();
+        return false;
+    }
+
+    AddressList ordered = interleaveFamilies(addresses);
+    size_t winner = 0;
+    const CheckClock::time_point connecting = CheckClock::now();
+    fd = connectAny(ordered, context, options.attemptDelayMs, status, &winner);
+    phases.connect = since(connecting);
+    phases.recorded |= PhaseTimings::CONNECT;
+    if (fd == INVALID_SOCKET_FD) {
+        fail(status, "connecting to " + hostName + ":" + std::to_string(portNumber));
+        recordPhases();
+        return false;
+    }
+    peer = numericAddress(ordered[winner]);
+    awaitingSince = CheckClock::now();
+
+    if (options.tls) {
+        return startTls(options.serverName);
+    }
+    return true;
+}
+
+bool Connection::startTls(const std::string& serverName) {
+#ifdef NETMON_SSL_ENABLED
+    if (!isOpen() || ssl) {
+        fail(IoStatus::FAILED, "starting TLS");
+        return false;
+    }
+    if (!serverName.empty()) {
+        tlsOptions.serverName = serverName;
+    }
+    SSL_CTX* context =
+        TlsClientCache::shared().context(tlsOptions.verifyPeer, tlsOptions.caFile);
+    if (context) {
+        ssl = SSL_new(context);
+    }
+    if (!ssl) {
+        fail(IoStatus::FAILED, "creating TLS session");
+        close();
+        return false;
+    }
+    SSL_set_fd(ssl, static_cast<int>(fd));
+    const std::string& sni = tlsOptions.serverName.empty() ? host : tlsOptions.serverName;
+    SSL_set_tlsext_host_name(ssl, sni.c_str());
+    if (tlsOptions.verifyPeer) {
+        SSL_set1_host(ssl, sni.c_str());
+    }
+    if (tlsOptions.resumeSession) {
+        SSL_SESSION* session = TlsClientCache::shared().session(tlsSessionKey());
+        if (session) {
+            SSL_set_session(ssl, session);
+            SSL_SESSION_free(session);
+        }
+    }
+
+    const CheckClock::time_point handshaking = CheckClock::now();
+    IoStatus status = tlsHandshake(ssl, fd, checkContext);
+    phases.tls = since(handshaking);
+    phases.recorded |= PhaseTimings::TLS;
+    awaitingSince = CheckClock::now();
+    if (status != IoStatus::OK) {
+        std::string what = "TLS handshake with " + host;
+        const long verified = SSL_get_verify_result(ssl);
+        if (tlsOptions.verifyPeer && verified != X509_V_OK) {
+            what += " (" + std::string(X509_verify_cert_error_string(verified)) + ")";
+        }
+        fail(status, what);
+        // The session may be what the server choked on
+        TlsClientCache::shared().storeSession(tlsSessionKey(), nullptr);
+        close();
+        return false;
+    }
+    return true;
+#else
+    (void)serverName;
+    fail(IoStatus::FAILED, "TLS support not compiled in");
+    close();
+    return false;
+#endif
+}
+
+void Connection::close() {
+    recordPhases();
+#ifdef NETMON_SSL_ENABLED
+    if (ssl) {
+        saveTlsSession();
+        SSL_free(ssl);
+        ssl = nullptr;
+    }
+#endif
+    closeSocket(fd);
+    fd = INVALID_SOCKET_FD;
+    buffer.clear();
+    readOffset = 0;
+}
+
+void Connection::detach() {
+    recordPhases();
+    saveTlsSession();
+    checkContext = CheckContext();
+}
+
+void Connection::rebind(const CheckContext& context) {
+    recordPhases();
+    checkContext = context;
+    lastStatus = IoStatus::OK;
+    lastError.clear();
+    phases = PhaseTimings();
+    phases.reused = true;
+    opened = CheckClock::now();
+    awaitingSince = opened;
+    gotFirstByte = false;
+    timing = true;
+}
+
+bool Connection::stillOpen() {
+    if (!isOpen() || readOffset < buffer.size()) {
+        return false;
+    }
+    bool pending = false;
+    if (peekSocket(fd, pending) != IoStatus::OK) {
+        return false;
+    }
+    if (!pending) {
+        return true;
+    }
+#ifdef NETMON_SSL_ENABLED
+    // TLS 1.3 servers may send session tickets after the handshake; those
+    // are fine, application data or a close_notify are not
+    if (ssl) {
+        char byte;
+        const int rc = SSL_peek(ssl, &byte, 1);
+        if (rc > 0) {
+            return false;
+        }
+        const int error = SSL_get_error(ssl, rc);
+        ERR_clear_error();
+        return error == SSL_ERROR_WANT_READ;
+    }
+#endif
+    return false;
+}
+
+PhaseTimings Connection::timings() const {
+    PhaseTimings current = phases;
+    if (timing) {
+        current.total = since(opened);
+    }
+    return current;
+}
+
+void Connection::recordPhases() {
+    if (!timing) {
+        return;
+    }
+    timing = false;
+    phases.total = since(opened);
+    if (checkContext.phases) {
+        checkContext.phases->record(phases);
+    }
+}
+
+std::string Connection::tlsSessionKey() const {
+    return host + ":" + std::to_string(port) + "/" + tlsOptions.serverName +
+           (tlsOptions.verifyPeer ? "/verify:" + tlsOptions.caFile : "");
+}
+
+void Connection::saveTlsSession() {
+#ifdef NETMON_SSL_ENABLED
+    // TLS 1.3 tickets arrive after the handshake, so the session worth
+    // keeping is the one at the end of the conversation
+    if (!ssl || !tlsOptions.resumeSession || !SSL_is_init_finished(ssl)) {
+        return;
+    }
+    SSL_SESSION* session = SSL_get1_session(ssl);
+    if (session && SSL_SESSION_is_resumable(session)) {
+        TlsClientCache::shared().storeSession(tlsSessionKey(), session);
+    }
+    SSL_SESSION_free(session);
+#endif
+}
+
+bool Connection::tlsResumed() const {
+#ifdef NETMON_SSL_ENABLED
+    return ssl && SSL_session_reused(ssl) == 1;
+#else
+    return false;
+#endif
+}
+
+bool Connection::isTls() const {
+#ifdef NETMON_SSL_ENABLED
+    return ssl != nullptr;
+#else
+    return false;
+#endif
+}
+
+IoStatus Connection::write(const std::string& data) {
+    return write(data.data(), data.size());
+}
+
+IoStatus Connection::write(const char* data, size_t length) {
+    if (!isOpen()) {
+        return fail(IoStatus::FAILED, "writing to a closed connection");
+    }
+#ifdef NETMON_SSL_ENABLED
+    IoStatus status = ssl ? tlsSendAll(ssl, fd, data, length, checkContext)
+                          : sendAll(fd, data, length, checkContext);
+#else
+    IoStatus status = sendAll(fd, data, length, checkContext);
+#endif
+    if (!gotFirstByte) {
+        awaitingSince = CheckClock::now();   // The reply is to this request
+    }
+    if (status == IoStatus::OK && checkContext.phases) {
+        checkContext.phases->addTraffic(0, length);
+    }
+    return status == IoStatus::OK ? status : fail(status, "sending to " + host);
+}
+
+IoStatus Connection::fill() {
+    if (!isOpen()) {
+        return fail(IoStatus::FAILED, "reading from a closed connection");
+    }
+
+    // Drop consumed bytes before growing; the buffer's capacity is kept
+    // for the life of the connection
+    if (readOffset > 0 && readOffset >= buffer.size() / 2) {
+        buffer.erase(0, readOffset);
+        readOffset = 0;
+    }
+    const size_t used = buffer.size();
+    buffer.resize(used + READ_CHUNK);
+    size_t received = 0;
+#ifdef NETMON_SSL_ENABLED
+    IoStatus status = ssl ? tlsRecvSome(ssl, fd, &buffer[used], READ_CHUNK, received, checkContext)
+                          : recvSome(fd, &buffer[used], READ_CHUNK, received, checkContext);
+#else
+    IoStatus status = recvSome(fd, &buffer[used], READ_CHUNK, received, checkContext);
+#endif
+    buffer.resize(used + received);
+    if (received > 0 && checkContext.phases) {
+        checkContext.phases->addTraffic(received, 0);
+    }
+    if (received > 0 && !gotFirstByte) {
+        gotFirstByte = true;
+        phases.firstByte = since(awaitingSince);
+        phases.recorded |= PhaseTimings::FIRST_BYTE;
+    }
+    if (status == IoStatus::CLOSED) {
+        lastStatus = status;
+        return status;
+    }
+    return status == IoStatus::OK ? status : fail(status, "receiving from " + host);
+}
+
+IoStatus Connection::fail(IoStatus status, const std::string& what) {
+    lastStatus = status;
+    lastError = what + " " + ioStatusToString(status);
+    return status;
+}
+
+void Connection::consume(size_t length, std::string& out) {
+    out.append(buffer, readOffset, length);
+    readOffset += length;
+    if (readOffset == buffer.size()) {
+        buffer.clear();
+        readOffset = 0;
+    }
+}
+
+IoStatus Connection::readSome(std::string& out) {
+    if (readOffset == buffer.size()) {
+        IoStatus status = fill();
+        if (status != IoStatus::OK) {
+            return status;
+        }
+    }
+    consume(buffer.size() - readOffset, out);
+    return IoStatus::OK;
+}
+
+IoStatus Connection::readLine(std::string& line) {
+    line.clear();
+    size_t searched = readOffset;
+    for (;;) {
+        size_t end = buffer.find('\n', searched);
+        if (end != std::string::npos) {
+            consume(end - readOffset, line);
+            readOffset++;   // The '\n'
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            return IoStatus::OK;
+        }
+        searched = buffer.size() - readOffset;
+        IoStatus status = fill();
+        searched += readOffset;
+        if (status != IoStatus::OK) {
+            consume(buffer.size() - readOffset, line);
+            return status;
+        }
+    }
+}
+
+IoStatus Connection::readUntil(const std::string& delimiter, std::string& out) {
+    for (;;) {
+        size_t end = buffer.find(delimiter, readOffset);
+        if (end != std::string::npos) {
+            consume(end + delimiter.size() - readOffset, out);
+            return IoStatus::OK;
+        }
+        IoStatus status = fill();
+        if (status != IoStatus::OK) {
+            return status;
+        }
+    }
+}
+
+IoStatus Connection::readExactly(size_t length, std::string& out) {
+    while (buffer.size() - readOffset < length) {
+        IoStatus status = fill();
+        if (status != IoStatus::OK) {
+            return status;
+        }
+    }
+    consume(length, out);
+    return IoStatus::OK;
+}
+
+IoStatus Connection::receive(const std::function<size_t(const char*, size_t)>& consumer) {
+    if (readOffset == buffer.size()) {
+        IoStatus status = fill();
+        if (status != IoStatus::OK) {
+            return status;
+        }
+    }
+    const size_t available = buffer.size() - readOffset;
+    readOffset += std::min(consumer(buffer.data() + readOffset, available), available);
+    if (readOffset == buffer.size()) {
+        buffer.clear();
+        readOffset = 0;
+    }
+    return IoStatus::OK;
+}
+
+IoStatus Connection::readAll(std::string& out, size_t limit) {
+    for (;;) {
+        consume(std::min(buffer.size() - readOffset, limit - std::min(limit, out.size())), out);
+        if (out.size() >= limit) {
+            return IoStatus::OK;
+        }
+        IoStatus status = fill();
+        if (status == IoStatus::CLOSED) {
+            return IoStatus::OK;
+        }
+        if (status != IoStatus::OK) {
+            return status;
+        }
+    }
+}
+
+} // namespace net
+} // namespace netmon_plugins
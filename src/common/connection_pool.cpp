@@ -0,0 +1,193 @@
+// src/common/connection_pool.cpp
+// Keep-alive connection pool implementation
+
+#include "netmon/connection_pool.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace netmon_plugins {
+namespace net {
+
+namespace {
+
+// Longest single wait for a free slot, so that cancellation is noticed
+const std::chrono::milliseconds SLOT_POLL_SLICE(50);
+
+std::string poolKey(const std::string& host, int port, const ConnectOptions& options) {
+    std::string key = host + ":" + std::to_string(port);
+    if (options.tls) {
+        key += "/tls/" + options.serverName;
+        if (options.verifyPeer) {
+            key += "/verify:" + options.caFile;
+        }
+    }
+    return key;
+}
+
+} // namespace
+
+ConnectionPool::Lease::~Lease() {
+    release();
+}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept {
+    *this = std::move(other);
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        other.pool = nullptr;
+        key = std::move(other.key);
+        connection = std::move(other.connection);
+        wasReused = other.wasReused;
+        failure = std::move(other.failure);
+    }
+    return *this;
+}
+
+void ConnectionPool::Lease::release(bool keepAlive) {
+    if (!pool) {
+        connection.close();
+        return;
+    }
+    ConnectionPool* owner = pool;
+    pool = nullptr;
+    owner->giveBack(key, connection, keepAlive && connection.stillOpen());
+}
+
+ConnectionPool::ConnectionPool(const PoolLimits& poolLimits) : limits(poolLimits) {
+    limits.maxPerHost = std::max<size_t>(1, limits.maxPerHost);
+}
+
+ConnectionPool::~ConnectionPool() {
+    clear();
+}
+
+ConnectionPool& ConnectionPool::shared() {
+    // Never destroyed: a check abandoned past its deadline may still hold a
+    // lease while the process exits
+    static ConnectionPool* pool = new ConnectionPool();
+    return *pool;
+}
+
+ConnectionPool::Lease ConnectionPool::acquire(const std::string& host, int port,
+                                              const CheckContext& context,
+                                              const ConnectOptions& options) {
+    Lease lease;
+    lease.key = poolKey(host, port, options);
+    std::vector<Connection> closing;   // Closed once the lock is released
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            const CheckClock::time_point now = CheckClock::now();
+            evictExpired(now, closing);
+            HostConnections& entry = hosts[lease.key];
+            while (!entry.idle.empty() && !lease.wasReused) {
+                Connection candidate = std::move(entry.idle.back().connection);
+                entry.idle.pop_back();
+                if (candidate.stillOpen()) {
+                    lease.connection = std::move(candidate);
+                    lease.wasReused = true;
+                } else {
+                    entry.open--;
+                    closing.push_back(std::move(candidate));
+                }
+            }
+            if (lease.wasReused) {
+                break;
+            }
+            if (entry.open < limits.maxPerHost) {
+                entry.open++;
+                break;
+            }
+            if (context.stopRequested()) {
+                lease.failure = "waiting for a connection to " + host + ":" +
+                                std::to_string(port) + " " +
+                                ioStatusToString(context.token.cancelled() ? IoStatus::CANCELLED
+                                                                           : IoStatus::TIMED_OUT);
+                return lease;
+            }
+            CheckClock::time_point wakeAt = now + SLOT_POLL_SLICE;
+            if (context.deadline.isSet()) {
+                wakeAt = std::min(wakeAt, context.deadline.time());
+            }
+            released.wait_until(lock, wakeAt);
+        }
+    }
+    closing.clear();
+
+    lease.pool = this;
+    if (lease.wasReused) {
+        lease.connection.rebind(context);
+    } else if (!lease.connection.open(host, port, context, options)) {
+        lease.release();
+    }
+    return lease;
+}
+
+void ConnectionPool::giveBack(const std::string& key, Connection& connection, bool keepAlive) {
+    Connection surplus;   // Declared first so it is closed after the lock is released
+    if (keepAlive) {
+        connection.detach();
+    } else {
+        connection.close();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    HostConnections& entry = hosts[key];
+    if (keepAlive && entry.idle.size() < limits.maxIdlePerHost) {
+        entry.idle.push_back({std::move(connection), CheckClock::now()});
+    } else {
+        surplus = std::move(connection);
+        entry.open--;
+        if (entry.open == 0) {
+            hosts.erase(key);
+        }
+    }
+    released.notify_one();
+}
+
+void ConnectionPool::evictExpired(CheckClock::time_point now, std::vector<Connection>& expired) {
+    for (auto it = hosts.begin(); it != hosts.end();) {
+        std::vector<IdleConnection>& idle = it->second.idle;
+        // Oldest first: stop at the first one still fresh enough
+        size_t stale = 0;
+        while (stale < idle.size() && now - idle[stale].since >= limits.idleTimeout) {
+            expired.push_back(std::move(idle[stale].connection));
+            stale++;
+        }
+        idle.erase(idle.begin(), idle.begin() + static_cast<std::ptrdiff_t>(stale));
+        it->second.open -= stale;
+        if (it->second.open == 0) {
+            it = hosts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t ConnectionPool::idleCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& entry : hosts) {
+        count += entry.second.idle.size();
+    }
+    return count;
+}
+
+void ConnectionPool::clear() {
+    std::vector<Connection> closing;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = hosts.begin(); it != hosts.end();) {
+        for (IdleConnection& idle : it->second.idle) {
+            closing.push_back(std::move(idle.connection));
+        }
+        it->second.open -= it->second.idle.size();
+        it->second.idle.clear();
+        it = it->second.open == 0 ? hosts.erase(it) : std::next(it);
+    }
+}
+
+} // namespace net
+} // namespace netmon_plugins
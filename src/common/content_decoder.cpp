@@ -0,0 +1,190 @@
+// src/common/content_decoder.cpp
+// Streaming decoder for HTTP content codings implementation
+
+#include "netmon/content_decoder.hpp"
+#include <algorithm>
+#include <cctype>
+#include <utility>
+#include <vector>
+
+#ifdef NETMON_ZLIB_ENABLED
+#include <zlib.h>
+#endif
+
+namespace netmon_plugins {
+
+namespace {
+
+#ifdef NETMON_ZLIB_ENABLED
+// Decoded bytes produced per inflate() call
+const size_t OUTPUT_CHUNK = 16 * 1024;
+
+// gzip members start with 1f 8b
+const unsigned char GZIP_MAGIC = 0x1f;
+#endif
+
+std::vector<std::string> codings(const std::string& value) {
+    std::vector<std::string> names;
+    std::string current;
+    for (char c : value + ",") {
+        if (c == ',') {
+            if (!current.empty() && current != "identity") {
+                names.push_back(current);
+            }
+            current.clear();
+        } else if (c != ' ' && c != '\t') {
+            current += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    return names;
+}
+
+} // namespace
+
+ContentDecoder::Coding ContentDecoder::codingOf(const std::string& contentEncoding) {
+    const std::vector<std::string> names = codings(contentEncoding);
+    if (names.empty()) {
+        return Coding::IDENTITY;
+    }
+#ifdef NETMON_ZLIB_ENABLED
+    if (names.size() == 1 && (names[0] == "gzip" || names[0] == "x-gzip")) {
+        return Coding::GZIP;
+    }
+    if (names.size() == 1 && names[0] == "deflate") {
+        return Coding::DEFLATE;
+    }
+#endif
+    return Coding::UNSUPPORTED;
+}
+
+const char* ContentDecoder::acceptEncoding() {
+#ifdef NETMON_ZLIB_ENABLED
+    return "gzip, deflate";
+#else
+    return "";
+#endif
+}
+
+ContentDecoder::ContentDecoder(Coding bodyCoding, HttpResponseParser::BodyConsumer bodyConsumer)
+    : coding(bodyCoding), consumer(std::move(bodyConsumer)) {}
+
+ContentDecoder::~ContentDecoder() {
+#ifdef NETMON_ZLIB_ENABLED
+    if (started) {
+        inflateEnd(stream.get());
+    }
+#endif
+}
+
+bool ContentDecoder::write(const char* data, size_t length) {
+    if (failed()) {
+        return false;
+    }
+    if (coding != Coding::GZIP && coding != Coding::DEFLATE) {
+        decoded += length;
+        return !consumer || consumer(data, length);
+    }
+#ifdef NETMON_ZLIB_ENABLED
+    if (!started && coding == Coding::GZIP && !start(false)) {
+        return false;
+    }
+    if (!started) {
+        // "deflate" should be zlib-wrapped, but servers also send raw
+        // deflate; the first two bytes tell which
+        const size_t take = std::min(length, 2 - prefix.size());
+        prefix.append(data, take);
+        data += take;
+        length -= take;
+        if (prefix.size() < 2) {
+            return true;
+        }
+        const unsigned int header = (static_cast<unsigned char>(prefix[0]) << 8) |
+                                    static_cast<unsigned char>(prefix[1]);
+        const bool wrapped = (prefix[0] & 0x0f) == Z_DEFLATED && header % 31 == 0;
+        if (!start(!wrapped) || !inflateSome(prefix.data(), prefix.size())) {
+            return false;
+        }
+        prefix.clear();
+    }
+    return inflateSome(data, length);
+#else
+    return fail("content coding not supported");
+#endif
+}
+
+bool ContentDecoder::finish() {
+    if (failed()) {
+        return false;
+    }
+#ifdef NETMON_ZLIB_ENABLED
+    // An empty body is accepted whatever its claimed coding
+    if ((started && !ended) || !prefix.empty()) {
+        return fail("compressed body ends early");
+    }
+#endif
+    return true;
+}
+
+bool ContentDecoder::fail(const std::string& what) {
+    failure = what;
+    return false;
+}
+
+#ifdef NETMON_ZLIB_ENABLED
+bool ContentDecoder::start(bool raw) {
+    stream.reset(new z_stream_s());
+    // 15-bit window; +16 expects a gzip wrapper, negative means none
+    const int windowBits = raw ? -15 : coding == Coding::GZIP ? 15 + 16 : 15;
+    if (inflateInit2(stream.get(), windowBits) != Z_OK) {
+        return fail("cannot start decompression");
+    }
+    started = true;
+    return true;
+}
+
+bool ContentDecoder::inflateSome(const char* data, size_t length) {
+    char out[OUTPUT_CHUNK];
+    stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream->avail_in = static_cast<uInt>(length);
+    bool outputPending = false;
+    for (;;) {
+        if (ended) {
+            if (stream->avail_in == 0) {
+                return true;
+            }
+            // Another gzip member follows; anything else after the end of
+            // the stream is ignored
+            if (coding != Coding::GZIP || *stream->next_in != GZIP_MAGIC) {
+                return true;
+            }
+            inflateReset(stream.get());
+            ended = false;
+        }
+        if (stream->avail_in == 0 && !outputPending) {
+            return true;
+        }
+        stream->next_out = reinterpret_cast<Bytef*>(out);
+        stream->avail_out = static_cast<uInt>(sizeof(out));
+        const int result = inflate(stream.get(), Z_NO_FLUSH);
+        const size_t produced = sizeof(out) - stream->avail_out;
+        outputPending = stream->avail_out == 0;
+        if (produced > 0) {
+            decoded += produced;
+            if (consumer && !consumer(out, produced)) {
+                return false;
+            }
+        }
+        if (result == Z_STREAM_END) {
+            ended = true;
+        } else if (result == Z_BUF_ERROR) {
+            return true;   // Needs more input
+        } else if (result != Z_OK) {
+            const std::string what = coding == Coding::GZIP ? "corrupt gzip body"
+                                                            : "corrupt deflate body";
+            return fail(stream->msg ? what + ": " + stream->msg : what);
+        }
+    }
+}
+#endif
+
+} // namespace netmon_plugins
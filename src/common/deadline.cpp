@@ -0,0 +1,81 @@
+// src/common/deadline.cpp
+// Deadline and check context implementation
+
+#include "netmon/deadline.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace netmon_plugins {
+
+namespace {
+
+thread_local const CheckContext* currentContext = nullptr;
+
+} // namespace
+
+Deadline Deadline::after(std::chrono::milliseconds budget) {
+    return Deadline(CheckClock::now() + budget, budget);
+}
+
+Deadline Deadline::afterSeconds(int seconds) {
+    return after(std::chrono::seconds(std::max(0, seconds)));
+}
+
+bool Deadline::expired() const {
+    return set && CheckClock::now() >= at;
+}
+
+std::chrono::milliseconds Deadline::remaining() const {
+    if (!set) {
+        return std::chrono::milliseconds(std::numeric_limits<int>::max());
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(at - CheckClock::now());
+    return std::max(left, std::chrono::milliseconds(0));
+}
+
+int Deadline::pollTimeout(int sliceMs) const {
+    if (!set) {
+        return sliceMs > 0 ? sliceMs : -1;
+    }
+    auto left = remaining().count();
+    if (left == 0 && CheckClock::now() < at) {
+        left = 1;   // Less than a millisecond left; don't spin
+    }
+    if (sliceMs > 0 && left > sliceMs) {
+        return sliceMs;
+    }
+    return static_cast<int>(std::min<long long>(left, std::numeric_limits<int>::max()));
+}
+
+Deadline Deadline::earliest(const Deadline& other) const {
+    if (!set) {
+        return other;
+    }
+    if (!other.set) {
+        return *this;
+    }
+    return at <= other.at ? *this : other;
+}
+
+CheckContext CheckContext::within(int timeoutSeconds) const {
+    if (timeoutSeconds <= 0) {
+        return *this;
+    }
+    return CheckContext(deadline.earliest(Deadline::afterSeconds(timeoutSeconds)), token, phases);
+}
+
+const CheckContext& CheckContext::current() {
+    static const CheckContext unbounded;
+    return currentContext ? *currentContext : unbounded;
+}
+
+ScopedCheckContext::ScopedCheckContext(const CheckContext& context)
+    : previous(currentContext) {
+    currentContext = &context;
+}
+
+ScopedCheckContext::~ScopedCheckContext() {
+    currentContext = previous;
+}
+
+} // namespace netmon_plugins
@@ -0,0 +1,300 @@
+// src/common/event_loop.cpp
+// Event loop implementation
+
+#include "netmon/event_loop.hpp"
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace netmon_plugins {
+
+// Tasks posted from other threads, plus the descriptor that wakes the loop.
+// Shared with posters so that a late post after the loop is destroyed is a
+// harmless no-op.
+struct EventLoop::PostQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+    bool alive = true;
+    int wakeRead = -1;
+    int wakeWrite = -1;
+
+    void push(std::function<void()> task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!alive) {
+            return;
+        }
+        bool wasEmpty = tasks.empty();
+        tasks.push_back(std::move(task));
+        if (wasEmpty) {
+            wake();
+        }
+    }
+
+    void wake() {
+#ifdef __linux__
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeWrite, &one, sizeof(one));
+        (void)ignored;
+#elif !defined(_WIN32)
+        char byte = 1;
+        ssize_t ignored = write(wakeWrite, &byte, 1);
+        (void)ignored;
+#endif
+    }
+
+    void drainWake() {
+#ifdef __linux__
+        uint64_t value;
+        ssize_t ignored = read(wakeRead, &value, sizeof(value));
+        (void)ignored;
+#elif !defined(_WIN32)
+        char buffer[64];
+        while (read(wakeRead, buffer, sizeof(buffer)) > 0) {
+        }
+#endif
+    }
+};
+
+namespace {
+
+#ifdef _WIN32
+// No wake descriptor on Windows; bound every wait instead
+const int POST_POLL_INTERVAL_MS = 50;
+#endif
+
+#ifdef __linux__
+uint32_t toEpoll(unsigned events) {
+    uint32_t mask = 0;
+    if (events & EventLoop::READABLE) {
+        mask |= EPOLLIN;
+    }
+    if (events & EventLoop::WRITABLE) {
+        mask |= EPOLLOUT;
+    }
+    return mask;
+}
+#endif
+
+} // namespace
+
+EventLoop::EventLoop() : posted(std::make_shared<PostQueue>()) {
+#ifdef __linux__
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    posted->wakeRead = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    posted->wakeWrite = posted->wakeRead;
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = posted->wakeRead;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, posted->wakeRead, &event);
+#elif !defined(_WIN32)
+    int fds[2];
+    if (pipe(fds) == 0) {
+        fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL, 0) | O_NONBLOCK);
+        posted->wakeRead = fds[0];
+        posted->wakeWrite = fds[1];
+    }
+#endif
+}
+
+EventLoop::~EventLoop() {
+    std::lock_guard<std::mutex> lock(posted->mutex);
+    posted->alive = false;
+    posted->tasks.clear();
+#ifndef _WIN32
+    if (posted->wakeRead >= 0) {
+        close(posted->wakeRead);
+    }
+    if (posted->wakeWrite >= 0 && posted->wakeWrite != posted->wakeRead) {
+        close(posted->wakeWrite);
+    }
+#endif
+#ifdef __linux__
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+#endif
+}
+
+void EventLoop::add(SocketFd fd, unsigned events, Handler handler) {
+    handlers[fd] = Registration{events, std::move(handler), nextGeneration++};
+#ifdef __linux__
+    struct epoll_event event = {};
+    event.events = toEpoll(events);
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+#endif
+}
+
+void EventLoop::modify(SocketFd fd, unsigned events) {
+    auto it = handlers.find(fd);
+    if (it == handlers.end() || it->second.events == events) {
+        return;
+    }
+    it->second.events = events;
+#ifdef __linux__
+    struct epoll_event event = {};
+    event.events = toEpoll(events);
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+#endif
+}
+
+void EventLoop::remove(SocketFd fd) {
+    if (handlers.erase(fd) == 0) {
+        return;
+    }
+#ifdef __linux__
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+}
+
+int EventLoop::runOnce(int timeoutMs) {
+    // Snapshot the ready registrations first: handlers may add or remove
+    // descriptors, and a descriptor closed by one handler may be reused by
+    // a registration another handler adds in the same pass
+    struct Ready {
+        SocketFd fd;
+        unsigned events;
+        uint64_t generation;
+    };
+    std::vector<Ready> ready;
+    bool woken = false;
+
+#ifdef __linux__
+    struct epoll_event events[256];
+    int count = epoll_wait(epollFd, events, 256, timeoutMs);
+    for (int i = 0; i < count; i++) {
+        if (events[i].data.fd == posted->wakeRead) {
+            woken = true;
+            continue;
+        }
+        unsigned mask = 0;
+        if (events[i].events & EPOLLIN) {
+            mask |= READABLE;
+        }
+        if (events[i].events & EPOLLOUT) {
+            mask |= WRITABLE;
+        }
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+            mask |= READABLE | WRITABLE;
+        }
+        const SocketFd fd = static_cast<SocketFd>(events[i].data.fd);
+        auto it = handlers.find(fd);
+        if (it != handlers.end()) {
+            ready.push_back({fd, mask, it->second.generation});
+        }
+    }
+#else
+#ifdef _WIN32
+    std::vector<WSAPOLLFD> fds;
+    if (timeoutMs < 0 || timeoutMs > POST_POLL_INTERVAL_MS) {
+        timeoutMs = POST_POLL_INTERVAL_MS;
+    }
+#else
+    std::vector<struct pollfd> fds;
+#endif
+    fds.reserve(handlers.size() + 1);
+    for (const auto& entry : handlers) {
+        short mask = 0;
+        if (entry.second.events & READABLE) {
+            mask |= POLLIN;
+        }
+        if (entry.second.events & WRITABLE) {
+            mask |= POLLOUT;
+        }
+        fds.push_back({entry.first, mask, 0});
+    }
+#ifdef _WIN32
+    int count = fds.empty() ? (Sleep(static_cast<DWORD>(timeoutMs)), 0)
+                            : WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMs);
+#else
+    if (posted->wakeRead >= 0) {
+        fds.push_back({posted->wakeRead, POLLIN, 0});
+    }
+    int count = poll(fds.data(), fds.size(), timeoutMs);
+#endif
+    for (size_t i = 0; count > 0 && i < fds.size(); i++) {
+        if (fds[i].revents == 0) {
+            continue;
+        }
+#ifndef _WIN32
+        if (fds[i].fd == posted->wakeRead) {
+            woken = true;
+            continue;
+        }
+#endif
+        unsigned mask = 0;
+        if (fds[i].revents & POLLIN) {
+            mask |= READABLE;
+        }
+        if (fds[i].revents & POLLOUT) {
+            mask |= WRITABLE;
+        }
+        if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            mask |= READABLE | WRITABLE;
+        }
+        auto it = handlers.find(static_cast<SocketFd>(fds[i].fd));
+        if (it != handlers.end()) {
+            ready.push_back({it->first, mask, it->second.generation});
+        }
+    }
+#endif
+
+    int dispatched = 0;
+    for (const auto& event : ready) {
+        auto it = handlers.find(event.fd);
+        if (it == handlers.end() || it->second.generation != event.generation) {
+            continue;
+        }
+        Handler handler = it->second.handler;   // May remove itself
+        handler(event.events);
+        dispatched++;
+    }
+
+    if (woken) {
+        posted->drainWake();
+    }
+    return dispatched + runPosted();
+}
+
+int EventLoop::runPosted() {
+    std::deque<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(posted->mutex);
+        tasks.swap(posted->tasks);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+    return static_cast<int>(tasks.size());
+}
+
+void EventLoop::post(std::function<void()> task) {
+    posted->push(std::move(task));
+}
+
+EventLoop::Poster EventLoop::poster() const {
+    std::weak_ptr<PostQueue> queue = posted;
+    return [queue](std::function<void()> task) {
+        if (auto target = queue.lock()) {
+            target->push(std::move(task));
+        }
+    };
+}
+
+} // namespace netmon_plugins
@@ -0,0 +1,672 @@
+// src/common/executor.cpp
+// In-process check execution
+
+#include "netmon/executor.hpp"
+#include "netmon/phase_timings.hpp"
+#include "netmon/result_cache.hpp"
+#include "netmon/telemetry.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace netmon_plugins {
+
+namespace {
+
+CheckOutcome unknownOutcome(const std::string& message) {
+    return CheckOutcome(static_cast<int>(ExitCode::UNKNOWN), "UNKNOWN: " + message + "\n",
+                        PerfMetrics(), message);
+}
+
+CheckOutcome resultOutcome(const PluginResult& result) {
+    return CheckOutcome(static_cast<int>(result.code), formatResult(result) + "\n",
+                        result.perfdata, result.message);
+}
+
+// Plugins take a mutable argv, so hand them private copies
+void parseInto(Plugin& plugin, const std::vector<std::string>& args) {
+    std::vector<std::string> storage(args);
+    std::vector<char*> argv;
+    argv.reserve(storage.size() + 1);
+    for (auto& arg : storage) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+    plugin.parseArguments(static_cast<int>(storage.size()), argv.data());
+}
+
+} // namespace
+
+PreparedCheck::PreparedCheck(const std::vector<std::string>& arguments)
+    : args(arguments) {
+    if (args.empty()) {
+        throw std::invalid_argument("No plugin specified");
+    }
+    name = pluginNameFromCommand(args[0]);
+    std::unique_ptr<Plugin> instance = PluginRegistry::instance().create(name);
+    if (!instance) {
+        throw std::invalid_argument("Unknown plugin '" + name + "'");
+    }
+
+    telemetry = &ExecutionTelemetry::global().plugin(name);
+    config = instance->parseConfig(args);
+    if (!config) {
+        // Single-shot plugin: validate the arguments now, parse again per run
+        parseInto(*instance, args);
+    }
+    plugin = std::move(instance);
+}
+
+CheckOutcome PreparedCheck::run() const {
+    return run(CheckContext());
+}
+
+CheckOutcome PreparedCheck::run(const CheckContext& context) const {
+    // A fresh recorder per run collects the phases and traffic of every
+    // connection
+    const CheckContext timed(context.deadline, context.token, std::make_shared<PhaseRecorder>());
+    ScopedCheckContext scope(timed);
+    const uint64_t rssBefore = peakRssKilobytes();
+    const CheckClock::time_point started = CheckClock::now();
+    RunSample sample;
+    CheckOutcome outcome;
+    try {
+        PluginResult result;
+        if (config) {
+            result = plugin->check(*config);
+        } else {
+            std::unique_ptr<Plugin> instance = PluginRegistry::instance().create(name);
+            parseInto(*instance, args);
+            result = instance->check();
+        }
+        sample.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            CheckClock::now() - started);
+        appendPhasePerfdata(result.perfdata, *timed.phases, sample.duration);
+        outcome = resultOutcome(result);
+    } catch (const std::exception& e) {
+        outcome = unknownOutcome("Plugin error - " + std::string(e.what()));
+        sample.threw = true;
+    } catch (...) {
+        outcome = unknownOutcome("Unknown plugin error");
+        sample.threw = true;
+    }
+
+    if (sample.threw) {
+        sample.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            CheckClock::now() - started);
+    }
+    sample.exitCode = outcome.exitCode;
+    sample.timedOut = context.stopRequested();
+    sample.connections = timed.phases->connections() - timed.phases->reusedConnections();
+    sample.bytesRead = timed.phases->bytesRead();
+    sample.bytesWritten = timed.phases->bytesWritten();
+    const uint64_t rssAfter = peakRssKilobytes();
+    sample.rssGrowthKb = rssAfter > rssBefore ? rssAfter - rssBefore : 0;
+    telemetry->record(sample);
+    return outcome;
+}
+
+ResultRecord makeResultRecord(const std::string& check, const CheckOutcome& outcome,
+                              std::chrono::microseconds latency) {
+    ResultRecord record;
+    record.check = check;
+    record.exitCode = outcome.exitCode;
+    record.message = outcome.message;
+    if (record.message.empty()) {
+        // Outcomes built by hand (help text, agent errors): first line as is
+        record.message = outcome.output.substr(0, outcome.output.find('\n'));
+    }
+    record.metrics = outcome.perfdata;
+    record.latency = latency;
+    record.timestamp = std::chrono::system_clock::now();
+    return record;
+}
+
+std::shared_ptr<const PreparedCheck> prepareCheck(const std::vector<std::string>& args,
+                                                  CheckOutcome& failure) {
+    if (args.empty()) {
+        failure = unknownOutcome("No plugin specified");
+        return nullptr;
+    }
+    const std::string name = pluginNameFromCommand(args[0]);
+    if (!PluginRegistry::instance().contains(name)) {
+        failure = unknownOutcome("Unknown plugin '" + name + "'");
+        return nullptr;
+    }
+
+    try {
+        return std::make_shared<const PreparedCheck>(args);
+    } catch (const HelpRequested&) {
+        failure = CheckOutcome(static_cast<int>(ExitCode::OK),
+                               PluginRegistry::instance().create(name)->getUsage() + "\n");
+    } catch (const std::exception& e) {
+        failure = unknownOutcome("Invalid arguments - " + std::string(e.what()));
+    } catch (...) {
+        failure = unknownOutcome("Invalid arguments");
+    }
+    return nullptr;
+}
+
+namespace {
+
+// Fires callbacks at their deadlines on one shared thread, so in-flight
+// async checks cost no thread of their own while they wait
+class DeadlineWatcher {
+public:
+    DeadlineWatcher() : thread([this]() { loop(); }) {}
+
+    ~DeadlineWatcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_one();
+        thread.join();
+    }
+
+    void watch(CheckClock::time_point when, std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            deadlines.emplace(when, std::move(callback));
+        }
+        changed.notify_one();
+    }
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (deadlines.empty()) {
+                changed.wait(lock);
+                continue;
+            }
+            auto first = deadlines.begin();
+            if (CheckClock::now() < first->first) {
+                changed.wait_until(lock, first->first);
+                continue;
+            }
+            std::function<void()> callback = std::move(first->second);
+            deadlines.erase(first);
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+
+    std::multimap<CheckClock::time_point, std::function<void()>> deadlines;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool stopping = false;
+    std::thread thread;
+};
+
+DeadlineWatcher& deadlineWatcher() {
+    static DeadlineWatcher watcher;
+    return watcher;
+}
+
+// When a pool worker running a check under context is written off
+ThreadPool::Clock::time_point poolDeadline(const CheckContext& context) {
+    return context.deadline.isSet() ? context.deadline.time()
+                                    : ThreadPool::Clock::time_point::max();
+}
+
+// Completion shared by the worker and the deadline; the first one wins
+struct AsyncCheck {
+    std::atomic<bool> done{false};
+    CheckCallback onDone;
+
+    bool finish(CheckOutcome outcome) {
+        if (done.exchange(true)) {
+            return false;
+        }
+        onDone(std::move(outcome));
+        return true;
+    }
+};
+
+} // namespace
+
+void checkAsync(ThreadPool& pool, std::shared_ptr<const PreparedCheck> check,
+                const CheckContext& context, CheckCallback onDone) {
+    auto pending = std::make_shared<AsyncCheck>();
+    pending->onDone = std::move(onDone);
+
+    if (context.deadline.isSet()) {
+        std::weak_ptr<AsyncCheck> weak = pending;
+        deadlineWatcher().watch(context.deadline.time(), [weak, context]() {
+            auto expired = weak.lock();
+            if (expired && expired->finish(timeoutOutcome(context.deadline))) {
+                context.token.cancel();
+            }
+        });
+    }
+
+    // A check still running past its deadline ignores the token; the pool
+    // replaces its worker rather than lose it
+    bool queued = pool.submit([pending, check, context]() {
+        // Skip checks whose deadline passed while they were queued
+        if (!pending->done) {
+            pending->finish(check->run(context));
+        }
+    }, poolDeadline(context));
+    if (!queued) {
+        pending->finish(unknownOutcome("Executor is shutting down"));
+    }
+}
+
+std::future<CheckOutcome> checkAsync(ThreadPool& pool,
+                                     std::shared_ptr<const PreparedCheck> check,
+                                     const CheckContext& context) {
+    auto promise = std::make_shared<std::promise<CheckOutcome>>();
+    std::future<CheckOutcome> future = promise->get_future();
+    checkAsync(pool, std::move(check), context, [promise](CheckOutcome outcome) {
+        promise->set_value(std::move(outcome));
+    });
+    return future;
+}
+
+// One shared run. It has no deadline of its own: every caller, the leader
+// included, leaves at its own deadline, and the last one to leave cancels
+// the run, so it lasts until the latest of them. Deadline callbacks hold
+// on to the flight, not to the coalescer, so they stay safe after it is
+// gone.
+struct CheckCoalescer::Flight {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool done = false;
+    CheckOutcome outcome;
+    size_t waiting = 0;                               // Callers still waiting
+    std::vector<std::shared_ptr<AsyncCheck>> waiters; // Asynchronous callers
+    CancellationToken token;                          // Of the shared run
+
+    // A caller gave up at its deadline; the last one cancels the run
+    void leave() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--waiting == 0 && !done) {
+            token.cancel();
+        }
+    }
+};
+
+CheckCoalescer::CheckCoalescer() = default;
+CheckCoalescer::~CheckCoalescer() = default;
+
+size_t CheckCoalescer::inFlight() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return flights.size();
+}
+
+std::shared_ptr<CheckCoalescer::Flight> CheckCoalescer::join(const std::string& key,
+                                                             bool& leader) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<Flight>& flight = flights[key];
+    // A run everyone gave up on is stopping; start afresh rather than
+    // inherit its cancelled outcome
+    leader = !flight || flight->token.cancelled();
+    if (leader) {
+        flight = std::make_shared<Flight>();
+        startedCount++;
+    } else {
+        coalescedCount++;
+    }
+    std::lock_guard<std::mutex> flightLock(flight->mutex);
+    flight->waiting++;
+    return flight;
+}
+
+void CheckCoalescer::finish(const std::string& key, const std::shared_ptr<Flight>& flight,
+                            CheckOutcome outcome) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = flights.find(key);
+        if (it != flights.end() && it->second == flight) {
+            flights.erase(it);
+        }
+    }
+    std::vector<std::shared_ptr<AsyncCheck>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(flight->mutex);
+        flight->done = true;
+        flight->outcome = std::move(outcome);
+        waiters.swap(flight->waiters);
+    }
+    flight->changed.notify_all();
+    // outcome is never written again once done is set
+    for (const auto& waiter : waiters) {
+        waiter->finish(flight->outcome);
+    }
+}
+
+void CheckCoalescer::checkAsync(ThreadPool& pool, const std::string& key,
+                                std::shared_ptr<const PreparedCheck> check,
+                                const CheckContext& context, CheckCallback onDone) {
+    auto pending = std::make_shared<AsyncCheck>();
+    pending->onDone = std::move(onDone);
+
+    bool leader = false;
+    std::shared_ptr<Flight> flight = join(key, leader);
+    {
+        std::unique_lock<std::mutex> lock(flight->mutex);
+        if (flight->done) {
+            // Finished since join(); the outcome is final
+            lock.unlock();
+            pending->finish(flight->outcome);
+            return;
+        }
+        flight->waiters.push_back(pending);
+    }
+
+    if (context.deadline.isSet()) {
+        std::weak_ptr<AsyncCheck> weak = pending;
+        deadlineWatcher().watch(context.deadline.time(), [weak, flight, context]() {
+            auto expired = weak.lock();
+            if (expired && expired->finish(timeoutOutcome(context.deadline))) {
+                flight->leave();
+            }
+        });
+    }
+    if (!leader) {
+        return;
+    }
+
+    // The shared run outlives the leader if others still wait on it, so it
+    // runs under the flight's token rather than the leader's deadline
+    CheckContext shared(Deadline(), flight->token, context.phases);
+    const Deadline leaderDeadline = context.deadline;
+    bool queued = pool.submit([this, key, flight, check, shared, leaderDeadline]() {
+        finish(key, flight, flight->token.cancelled() ? timeoutOutcome(leaderDeadline)
+                                                      : check->run(shared));
+    }, poolDeadline(context));
+    if (!queued) {
+        finish(key, flight, unknownOutcome("Executor is shutting down"));
+    }
+}
+
+CheckOutcome CheckCoalescer::run(const std::string& key, const PreparedCheck& check,
+                                 const CheckContext& context) {
+    bool leader = false;
+    std::shared_ptr<Flight> flight = join(key, leader);
+    if (leader) {
+        // Run on this thread, but as the flight's: the leader gives up at
+        // its deadline like the others, while the run goes on for them
+        if (context.deadline.isSet()) {
+            deadlineWatcher().watch(context.deadline.time(), [flight]() { flight->leave(); });
+        }
+        finish(key, flight, check.run(CheckContext(Deadline(), flight->token, context.phases)));
+        if (context.deadline.expired()) {
+            return timeoutOutcome(context.deadline);
+        }
+        return flight->outcome;
+    }
+
+    std::unique_lock<std::mutex> lock(flight->mutex);
+    auto done = [&flight]() { return flight->done; };
+    if (!context.deadline.isSet()) {
+        flight->changed.wait(lock, done);
+    } else if (!flight->changed.wait_until(lock, context.deadline.time(), done)) {
+        lock.unlock();
+        flight->leave();
+        return timeoutOutcome(context.deadline);
+    }
+    return flight->outcome;
+}
+
+CheckOutcome runCheck(const std::vector<std::string>& args) {
+    CheckOutcome failure;
+    std::shared_ptr<const PreparedCheck> prepared = prepareCheck(args, failure);
+    return prepared ? prepared->run() : failure;
+}
+
+CheckOutcome timeoutOutcome(int timeoutSeconds) {
+    return unknownOutcome("Check timed out after " + std::to_string(timeoutSeconds) + " seconds");
+}
+
+CheckOutcome timeoutOutcome(const Deadline& deadline) {
+    auto ms = deadline.budget().count();
+    if (ms % 1000 == 0) {
+        return timeoutOutcome(static_cast<int>(ms / 1000));
+    }
+    std::ostringstream seconds;
+    seconds << static_cast<double>(ms) / 1000.0;
+    return unknownOutcome("Check timed out after " + seconds.str() + " seconds");
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Shared between executeBatch() and its workers. Workers are detached so
+// that a check hung past its deadline never blocks the caller; the state
+// stays alive until the last of them lets go of it.
+struct BatchState {
+    std::vector<BatchCheck> checks;
+    BatchOptions options;
+    CheckCoalescer coalescer;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t next = 0;                            // Next check to start
+    size_t workers = 0;                         // Live worker threads
+    std::vector<char> reported;
+    std::vector<Clock::time_point> started;
+    std::vector<CancellationToken> tokens;
+    std::multimap<Clock::time_point, size_t> inFlight;  // deadline -> index
+    std::deque<BatchResult> finished;
+
+    int timeoutFor(size_t index) const {
+        int timeout = checks[index].timeoutSeconds;
+        return timeout > 0 ? timeout : options.defaultTimeoutSeconds;
+    }
+
+    void forgetInFlight(size_t index) {
+        for (auto it = inFlight.begin(); it != inFlight.end(); ++it) {
+            if (it->second == index) {
+                inFlight.erase(it);
+                return;
+            }
+        }
+    }
+};
+
+void batchWorker(std::shared_ptr<BatchState> state) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (state->next < state->checks.size()) {
+        size_t index = state->next++;
+        Clock::time_point start = Clock::now();
+        state->started[index] = start;
+        state->inFlight.emplace(start + std::chrono::seconds(state->timeoutFor(index)), index);
+        CheckContext context(Deadline::afterSeconds(state->timeoutFor(index)),
+                             state->tokens[index]);
+        state->changed.notify_all();
+        lock.unlock();
+
+        const BatchCheck& check = state->checks[index];
+        CheckOutcome outcome;
+        std::shared_ptr<const PreparedCheck> prepared =
+            check.prepared ? check.prepared : prepareCheck(check.args, outcome);
+        if (prepared && state->options.coalesce) {
+            outcome = state->coalescer.run(check.key.empty() ? resultCacheKey(check.args)
+                                                             : check.key,
+                                           *prepared, context);
+        } else if (prepared) {
+            outcome = prepared->run(context);
+        }
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+        lock.lock();
+        bool abandoned = state->reported[index] != 0;
+        if (!abandoned) {
+            state->reported[index] = 1;
+            state->forgetInFlight(index);
+            BatchResult result;
+            result.index = index;
+            result.id = state->checks[index].id;
+            result.outcome = std::move(outcome);
+            result.latency = latency;
+            state->finished.push_back(std::move(result));
+            state->changed.notify_all();
+        }
+        // A replacement took over while this worker was stuck; step aside
+        if (abandoned && state->workers > state->options.concurrency) {
+            break;
+        }
+    }
+    state->workers--;
+}
+
+void startBatchWorker(const std::shared_ptr<BatchState>& state) {
+    state->workers++;
+    std::thread(batchWorker, state).detach();
+}
+
+} // namespace
+
+BatchSummary executeBatch(const std::vector<BatchCheck>& checks,
+                          const BatchOptions& options,
+                          const BatchResultHandler& onResult) {
+    BatchSummary summary;
+    if (checks.empty()) {
+        return summary;
+    }
+
+    auto state = std::make_shared<BatchState>();
+    state->checks = checks;
+    state->options = options;
+    state->options.concurrency = std::max<size_t>(1, options.concurrency);
+    state->reported.assign(checks.size(), 0);
+    state->started.assign(checks.size(), Clock::time_point());
+    state->tokens.resize(checks.size());
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    size_t initialWorkers = std::min(state->options.concurrency, checks.size());
+    for (size_t i = 0; i < initialWorkers; i++) {
+        startBatchWorker(state);
+    }
+
+    size_t reportedCount = 0;
+    while (reportedCount < checks.size()) {
+        BatchResult result;
+        if (!state->finished.empty()) {
+            result = std::move(state->finished.front());
+            state->finished.pop_front();
+        } else if (!state->inFlight.empty() && state->inFlight.begin()->first <= Clock::now()) {
+            size_t index = state->inFlight.begin()->second;
+            state->inFlight.erase(state->inFlight.begin());
+            state->reported[index] = 1;
+            state->tokens[index].cancel();
+            result.index = index;
+            result.id = state->checks[index].id;
+            result.outcome = timeoutOutcome(state->timeoutFor(index));
+            result.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock::now() - state->started[index]);
+            result.timedOut = true;
+            // The hung worker is lost for now; keep the batch at full width
+            if (state->next < checks.size()) {
+                startBatchWorker(state);
+            }
+        } else {
+            if (state->inFlight.empty()) {
+                state->changed.wait(lock);
+            } else {
+                state->changed.wait_until(lock, state->inFlight.begin()->first);
+            }
+            continue;
+        }
+
+        reportedCount++;
+        summary.completed++;
+        if (result.timedOut) {
+            summary.timedOut++;
+        }
+        summary.worstExitCode = std::max(summary.worstExitCode, result.outcome.exitCode);
+
+        lock.unlock();
+        if (onResult) {
+            onResult(result);
+        }
+        lock.lock();
+    }
+
+    summary.coalesced = state->coalescer.coalesced();
+    return summary;
+}
+
+std::vector<std::string> splitCommandLine(const std::string& line) {
+    std::vector<std::string> args;
+    std::string current;
+    bool inToken = false;
+    char quote = '\0';
+
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quote == '\'') {
+            if (c == '\'') {
+                quote = '\0';
+            } else {
+                current += c;
+            }
+        } else if (quote == '"') {
+            if (c == '"') {
+                quote = '\0';
+            } else if (c == '\\' && i + 1 < line.size() &&
+                       (line[i + 1] == '"' || line[i + 1] == '\\')) {
+                current += line[++i];
+            } else {
+                current += c;
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            inToken = true;
+        } else if (c == '\\' && i + 1 < line.size()) {
+            current += line[++i];
+            inToken = true;
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            if (inToken) {
+                args.push_back(current);
+                current.clear();
+                inToken = false;
+            }
+        } else {
+            current += c;
+            inToken = true;
+        }
+    }
+
+    if (quote != '\0') {
+        throw std::invalid_argument("unterminated quote");
+    }
+    if (inToken) {
+        args.push_back(current);
+    }
+    return args;
+}
+
+bool parseBatchLine(const std::string& line, BatchCheck& check) {
+    size_t first = line.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos || line[first] == '#') {
+        return false;
+    }
+
+    std::vector<std::string> args = splitCommandLine(line);
+    check.id.clear();
+    if (!args.empty() && args.front().size() > 1 && args.front().back() == ':') {
+        check.id = args.front().substr(0, args.front().size() - 1);
+        args.erase(args.begin());
+    }
+    if (args.empty()) {
+        throw std::invalid_argument("no plugin given");
+    }
+    check.args = std::move(args);
+    return true;
+}
+
+} // namespace netmon_plugins
@@ -2,398 +2,271 @@
 // HTTP API utility implementation
 
 #include "netmon/http_api.hpp"
-#include <sstream>
+#include "netmon/connection_pool.hpp"
+#include "netmon/content_decoder.hpp"
+#include <algorithm>
+#include <cctype>
+#include <memory>
 #include <string>
 
-#ifdef NETMON_SSL_ENABLED
-#include <openssl/ssl.h>
-#include <openssl/err.h>
-#endif
+namespace netmon_plugins {
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include <fcntl.h>
-#endif
+namespace {
 
-namespace netmon_plugins {
+std::string base64Encode(const std::string& input) {
+    const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+    size_t i = 0;
+    while (i < input.length()) {
+        unsigned char b1 = static_cast<unsigned char>(input[i++]);
+        unsigned char b2 = (i < input.length()) ? static_cast<unsigned char>(input[i++]) : 0;
+        unsigned char b3 = (i < input.length()) ? static_cast<unsigned char>(input[i++]) : 0;
 
-std::string httpGet(const std::string& host, int port, const std::string& path,
-                   bool useSSL, int timeout, int& statusCode) {
-    return httpGetAuth(host, port, path, useSSL, timeout, "", "", statusCode);
+        unsigned int combined = (static_cast<unsigned int>(b1) << 16) |
+                               (static_cast<unsigned int>(b2) << 8) |
+                               static_cast<unsigned int>(b3);
+
+        encoded += base64_chars[(combined >> 18) & 63];
+        encoded += base64_chars[(combined >> 12) & 63];
+        if (i - 2 < input.length()) {
+            encoded += base64_chars[(combined >> 6) & 63];
+        } else {
+            encoded += '=';
+        }
+        if (i - 1 < input.length()) {
+            encoded += base64_chars[combined & 63];
+        } else {
+            encoded += '=';
+        }
+    }
+    return encoded;
 }
 
-std::string httpGetAuth(const std::string& host, int port, const std::string& path,
-                       bool useSSL, int timeout, const std::string& username,
-                       const std::string& password, int& statusCode) {
-    statusCode = 0;
-    std::string responseBody;
-    
-    // Build HTTP request
-    std::ostringstream request;
-    request << "GET " << path << " HTTP/1.1\r\n";
-    request << "Host: " << host;
-    if (port != 80 && port != 443) {
-        request << ":" << port;
+bool validToken(const std::string& text) {
+    return !text.empty() && text.find_first_of(" \t\r\n:") == std::string::npos;
+}
+
+bool validValue(const std::string& text) {
+    return text.find_first_of("\r\n") == std::string::npos;
+}
+
+// Content-Length or Transfer-Encoding, in any case
+bool framingField(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower == "content-length" || lower == "transfer-encoding";
+}
+
+bool idempotent(const std::string& method) {
+    return method == "GET" || method == "HEAD" || method == "OPTIONS" || method == "PUT" ||
+           method == "DELETE";
+}
+
+bool sendsBody(const HttpRequest& request) {
+    return !request.body.empty() || request.method == "POST" || request.method == "PUT" ||
+           request.method == "PATCH";
+}
+
+// The request head and body; empty (with error set) if a field would
+// break the framing
+std::string serialize(const HttpRequest& request, std::string& error) {
+    if (!validToken(request.method) || request.path.empty() || request.path[0] != '/' ||
+        request.path.find_first_of(" \r\n") != std::string::npos) {
+        error = "invalid request line " + request.method + " " + request.path;
+        return "";
     }
-    request << "\r\n";
-    request << "Connection: close\r\n";
-    request << "User-Agent: NetMon-Plugins/1.0\r\n";
-    request << "Accept: application/json, text/plain, */*\r\n";
-    
-    // Add basic auth if provided
-    if (!username.empty()) {
-        std::string auth = username + ":" + password;
-        // Base64 encoding
-        const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-        std::string encoded;
-        size_t i = 0;
-        while (i < auth.length()) {
-            unsigned char b1 = static_cast<unsigned char>(auth[i++]);
-            unsigned char b2 = (i < auth.length()) ? static_cast<unsigned char>(auth[i++]) : 0;
-            unsigned char b3 = (i < auth.length()) ? static_cast<unsigned char>(auth[i++]) : 0;
-            
-            unsigned int combined = (static_cast<unsigned int>(b1) << 16) | 
-                                   (static_cast<unsigned int>(b2) << 8) | 
-                                   static_cast<unsigned int>(b3);
-            
-            encoded += base64_chars[(combined >> 18) & 63];
-            encoded += base64_chars[(combined >> 12) & 63];
-            if (i - 2 < auth.length()) {
-                encoded += base64_chars[(combined >> 6) & 63];
-            } else {
-                encoded += '=';
-            }
-            if (i - 1 < auth.length()) {
-                encoded += base64_chars[combined & 63];
-            } else {
-                encoded += '=';
-            }
+    std::string text = request.method + " " + request.path + " HTTP/1.1\r\n";
+    if (!findHeader(request.headers, "Host")) {
+        text += "Host: " + request.host;
+        if (request.port != (request.useSSL ? 443 : 80)) {
+            text += ":" + std::to_string(request.port);
         }
-        request << "Authorization: Basic " << encoded << "\r\n";
+        text += "\r\n";
     }
-    
-    request << "\r\n";
-    std::string requestStr = request.str();
-    
-#ifdef NETMON_SSL_ENABLED
-    if (useSSL) {
-        // Use HTTPS
-        SSL_library_init();
-        SSL_load_error_strings();
-        OpenSSL_add_all_algorithms();
-        
-        SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
-        if (!ctx) {
-            return "";
-        }
-        
-        SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
-        SSL_CTX_set_default_verify_paths(ctx);
-        
-#ifdef _WIN32
-        WSADATA wsaData;
-        WSAStartup(MAKEWORD(2, 2), &wsaData);
-        
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(port);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            SSL_CTX_free(ctx);
-            WSACleanup();
-            return "";
-        }
-        
-        SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock == INVALID_SOCKET) {
-            freeaddrinfo(result);
-            SSL_CTX_free(ctx);
-            WSACleanup();
-            return "";
-        }
-        
-        DWORD timeoutMs = timeout * 1000;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-        
-        if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-            freeaddrinfo(result);
-            closesocket(sock);
-            SSL_CTX_free(ctx);
-            WSACleanup();
-            return "";
-        }
-        
-        freeaddrinfo(result);
-        
-        SSL* ssl = SSL_new(ctx);
-        if (!ssl) {
-            closesocket(sock);
-            WSACleanup();
-            SSL_CTX_free(ctx);
-            return "";
-        }
-        
-        SSL_set_fd(ssl, sock);
-        #ifdef SSL_set_tlsext_host_name
-        SSL_set_tlsext_host_name(ssl, host.c_str());
-        #endif
-        
-        if (SSL_connect(ssl) <= 0) {
-            SSL_free(ssl);
-            closesocket(sock);
-            WSACleanup();
-            SSL_CTX_free(ctx);
-            return "";
-        }
-        
-        if (SSL_write(ssl, requestStr.c_str(), static_cast<int>(requestStr.length())) <= 0) {
-            SSL_free(ssl);
-            closesocket(sock);
-            WSACleanup();
-            SSL_CTX_free(ctx);
+    if (!findHeader(request.headers, "User-Agent")) {
+        text += "User-Agent: NetMon-Plugins/1.0\r\n";
+    }
+    if (!findHeader(request.headers, "Accept")) {
+        text += "Accept: application/json, text/plain, */*\r\n";
+    }
+    if (request.decompress && *ContentDecoder::acceptEncoding() != '\0' &&
+        !findHeader(request.headers, "Accept-Encoding")) {
+        text += std::string("Accept-Encoding: ") + ContentDecoder::acceptEncoding() + "\r\n";
+    }
+    for (const HttpHeader& field : request.headers) {
+        if (!validToken(field.name) || !validValue(field.value)) {
+            error = "invalid header field " + field.name;
             return "";
         }
-        
-        char buffer[8192];
-        std::string fullResponse;
-        int bytes;
-        while ((bytes = SSL_read(ssl, buffer, sizeof(buffer) - 1)) > 0) {
-            buffer[bytes] = '\0';
-            fullResponse += buffer;
-        }
-        
-        SSL_free(ssl);
-        closesocket(sock);
-        WSACleanup();
-        SSL_CTX_free(ctx);
-#else
-        struct addrinfo hints, *result;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        
-        std::string portStr = std::to_string(port);
-        if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-            SSL_CTX_free(ctx);
-            return "";
+        if (framingField(field.name)) {
+            continue;   // Framing is ours to decide
         }
-        
-        int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-        if (sock < 0) {
-            freeaddrinfo(result);
-            SSL_CTX_free(ctx);
-            return "";
+        text += field.name + ": " + field.value + "\r\n";
+    }
+    if (sendsBody(request)) {
+        text += "Content-Length: " + std::to_string(request.body.size()) + "\r\n";
+    }
+    text += "\r\n";
+    text += request.body;
+    return text;
+}
+
+// Read one response into parser, handing its body to the parser's
+// consumer as it arrives
+IoStatus readResponse(net::Connection& connection, HttpResponseParser& parser) {
+    while (!parser.done()) {
+        IoStatus status = connection.receive([&parser](const char* data, size_t length) {
+            return parser.feed(data, length);
+        });
+        if (status == IoStatus::CLOSED) {
+            parser.finish();
+        } else if (status != IoStatus::OK) {
+            return status;
         }
-        
-        struct timeval tv;
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-            freeaddrinfo(result);
-            close(sock);
-            SSL_CTX_free(ctx);
-            return "";
+    }
+    return parser.complete() ? IoStatus::OK : IoStatus::FAILED;
+}
+
+// Send request and read its response into response, the body going to
+// consumer
+void perform(const HttpRequest& request, HttpResponse& response,
+             const HttpResponseParser::BodyConsumer& consumer) {
+    const std::string message = serialize(request, response.error);
+    if (message.empty()) {
+        response.status = IoStatus::FAILED;
+        return;
+    }
+
+    // One deadline covers resolution, connect, TLS handshake and the whole
+    // response, so a peer trickling bytes cannot stretch the timeout
+    const CheckContext context = CheckContext::current().within(request.timeoutSeconds);
+    net::ConnectOptions options;
+    options.tls = request.useSSL;
+    options.verifyPeer = request.verifyPeer;
+    options.caFile = request.caFile;
+    for (;;) {
+        net::ConnectionPool::Lease connection =
+            net::ConnectionPool::shared().acquire(request.host, request.port, context, options);
+        if (!connection) {
+            response.status = IoStatus::FAILED;
+            response.error = connection.error();
+            return;
         }
-        
-        freeaddrinfo(result);
-        
-        SSL* ssl = SSL_new(ctx);
-        if (!ssl) {
-            close(sock);
-            SSL_CTX_free(ctx);
-            return "";
+
+        // A compressed body is decoded on its way to consumer; the coding
+        // is known once the head is parsed, before the first body byte
+        const HttpResponseParser* head = nullptr;
+        std::unique_ptr<ContentDecoder> decoder;
+        HttpResponseParser parser([&](const char* data, size_t length) {
+            if (!decoder) {
+                const std::string* encoding = head->header("Content-Encoding");
+                decoder.reset(new ContentDecoder(request.decompress && encoding
+                                                     ? ContentDecoder::codingOf(*encoding)
+                                                     : ContentDecoder::Coding::IDENTITY,
+                                                 consumer));
+            }
+            return decoder->write(data, length);
+        });
+        head = &parser;
+        if (request.method == "HEAD") {
+            parser.expectNoBody();
         }
-        
-        SSL_set_fd(ssl, sock);
-        #ifdef SSL_set_tlsext_host_name
-        SSL_set_tlsext_host_name(ssl, host.c_str());
-        #endif
-        
-        if (SSL_connect(ssl) <= 0) {
-            SSL_free(ssl);
-            close(sock);
-            SSL_CTX_free(ctx);
-            return "";
+        IoStatus status = connection->write(message);
+        if (status == IoStatus::OK) {
+            status = readResponse(*connection, parser);
         }
-        
-        if (SSL_write(ssl, requestStr.c_str(), static_cast<int>(requestStr.length())) <= 0) {
-            SSL_free(ssl);
-            close(sock);
-            SSL_CTX_free(ctx);
-            return "";
+        // A kept-alive connection the server closed meanwhile: try a fresh
+        // one, unless the request may have had an effect already
+        if (connection.reused() && !parser.headComplete() && idempotent(request.method) &&
+            (status == IoStatus::CLOSED || status == IoStatus::FAILED)) {
+            continue;
         }
-        
-        char buffer[8192];
-        std::string fullResponse;
-        ssize_t bytes;
-        while ((bytes = SSL_read(ssl, buffer, sizeof(buffer) - 1)) > 0) {
-            buffer[bytes] = '\0';
-            fullResponse += buffer;
+        const bool reusable = status == IoStatus::OK && parser.keepAlive();
+        if (status == IoStatus::OK && decoder && !decoder->finish()) {
+            status = IoStatus::FAILED;
         }
-        
-        SSL_free(ssl);
-        close(sock);
-        SSL_CTX_free(ctx);
-#endif
-        
-        // Parse response
-        size_t headerEnd = fullResponse.find("\r\n\r\n");
-        if (headerEnd != std::string::npos) {
-            std::string headers = fullResponse.substr(0, headerEnd);
-            responseBody = fullResponse.substr(headerEnd + 4);
-            
-            // Extract status code
-            size_t statusPos = headers.find("HTTP/");
-            if (statusPos != std::string::npos) {
-                size_t codeStart = headers.find(" ", statusPos) + 1;
-                size_t codeEnd = headers.find(" ", codeStart);
-                if (codeEnd != std::string::npos) {
-                    statusCode = std::stoi(headers.substr(codeStart, codeEnd - codeStart));
-                }
-            }
+        response.statusCode = parser.statusCode();
+        response.reason = parser.reason();
+        response.headers = parser.headers();
+        response.status = status;
+        response.decompressed = decoder && decoder->bodyCoding() != ContentDecoder::Coding::IDENTITY &&
+                                decoder->bodyCoding() != ContentDecoder::Coding::UNSUPPORTED;
+        if (status != IoStatus::OK) {
+            response.error = decoder && decoder->failed() ? decoder->error()
+                             : parser.failed()            ? parser.error()
+                                                          : connection->error();
         }
-        
-        return responseBody;
+        connection.release(reusable);
+        return;
     }
-#endif
+}
 
-    // Use HTTP
-#ifdef _WIN32
-    WSADATA wsaData;
-    WSAStartup(MAKEWORD(2, 2), &wsaData);
-    
-    struct addrinfo hints, *result;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    
-    std::string portStr = std::to_string(port);
-    if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-        WSACleanup();
-        return "";
-    }
-    
-    SOCKET sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-    if (sock == INVALID_SOCKET) {
-        freeaddrinfo(result);
-        WSACleanup();
-        return "";
-    }
-    
-    DWORD timeoutMs = timeout * 1000;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeoutMs, sizeof(timeoutMs));
-    
-    if (connect(sock, result->ai_addr, static_cast<int>(result->ai_addrlen)) != 0) {
-        freeaddrinfo(result);
-        closesocket(sock);
-        WSACleanup();
-        return "";
-    }
-    
-    freeaddrinfo(result);
-    
-    if (send(sock, requestStr.c_str(), static_cast<int>(requestStr.length()), 0) < 0) {
-        closesocket(sock);
-        WSACleanup();
-        return "";
-    }
-    
-    char buffer[8192];
-    std::string fullResponse;
-    int bytes;
-    while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-        buffer[bytes] = '\0';
-        fullResponse += buffer;
-    }
-    
-    closesocket(sock);
-    WSACleanup();
-#else
-    struct addrinfo hints, *result;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    
-    std::string portStr = std::to_string(port);
-    if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-        return "";
-    }
-    
-    int sock = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-    if (sock < 0) {
-        freeaddrinfo(result);
-        return "";
-    }
-    
-    struct timeval tv;
-    tv.tv_sec = timeout;
-    tv.tv_usec = 0;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-    
-    if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
-        freeaddrinfo(result);
-        close(sock);
-        return "";
-    }
-    
-    freeaddrinfo(result);
-    
-    if (send(sock, requestStr.c_str(), requestStr.length(), 0) < 0) {
-        close(sock);
-        return "";
-    }
-    
-    char buffer[8192];
-    std::string fullResponse;
-    ssize_t bytes;
-    while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-        buffer[bytes] = '\0';
-        fullResponse += buffer;
-    }
-    
-    close(sock);
-#endif
+} // namespace
 
-    // Parse response
-    size_t headerEnd = fullResponse.find("\r\n\r\n");
-    if (headerEnd != std::string::npos) {
-        std::string headers = fullResponse.substr(0, headerEnd);
-        responseBody = fullResponse.substr(headerEnd + 4);
-        
-        // Extract status code
-        size_t statusPos = headers.find("HTTP/");
-        if (statusPos != std::string::npos) {
-            size_t codeStart = headers.find(" ", statusPos) + 1;
-            size_t codeEnd = headers.find(" ", codeStart);
-            if (codeEnd != std::string::npos) {
-                try {
-                    statusCode = std::stoi(headers.substr(codeStart, codeEnd - codeStart));
-                } catch (...) {
-                    statusCode = 0;
-                }
-            }
+HttpRequest& HttpRequest::header(const std::string& name, const std::string& value) {
+    headers.push_back({name, value});
+    return *this;
+}
+
+HttpRequest& HttpRequest::basicAuth(const std::string& username, const std::string& password) {
+    return header("Authorization", "Basic " + base64Encode(username + ":" + password));
+}
+
+HttpRequest& HttpRequest::bearerToken(const std::string& token) {
+    return header("Authorization", "Bearer " + token);
+}
+
+const std::string* HttpResponse::header(const std::string& name) const {
+    return findHeader(headers, name);
+}
+
+HttpResponse httpRequest(const HttpRequest& request) {
+    HttpResponse response;
+    perform(request, response, [&response](const char* data, size_t length) {
+        if (response.body.size() + length > MAX_HTTP_RESPONSE_BODY) {
+            response.body.append(data, MAX_HTTP_RESPONSE_BODY - response.body.size());
+            response.truncated = true;
+            return false;
         }
+        response.body.append(data, length);
+        return true;
+    });
+    return response;
+}
+
+HttpResponse httpRequest(const HttpRequest& request,
+                         const HttpResponseParser::BodyConsumer& consumer) {
+    HttpResponse response;
+    perform(request, response, consumer);
+    return response;
+}
+
+std::string httpGet(const std::string& host, int port, const std::string& path,
+                   bool useSSL, int timeout, int& statusCode) {
+    return httpGetAuth(host, port, path, useSSL, timeout, "", "", statusCode);
+}
+
+std::string httpGetAuth(const std::string& host, int port, const std::string& path,
+                       bool useSSL, int timeout, const std::string& username,
+                       const std::string& password, int& statusCode) {
+    HttpRequest request;
+    request.host = host;
+    request.port = port;
+    request.path = path;
+    request.useSSL = useSSL;
+    request.timeoutSeconds = timeout;
+    if (!username.empty()) {
+        request.basicAuth(username, password);
     }
-    
-    return responseBody;
+    HttpResponse response = httpRequest(request);
+    // A body cut off by the deadline, or by anything else, is no answer
+    if (!response.complete()) {
+        statusCode = 0;
+        return "";
+    }
+    statusCode = response.statusCode;
+    return response.body;
 }
 
 } // namespace netmon_plugins
-
@@ -0,0 +1,338 @@
+// src/common/http_parser.cpp
+// Incremental HTTP/1.1 response parser implementation
+
+#include "netmon/http_parser.hpp"
+#include <cctype>
+#include <cstring>
+#include <utility>
+
+namespace netmon_plugins {
+
+namespace {
+
+// Largest chunk accepted, well beyond anything a check reads
+const unsigned long long MAX_CHUNK_SIZE = 1ULL << 40;
+
+bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) !=
+            std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string trim(const std::string& text) {
+    const size_t start = text.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    return text.substr(start, text.find_last_not_of(" \t") - start + 1);
+}
+
+// Comma-separated list elements, e.g. of Connection or Transfer-Encoding
+std::vector<std::string> listElements(const std::string& value) {
+    std::vector<std::string> elements;
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t comma = value.find(',', start);
+        if (comma == std::string::npos) {
+            comma = value.size();
+        }
+        std::string element = trim(value.substr(start, comma - start));
+        if (!element.empty()) {
+            elements.push_back(std::move(element));
+        }
+        start = comma + 1;
+    }
+    return elements;
+}
+
+bool parseDecimal(const std::string& text, unsigned long long& value) {
+    if (text.empty()) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9' || value > (~0ULL - 9) / 10) {
+            return false;
+        }
+        value = value * 10 + static_cast<unsigned long long>(c - '0');
+    }
+    return true;
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+} // namespace
+
+const std::string* findHeader(const std::vector<HttpHeader>& headers, const std::string& name) {
+    for (const HttpHeader& field : headers) {
+        if (equalsIgnoreCase(field.name, name)) {
+            return &field.value;
+        }
+    }
+    return nullptr;
+}
+
+HttpResponseParser::HttpResponseParser(BodyConsumer bodyConsumer)
+    : consumer(std::move(bodyConsumer)) {}
+
+void HttpResponseParser::reset() {
+    BodyConsumer kept = std::move(consumer);
+    *this = HttpResponseParser(std::move(kept));
+}
+
+bool HttpResponseParser::keepAlive() const {
+    return complete() && !closeDelimited && !closeRequested &&
+           (minorVersion >= 1 || keepAliveOffered);
+}
+
+bool HttpResponseParser::lineState() const {
+    return state == State::STATUS_LINE || state == State::HEADERS ||
+           state == State::CHUNK_SIZE || state == State::CHUNK_END || state == State::TRAILERS;
+}
+
+size_t HttpResponseParser::feed(const char* data, size_t length) {
+    size_t used = 0;
+    while (used < length && !done()) {
+        if (lineState()) {
+            const char* start = data + used;
+            const void* newline = std::memchr(start, '\n', length - used);
+            const size_t take = newline ? static_cast<size_t>(static_cast<const char*>(newline) -
+                                                              start) + 1
+                                        : length - used;
+            if (headBytes + take > MAX_HEAD_SIZE) {
+                fail("response head too large");
+                return used;
+            }
+            // Only head and chunk framing lines are copied, never the body
+            line.append(start, take);
+            headBytes += take;
+            used += take;
+            if (newline) {
+                line.pop_back();
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                handleLine();
+                line.clear();
+            }
+            continue;
+        }
+
+        const size_t available = length - used;
+        size_t take = available;
+        if (state != State::BODY_UNTIL_CLOSE && remaining < available) {
+            take = static_cast<size_t>(remaining);
+        }
+        used += take;
+        if (!deliver(data + used - take, take)) {
+            return used;
+        }
+        if (state == State::BODY_UNTIL_CLOSE) {
+            continue;
+        }
+        remaining -= take;
+        if (remaining == 0) {
+            state = state == State::CHUNK_DATA ? State::CHUNK_END : State::COMPLETE;
+        }
+    }
+    return used;
+}
+
+void HttpResponseParser::finish() {
+    if (state == State::BODY_UNTIL_CLOSE) {
+        state = State::COMPLETE;
+    } else if (!done()) {
+        fail(status == 0 ? "connection closed before a response"
+                         : "connection closed before the end of the response");
+    }
+}
+
+void HttpResponseParser::handleLine() {
+    switch (state) {
+    case State::STATUS_LINE:
+        parseStatusLine();
+        break;
+    case State::HEADERS:
+        if (line.empty()) {
+            startBody();
+        } else {
+            parseHeaderLine();
+        }
+        break;
+    case State::CHUNK_SIZE:
+        parseChunkSize();
+        break;
+    case State::CHUNK_END:
+        if (!line.empty()) {
+            fail("malformed chunk: data longer than its size");
+            return;
+        }
+        headBytes = 0;
+        state = State::CHUNK_SIZE;
+        break;
+    case State::TRAILERS:
+        // Trailer fields carry nothing a check uses
+        if (line.empty()) {
+            state = State::COMPLETE;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void HttpResponseParser::parseStatusLine() {
+    // HTTP/1.x SP 3DIGIT SP reason
+    if (line.size() < 12 || line.compare(0, 7, "HTTP/1.") != 0 ||
+        !std::isdigit(static_cast<unsigned char>(line[7])) || line[8] != ' ' ||
+        !std::isdigit(static_cast<unsigned char>(line[9])) ||
+        !std::isdigit(static_cast<unsigned char>(line[10])) ||
+        !std::isdigit(static_cast<unsigned char>(line[11])) ||
+        (line.size() > 12 && line[12] != ' ')) {
+        fail("malformed status line");
+        return;
+    }
+    minorVersion = line[7] - '0';
+    status = (line[9] - '0') * 100 + (line[10] - '0') * 10 + (line[11] - '0');
+    reasonPhrase = line.size() > 13 ? line.substr(13) : "";
+    state = State::HEADERS;
+}
+
+void HttpResponseParser::parseHeaderLine() {
+    if (line[0] == ' ' || line[0] == '\t') {
+        // Obsolete line folding continues the previous field
+        if (fields.empty()) {
+            fail("malformed header field");
+            return;
+        }
+        fields.back().value += " " + trim(line);
+        return;
+    }
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos || colon == 0) {
+        fail("malformed header field");
+        return;
+    }
+    fields.push_back({line.substr(0, colon), trim(line.substr(colon + 1))});
+}
+
+void HttpResponseParser::startBody() {
+    if (status >= 100 && status < 200 && status != 101) {
+        // Interim response: the final one follows
+        BodyConsumer kept = std::move(consumer);
+        const bool headRequest = noBody;
+        *this = HttpResponseParser(std::move(kept));
+        noBody = headRequest;
+        return;
+    }
+
+    bool hasTransferEncoding = false;
+    bool hasLength = false;
+    unsigned long long contentLength = 0;
+    for (const HttpHeader& field : fields) {
+        if (equalsIgnoreCase(field.name, "transfer-encoding")) {
+            const std::vector<std::string> codings = listElements(field.value);
+            hasTransferEncoding = true;
+            isChunked = !codings.empty() && equalsIgnoreCase(codings.back(), "chunked");
+        } else if (equalsIgnoreCase(field.name, "content-length")) {
+            unsigned long long length = 0;
+            if (!parseDecimal(field.value, length) || (hasLength && length != contentLength)) {
+                fail("invalid Content-Length");
+                return;
+            }
+            hasLength = true;
+            contentLength = length;
+        } else if (equalsIgnoreCase(field.name, "connection")) {
+            for (const std::string& option : listElements(field.value)) {
+                closeRequested = closeRequested || equalsIgnoreCase(option, "close");
+                keepAliveOffered = keepAliveOffered || equalsIgnoreCase(option, "keep-alive");
+            }
+        }
+    }
+
+    headParsed = true;
+    headBytes = 0;
+    if (status == 101) {
+        // The connection now speaks another protocol
+        closeRequested = true;
+        state = State::COMPLETE;
+    } else if (noBody || status == 204 || status == 304) {
+        state = State::COMPLETE;
+    } else if (hasTransferEncoding) {
+        // Transfer-Encoding overrides Content-Length (RFC 9112 6.3)
+        if (isChunked) {
+            state = State::CHUNK_SIZE;
+        } else {
+            closeDelimited = true;
+            state = State::BODY_UNTIL_CLOSE;
+        }
+    } else if (hasLength) {
+        remaining = contentLength;
+        state = contentLength == 0 ? State::COMPLETE : State::BODY_LENGTH;
+    } else {
+        closeDelimited = true;
+        state = State::BODY_UNTIL_CLOSE;
+    }
+}
+
+void HttpResponseParser::parseChunkSize() {
+    // chunk-size [; extensions]
+    unsigned long long size = 0;
+    size_t i = 0;
+    for (; i < line.size(); i++) {
+        const int digit = hexDigit(line[i]);
+        if (digit < 0) {
+            break;
+        }
+        size = size * 16 + static_cast<unsigned long long>(digit);
+        if (size > MAX_CHUNK_SIZE) {
+            fail("chunk too large");
+            return;
+        }
+    }
+    if (i == 0 || (i < line.size() && line[i] != ';' && line[i] != ' ' && line[i] != '\t')) {
+        fail("malformed chunk size");
+        return;
+    }
+    headBytes = 0;
+    if (size == 0) {
+        state = State::TRAILERS;
+    } else {
+        remaining = size;
+        state = State::CHUNK_DATA;
+    }
+}
+
+bool HttpResponseParser::deliver(const char* data, size_t length) {
+    bodyLength += length;
+    if (consumer && length > 0 && !consumer(data, length)) {
+        fail("body consumer stopped");
+        return false;
+    }
+    return true;
+}
+
+void HttpResponseParser::fail(const std::string& what) {
+    failure = what;
+    state = State::FAILED;
+}
+
+} // namespace netmon_plugins
@@ -0,0 +1,262 @@
+// src/common/icmp.cpp
+// ICMP echo implementation
+
+#include "netmon/icmp.hpp"
+#include "netmon/phase_timings.hpp"
+#include "netmon/socket_io.hpp"
+#include "netmon/timer_wheel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <iphlpapi.h>
+#include <icmpapi.h>
+#pragma comment(lib, "iphlpapi.lib")
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/ip_icmp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace netmon_plugins {
+
+namespace {
+
+constexpr int CANCEL_POLL_SLICE_MS = 100;
+
+struct sockaddr_in resolveIPv4(const std::string& host, const CheckContext& context) {
+    AddressList addresses;
+    std::string error;
+    if (resolveAddresses(host, 0, context, addresses, error) != IoStatus::OK) {
+        throw std::runtime_error(error);
+    }
+    for (const ResolvedAddress& address : addresses) {
+        if (address.family == AF_INET && address.sockaddr.size() >= sizeof(struct sockaddr_in)) {
+            struct sockaddr_in destAddr;
+            memcpy(&destAddr, address.sockaddr.data(), sizeof(destAddr));
+            return destAddr;
+        }
+    }
+    throw std::runtime_error("No IPv4 address for " + host);
+}
+
+class RttTally {
+public:
+    void add(double rtt) {
+        if (stats.packetsReceived == 0 || rtt < stats.minRTT) stats.minRTT = rtt;
+        if (rtt > stats.maxRTT) stats.maxRTT = rtt;
+        stats.packetsReceived++;
+        total += rtt;
+    }
+
+    void sent() { stats.packetsSent++; }
+
+    EchoStats finish() {
+        if (stats.packetsReceived > 0) {
+            stats.avgRTT = total / stats.packetsReceived;
+        }
+        if (stats.packetsSent > 0) {
+            stats.packetLoss =
+                ((stats.packetsSent - stats.packetsReceived) * 100.0) / stats.packetsSent;
+        }
+        return stats;
+    }
+
+private:
+    EchoStats stats;
+    double total = 0.0;
+};
+
+#ifndef _WIN32
+// Distinct per ping so that concurrent checks in one process, which all
+// see every reply on their raw sockets, only count their own
+std::atomic<unsigned> echoSequence{0};
+
+uint16_t nextEchoId() {
+    return static_cast<uint16_t>(static_cast<unsigned>(getpid()) * 2654435761u +
+                                 echoSequence.fetch_add(1));
+}
+
+unsigned short in_cksum(const unsigned short* addr, int len) {
+    int nleft = len;
+    int sum = 0;
+    const unsigned short* w = addr;
+    unsigned short answer = 0;
+
+    while (nleft > 1) {
+        sum += *w++;
+        nleft -= 2;
+    }
+
+    if (nleft == 1) {
+        *(unsigned char*)(&answer) = *(const unsigned char*)w;
+        sum += answer;
+    }
+
+    sum = (sum >> 16) + (sum & 0xffff);
+    sum += (sum >> 16);
+    answer = ~sum;
+    return answer;
+}
+
+// Sequence number of an echo reply to one of ours, or -1
+int matchReply(const char* buffer, ssize_t length, uint16_t id, int count) {
+    if (length < 1) {
+        return -1;
+    }
+    // Raw sockets deliver the IP header too
+    const size_t headerLength = (static_cast<unsigned char>(buffer[0]) & 0x0f) * 4u;
+    if (static_cast<size_t>(length) < headerLength + ICMP_MINLEN) {
+        return -1;
+    }
+    struct icmp reply;
+    memcpy(&reply, buffer + headerLength, ICMP_MINLEN);
+    if (reply.icmp_type != ICMP_ECHOREPLY || ntohs(reply.icmp_id) != id) {
+        return -1;
+    }
+    const int seq = ntohs(reply.icmp_seq);
+    return seq < count ? seq : -1;
+}
+#endif
+
+} // namespace
+
+EchoStats pingEcho(const std::string& host, int count, std::chrono::milliseconds interval,
+                   std::chrono::milliseconds replyTimeout, const CheckContext& context) {
+    RttTally tally;
+    if (count <= 0) {
+        return tally.finish();
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+    struct sockaddr_in destAddr;
+    try {
+        destAddr = resolveIPv4(host, context);
+    } catch (...) {
+        WSACleanup();
+        throw;
+    }
+
+    HANDLE hIcmpFile = IcmpCreateFile();
+    if (hIcmpFile == INVALID_HANDLE_VALUE) {
+        WSACleanup();
+        throw std::runtime_error("Failed to create ICMP handle");
+    }
+
+    // IcmpSendEcho blocks for its reply, so requests go one at a time
+    char sendData[32] = "Data Buffer";
+    std::vector<char> replyBuffer(sizeof(ICMP_ECHO_REPLY) + sizeof(sendData));
+    for (int i = 0; i < count && !context.stopRequested(); i++) {
+        const auto wait = std::min(replyTimeout, context.deadline.remaining());
+        tally.sent();
+        DWORD dwRetVal = IcmpSendEcho(hIcmpFile, destAddr.sin_addr.S_un.S_addr, sendData,
+                                      sizeof(sendData), nullptr, replyBuffer.data(),
+                                      static_cast<DWORD>(replyBuffer.size()),
+                                      static_cast<DWORD>(wait.count()));
+        if (dwRetVal != 0) {
+            ICMP_ECHO_REPLY* echoReply = (ICMP_ECHO_REPLY*)replyBuffer.data();
+            if (echoReply->Status == 0) {
+                tally.add(echoReply->RoundTripTime);
+            }
+        }
+        if (i < count - 1) {
+            Sleep(static_cast<DWORD>(interval.count()));
+        }
+    }
+
+    IcmpCloseHandle(hIcmpFile);
+    WSACleanup();
+#else
+    const struct sockaddr_in destAddr = resolveIPv4(host, context);
+
+    int sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+    if (sock < 0) {
+        throw std::runtime_error("Failed to create ICMP socket (requires root privileges)");
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+    const uint16_t id = nextEchoId();
+    std::vector<CheckClock::time_point> sentAt(count);
+    std::vector<TimerId> replyTimers(count, NO_TIMER);   // Set while awaiting the reply
+    const CheckClock::time_point start = CheckClock::now();
+    TimerWheel wheel(std::chrono::milliseconds(1), start);
+
+    for (int i = 0; i < count; i++) {
+        wheel.schedule(start + interval * i, [&, i]() {
+            struct icmp packet;
+            memset(&packet, 0, sizeof(packet));
+            packet.icmp_type = ICMP_ECHO;
+            packet.icmp_code = 0;
+            packet.icmp_id = htons(id);
+            packet.icmp_seq = htons(static_cast<uint16_t>(i));
+            packet.icmp_cksum = 0;
+            packet.icmp_cksum = in_cksum((unsigned short*)&packet, sizeof(packet));
+
+            tally.sent();
+            sentAt[i] = CheckClock::now();
+            if (sendto(sock, &packet, sizeof(packet), 0,
+                       (const struct sockaddr*)&destAddr, sizeof(destAddr)) > 0) {
+                if (context.phases) {
+                    context.phases->addTraffic(0, sizeof(packet));
+                }
+                replyTimers[i] = wheel.schedule(sentAt[i] + replyTimeout, [&, i]() {
+                    replyTimers[i] = NO_TIMER;   // Lost
+                });
+            }
+        });
+    }
+
+    while (!wheel.empty() && !context.stopRequested()) {
+        const auto untilNext = std::chrono::duration_cast<std::chrono::milliseconds>(
+            wheel.nextExpiry() - CheckClock::now()).count() + 1;
+        const int timeout = static_cast<int>(std::max<long long>(
+            0, std::min<long long>(untilNext, context.deadline.pollTimeout(CANCEL_POLL_SLICE_MS))));
+
+        struct pollfd entry;
+        entry.fd = sock;
+        entry.events = POLLIN;
+        entry.revents = 0;
+        if (poll(&entry, 1, timeout) > 0 && (entry.revents & POLLIN)) {
+            char buffer[1024];
+            struct sockaddr_in fromAddr;
+            socklen_t fromLen = sizeof(fromAddr);
+            ssize_t length;
+            while ((length = recvfrom(sock, buffer, sizeof(buffer), 0,
+                                      (struct sockaddr*)&fromAddr, &fromLen)) > 0) {
+                const CheckClock::time_point received = CheckClock::now();
+                const int seq = matchReply(buffer, length, id, count);
+                if (seq >= 0 && fromAddr.sin_addr.s_addr == destAddr.sin_addr.s_addr &&
+                    wheel.cancel(replyTimers[seq])) {
+                    replyTimers[seq] = NO_TIMER;
+                    if (context.phases) {
+                        context.phases->addTraffic(static_cast<size_t>(length), 0);
+                    }
+                    tally.add(std::chrono::duration<double, std::milli>(
+                        received - sentAt[seq]).count());
+                }
+                fromLen = sizeof(fromAddr);
+            }
+        }
+        wheel.advance(CheckClock::now());
+    }
+
+    close(sock);
+#endif
+
+    return tally.finish();
+}
+
+} // namespace netmon_plugins
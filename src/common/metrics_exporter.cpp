@@ -0,0 +1,93 @@
+// src/common/metrics_exporter.cpp
+// Prometheus metrics exporter implementation
+
+#include "netmon/metrics_exporter.hpp"
+#include <utility>
+
+namespace netmon_plugins {
+
+namespace {
+
+void appendFamilyHeader(const std::string& family, std::string& out) {
+    if (family == "netmon_check_status") {
+        out += "# HELP netmon_check_status Plugin exit code "
+               "(0=OK, 1=WARNING, 2=CRITICAL, 3=UNKNOWN)\n";
+    } else if (family == "netmon_check_latency_seconds") {
+        out += "# HELP netmon_check_latency_seconds Duration of the last run of the check\n";
+    } else if (family.compare(0, 15, "netmon_perfdata") == 0) {
+        out += "# HELP " + family + " Perfdata of the last run of the check, by label\n";
+    }
+    const bool counter = family.size() > 6 &&
+                         family.compare(family.size() - 6, 6, "_total") == 0;
+    out += "# TYPE " + family + (counter ? " counter\n" : " gauge\n");
+}
+
+} // namespace
+
+void MetricsExporter::drop(const std::string& check) {
+    auto found = familiesOf.find(check);
+    if (found == familiesOf.end()) {
+        return;
+    }
+    for (const std::string& family : found->second) {
+        auto samples = families.find(family);
+        if (samples != families.end()) {
+            samples->second.erase(check);
+            if (samples->second.empty()) {
+                families.erase(samples);
+            }
+        }
+    }
+    familiesOf.erase(found);
+}
+
+void MetricsExporter::update(const ResultRecord& record) {
+    // Format outside the lock; scrapes only wait for the swap
+    std::map<std::string, std::string> rendered;
+    for (auto& sample : prometheusSamples(record)) {
+        std::string& lines = rendered[sample.first];
+        lines += sample.second;
+        lines += '\n';
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    drop(record.check);
+    std::vector<std::string>& owned = familiesOf[record.check];
+    for (auto& entry : rendered) {
+        owned.push_back(entry.first);
+        families[entry.first][record.check] = std::move(entry.second);
+    }
+    stale = true;
+}
+
+bool MetricsExporter::remove(const std::string& check) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (familiesOf.find(check) == familiesOf.end()) {
+        return false;
+    }
+    drop(check);
+    stale = true;
+    return true;
+}
+
+std::string MetricsExporter::render() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stale) {
+        page.clear();
+        for (const auto& family : families) {
+            appendFamilyHeader(family.first, page);
+            for (const auto& samples : family.second) {
+                page += samples.second;
+            }
+        }
+        stale = false;
+    }
+    return page;
+}
+
+size_t MetricsExporter::checks() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return familiesOf.size();
+}
+
+} // namespace netmon_plugins
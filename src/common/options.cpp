@@ -0,0 +1,336 @@
+// src/common/options.cpp
+// Table-driven command-line parsing and usage text
+
+#include "netmon/options.hpp"
+#include "netmon/plugin.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace netmon_plugins {
+namespace options_detail {
+
+namespace {
+
+template <typename Integer>
+bool parseInteger(const char* text, Integer& value) {
+    const char* end = text + std::strlen(text);
+    Integer parsed = 0;
+    const auto result = std::from_chars(text, end, parsed);
+    if (text == end || result.ec != std::errc() || result.ptr != end) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// "--port" if the option has a long name, else "-p"
+std::string optionName(const OptionSpec& spec) {
+    if (spec.longName) {
+        return std::string("--") + spec.longName;
+    }
+    return std::string("-") + spec.shortName;
+}
+
+void apply(const OptionSpec& spec, const char* value, void* target) {
+    bool valid;
+    try {
+        valid = spec.apply(target, value);
+    } catch (const std::invalid_argument& e) {
+        throw std::invalid_argument("invalid value for " + optionName(spec) + ": " + e.what());
+    }
+    if (!valid) {
+        throw std::invalid_argument("invalid value for " + optionName(spec) + ": '" +
+                                    std::string(value ? value : "") + "'");
+    }
+}
+
+bool definesHelp(const OptionSpec* const* table, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (table[i]->shortName == 'h' ||
+            (table[i]->longName && std::strcmp(table[i]->longName, "help") == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const OptionSpec* findLong(const OptionSpec* const* table, size_t count, const char* name,
+                           size_t length) {
+    for (size_t i = 0; i < count; i++) {
+        const char* longName = table[i]->longName;
+        if (longName && std::strlen(longName) == length &&
+            std::strncmp(longName, name, length) == 0) {
+            return table[i];
+        }
+    }
+    return nullptr;
+}
+
+const OptionSpec* findShort(const OptionSpec* const* table, size_t count, char name) {
+    for (size_t i = 0; i < count; i++) {
+        if (table[i]->shortName == name) {
+            return table[i];
+        }
+    }
+    return nullptr;
+}
+
+const OptionSpec* findPositional(const OptionSpec* const* table, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (table[i]->isPositional()) {
+            return table[i];
+        }
+    }
+    return nullptr;
+}
+
+// "  -H, --hostname HOST" without the help text
+std::string optionColumn(const OptionSpec& spec) {
+    std::string column = "  ";
+    if (spec.isPositional()) {
+        return column + spec.valueName;
+    }
+    if (spec.shortName != '\0') {
+        column += '-';
+        column += spec.shortName;
+        column += spec.longName ? ", " : "";
+    } else {
+        column += "    ";
+    }
+    if (spec.longName) {
+        column += "--";
+        column += spec.longName;
+    }
+    if (spec.valueName) {
+        column += ' ';
+        column += spec.valueName;
+    }
+    return column;
+}
+
+} // namespace
+
+bool parseValue(const char* text, int& value) {
+    return parseInteger(text, value);
+}
+
+bool parseValue(const char* text, long long& value) {
+    return parseInteger(text, value);
+}
+
+bool parseValue(const char* text, double& value) {
+    if (*text == '\0' || std::isspace(static_cast<unsigned char>(*text))) {
+        return false;
+    }
+    char* end = nullptr;
+    const double parsed = std::strtod(text, &end);
+    if (*end != '\0' || !std::isfinite(parsed)) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool parseValue(const char* text, std::string& value) {
+    value = text;
+    return true;
+}
+
+bool parseValue(const char* text, ThresholdRange& value) {
+    return ThresholdRange::tryParse(text, value);
+}
+
+bool parseValue(const char* text, std::vector<std::string>& value) {
+    value.emplace_back(text);
+    return true;
+}
+
+void describeValue(int value, std::string& out) {
+    if (value > 0) {
+        out += std::to_string(value);
+    }
+}
+
+void describeValue(long long value, std::string& out) {
+    if (value > 0) {
+        out += std::to_string(value);
+    }
+}
+
+void describeValue(double value, std::string& out) {
+    if (value > 0) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%g", value);
+        out += text;
+    }
+}
+
+void describeValue(const std::string& value, std::string& out) {
+    out += value;
+}
+
+void describeValue(const ThresholdRange& value, std::string& out) {
+    out += value.toString();
+}
+
+// Split a command line into options and their values, calling
+// visit(spec, value) for each in order; value is nullptr for a flag
+template <typename Visitor>
+void visitOptions(const OptionSpec* const* table, size_t count,
+                  const std::vector<std::string>& args, Visitor visit) {
+    const bool ownHelp = !definesHelp(table, count);
+    const OptionSpec* positional = findPositional(table, count);
+    bool optionsEnded = false;
+
+    for (size_t i = 1; i < args.size(); i++) {
+        const char* arg = args[i].c_str();
+        const OptionSpec* spec = nullptr;
+        const char* value = nullptr;   // Attached: --port=80 or -p80
+
+        if (optionsEnded || arg[0] != '-' || arg[1] == '\0') {
+            if (!positional) {
+                throw std::invalid_argument("unexpected argument '" + args[i] + "'");
+            }
+            visit(*positional, arg);
+            continue;
+        }
+        if (arg[1] == '-') {
+            if (arg[2] == '\0') {
+                optionsEnded = true;
+                continue;
+            }
+            const char* name = arg + 2;
+            const char* equals = std::strchr(name, '=');
+            const size_t length = equals ? static_cast<size_t>(equals - name) : std::strlen(name);
+            spec = findLong(table, count, name, length);
+            if (!spec && ownHelp && length == 4 && std::strncmp(name, "help", 4) == 0) {
+                throw HelpRequested();
+            }
+            if (!spec) {
+                throw std::invalid_argument("unknown option '" +
+                                            std::string(arg, name + length) + "'");
+            }
+            value = equals ? equals + 1 : nullptr;
+        } else {
+            spec = findShort(table, count, arg[1]);
+            if (!spec && ownHelp && arg[1] == 'h' && arg[2] == '\0') {
+                throw HelpRequested();
+            }
+            if (!spec) {
+                throw std::invalid_argument("unknown option '" + args[i] + "'");
+            }
+            value = arg[2] != '\0' ? arg + 2 : nullptr;
+        }
+
+        if (!spec->valueName) {
+            if (value) {
+                throw std::invalid_argument("option " + optionName(*spec) + " takes no value");
+            }
+            visit(*spec, nullptr);
+            continue;
+        }
+        if (!value) {
+            if (i + 1 >= args.size()) {
+                throw std::invalid_argument("option " + optionName(*spec) + " requires " +
+                                            spec->valueName);
+            }
+            value = args[++i].c_str();
+        }
+        visit(*spec, value);
+    }
+}
+
+void parseOptionTable(const OptionSpec* const* table, size_t count,
+                      const std::vector<std::string>& args, void* target) {
+    visitOptions(table, count, args, [target](const OptionSpec& spec, const char* value) {
+        apply(spec, value, target);
+    });
+}
+
+std::vector<std::string> canonicalOptionTable(const OptionSpec* const* table, size_t count,
+                                              const std::vector<std::string>& args) {
+    struct Given {
+        size_t rank;   // Table position of a value option; count for the others
+        const OptionSpec* spec;
+        const char* value;
+    };
+    std::vector<Given> given;
+    visitOptions(table, count, args, [&](const OptionSpec& spec, const char* value) {
+        size_t rank = count;
+        if (spec.describeDefault) {
+            rank = static_cast<size_t>(std::find(table, table + count, &spec) - table);
+        }
+        given.push_back({rank, &spec, value});
+    });
+    std::stable_sort(given.begin(), given.end(),
+                     [](const Given& a, const Given& b) { return a.rank < b.rank; });
+
+    std::vector<std::string> canonical;
+    canonical.push_back(args.empty() ? std::string() : args[0]);
+    std::vector<std::string> positionals;
+    for (const Given& entry : given) {
+        if (entry.spec->isPositional()) {
+            positionals.emplace_back(entry.value);
+            continue;
+        }
+        canonical.push_back(optionName(*entry.spec));
+        if (entry.value) {
+            canonical.emplace_back(entry.value);
+        }
+    }
+    if (!positionals.empty()) {
+        canonical.emplace_back("--");
+        canonical.insert(canonical.end(), positionals.begin(), positionals.end());
+    }
+    return canonical;
+}
+
+std::string formatOptionTable(const char* synopsis, const OptionSpec* const* table,
+                              size_t count, const void* defaults) {
+    static const OptionSpec HELP = {'h', "help", nullptr, "Show this help message", nullptr,
+                                    nullptr};
+    const OptionSpec* help = definesHelp(table, count) ? nullptr : &HELP;
+
+    size_t width = 0;
+    for (size_t i = 0; i < count; i++) {
+        width = std::max(width, optionColumn(*table[i]).size());
+    }
+    if (help) {
+        width = std::max(width, optionColumn(*help).size());
+    }
+    width += 2;
+
+    std::string text = "Usage: ";
+    text += synopsis;
+    text += "\nOptions:";
+    auto appendLine = [&](const OptionSpec& spec) {
+        std::string column = optionColumn(spec);
+        column.resize(width, ' ');
+        text += '\n';
+        text += column;
+        text += spec.help;
+        std::string value;
+        if (spec.describeDefault) {
+            spec.describeDefault(defaults, value);
+        }
+        if (!value.empty()) {
+            text += " (default: " + value + ")";
+        }
+    };
+    for (size_t i = 0; i < count; i++) {
+        appendLine(*table[i]);
+    }
+    if (help) {
+        appendLine(*help);
+    }
+    return text;
+}
+
+} // namespace options_detail
+} // namespace netmon_plugins
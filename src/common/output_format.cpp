@@ -0,0 +1,441 @@
+// src/common/output_format.cpp
+// Check result encoder implementation
+
+#include "netmon/output_format.hpp"
+#include "netmon/plugin.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <utility>
+
+namespace netmon_plugins {
+
+namespace {
+
+const uint8_t BINARY_VERSION = 1;
+
+enum BinaryFlags : uint8_t {
+    HAS_WARN = 1,
+    HAS_CRIT = 2,
+    HAS_MIN = 4,
+    HAS_MAX = 8
+};
+
+std::string statusName(int exitCode) {
+    if (exitCode < 0 || exitCode > 3) {
+        return "UNKNOWN";
+    }
+    return exitCodeToString(static_cast<ExitCode>(exitCode));
+}
+
+int64_t unixMicros(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+// JSON
+
+void appendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+                out += escape;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+void appendJsonNumber(std::string& out, double value) {
+    out += std::isfinite(value) ? formatNumber(value) : "null";
+}
+
+void encodeJson(const ResultRecord& record, std::string& out) {
+    out += "{\"check\":";
+    appendJsonString(out, record.check);
+    out += ",\"status\":";
+    appendJsonString(out, statusName(record.exitCode));
+    out += ",\"exit_code\":" + std::to_string(record.exitCode);
+    out += ",\"message\":";
+    appendJsonString(out, record.message);
+    out += ",\"latency_ms\":";
+    appendJsonNumber(out, static_cast<double>(record.latency.count()) / 1e3);
+    out += ",\"timestamp\":";
+    appendJsonNumber(out, static_cast<double>(unixMicros(record.timestamp)) / 1e6);
+    out += ",\"metrics\":[";
+    for (size_t i = 0; i < record.metrics.size(); i++) {
+        const PerfMetric& metric = record.metrics[i];
+        out += i == 0 ? "{\"label\":" : ",{\"label\":";
+        appendJsonString(out, metric.label);
+        out += ",\"value\":";
+        appendJsonNumber(out, metric.value);
+        if (!metric.unit.empty()) {
+            out += ",\"unit\":";
+            appendJsonString(out, metric.unit);
+        }
+        if (!metric.warn.empty()) {
+            out += ",\"warn\":";
+            appendJsonString(out, metric.warn);
+        }
+        if (!metric.crit.empty()) {
+            out += ",\"crit\":";
+            appendJsonString(out, metric.crit);
+        }
+        if (metric.hasMin) {
+            out += ",\"min\":";
+            appendJsonNumber(out, metric.min);
+        }
+        if (metric.hasMax) {
+            out += ",\"max\":";
+            appendJsonNumber(out, metric.max);
+        }
+        out += '}';
+    }
+    out += "]}\n";
+}
+
+// Prometheus
+
+// Family name suffix and scale factor to the base unit
+void prometheusUnit(const std::string& unit, std::string& suffix, double& scale) {
+    static const std::map<std::string, std::pair<const char*, double>> units = {
+        {"s", {"_seconds", 1.0}},
+        {"ms", {"_seconds", 1e-3}},
+        {"us", {"_seconds", 1e-6}},
+        {"B", {"_bytes", 1.0}},
+        {"KB", {"_bytes", 1024.0}},
+        {"MB", {"_bytes", 1024.0 * 1024}},
+        {"GB", {"_bytes", 1024.0 * 1024 * 1024}},
+        {"TB", {"_bytes", 1024.0 * 1024 * 1024 * 1024}},
+        {"%", {"_percent", 1.0}},
+        {"c", {"_total", 1.0}}
+    };
+    auto it = units.find(unit);
+    suffix = it == units.end() ? "" : it->second.first;
+    scale = it == units.end() ? 1.0 : it->second.second;
+}
+
+std::string prometheusLabelValue(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+std::string prometheusValue(double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    return formatNumber(value);
+}
+
+// InfluxDB line protocol
+
+std::string influxEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == ',' || c == '=' || c == ' ') {
+            out += '\\';
+        }
+        out += c == '\n' ? ' ' : c;
+    }
+    return out;
+}
+
+void encodeInflux(const ResultRecord& record, std::string& out) {
+    out += "netmon,check=" + influxEscape(record.check);
+    out += " exit_code=" + std::to_string(record.exitCode) + "i";
+    out += ",latency=" + formatNumber(static_cast<double>(record.latency.count()) / 1e6);
+    out += ",message=\"";
+    for (char c : record.message) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c == '\n' ? ' ' : c;   // A newline would end the line
+    }
+    out += '"';
+    for (const PerfMetric& metric : record.metrics) {
+        if (std::isfinite(metric.value)) {   // The protocol has no NaN
+            out += "," + influxEscape(metric.label) + "=" + formatNumber(metric.value);
+        }
+    }
+    out += " " + std::to_string(unixMicros(record.timestamp) * 1000) + "\n";
+}
+
+// Binary
+
+void putInt(std::string& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+void putDouble(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putInt(out, bits, 8);
+}
+
+void putString(std::string& out, const std::string& text, int lengthBytes) {
+    const size_t limit = lengthBytes == 1 ? 0xff : 0xffff;
+    const size_t length = text.size() < limit ? text.size() : limit;
+    putInt(out, length, lengthBytes);
+    out.append(text, 0, length);
+}
+
+void encodeBinary(const ResultRecord& record, std::string& out) {
+    std::string body;
+    putInt(body, BINARY_VERSION, 1);
+    putInt(body, static_cast<uint8_t>(record.exitCode), 1);
+    putString(body, record.check, 2);
+    putString(body, record.message, 2);
+    putInt(body, static_cast<uint64_t>(unixMicros(record.timestamp)), 8);
+    putInt(body, static_cast<uint32_t>(record.latency.count()), 4);
+    putInt(body, record.metrics.size() < 0xffff ? record.metrics.size() : 0xffff, 2);
+    for (size_t i = 0; i < record.metrics.size() && i < 0xffff; i++) {
+        const PerfMetric& metric = record.metrics[i];
+        putString(body, metric.label, 1);
+        putString(body, metric.unit, 1);
+        putDouble(body, metric.value);
+        uint8_t flags = (metric.warn.empty() ? 0 : HAS_WARN) | (metric.crit.empty() ? 0 : HAS_CRIT) |
+                        (metric.hasMin ? HAS_MIN : 0) | (metric.hasMax ? HAS_MAX : 0);
+        putInt(body, flags, 1);
+        if (flags & HAS_WARN) {
+            putString(body, metric.warn, 1);
+        }
+        if (flags & HAS_CRIT) {
+            putString(body, metric.crit, 1);
+        }
+        if (flags & HAS_MIN) {
+            putDouble(body, metric.min);
+        }
+        if (flags & HAS_MAX) {
+            putDouble(body, metric.max);
+        }
+    }
+    putInt(out, body.size(), 4);
+    out += body;
+}
+
+// Bounds-checked little-endian reader over one record
+class BinaryReader {
+public:
+    BinaryReader(const char* bytes, size_t length) : data(bytes), size(length) {}
+
+    bool getInt(uint64_t& value, int bytes) {
+        if (size - offset < static_cast<size_t>(bytes)) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(data[offset++])) << (8 * i);
+        }
+        return true;
+    }
+
+    bool getDouble(double& value) {
+        uint64_t bits;
+        if (!getInt(bits, 8)) {
+            return false;
+        }
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+    bool getString(std::string& text, int lengthBytes) {
+        uint64_t length;
+        if (!getInt(length, lengthBytes) || size - offset < length) {
+            return false;
+        }
+        text.assign(data + offset, static_cast<size_t>(length));
+        offset += static_cast<size_t>(length);
+        return true;
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t offset = 0;
+};
+
+} // namespace
+
+std::vector<std::pair<std::string, std::string>> prometheusSamples(const ResultRecord& record) {
+    std::vector<std::pair<std::string, std::string>> samples;
+    const std::string labels = "{check=\"" + prometheusLabelValue(record.check) + "\"}";
+    samples.emplace_back("netmon_check_status",
+                         "netmon_check_status" + labels + " " + std::to_string(record.exitCode));
+    samples.emplace_back("netmon_check_latency_seconds",
+                         "netmon_check_latency_seconds" + labels + " " +
+                         prometheusValue(static_cast<double>(record.latency.count()) / 1e6));
+    // Perfdata labels are free text and differ per plugin, so they go in a
+    // label of one family per unit rather than into metric names
+    const std::string checkLabel = "{check=\"" + prometheusLabelValue(record.check) + "\"";
+    for (const PerfMetric& metric : record.metrics) {
+        std::string suffix;
+        double scale;
+        prometheusUnit(metric.unit, suffix, scale);
+        const std::string family = "netmon_perfdata" + suffix;
+        std::string line = family + checkLabel + ",label=\"" +
+                           prometheusLabelValue(metric.label) + "\"";
+        if (suffix.empty() && !metric.unit.empty()) {
+            line += ",unit=\"" + prometheusLabelValue(metric.unit) + "\"";
+        }
+        line += "} " + prometheusValue(metric.value * scale);
+        samples.emplace_back(family, std::move(line));
+    }
+    return samples;
+}
+
+bool parseOutputFormat(const std::string& name, OutputFormat& format) {
+    static const std::map<std::string, OutputFormat> formats = {
+        {"nagios", OutputFormat::NAGIOS},
+        {"json", OutputFormat::JSON},
+        {"prometheus", OutputFormat::PROMETHEUS},
+        {"influx", OutputFormat::INFLUX},
+        {"binary", OutputFormat::BINARY}
+    };
+    auto it = formats.find(name);
+    if (it == formats.end()) {
+        return false;
+    }
+    format = it->second;
+    return true;
+}
+
+std::string outputFormatToString(OutputFormat format) {
+    switch (format) {
+    case OutputFormat::NAGIOS:     return "nagios";
+    case OutputFormat::JSON:       return "json";
+    case OutputFormat::PROMETHEUS: return "prometheus";
+    case OutputFormat::INFLUX:     return "influx";
+    case OutputFormat::BINARY:     return "binary";
+    }
+    return "nagios";
+}
+
+void encodeResult(OutputFormat format, const ResultRecord& record, std::string& out) {
+    switch (format) {
+    case OutputFormat::NAGIOS: {
+        out += statusName(record.exitCode) + ": " + record.message;
+        std::string perfdata = formatPerfdata(record.metrics);
+        if (!perfdata.empty()) {
+            out += " | " + perfdata;
+        }
+        out += '\n';
+        break;
+    }
+    case OutputFormat::JSON:
+        encodeJson(record, out);
+        break;
+    case OutputFormat::PROMETHEUS:
+        for (const auto& sample : prometheusSamples(record)) {
+            out += sample.second + "\n";
+        }
+        break;
+    case OutputFormat::INFLUX:
+        encodeInflux(record, out);
+        break;
+    case OutputFormat::BINARY:
+        encodeBinary(record, out);
+        break;
+    }
+}
+
+void encodeResults(OutputFormat format, const std::vector<ResultRecord>& records,
+                   std::string& out) {
+    if (format != OutputFormat::PROMETHEUS) {
+        for (const ResultRecord& record : records) {
+            encodeResult(format, record, out);
+        }
+        return;
+    }
+
+    // Families in order of first appearance, each with all its samples
+    std::vector<std::pair<std::string, std::string>> families;
+    std::map<std::string, size_t> index;
+    for (const ResultRecord& record : records) {
+        for (auto& sample : prometheusSamples(record)) {
+            auto found = index.find(sample.first);
+            if (found == index.end()) {
+                index.emplace(sample.first, families.size());
+                families.emplace_back(sample.first, sample.second + "\n");
+            } else {
+                families[found->second].second += sample.second + "\n";
+            }
+        }
+    }
+    for (const auto& family : families) {
+        out += family.second;
+    }
+}
+
+bool decodeBinaryResult(const char* data, size_t size, ResultRecord& record, size_t& consumed) {
+    BinaryReader header(data, size);
+    uint64_t length;
+    if (!header.getInt(length, 4) || size - 4 < length) {
+        return false;
+    }
+
+    BinaryReader reader(data + 4, static_cast<size_t>(length));
+    uint64_t version, exitCode, timestamp, latency, count;
+    if (!reader.getInt(version, 1) || version != BINARY_VERSION ||
+        !reader.getInt(exitCode, 1) ||
+        !reader.getString(record.check, 2) ||
+        !reader.getString(record.message, 2) ||
+        !reader.getInt(timestamp, 8) ||
+        !reader.getInt(latency, 4) ||
+        !reader.getInt(count, 2)) {
+        return false;
+    }
+    record.exitCode = static_cast<int>(exitCode);
+    record.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::microseconds(static_cast<int64_t>(timestamp))));
+    record.latency = std::chrono::microseconds(latency);
+
+    record.metrics.clear();
+    for (uint64_t i = 0; i < count; i++) {
+        PerfMetric metric;
+        uint64_t flags;
+        if (!reader.getString(metric.label, 1) || !reader.getString(metric.unit, 1) ||
+            !reader.getDouble(metric.value) || !reader.getInt(flags, 1)) {
+            return false;
+        }
+        if (((flags & HAS_WARN) && !reader.getString(metric.warn, 1)) ||
+            ((flags & HAS_CRIT) && !reader.getString(metric.crit, 1)) ||
+            ((flags & HAS_MIN) && !reader.getDouble(metric.min)) ||
+            ((flags & HAS_MAX) && !reader.getDouble(metric.max))) {
+            return false;
+        }
+        metric.hasMin = (flags & HAS_MIN) != 0;
+        metric.hasMax = (flags & HAS_MAX) != 0;
+        record.metrics.push_back(std::move(metric));
+    }
+    consumed = static_cast<size_t>(4 + length);
+    return true;
+}
+
+} // namespace netmon_plugins
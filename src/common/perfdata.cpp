@@ -0,0 +1,240 @@
+// src/common/perfdata.cpp
+// Performance data parsing and formatting
+
+#include "netmon/perfdata.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+namespace netmon_plugins {
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Parse a number at the start of text; end points past it
+bool parseNumber(const std::string& text, double& value, size_t& end) {
+    if (text.compare(0, 1, "U") == 0) {
+        value = std::numeric_limits<double>::quiet_NaN();
+        end = 1;
+        return true;
+    }
+    const char* start = text.c_str();
+    char* stop = nullptr;
+    value = std::strtod(start, &stop);
+    end = static_cast<size_t>(stop - start);
+    return end > 0;
+}
+
+bool parseOptionalNumber(const std::string& text, bool& present, double& value) {
+    present = false;
+    if (text.empty()) {
+        return true;
+    }
+    size_t end = 0;
+    if (!parseNumber(text, value, end) || end != text.size()) {
+        return false;
+    }
+    present = true;
+    return true;
+}
+
+// Split "value[UOM];warn;crit;min;max" into its fields
+bool parseField(const std::string& data, PerfMetric& metric) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    for (;;) {
+        size_t semicolon = data.find(';', start);
+        parts.push_back(data.substr(start, semicolon - start));
+        if (semicolon == std::string::npos) {
+            break;
+        }
+        start = semicolon + 1;
+    }
+    if (parts.size() > 5) {
+        return false;
+    }
+
+    size_t end = 0;
+    if (!parseNumber(parts[0], metric.value, end)) {
+        return false;
+    }
+    metric.unit = parts[0].substr(end);
+    for (char c : metric.unit) {
+        if (!std::isalpha(static_cast<unsigned char>(c)) && c != '%') {
+            return false;
+        }
+    }
+    metric.warn = parts.size() > 1 ? parts[1] : "";
+    metric.crit = parts.size() > 2 ? parts[2] : "";
+    return parseOptionalNumber(parts.size() > 3 ? parts[3] : "", metric.hasMin, metric.min) &&
+           parseOptionalNumber(parts.size() > 4 ? parts[4] : "", metric.hasMax, metric.max);
+}
+
+bool needsQuotes(const std::string& label) {
+    for (char c : label) {
+        if (c == ' ' || c == '=' || c == '\'') {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+PerfMetric& PerfMetric::thresholds(const std::string& warning, const std::string& critical) {
+    warn = warning;
+    crit = critical;
+    return *this;
+}
+
+PerfMetric& PerfMetric::thresholds(double warning, double critical) {
+    return thresholds(formatPerfValue(warning), formatPerfValue(critical));
+}
+
+PerfMetric& PerfMetric::thresholds(const Thresholds& limits) {
+    return thresholds(limits.warning.toString(), limits.critical.toString());
+}
+
+PerfMetric& PerfMetric::minimum(double low) {
+    hasMin = true;
+    min = low;
+    return *this;
+}
+
+PerfMetric& PerfMetric::maximum(double high) {
+    hasMax = true;
+    max = high;
+    return *this;
+}
+
+bool parsePerfdata(const std::string& text, PerfMetrics& metrics) {
+    bool clean = true;
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && isSpace(text[i])) {
+            i++;
+        }
+        if (i == text.size()) {
+            break;
+        }
+
+        // Label: bare up to '=', or single-quoted with '' for a quote
+        PerfMetric metric;
+        bool labelOk = true;
+        if (text[i] == '\'') {
+            i++;
+            for (;;) {
+                if (i >= text.size()) {
+                    labelOk = false;
+                    break;
+                }
+                if (text[i] == '\'') {
+                    if (i + 1 < text.size() && text[i + 1] == '\'') {
+                        metric.label += '\'';
+                        i += 2;
+                        continue;
+                    }
+                    i++;
+                    break;
+                }
+                metric.label += text[i++];
+            }
+        } else {
+            while (i < text.size() && text[i] != '=' && !isSpace(text[i])) {
+                metric.label += text[i++];
+            }
+        }
+
+        size_t fieldEnd = i;
+        while (fieldEnd < text.size() && !isSpace(text[fieldEnd])) {
+            fieldEnd++;
+        }
+        if (labelOk && !metric.label.empty() && i < text.size() && text[i] == '=' &&
+            parseField(text.substr(i + 1, fieldEnd - i - 1), metric)) {
+            metrics.push_back(std::move(metric));
+        } else {
+            clean = false;
+        }
+        i = fieldEnd;
+    }
+    return clean;
+}
+
+// Plain decimal, trailing zeros trimmed: "0.25", "1024", "0.000013"
+std::string formatPerfValue(double value) {
+    if (!std::isfinite(value)) {
+        return formatNumber(value);
+    }
+    char text[400];
+    std::snprintf(text, sizeof(text), "%.6f", value);
+    std::string out = text;
+    size_t last = out.find_last_not_of('0');
+    if (out[last] == '.') {
+        last--;
+    }
+    out.erase(last + 1);
+    return out == "-0" ? "0" : out;
+}
+
+std::string formatNumber(double value) {
+    if (std::isnan(value)) {
+        return "nan";
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.15g", value);
+    if (std::strtod(text, nullptr) != value) {
+        std::snprintf(text, sizeof(text), "%.17g", value);
+    }
+    return text;
+}
+
+void appendPerfdata(std::string& out, const PerfMetrics& metrics) {
+    for (size_t i = 0; i < metrics.size(); i++) {
+        const PerfMetric& metric = metrics[i];
+        if (i > 0) {
+            out += ' ';
+        }
+        if (needsQuotes(metric.label)) {
+            out += '\'';
+            for (char c : metric.label) {
+                out += c;
+                if (c == '\'') {
+                    out += '\'';
+                }
+            }
+            out += '\'';
+        } else {
+            out += metric.label;
+        }
+        out += '=';
+        out += std::isnan(metric.value) ? "U" : formatPerfValue(metric.value);
+        out += metric.unit;
+
+        // Trailing empty fields are dropped: "a=1;;5" not "a=1;;5;;"
+        std::string tail[4] = {metric.warn, metric.crit,
+                               metric.hasMin ? formatPerfValue(metric.min) : "",
+                               metric.hasMax ? formatPerfValue(metric.max) : ""};
+        int last = 3;
+        while (last >= 0 && tail[last].empty()) {
+            last--;
+        }
+        for (int field = 0; field <= last; field++) {
+            out += ';';
+            out += tail[field];
+        }
+    }
+}
+
+std::string formatPerfdata(const PerfMetrics& metrics) {
+    std::string out;
+    appendPerfdata(out, metrics);
+    return out;
+}
+
+} // namespace netmon_plugins
@@ -0,0 +1,62 @@
+// src/common/phase_timings.cpp
+// Per-phase latency implementation
+
+#include "netmon/phase_timings.hpp"
+
+namespace netmon_plugins {
+
+namespace {
+
+double seconds(std::chrono::microseconds value) {
+    return static_cast<double>(value.count()) / 1e6;
+}
+
+} // namespace
+
+void PhaseTimings::appendMetrics(PerfMetrics& metrics) const {
+    const struct {
+        Phase phase;
+        const char* label;
+        std::chrono::microseconds value;
+    } phases[] = {{DNS, "dns_time", dns}, {CONNECT, "connect_time", connect},
+                  {TLS, "tls_time", tls}, {FIRST_BYTE, "ttfb", firstByte}};
+    for (const auto& phase : phases) {
+        if (recorded & phase.phase) {
+            metrics.emplace_back(phase.label, seconds(phase.value), "s");
+        }
+    }
+    metrics.emplace_back("total_time", seconds(total), "s");
+}
+
+void PhaseRecorder::record(const PhaseTimings& timings) {
+    dnsUs.fetch_add(timings.dns.count(), std::memory_order_relaxed);
+    connectUs.fetch_add(timings.connect.count(), std::memory_order_relaxed);
+    tlsUs.fetch_add(timings.tls.count(), std::memory_order_relaxed);
+    firstByteUs.fetch_add(timings.firstByte.count(), std::memory_order_relaxed);
+    recordedPhases.fetch_or(timings.recorded, std::memory_order_relaxed);
+    if (timings.reused) {
+        reusedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    count.fetch_add(1, std::memory_order_release);
+}
+
+PhaseTimings PhaseRecorder::summary(std::chrono::microseconds checkTime) const {
+    PhaseTimings timings;
+    timings.dns = std::chrono::microseconds(dnsUs.load(std::memory_order_relaxed));
+    timings.connect = std::chrono::microseconds(connectUs.load(std::memory_order_relaxed));
+    timings.tls = std::chrono::microseconds(tlsUs.load(std::memory_order_relaxed));
+    timings.firstByte = std::chrono::microseconds(firstByteUs.load(std::memory_order_relaxed));
+    timings.total = checkTime;
+    timings.recorded = recordedPhases.load(std::memory_order_relaxed);
+    return timings;
+}
+
+void appendPhasePerfdata(PerfMetrics& perfdata, const PhaseRecorder& recorder,
+                         std::chrono::microseconds checkTime) {
+    if (recorder.connections() == 0) {
+        return;
+    }
+    recorder.summary(checkTime).appendMetrics(perfdata);
+}
+
+} // namespace netmon_plugins
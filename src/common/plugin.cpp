@@ -2,11 +2,84 @@
 // Implementation of common plugin utilities
 
 #include "netmon/plugin.hpp"
+#include "netmon/deadline.hpp"
+#include "netmon/phase_timings.hpp"
+#include "netmon/result_cache.hpp"
+#include <chrono>
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#include <stdexcept>
 
 namespace netmon_plugins {
 
+std::shared_ptr<const CheckConfig> Plugin::parseConfig(
+    const std::vector<std::string>& /*args*/) const {
+    return nullptr;
+}
+
+PluginResult Plugin::check(const CheckConfig& /*config*/) const {
+    throw std::logic_error("plugin does not support re-entrant checks");
+}
+
+std::vector<std::string> Plugin::canonicalArguments(const std::vector<std::string>& args) const {
+    return args;
+}
+
+PluginRegistry& PluginRegistry::instance() {
+    static PluginRegistry registry;
+    return registry;
+}
+
+bool PluginRegistry::add(const PluginInfo& info) {
+    return plugins.emplace(info.name, info).second;
+}
+
+const PluginInfo* PluginRegistry::find(const std::string& name) const {
+    auto it = plugins.find(name);
+    return it == plugins.end() ? nullptr : &it->second;
+}
+
+std::unique_ptr<Plugin> PluginRegistry::create(const std::string& name) const {
+    const PluginInfo* info = find(name);
+    if (!info) {
+        return nullptr;
+    }
+    return info->factory();
+}
+
+bool PluginRegistry::contains(const std::string& name) const {
+    return plugins.find(name) != plugins.end();
+}
+
+std::vector<std::string> PluginRegistry::names() const {
+    std::vector<std::string> result;
+    result.reserve(plugins.size());
+    for (const auto& entry : plugins) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+std::vector<const PluginInfo*> PluginRegistry::list() const {
+    std::vector<const PluginInfo*> result;
+    result.reserve(plugins.size());
+    for (const auto& entry : plugins) {
+        result.push_back(&entry.second);
+    }
+    return result;
+}
+
+std::vector<const PluginInfo*> PluginRegistry::list(PluginCategory category) const {
+    std::vector<const PluginInfo*> result;
+    for (const auto& entry : plugins) {
+        if (entry.second.category == category) {
+            result.push_back(&entry.second);
+        }
+    }
+    return result;
+}
+
 std::string exitCodeToString(ExitCode code) {
     switch (code) {
         case ExitCode::OK:
@@ -22,27 +95,228 @@ std::string exitCodeToString(ExitCode code) {
     }
 }
 
-void printResult(const PluginResult& result) {
-    std::cout << exitCodeToString(result.code) << ": " << result.message;
+std::string categoryToString(PluginCategory category) {
+    switch (category) {
+        case PluginCategory::System:
+            return "system";
+        case PluginCategory::Network:
+            return "network";
+        case PluginCategory::Database:
+            return "database";
+        case PluginCategory::Application:
+            return "application";
+        case PluginCategory::Hardware:
+            return "hardware";
+        case PluginCategory::Specialized:
+            return "specialized";
+        case PluginCategory::Utility:
+            return "utility";
+        default:
+            return "unknown";
+    }
+}
+
+std::string formatResult(const PluginResult& result) {
+    std::string line = exitCodeToString(result.code) + ": " + result.message;
     if (!result.perfdata.empty()) {
-        std::cout << " | " << result.perfdata;
+        line += " | ";
+        appendPerfdata(line, result.perfdata);
     }
-    std::cout << std::endl;
+    return line;
+}
+
+void printResult(const PluginResult& result) {
+    std::cout << formatResult(result) << std::endl;
 }
 
 int executePlugin(Plugin& plugin) {
+    return executePlugin(plugin, OutputFormat::NAGIOS, "");
+}
+
+namespace {
+
+// Run a plugin once; threw is set when the result stands for an exception
+ResultRecord runPluginOnce(Plugin& plugin, const std::string& checkName, bool& threw) {
+    const CheckContext context(Deadline(), CancellationToken(), std::make_shared<PhaseRecorder>());
+    ScopedCheckContext scope(context);
+    const CheckClock::time_point started = CheckClock::now();
+    PluginResult result;
+    threw = false;
     try {
-        PluginResult result = plugin.check();
-        printResult(result);
-        return static_cast<int>(result.code);
+        result = plugin.check();
+        appendPhasePerfdata(result.perfdata, *context.phases,
+                            std::chrono::duration_cast<std::chrono::microseconds>(
+                                CheckClock::now() - started));
     } catch (const std::exception& e) {
-        std::cerr << "UNKNOWN: Plugin error - " << e.what() << std::endl;
-        return static_cast<int>(ExitCode::UNKNOWN);
+        result = PluginResult(ExitCode::UNKNOWN, "Plugin error - " + std::string(e.what()));
+        threw = true;
     } catch (...) {
-        std::cerr << "UNKNOWN: Unknown plugin error" << std::endl;
+        result = PluginResult(ExitCode::UNKNOWN, "Unknown plugin error");
+        threw = true;
+    }
+
+    ResultRecord record;
+    record.check = checkName;
+    record.exitCode = static_cast<int>(result.code);
+    record.message = std::move(result.message);
+    record.metrics = std::move(result.perfdata);
+    record.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        CheckClock::now() - started);
+    record.timestamp = std::chrono::system_clock::now();
+    return record;
+}
+
+int printRecord(const ResultRecord& record, OutputFormat format, bool threw) {
+    std::string encoded;
+    encodeResult(format, record, encoded);
+    // Plugin errors go to stderr, as they always have
+    std::ostream& out = threw && format == OutputFormat::NAGIOS ? std::cerr : std::cout;
+    out.write(encoded.data(), static_cast<std::streamsize>(encoded.size()));
+    out.flush();
+    return record.exitCode;
+}
+
+} // namespace
+
+int executePlugin(Plugin& plugin, OutputFormat format, const std::string& checkName) {
+    bool threw = false;
+    const ResultRecord record = runPluginOnce(plugin, checkName, threw);
+    return printRecord(record, format, threw);
+}
+
+std::string formatPluginList() {
+    std::string text;
+    for (const PluginInfo* info : PluginRegistry::instance().list()) {
+        std::unique_ptr<Plugin> plugin = info->factory();
+        text += "check_" + info->name + "\t" + categoryToString(info->category) +
+                "\t" + plugin->getDescription() + "\n";
+    }
+    return text;
+}
+
+std::string pluginNameFromCommand(const std::string& command) {
+    std::string name = command;
+    size_t slash = name.find_last_of("/\\");
+    if (slash != std::string::npos) {
+        name = name.substr(slash + 1);
+    }
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".exe") == 0) {
+        name.resize(name.size() - 4);
+    }
+    if (name.compare(0, 6, "check_") == 0) {
+        name = name.substr(6);
+    }
+    return name;
+}
+
+namespace {
+
+std::string multicallUsage(const std::string& program) {
+    return "Usage: " + program + " PLUGIN [plugin options]\n"
+           "       check_PLUGIN [plugin options]   (symlink to " + program + ")\n"
+           "       " + program + " --list\n"
+           "Run '" + program + " PLUGIN --help' for plugin options.";
+}
+
+} // namespace
+
+int runPluginMain(int argc, char* argv[]) {
+    const PluginRegistry& registry = PluginRegistry::instance();
+    const std::string program = argc > 0 ? pluginNameFromCommand(argv[0]) : "netmon";
+
+    // Standalone executable: exactly one plugin is linked in
+    std::string name;
+    if (registry.size() == 1) {
+        name = registry.names().front();
+    } else if (registry.contains(program)) {
+        // Multicall binary invoked through a check_<name> symlink
+        name = program;
+    } else {
+        // Multicall binary invoked directly: "netmon <plugin> [args...]"
+        if (argc < 2 || std::strcmp(argv[1], "-h") == 0 || std::strcmp(argv[1], "--help") == 0) {
+            std::cout << multicallUsage(program) << std::endl;
+            return argc < 2 ? static_cast<int>(ExitCode::UNKNOWN) : 0;
+        }
+        if (std::strcmp(argv[1], "--list") == 0) {
+            std::cout << formatPluginList() << std::flush;
+            return 0;
+        }
+        name = pluginNameFromCommand(argv[1]);
+        if (!registry.contains(name)) {
+            std::cout << "UNKNOWN: Unknown plugin '" << name << "'" << std::endl;
+            return static_cast<int>(ExitCode::UNKNOWN);
+        }
+        // The subcommand becomes the plugin's argv[0]
+        argc--;
+        argv++;
+    }
+
+    // Output format and caching are ours, not the plugin's
+    OutputFormat format = OutputFormat::NAGIOS;
+    std::vector<std::string> words;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string value;
+        if (arg == "--output-format" && i + 1 < argc) {
+            value = argv[++i];
+        } else if (arg.compare(0, 16, "--output-format=") == 0) {
+            value = arg.substr(16);
+        } else {
+            words.push_back(arg);
+            continue;
+        }
+        if (!parseOutputFormat(value, format)) {
+            std::cout << "UNKNOWN: Invalid arguments - unknown output format '" << value
+                      << "'" << std::endl;
+            return static_cast<int>(ExitCode::UNKNOWN);
+        }
+    }
+    CachePolicy cachePolicy;
+    std::string cacheDir = DEFAULT_CACHE_DIR;
+    try {
+        extractCacheOptions(words, cachePolicy, cacheDir);
+    } catch (const std::exception& e) {
+        std::cout << "UNKNOWN: Invalid arguments - " << e.what() << std::endl;
         return static_cast<int>(ExitCode::UNKNOWN);
     }
+    std::vector<char*> pluginArgs;
+    for (auto& word : words) {
+        pluginArgs.push_back(&word[0]);
+    }
+    argc = static_cast<int>(pluginArgs.size());
+    pluginArgs.push_back(nullptr);
+    argv = pluginArgs.data();
+
+    std::unique_ptr<Plugin> plugin = registry.create(name);
+    try {
+        plugin->parseArguments(argc, argv);
+    } catch (const HelpRequested&) {
+        std::cout << plugin->getUsage() << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "UNKNOWN: Invalid arguments - " << e.what() << std::endl;
+        return static_cast<int>(ExitCode::UNKNOWN);
+    }
+    if (!cachePolicy.enabled()) {
+        return executePlugin(*plugin, format, name);
+    }
+
+    // Serve a cached result unless this process is the one to refresh it
+    FileResultCache cache(cacheDir);
+    if (!cache.error().empty()) {
+        std::cerr << "WARNING: result cache disabled - " << cache.error() << std::endl;
+    }
+    const std::string key = resultCacheKey(words);
+    ResultRecord record;
+    bool refresh = false;
+    if (cache.lookup(key, cachePolicy, record, refresh) != CacheState::MISS && !refresh) {
+        record.check = name;
+        return printRecord(record, format, false);
+    }
+    bool threw = false;
+    record = runPluginOnce(*plugin, name, threw);
+    cache.store(key, record);
+    return printRecord(record, format, threw);
 }
 
 } // namespace netmon_plugins
-
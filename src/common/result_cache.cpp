@@ -0,0 +1,382 @@
+// src/common/result_cache.cpp
+// In-memory and file-backed check result caches
+
+#include "netmon/result_cache.hpp"
+#include "netmon/plugin.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace netmon_plugins {
+
+namespace {
+
+const int UNKNOWN_CODE = static_cast<int>(ExitCode::UNKNOWN);
+
+std::chrono::seconds parseSeconds(const std::string& option, const std::string& text) {
+    char* end = nullptr;
+    errno = 0;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || errno != 0 || value < 0) {
+        throw std::invalid_argument(option + " needs a number of seconds, got '" + text + "'");
+    }
+    return std::chrono::seconds(value);
+}
+
+#ifndef _WIN32
+// FNV-1a; only names cache files, collisions are caught by the stored key
+uint64_t hashKey(const std::string& key) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool readFile(const std::string& path, std::string& data) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char buffer[4096];
+    ssize_t bytes;
+    while ((bytes = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes < 0) {
+            close(fd);
+            return false;
+        }
+        data.append(buffer, static_cast<size_t>(bytes));
+    }
+    close(fd);
+    return true;
+}
+
+bool writeFile(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t written = write(fd, data.data() + offset, data.size() - offset);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// mkdir -p with mode for every level it creates; false with error set if
+// path is not a directory afterwards
+bool createDirectories(const std::string& path, mode_t mode, std::string& error) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        const std::string level = path.substr(0, slash);
+        if (!level.empty() && mkdir(level.c_str(), mode) != 0 && errno != EEXIST) {
+            error = "cannot create " + level + ": " + std::strerror(errno);
+            return false;
+        }
+        if (slash == std::string::npos) {
+            break;
+        }
+    }
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+        error = path + " is not a directory";
+        return false;
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+void extractCacheOptions(std::vector<std::string>& args, CachePolicy& policy,
+                         std::string& directory) {
+    std::vector<std::string> kept;
+    kept.reserve(args.size());
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        std::string option = arg;
+        std::string value;
+        const size_t equals = arg.find('=');
+        if (arg.compare(0, 8, "--cache-") == 0 && equals != std::string::npos) {
+            option = arg.substr(0, equals);
+            value = arg.substr(equals + 1);
+        }
+        if (option != "--cache-ttl" && option != "--cache-stale" && option != "--cache-dir") {
+            kept.push_back(arg);
+            continue;
+        }
+        if (equals == std::string::npos) {
+            if (i + 1 >= args.size()) {
+                throw std::invalid_argument(option + " needs a value");
+            }
+            value = args[++i];
+        }
+        if (option == "--cache-ttl") {
+            policy.ttl = parseSeconds(option, value);
+        } else if (option == "--cache-stale") {
+            policy.staleFor = parseSeconds(option, value);
+        } else {
+            directory = value;
+        }
+    }
+    args.swap(kept);
+}
+
+std::string resultCacheKey(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        return "";
+    }
+    std::string key = pluginNameFromCommand(args[0]);
+    std::vector<std::string> canonical;
+    std::unique_ptr<Plugin> plugin = PluginRegistry::instance().create(key);
+    if (plugin) {
+        try {
+            canonical = plugin->canonicalArguments(args);
+        } catch (const std::exception&) {
+            // The check fails on these arguments anyway; key them as given
+            canonical.clear();
+        }
+    }
+    const std::vector<std::string>& words = canonical.empty() ? args : canonical;
+    for (size_t i = 1; i < words.size(); i++) {
+        key.push_back('\0');
+        key += words[i];
+    }
+    return key;
+}
+
+ResultCache::ResultCache(size_t maxEntries) : capacity(maxEntries > 0 ? maxEntries : 1) {}
+
+void ResultCache::touch(std::list<Entry>::iterator it) {
+    entries.splice(entries.begin(), entries, it);
+}
+
+CacheLookup ResultCache::lookup(const std::string& key, const CachePolicy& policy,
+                                Clock::time_point now) {
+    CacheLookup result;
+    result.refresh = true;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(key);
+    if (found == index.end()) {
+        return result;
+    }
+
+    auto it = found->second;
+    const Clock::duration age = now - it->stored;
+    if (age > policy.ttl + policy.staleFor) {
+        entries.erase(it);
+        index.erase(found);
+        return result;
+    }
+
+    touch(it);
+    result.outcome = it->outcome;
+    if (age <= policy.ttl) {
+        result.state = CacheState::FRESH;
+        result.refresh = false;
+    } else {
+        result.state = CacheState::STALE;
+        result.refresh = !it->refreshing;
+        it->refreshing = true;
+    }
+    return result;
+}
+
+void ResultCache::store(const std::string& key, const CheckOutcome& outcome,
+                        Clock::time_point now) {
+    if (outcome.exitCode == UNKNOWN_CODE) {
+        abandon(key);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(key);
+    if (found != index.end()) {
+        auto it = found->second;
+        it->outcome = outcome;
+        it->stored = now;
+        it->refreshing = false;
+        touch(it);
+        return;
+    }
+
+    entries.push_front(Entry{key, outcome, now, false});
+    index.emplace(key, entries.begin());
+    while (entries.size() > capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+void ResultCache::abandon(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(key);
+    if (found != index.end()) {
+        found->second->refreshing = false;
+    }
+}
+
+size_t ResultCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    index.clear();
+    entries.clear();
+}
+
+#ifndef _WIN32
+FileResultCache::FileResultCache(std::string directory) : dir(std::move(directory)) {
+    // The directory, and any parent it needs, is private to the user
+    // running checks
+    if (!createDirectories(dir, 0700, problem)) {
+        dir.clear();
+    }
+}
+
+FileResultCache::~FileResultCache() {
+    unlock();
+}
+
+std::string FileResultCache::pathFor(const std::string& key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx",
+                  static_cast<unsigned long long>(hashKey(key)));
+    return dir + name;
+}
+
+bool FileResultCache::lockEntry(const std::string& path) {
+    unlock();
+    int fd = open((path + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return false;
+    }
+    lockFd = fd;
+    return true;
+}
+
+void FileResultCache::unlock() {
+    if (lockFd >= 0) {
+        close(lockFd);
+        lockFd = -1;
+    }
+}
+
+CacheState FileResultCache::lookup(const std::string& key, const CachePolicy& policy,
+                                   ResultRecord& record, bool& refresh) {
+    refresh = true;
+    if (dir.empty()) {
+        return CacheState::MISS;
+    }
+    const std::string path = pathFor(key);
+
+    // File layout: u32 key length, the key, one BINARY record
+    std::string data;
+    size_t consumed = 0;
+    if (!readFile(path, data) || data.size() < 4) {
+        return CacheState::MISS;
+    }
+    const uint32_t keySize = static_cast<uint32_t>(static_cast<unsigned char>(data[0])) |
+                             static_cast<uint32_t>(static_cast<unsigned char>(data[1])) << 8 |
+                             static_cast<uint32_t>(static_cast<unsigned char>(data[2])) << 16 |
+                             static_cast<uint32_t>(static_cast<unsigned char>(data[3])) << 24;
+    if (data.size() < 4 + static_cast<size_t>(keySize) ||
+        data.compare(4, keySize, key) != 0 ||
+        !decodeBinaryResult(data.data() + 4 + keySize, data.size() - 4 - keySize, record,
+                            consumed)) {
+        return CacheState::MISS;
+    }
+
+    const auto age = std::chrono::system_clock::now() - record.timestamp;
+    if (age <= policy.ttl) {
+        refresh = false;
+        return CacheState::FRESH;
+    }
+    if (age > policy.ttl + policy.staleFor) {
+        return CacheState::MISS;
+    }
+    refresh = lockEntry(path);
+    return CacheState::STALE;
+}
+
+bool FileResultCache::store(const std::string& key, const ResultRecord& record) {
+    if (dir.empty() || record.exitCode == UNKNOWN_CODE) {
+        unlock();
+        return false;
+    }
+    const std::string path = pathFor(key);
+    std::string data;
+    const uint32_t keySize = static_cast<uint32_t>(key.size());
+    for (int shift = 0; shift < 32; shift += 8) {
+        data.push_back(static_cast<char>((keySize >> shift) & 0xff));
+    }
+    data += key;
+    encodeResult(OutputFormat::BINARY, record, data);
+
+    // Write a private temporary file and rename it into place, so readers
+    // only ever see a complete entry
+    std::string temp = path + ".XXXXXX";
+    int fd = mkstemp(&temp[0]);
+    bool ok = fd >= 0 && writeFile(fd, data);
+    if (fd >= 0) {
+        ok = close(fd) == 0 && ok;
+    }
+    ok = ok && std::rename(temp.c_str(), path.c_str()) == 0;
+    if (!ok && fd >= 0) {
+        unlink(temp.c_str());
+    }
+    unlock();
+    return ok;
+}
+#else
+// No flock() or mkstemp(): every lookup is a MISS and nothing is stored,
+// so one-shot checks run uncached
+FileResultCache::FileResultCache(std::string) : problem("not supported on Windows") {}
+
+FileResultCache::~FileResultCache() {}
+
+std::string FileResultCache::pathFor(const std::string&) const {
+    return "";
+}
+
+bool FileResultCache::lockEntry(const std::string&) {
+    return false;
+}
+
+void FileResultCache::unlock() {}
+
+CacheState FileResultCache::lookup(const std::string&, const CachePolicy&, ResultRecord&,
+                                   bool& refresh) {
+    refresh = true;
+    return CacheState::MISS;
+}
+
+bool FileResultCache::store(const std::string&, const ResultRecord&) {
+    return false;
+}
+#endif
+
+} // namespace netmon_plugins
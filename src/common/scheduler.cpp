@@ -0,0 +1,209 @@
+// src/common/scheduler.cpp
+// Check inventory parsing and the interval scheduler
+
+#include "netmon/scheduler.hpp"
+#include "netmon/executor.hpp"
+#include "netmon/result_cache.hpp"
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+namespace netmon_plugins {
+
+namespace {
+
+// FNV-1a over the check's identity
+uint64_t hashCheck(const ScheduledCheck& check) {
+    const std::string identity = check.id + '\0' + resultCacheKey(check.args);
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : identity) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+bool parseInterval(const std::string& text, std::chrono::seconds& interval) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0])) || text.size() > 9) {
+        return false;
+    }
+    char* end = nullptr;
+    long value = std::strtol(text.c_str(), &end, 10);
+    long scale = 1;
+    if (*end == 'm') {
+        scale = 60;
+        end++;
+    } else if (*end == 'h') {
+        scale = 3600;
+        end++;
+    } else if (*end == 's') {
+        end++;
+    }
+    if (*end != '\0' || value <= 0) {
+        return false;
+    }
+    interval = std::chrono::seconds(value * scale);
+    return true;
+}
+
+bool parseInventoryLine(const std::string& line, ScheduledCheck& check) {
+    check.interval = std::chrono::seconds(0);
+    size_t first = line.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos || line[first] == '#') {
+        return false;
+    }
+
+    std::string rest = line;
+    size_t end = line.find_first_of(" \t\r\n", first);
+    std::chrono::seconds interval;
+    if (parseInterval(line.substr(first, end - first), interval)) {
+        check.interval = interval;
+        rest = end == std::string::npos ? "" : line.substr(end);
+    }
+
+    BatchCheck parsed;
+    if (!parseBatchLine(rest, parsed)) {
+        throw std::invalid_argument("no plugin given");
+    }
+    check.id = std::move(parsed.id);
+    check.args = std::move(parsed.args);
+    return true;
+}
+
+std::vector<ScheduledCheck> readInventory(std::istream& input, std::vector<std::string>& errors) {
+    std::vector<ScheduledCheck> checks;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        ScheduledCheck check;
+        try {
+            if (!parseInventoryLine(line, check)) {
+                continue;
+            }
+        } catch (const std::invalid_argument& e) {
+            errors.push_back("line " + std::to_string(lineNumber) + ": " + e.what());
+            continue;
+        }
+        if (check.id.empty()) {
+            check.id = std::to_string(lineNumber);
+        }
+        checks.push_back(std::move(check));
+    }
+    return checks;
+}
+
+std::chrono::milliseconds phaseOffset(const ScheduledCheck& check,
+                                      std::chrono::seconds interval) {
+    const auto period = std::chrono::duration_cast<std::chrono::milliseconds>(interval).count();
+    if (period <= 0) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::milliseconds(
+        static_cast<int64_t>(hashCheck(check) % static_cast<uint64_t>(period)));
+}
+
+std::chrono::system_clock::time_point alignedRun(std::chrono::system_clock::time_point now,
+                                                 std::chrono::milliseconds offset,
+                                                 std::chrono::seconds interval) {
+    using std::chrono::milliseconds;
+    const int64_t period = std::chrono::duration_cast<milliseconds>(interval).count();
+    const int64_t nowMs =
+        std::chrono::duration_cast<milliseconds>(now.time_since_epoch()).count();
+    if (period <= 0) {
+        return now;
+    }
+    // Runs fall on offset + k * period since the epoch; take the next one
+    int64_t phase = (nowMs - offset.count()) % period;
+    if (phase < 0) {
+        phase += period;
+    }
+    return std::chrono::system_clock::time_point(milliseconds(nowMs - phase + period));
+}
+
+Scheduler::Scheduler(std::vector<ScheduledCheck> checks, Dispatch onDue,
+                     const SchedulerOptions& schedulerOptions)
+    : inventory(std::move(checks)),
+      dispatch(std::move(onDue)),
+      options(schedulerOptions),
+      wheel(schedulerOptions.tick),
+      timers(inventory.size(), NO_TIMER) {}
+
+Scheduler::~Scheduler() {
+    stop();
+}
+
+std::chrono::seconds Scheduler::intervalOf(const ScheduledCheck& check) const {
+    return check.interval.count() > 0 ? check.interval : options.defaultInterval;
+}
+
+void Scheduler::arm(size_t index, CheckClock::time_point when) {
+    timers[index] = wheel.schedule(when, [this, index, when]() {
+        runs++;
+        dispatch(index, inventory[index]);
+
+        // Keep the phase; after a stall skip the runs that were missed
+        const auto interval = intervalOf(inventory[index]);
+        CheckClock::time_point next = when + interval;
+        const CheckClock::time_point now = CheckClock::now();
+        while (next <= now) {
+            next += interval;
+        }
+        arm(index, next);
+    });
+}
+
+void Scheduler::start() {
+    if (thread.joinable()) {
+        return;
+    }
+    const auto wallNow = std::chrono::system_clock::now();
+    const auto steadyNow = CheckClock::now();
+    for (size_t i = 0; i < inventory.size(); i++) {
+        const auto interval = intervalOf(inventory[i]);
+        const auto first = alignedRun(wallNow, phaseOffset(inventory[i], interval), interval);
+        arm(i, steadyNow + std::chrono::duration_cast<CheckClock::duration>(first - wallNow));
+    }
+    stopping = false;
+    thread = std::thread([this]() { loop(); });
+}
+
+void Scheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    // Drop the pending runs, or a later start() would arm every check twice
+    for (TimerId& timer : timers) {
+        wheel.cancel(timer);
+        timer = NO_TIMER;
+    }
+}
+
+void Scheduler::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        const CheckClock::time_point next = wheel.nextExpiry();
+        if (next == CheckClock::time_point::max()) {
+            changed.wait(lock);
+            continue;
+        }
+        if (CheckClock::now() < next) {
+            changed.wait_until(lock, next);
+            continue;
+        }
+        lock.unlock();
+        wheel.advance(CheckClock::now());
+        lock.lock();
+    }
+}
+
+} // namespace netmon_plugins
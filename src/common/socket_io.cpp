@@ -0,0 +1,626 @@
+// src/common/socket_io.cpp
+// Deadline-aware socket helpers
+
+#include "netmon/socket_io.hpp"
+#include "netmon/thread_pool.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#ifdef NETMON_SSL_ENABLED
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace netmon_plugins {
+
+namespace {
+
+// Longest single wait, so that a cancelled token is noticed promptly
+const int CANCEL_POLL_SLICE_MS = 50;
+
+#ifdef _WIN32
+int lastSocketError() { return WSAGetLastError(); }
+bool wouldBlock(int err) { return err == WSAEWOULDBLOCK; }
+bool connectPending(int err) { return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS; }
+bool interrupted(int err) { return err == WSAEINTR; }
+
+void ensureWinsock() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        WSADATA wsaData;
+        WSAStartup(MAKEWORD(2, 2), &wsaData);
+    });
+}
+
+bool setNonBlocking(SocketFd fd) {
+    u_long mode = 1;
+    return ioctlsocket(static_cast<SOCKET>(fd), FIONBIO, &mode) == 0;
+}
+
+int pollOne(SocketFd fd, short events, int timeoutMs) {
+    WSAPOLLFD pfd;
+    pfd.fd = static_cast<SOCKET>(fd);
+    pfd.events = events;
+    pfd.revents = 0;
+    return WSAPoll(&pfd, 1, timeoutMs);
+}
+#else
+int lastSocketError() { return errno; }
+bool wouldBlock(int err) { return err == EAGAIN || err == EWOULDBLOCK; }
+bool connectPending(int err) { return err == EINPROGRESS; }
+bool interrupted(int err) { return err == EINTR; }
+void ensureWinsock() {}
+
+bool setNonBlocking(SocketFd fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+int pollOne(SocketFd fd, short events, int timeoutMs) {
+    struct pollfd pfd = {fd, events, 0};
+    return poll(&pfd, 1, timeoutMs);
+}
+#endif
+
+IoStatus stoppedStatus(const CheckContext& context) {
+    return context.token.cancelled() ? IoStatus::CANCELLED : IoStatus::TIMED_OUT;
+}
+
+void toAddressList(const struct addrinfo* result, AddressList& addresses) {
+    for (const struct addrinfo* entry = result; entry; entry = entry->ai_next) {
+        ResolvedAddress address;
+        address.family = entry->ai_family;
+        address.sockaddr.assign(reinterpret_cast<const char*>(entry->ai_addr),
+                                static_cast<size_t>(entry->ai_addrlen));
+        addresses.push_back(std::move(address));
+    }
+}
+
+int lookup(const std::string& host, int port, int flags, AddressList& addresses) {
+    ensureWinsock();
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = flags;
+    struct addrinfo* result = nullptr;
+    int rc = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result);
+    if (rc == 0) {
+        toAddressList(result, addresses);
+        freeaddrinfo(result);
+    }
+    return rc;
+}
+
+// getaddrinfo() cannot be interrupted, so names are resolved on the shared
+// resolver threads. If the deadline passes first the caller abandons the
+// lookup and its result is dropped when it eventually returns.
+struct Resolution {
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;
+    bool abandoned = false;
+    bool ok = false;
+    std::string error;
+    AddressList addresses;
+};
+
+// Never destroyed: a lookup stuck in getaddrinfo() must not hold up exit
+ThreadPool& resolverPool() {
+    static ThreadPool* pool = new ThreadPool(RESOLVER_THREADS, RESOLVER_QUEUE_LIMIT);
+    return *pool;
+}
+
+} // namespace
+
+const char* ioStatusToString(IoStatus status) {
+    switch (status) {
+        case IoStatus::OK: return "ok";
+        case IoStatus::CLOSED: return "connection closed";
+        case IoStatus::TIMED_OUT: return "timed out";
+        case IoStatus::CANCELLED: return "cancelled";
+        case IoStatus::FAILED: return "failed";
+    }
+    return "failed";
+}
+
+bool resolveNumeric(const std::string& host, int port, AddressList& addresses) {
+    return lookup(host, port, AI_NUMERICHOST, addresses) == 0;
+}
+
+bool lookupAddresses(const std::string& host, int port, AddressList& addresses,
+                     std::string& error) {
+    int rc = lookup(host, port, 0, addresses);
+    if (rc != 0) {
+        error = "cannot resolve " + host + ": " + gai_strerror(rc);
+        return false;
+    }
+    return true;
+}
+
+bool lookupAsync(const std::string& host, int port, std::function<bool()> wanted,
+                 LookupCallback done) {
+    return resolverPool().submit([host, port, wanted, done]() {
+        if (wanted && !wanted()) {
+            return;
+        }
+        AddressList found;
+        std::string error;
+        bool ok = lookupAddresses(host, port, found, error);
+        done(ok, found, error);
+    });
+}
+
+IoStatus resolveAddresses(const std::string& host, int port, const CheckContext& context,
+                          AddressList& addresses, std::string& error) {
+    if (resolveNumeric(host, port, addresses)) {
+        return IoStatus::OK;
+    }
+
+    auto state = std::make_shared<Resolution>();
+    bool queued = lookupAsync(
+        host, port,
+        [state]() {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            return !state->abandoned;
+        },
+        [state](bool ok, AddressList& found, const std::string& failure) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->ok = ok;
+            state->error = failure;
+            state->addresses = std::move(found);
+            state->finished = true;
+            state->done.notify_one();
+        });
+    if (!queued) {
+        error = "cannot resolve " + host + ": too many lookups pending";
+        return IoStatus::FAILED;
+    }
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (!state->finished) {
+        if (context.stopRequested()) {
+            state->abandoned = true;
+            error = "resolving " + host + " " + ioStatusToString(stoppedStatus(context));
+            return stoppedStatus(context);
+        }
+        state->done.wait_for(lock, std::chrono::milliseconds(
+            context.deadline.pollTimeout(CANCEL_POLL_SLICE_MS)));
+    }
+    if (!state->ok) {
+        error = state->error;
+        return IoStatus::FAILED;
+    }
+    addresses = std::move(state->addresses);
+    return IoStatus::OK;
+}
+
+SocketFd startConnect(const ResolvedAddress& address) {
+    ensureWinsock();
+#ifdef _WIN32
+    SocketFd fd = static_cast<SocketFd>(socket(address.family, SOCK_STREAM, IPPROTO_TCP));
+#else
+    SocketFd fd = socket(address.family, SOCK_STREAM, IPPROTO_TCP);
+#endif
+    if (fd == INVALID_SOCKET_FD) {
+        return INVALID_SOCKET_FD;
+    }
+    if (!setNonBlocking(fd)) {
+        closeSocket(fd);
+        return INVALID_SOCKET_FD;
+    }
+
+    const struct sockaddr* addr = reinterpret_cast<const struct sockaddr*>(address.sockaddr.data());
+#ifdef _WIN32
+    int rc = connect(static_cast<SOCKET>(fd), addr, static_cast<int>(address.sockaddr.size()));
+#else
+    int rc = connect(fd, addr, static_cast<socklen_t>(address.sockaddr.size()));
+#endif
+    if (rc != 0 && !connectPending(lastSocketError())) {
+        closeSocket(fd);
+        return INVALID_SOCKET_FD;
+    }
+    return fd;
+}
+
+IoStatus finishConnect(SocketFd fd) {
+    int soError = 0;
+    socklen_t len = sizeof(soError);
+#ifdef _WIN32
+    int rc = getsockopt(static_cast<SOCKET>(fd), SOL_SOCKET, SO_ERROR,
+                        reinterpret_cast<char*>(&soError), &len);
+#else
+    int rc = getsockopt(fd, SOL_SOCKET, SO_ERROR, &soError, &len);
+#endif
+    return rc == 0 && soError == 0 ? IoStatus::OK : IoStatus::FAILED;
+}
+
+IoStatus readAvailable(SocketFd fd, std::string& into, size_t limit) {
+    char buffer[4096];
+    while (into.size() < limit) {
+        size_t room = std::min(sizeof(buffer), limit - into.size());
+#ifdef _WIN32
+        int bytes = recv(static_cast<SOCKET>(fd), buffer, static_cast<int>(room), 0);
+#else
+        ssize_t bytes = recv(fd, buffer, room, 0);
+#endif
+        if (bytes > 0) {
+            into.append(buffer, static_cast<size_t>(bytes));
+            continue;
+        }
+        if (bytes == 0) {
+            return IoStatus::CLOSED;
+        }
+        int err = lastSocketError();
+        if (interrupted(err)) {
+            continue;
+        }
+        return wouldBlock(err) ? IoStatus::OK : IoStatus::FAILED;
+    }
+    return IoStatus::OK;
+}
+
+IoStatus peekSocket(SocketFd fd, bool& pending) {
+    pending = false;
+    char byte;
+    for (;;) {
+#ifdef _WIN32
+        int bytes = recv(static_cast<SOCKET>(fd), &byte, 1, MSG_PEEK);
+#else
+        ssize_t bytes = recv(fd, &byte, 1, MSG_PEEK);
+#endif
+        if (bytes > 0) {
+            pending = true;
+            return IoStatus::OK;
+        }
+        if (bytes == 0) {
+            return IoStatus::CLOSED;
+        }
+        int err = lastSocketError();
+        if (!interrupted(err)) {
+            return wouldBlock(err) ? IoStatus::OK : IoStatus::FAILED;
+        }
+    }
+}
+
+IoStatus writeAvailable(SocketFd fd, const char* data, size_t length, size_t& written) {
+    written = 0;
+    while (written < length) {
+#ifdef _WIN32
+        int sent = send(static_cast<SOCKET>(fd), data + written,
+                        static_cast<int>(length - written), 0);
+#else
+        ssize_t sent = send(fd, data + written, length - written, MSG_NOSIGNAL);
+#endif
+        if (sent > 0) {
+            written += static_cast<size_t>(sent);
+            continue;
+        }
+        int err = lastSocketError();
+        if (sent < 0 && interrupted(err)) {
+            continue;
+        }
+        return sent < 0 && wouldBlock(err) ? IoStatus::OK : IoStatus::FAILED;
+    }
+    return IoStatus::OK;
+}
+
+AddressList interleaveFamilies(const AddressList& addresses) {
+    // RFC 8305 section 4: alternate families, starting with the one the
+    // resolver preferred, so one unreachable family costs a single attempt
+    AddressList first;
+    AddressList other;
+    for (const ResolvedAddress& address : addresses) {
+        (address.family == addresses.front().family ? first : other).push_back(address);
+    }
+    AddressList ordered;
+    ordered.reserve(addresses.size());
+    for (size_t i = 0; i < first.size() || i < other.size(); i++) {
+        if (i < first.size()) {
+            ordered.push_back(first[i]);
+        }
+        if (i < other.size()) {
+            ordered.push_back(other[i]);
+        }
+    }
+    return ordered;
+}
+
+SocketFd connectAny(const AddressList& addresses, const CheckContext& context,
+                    int attemptDelayMs, IoStatus& status, size_t* winner) {
+    struct Attempt {
+        SocketFd fd;
+        size_t index;
+    };
+    std::vector<Attempt> attempts;
+    auto abandon = [&attempts]() {
+        for (const Attempt& attempt : attempts) {
+            closeSocket(attempt.fd);
+        }
+    };
+
+    size_t next = 0;
+    auto nextStart = CheckClock::now();
+    for (;;) {
+        if (context.stopRequested()) {
+            abandon();
+            status = stoppedStatus(context);
+            return INVALID_SOCKET_FD;
+        }
+
+        // Start the next attempt when the previous one has had its head
+        // start or has failed, or straight away once nothing is in flight
+        auto now = CheckClock::now();
+        if (next < addresses.size() && (attempts.empty() || now >= nextStart)) {
+            SocketFd fd = startConnect(addresses[next]);
+            if (fd != INVALID_SOCKET_FD) {
+                attempts.push_back({fd, next});
+                nextStart = now + std::chrono::milliseconds(attemptDelayMs);
+            } else {
+                nextStart = now;
+            }
+            next++;
+            continue;
+        }
+        if (attempts.empty()) {
+            status = IoStatus::FAILED;
+            return INVALID_SOCKET_FD;
+        }
+
+        int timeout = context.deadline.pollTimeout(CANCEL_POLL_SLICE_MS);
+        if (next < addresses.size()) {
+            auto untilNext = std::chrono::duration_cast<std::chrono::milliseconds>(
+                nextStart - now).count();
+            timeout = static_cast<int>(std::max<long long>(
+                0, std::min<long long>(timeout, untilNext)));
+        }
+#ifdef _WIN32
+        std::vector<WSAPOLLFD> fds(attempts.size());
+        for (size_t i = 0; i < attempts.size(); i++) {
+            fds[i].fd = static_cast<SOCKET>(attempts[i].fd);
+            fds[i].events = POLLOUT;
+            fds[i].revents = 0;
+        }
+        int ready = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeout);
+#else
+        std::vector<struct pollfd> fds(attempts.size());
+        for (size_t i = 0; i < attempts.size(); i++) {
+            fds[i] = {attempts[i].fd, POLLOUT, 0};
+        }
+        int ready = poll(fds.data(), fds.size(), timeout);
+#endif
+        if (ready < 0 && !interrupted(lastSocketError())) {
+            abandon();
+            status = IoStatus::FAILED;
+            return INVALID_SOCKET_FD;
+        }
+
+        // First attempt to complete wins; refused ones drop out
+        for (size_t i = fds.size(); ready > 0 && i-- > 0;) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            if (finishConnect(attempts[i].fd) == IoStatus::OK) {
+                SocketFd fd = attempts[i].fd;
+                if (winner) {
+                    *winner = attempts[i].index;
+                }
+                attempts.erase(attempts.begin() + static_cast<std::ptrdiff_t>(i));
+                abandon();
+                status = IoStatus::OK;
+                return fd;
+            }
+            closeSocket(attempts[i].fd);
+            attempts.erase(attempts.begin() + static_cast<std::ptrdiff_t>(i));
+            // A failed attempt hands its head start to the next address
+            nextStart = CheckClock::now();
+        }
+    }
+}
+
+SocketFd connectTcp(const std::string& host, int port, const CheckContext& context,
+                    IoStatus& status, std::string& error) {
+    AddressList addresses;
+    status = resolveAddresses(host, port, context, addresses, error);
+    if (status != IoStatus::OK) {
+        return INVALID_SOCKET_FD;
+    }
+
+    SocketFd fd = connectAny(interleaveFamilies(addresses), context,
+                             CONNECT_ATTEMPT_DELAY_MS, status, nullptr);
+    if (fd == INVALID_SOCKET_FD) {
+        error = "connecting to " + host + ":" + std::to_string(port) + " " +
+                ioStatusToString(status);
+    }
+    return fd;
+}
+
+void closeSocket(SocketFd fd) {
+    if (fd == INVALID_SOCKET_FD) {
+        return;
+    }
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(fd));
+#else
+    close(fd);
+#endif
+}
+
+IoStatus waitSocket(SocketFd fd, bool forWrite, const CheckContext& context) {
+    const short events = forWrite ? POLLOUT : POLLIN;
+    for (;;) {
+        if (context.stopRequested()) {
+            return stoppedStatus(context);
+        }
+        int ready = pollOne(fd, events, context.deadline.pollTimeout(CANCEL_POLL_SLICE_MS));
+        if (ready > 0) {
+            return IoStatus::OK;
+        }
+        if (ready < 0 && !interrupted(lastSocketError())) {
+            return IoStatus::FAILED;
+        }
+    }
+}
+
+IoStatus sendAll(SocketFd fd, const char* data, size_t length, const CheckContext& context) {
+    size_t offset = 0;
+    while (offset < length) {
+#ifdef _WIN32
+        int sent = send(static_cast<SOCKET>(fd), data + offset,
+                        static_cast<int>(length - offset), 0);
+#else
+        ssize_t sent = send(fd, data + offset, length - offset, MSG_NOSIGNAL);
+#endif
+        if (sent > 0) {
+            offset += static_cast<size_t>(sent);
+            continue;
+        }
+        int err = lastSocketError();
+        if (sent < 0 && interrupted(err)) {
+            continue;
+        }
+        if (sent < 0 && wouldBlock(err)) {
+            IoStatus status = waitSocket(fd, true, context);
+            if (status != IoStatus::OK) {
+                return status;
+            }
+            continue;
+        }
+        return IoStatus::FAILED;
+    }
+    return IoStatus::OK;
+}
+
+IoStatus recvSome(SocketFd fd, char* buffer, size_t length, size_t& received,
+                  const CheckContext& context) {
+    received = 0;
+    for (;;) {
+        if (context.stopRequested()) {
+            return stoppedStatus(context);
+        }
+#ifdef _WIN32
+        int bytes = recv(static_cast<SOCKET>(fd), buffer, static_cast<int>(length), 0);
+#else
+        ssize_t bytes = recv(fd, buffer, length, 0);
+#endif
+        if (bytes > 0) {
+            received = static_cast<size_t>(bytes);
+            return IoStatus::OK;
+        }
+        if (bytes == 0) {
+            return IoStatus::CLOSED;
+        }
+        int err = lastSocketError();
+        if (interrupted(err)) {
+            continue;
+        }
+        if (!wouldBlock(err)) {
+            return IoStatus::FAILED;
+        }
+        IoStatus status = waitSocket(fd, false, context);
+        if (status != IoStatus::OK) {
+            return status;
+        }
+    }
+}
+
+#ifdef NETMON_SSL_ENABLED
+namespace {
+
+// Wait for whatever the TLS engine asked for; FAILED for real errors
+IoStatus waitTls(SSL* ssl, int rc, SocketFd fd, const CheckContext& context) {
+    switch (SSL_get_error(ssl, rc)) {
+        case SSL_ERROR_WANT_READ:
+            return waitSocket(fd, false, context);
+        case SSL_ERROR_WANT_WRITE:
+            return waitSocket(fd, true, context);
+        case SSL_ERROR_ZERO_RETURN:
+            return IoStatus::CLOSED;
+        case SSL_ERROR_SYSCALL:
+            // Servers commonly close without close_notify
+            return ERR_peek_error() == 0 ? IoStatus::CLOSED : IoStatus::FAILED;
+        default:
+            return IoStatus::FAILED;
+    }
+}
+
+} // namespace
+
+IoStatus tlsHandshake(SSL* ssl, SocketFd fd, const CheckContext& context) {
+    for (;;) {
+        if (context.stopRequested()) {
+            return stoppedStatus(context);
+        }
+        int rc = SSL_connect(ssl);
+        if (rc == 1) {
+            return IoStatus::OK;
+        }
+        IoStatus status = waitTls(ssl, rc, fd, context);
+        if (status != IoStatus::OK) {
+            return status == IoStatus::CLOSED ? IoStatus::FAILED : status;
+        }
+    }
+}
+
+IoStatus tlsSendAll(SSL* ssl, SocketFd fd, const char* data, size_t length,
+                    const CheckContext& context) {
+    size_t offset = 0;
+    while (offset < length) {
+        if (context.stopRequested()) {
+            return stoppedStatus(context);
+        }
+        int rc = SSL_write(ssl, data + offset, static_cast<int>(length - offset));
+        if (rc > 0) {
+            offset += static_cast<size_t>(rc);
+            continue;
+        }
+        IoStatus status = waitTls(ssl, rc, fd, context);
+        if (status != IoStatus::OK) {
+            return status == IoStatus::CLOSED ? IoStatus::FAILED : status;
+        }
+    }
+    return IoStatus::OK;
+}
+
+IoStatus tlsRecvSome(SSL* ssl, SocketFd fd, char* buffer, size_t length, size_t& received,
+                     const CheckContext& context) {
+    received = 0;
+    for (;;) {
+        if (context.stopRequested()) {
+            return stoppedStatus(context);
+        }
+        int rc = SSL_read(ssl, buffer, static_cast<int>(length));
+        if (rc > 0) {
+            received = static_cast<size_t>(rc);
+            return IoStatus::OK;
+        }
+        IoStatus status = waitTls(ssl, rc, fd, context);
+        if (status != IoStatus::OK) {
+            return status;
+        }
+    }
+}
+#endif
+
+} // namespace netmon_plugins
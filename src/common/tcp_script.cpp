@@ -0,0 +1,510 @@
+// src/common/tcp_script.cpp
+// Scripted TCP probe engine
+
+#include "netmon/tcp_script.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace netmon_plugins {
+
+namespace {
+
+// Replies longer than this without a match fail the probe
+const size_t MAX_REPLY_BYTES = 64 * 1024;
+
+// Longest wait between cancellation scans
+const int CANCEL_SCAN_INTERVAL_MS = 50;
+
+std::chrono::microseconds elapsedSince(CheckClock::time_point start, CheckClock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+}
+
+bool startsWith(const std::string& text, const std::string& prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool acceptable(const std::string& reply, const std::vector<std::string>& accept) {
+    if (accept.empty()) {
+        return true;
+    }
+    for (const auto& prefix : accept) {
+        if (startsWith(reply, prefix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Next complete line of data at offset, without its line ending
+bool nextLine(const std::string& data, size_t& offset, std::string& line) {
+    size_t end = data.find('\n', offset);
+    if (end == std::string::npos) {
+        return false;
+    }
+    line.assign(data, offset, end - offset);
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    offset = end + 1;
+    return true;
+}
+
+} // namespace
+
+TcpScript& TcpScript::send(const std::string& data) {
+    ScriptStep step;
+    step.action = ScriptStep::Action::SEND;
+    step.text = data;
+    script.push_back(step);
+    return *this;
+}
+
+TcpScript& TcpScript::expect(const std::string& text) {
+    ScriptStep step;
+    step.action = ScriptStep::Action::EXPECT_TEXT;
+    step.text = text;
+    script.push_back(step);
+    return *this;
+}
+
+TcpScript& TcpScript::expectLine(const std::vector<std::string>& accept,
+                                 const std::string& lineStart) {
+    ScriptStep step;
+    step.action = ScriptStep::Action::EXPECT_LINE;
+    step.accept = accept;
+    step.lineStart = lineStart;
+    script.push_back(step);
+    return *this;
+}
+
+TcpScript& TcpScript::expectReply(const std::vector<std::string>& accept) {
+    ScriptStep step;
+    step.action = ScriptStep::Action::EXPECT_REPLY;
+    step.accept = accept;
+    script.push_back(step);
+    return *this;
+}
+
+TcpScript& TcpScript::when(const std::string& replyPrefix) {
+    if (!script.empty()) {
+        script.back().when = replyPrefix;
+    }
+    return *this;
+}
+
+struct TcpProbeEngine::Probe {
+    enum class Phase { RESOLVING, CONNECTING, RUNNING };
+
+    size_t id = 0;
+    TcpProbe spec;
+    CheckContext context;
+    Callback done;
+    Phase phase = Phase::RESOLVING;
+
+    std::shared_ptr<std::atomic<bool>> lookupWanted;   // Cleared when the probe ends
+    AddressList addresses;
+    size_t nextAddress = 0;
+    std::vector<SocketFd> attempts;        // Connects racing until one succeeds
+    TimerId attemptTimer = NO_TIMER;       // Starts the next attempt
+    SocketFd fd = INVALID_SOCKET_FD;       // The connection once established
+    std::string connectError;
+
+    size_t step = 0;
+    std::string inbox;
+    std::string outbox;
+    size_t outOffset = 0;
+    bool peerClosed = false;
+    std::string lastReply;
+
+    TimerId deadlineTimer = NO_TIMER;
+    PhaseTimings timings;
+    CheckClock::time_point started;
+    CheckClock::time_point resolved;
+    CheckClock::time_point awaitingSince;   // Connected, or last send before any reply
+    bool gotFirstByte = false;
+};
+
+TcpProbeEngine::TcpProbeEngine() : lastCancelScan(CheckClock::now()) {}
+
+TcpProbeEngine::~TcpProbeEngine() {
+    for (auto& entry : probes) {
+        if (entry.second->lookupWanted) {
+            *entry.second->lookupWanted = false;
+        }
+        for (SocketFd attempt : entry.second->attempts) {
+            loop.remove(attempt);
+            closeSocket(attempt);
+        }
+        if (entry.second->fd != INVALID_SOCKET_FD) {
+            loop.remove(entry.second->fd);
+            closeSocket(entry.second->fd);
+        }
+    }
+}
+
+void TcpProbeEngine::add(const TcpProbe& spec, const CheckContext& context, Callback done) {
+    auto probe = std::unique_ptr<Probe>(new Probe());
+    probe->id = nextId++;
+    probe->spec = spec;
+    probe->context = context;
+    probe->done = std::move(done);
+    probe->started = CheckClock::now();
+    if (context.deadline.isSet()) {
+        const size_t id = probe->id;
+        probe->deadlineTimer = deadlines.schedule(context.deadline.time(), [this, id]() {
+            auto it = probes.find(id);
+            if (it != probes.end()) {
+                it->second->deadlineTimer = NO_TIMER;   // Fired; nothing to cancel
+                finish(*it->second, IoStatus::TIMED_OUT, false, "timed out");
+            }
+        });
+    }
+
+    Probe& added = *probe;
+    probes.emplace(added.id, std::move(probe));
+    start(added);
+}
+
+void TcpProbeEngine::start(Probe& probe) {
+    if (!probe.spec.addresses.empty()) {
+        probe.addresses = probe.spec.addresses;
+    }
+    if (!probe.addresses.empty() ||
+        resolveNumeric(probe.spec.host, probe.spec.port, probe.addresses)) {
+        probe.resolved = CheckClock::now();
+        probe.timings.dns = elapsedSince(probe.started, probe.resolved);
+        probe.timings.recorded |= PhaseTimings::DNS;
+        connectNext(probe);
+        return;
+    }
+
+    // The resolver reports back through the loop; if the engine is gone by
+    // then the post is dropped
+    EventLoop::Poster post = loop.poster();
+    const size_t id = probe.id;
+    auto wanted = std::make_shared<std::atomic<bool>>(true);
+    probe.lookupWanted = wanted;
+    bool queued = lookupAsync(
+        probe.spec.host, probe.spec.port, [wanted]() { return wanted->load(); },
+        [post, id, this](bool ok, AddressList& addresses, const std::string& failure) {
+            auto found = std::make_shared<AddressList>(std::move(addresses));
+            auto error = std::make_shared<std::string>(failure);
+            post([this, id, found, error, ok]() {
+                auto it = probes.find(id);
+                if (it == probes.end()) {
+                    return;
+                }
+                Probe& resolving = *it->second;
+                resolving.resolved = CheckClock::now();
+                resolving.timings.dns = elapsedSince(resolving.started, resolving.resolved);
+                resolving.timings.recorded |= PhaseTimings::DNS;
+                if (!ok) {
+                    finish(resolving, IoStatus::FAILED, false, *error);
+                    return;
+                }
+                resolving.addresses = interleaveFamilies(*found);
+                connectNext(resolving);
+            });
+        });
+    if (!queued) {
+        finish(probe, IoStatus::FAILED, false,
+               "cannot resolve " + probe.spec.host + ": too many lookups pending");
+    }
+}
+
+// Happy Eyeballs, as connectAny(): start on the next address, and give it
+// CONNECT_ATTEMPT_DELAY_MS before the one after joins the race, sooner if
+// it fails. Earlier attempts keep running; the first to connect wins.
+void TcpProbeEngine::connectNext(Probe& probe) {
+    deadlines.cancel(probe.attemptTimer);
+    probe.attemptTimer = NO_TIMER;
+    while (probe.nextAddress < probe.addresses.size()) {
+        SocketFd fd = startConnect(probe.addresses[probe.nextAddress++]);
+        if (fd == INVALID_SOCKET_FD) {
+            continue;
+        }
+        probe.attempts.push_back(fd);
+        probe.phase = Probe::Phase::CONNECTING;
+        const size_t id = probe.id;
+        loop.add(fd, EventLoop::WRITABLE, [this, id, fd](unsigned events) {
+            auto it = probes.find(id);
+            if (it == probes.end()) {
+                return;
+            }
+            if (it->second->phase == Probe::Phase::CONNECTING) {
+                onConnect(*it->second, fd);
+            } else {
+                onEvent(*it->second, events);
+            }
+        });
+        if (probe.nextAddress < probe.addresses.size()) {
+            probe.attemptTimer = deadlines.schedule(
+                CheckClock::now() + std::chrono::milliseconds(CONNECT_ATTEMPT_DELAY_MS),
+                [this, id]() {
+                    auto it = probes.find(id);
+                    if (it != probes.end()) {
+                        it->second->attemptTimer = NO_TIMER;   // Fired; nothing to cancel
+                        connectNext(*it->second);
+                    }
+                });
+        }
+        return;
+    }
+    if (probe.attempts.empty()) {
+        finish(probe, IoStatus::FAILED, false,
+               "connecting to " + probe.spec.host + ":" + std::to_string(probe.spec.port) +
+                   " failed");
+    }
+}
+
+void TcpProbeEngine::onConnect(Probe& probe, SocketFd attempt) {
+    probe.attempts.erase(std::find(probe.attempts.begin(), probe.attempts.end(), attempt));
+    if (finishConnect(attempt) != IoStatus::OK) {
+        loop.remove(attempt);
+        closeSocket(attempt);
+        connectNext(probe);
+        return;
+    }
+    for (SocketFd loser : probe.attempts) {
+        loop.remove(loser);
+        closeSocket(loser);
+    }
+    probe.attempts.clear();
+    deadlines.cancel(probe.attemptTimer);
+    probe.attemptTimer = NO_TIMER;
+
+    // Its handler passes events on to onEvent() from now on
+    probe.fd = attempt;
+    probe.phase = Probe::Phase::RUNNING;
+    probe.awaitingSince = CheckClock::now();
+    probe.timings.connect = elapsedSince(probe.resolved, probe.awaitingSince);
+    probe.timings.recorded |= PhaseTimings::CONNECT;
+    advance(probe);
+}
+
+void TcpProbeEngine::onEvent(Probe& probe, unsigned events) {
+
+    if ((events & EventLoop::READABLE) && !probe.peerClosed) {
+        const size_t before = probe.inbox.size();
+        IoStatus status = readAvailable(probe.fd, probe.inbox, MAX_REPLY_BYTES);
+        if (probe.inbox.size() > before && probe.context.phases) {
+            probe.context.phases->addTraffic(probe.inbox.size() - before, 0);
+        }
+        if (!probe.gotFirstByte && probe.inbox.size() > before) {
+            probe.gotFirstByte = true;
+            probe.timings.firstByte = elapsedSince(probe.awaitingSince, CheckClock::now());
+            probe.timings.recorded |= PhaseTimings::FIRST_BYTE;
+        }
+        if (status == IoStatus::CLOSED) {
+            probe.peerClosed = true;
+        } else if (status == IoStatus::FAILED) {
+            finish(probe, IoStatus::FAILED, false, "receive failed");
+            return;
+        }
+    }
+    advance(probe);
+}
+
+void TcpProbeEngine::advance(Probe& probe) {
+    const std::vector<ScriptStep>& steps = probe.spec.script.steps();
+    while (probe.step < steps.size()) {
+        const ScriptStep& step = steps[probe.step];
+        if (!step.when.empty() && !startsWith(probe.lastReply, step.when)) {
+            probe.step++;
+            continue;
+        }
+
+        if (step.action == ScriptStep::Action::SEND) {
+            if (probe.outbox.empty()) {
+                probe.outbox = step.text;
+                probe.outOffset = 0;
+            }
+            size_t written = 0;
+            IoStatus status = writeAvailable(probe.fd, probe.outbox.data() + probe.outOffset,
+                                             probe.outbox.size() - probe.outOffset, written);
+            if (status != IoStatus::OK) {
+                finish(probe, IoStatus::FAILED, false, "send failed");
+                return;
+            }
+            probe.outOffset += written;
+            if (probe.context.phases) {
+                probe.context.phases->addTraffic(0, written);
+            }
+            if (probe.outOffset < probe.outbox.size()) {
+                loop.modify(probe.fd, EventLoop::WRITABLE);
+                return;
+            }
+            probe.outbox.clear();
+            if (!probe.gotFirstByte) {
+                probe.awaitingSince = CheckClock::now();
+            }
+            probe.step++;
+            continue;
+        }
+
+        // Expectations: look for a complete answer in what has arrived
+        bool complete = false;
+        bool matched = false;
+        size_t consumed = 0;
+        if (step.action == ScriptStep::Action::EXPECT_TEXT) {
+            size_t found = probe.inbox.find(step.text);
+            if (found != std::string::npos) {
+                complete = matched = true;
+                size_t lineEnd = probe.inbox.find('\n', found + step.text.size());
+                consumed = lineEnd == std::string::npos ? probe.inbox.size() : lineEnd + 1;
+                probe.lastReply = probe.inbox.substr(0, consumed);
+            }
+        } else {
+            size_t offset = 0;
+            std::string line;
+            std::string reply;
+            while (nextLine(probe.inbox, offset, line)) {
+                if (step.action == ScriptStep::Action::EXPECT_LINE) {
+                    if (!startsWith(line, step.lineStart)) {
+                        continue;
+                    }
+                    complete = true;
+                    reply = line;
+                    break;
+                }
+                // Numeric reply: "250-first", "250-more", "250 last"; keep
+                // every line so callers can search the whole banner
+                if (!reply.empty()) {
+                    reply += '\n';
+                }
+                reply += line;
+                if (line.size() < 4 || line[3] != '-') {
+                    complete = true;
+                    break;
+                }
+            }
+            if (complete) {
+                consumed = offset;
+                probe.lastReply = reply;
+                // The final line carries the reply code proper
+                size_t lastLine = reply.rfind('\n');
+                matched = acceptable(lastLine == std::string::npos ? reply : reply.substr(lastLine + 1),
+                                     step.accept);
+            }
+        }
+
+        if (complete) {
+            probe.inbox.erase(0, consumed);
+            if (!matched) {
+                finish(probe, IoStatus::OK, false, "unexpected reply: " + probe.lastReply);
+                return;
+            }
+            probe.step++;
+            continue;
+        }
+        if (probe.peerClosed) {
+            finish(probe, IoStatus::CLOSED, false, "connection closed before expected reply");
+            return;
+        }
+        if (probe.inbox.size() >= MAX_REPLY_BYTES) {
+            finish(probe, IoStatus::FAILED, false, "reply too long");
+            return;
+        }
+        loop.modify(probe.fd, EventLoop::READABLE);
+        return;
+    }
+    finish(probe, IoStatus::OK, true, "");
+}
+
+void TcpProbeEngine::finish(Probe& probe, IoStatus status, bool matched,
+                            const std::string& error) {
+    TcpProbeResult result;
+    result.status = status;
+    result.matched = matched;
+    result.failedStep = matched ? 0 : probe.step;
+    result.reply = probe.lastReply;
+    result.error = error;
+    result.connected = probe.phase == Probe::Phase::RUNNING;
+    if (probe.phase == Probe::Phase::CONNECTING) {
+        probe.timings.connect = elapsedSince(probe.resolved, CheckClock::now());
+        probe.timings.recorded |= PhaseTimings::CONNECT;
+    }
+    probe.timings.total = elapsedSince(probe.started, CheckClock::now());
+    result.timings = probe.timings;
+    if (probe.context.phases) {
+        probe.context.phases->record(probe.timings);
+    }
+
+    if (probe.fd != INVALID_SOCKET_FD) {
+        loop.remove(probe.fd);
+        closeSocket(probe.fd);
+        probe.fd = INVALID_SOCKET_FD;
+    }
+    for (SocketFd attempt : probe.attempts) {
+        loop.remove(attempt);
+        closeSocket(attempt);
+    }
+    probe.attempts.clear();
+    deadlines.cancel(probe.attemptTimer);
+    deadlines.cancel(probe.deadlineTimer);
+    if (probe.lookupWanted) {
+        *probe.lookupWanted = false;
+    }
+
+    Callback done = std::move(probe.done);
+    probes.erase(probe.id);   // probe is gone from here on
+    if (done) {
+        done(result);
+    }
+}
+
+void TcpProbeEngine::expireProbes() {
+    auto now = CheckClock::now();
+    deadlines.advance(now);
+
+    if (now - lastCancelScan < std::chrono::milliseconds(CANCEL_SCAN_INTERVAL_MS)) {
+        return;
+    }
+    lastCancelScan = now;
+    std::vector<size_t> cancelled;
+    for (const auto& entry : probes) {
+        if (entry.second->context.token.cancelled()) {
+            cancelled.push_back(entry.first);
+        }
+    }
+    for (size_t id : cancelled) {
+        auto it = probes.find(id);
+        if (it != probes.end()) {
+            finish(*it->second, IoStatus::CANCELLED, false, "cancelled");
+        }
+    }
+}
+
+void TcpProbeEngine::run() {
+    while (!probes.empty()) {
+        int timeout = CANCEL_SCAN_INTERVAL_MS;
+        if (!deadlines.empty()) {
+            auto untilFirst = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadlines.nextExpiry() - CheckClock::now()).count();
+            timeout = static_cast<int>(std::max<long long>(
+                0, std::min<long long>(timeout, untilFirst + 1)));
+        }
+        loop.runOnce(timeout);
+        expireProbes();
+    }
+}
+
+TcpProbeResult runTcpScript(const std::string& host, int port, const TcpScript& script,
+                            const CheckContext& context) {
+    TcpProbe probe;
+    probe.host = host;
+    probe.port = port;
+    probe.script = script;
+
+    TcpProbeResult result;
+    TcpProbeEngine engine;
+    engine.add(probe, context, [&result](const TcpProbeResult& finished) {
+        result = finished;
+    });
+    engine.run();
+    return result;
+}
+
+} // namespace netmon_plugins
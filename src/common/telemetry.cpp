@@ -0,0 +1,327 @@
+// src/common/telemetry.cpp
+// Check runner self-metrics implementation
+
+#include "netmon/telemetry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX   // LatencyHistogram::max()
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+namespace netmon_plugins {
+
+namespace {
+
+// Values up to 2^36 - 1 us (about 19 hours) keep their precision
+constexpr uint64_t MAX_TRACKED_US = (uint64_t(1) << 36) - 1;
+
+// Below 128 a bucket per value; above, the top 7 bits of the value select
+// one of 64 buckets per power of two
+size_t bucketIndex(uint64_t value) {
+    if (value < 128) {
+        return static_cast<size_t>(value);
+    }
+    value = std::min(value, MAX_TRACKED_US);
+    int exponent = 7;
+    while ((value >> (exponent + 1)) != 0) {
+        exponent++;
+    }
+    const int shift = exponent - 6;
+    return static_cast<size_t>(shift) * 64 + static_cast<size_t>(value >> shift);
+}
+
+// Largest value that lands in bucket index
+uint64_t bucketUpperBound(size_t index) {
+    if (index < 128) {
+        return index;
+    }
+    const size_t shift = index / 64 - 1;
+    const uint64_t mantissa = index - shift * 64;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t load(const std::atomic<uint64_t>& counter) {
+    return counter.load(std::memory_order_relaxed);
+}
+
+std::string seconds(std::chrono::microseconds value) {
+    return formatNumber(static_cast<double>(value.count()) / 1e6);
+}
+
+void appendFamily(std::string& out, const char* family, const char* type, const char* help) {
+    out += "# HELP ";
+    out += family;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += family;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void appendSample(std::string& out, const char* family, const std::string& plugin,
+                  const std::string& value, const char* extraLabel = nullptr) {
+    out += family;
+    out += "{plugin=\"";
+    out += plugin;
+    out += '"';
+    if (extraLabel) {
+        out += ',';
+        out += extraLabel;
+    }
+    out += "} ";
+    out += value;
+    out += '\n';
+}
+
+void encodePrometheus(const std::vector<PluginStats>& stats, std::string& out) {
+    if (!stats.empty()) {
+        struct Counter {
+            const char* family;
+            const char* help;
+            uint64_t PluginStats::*field;
+        };
+        static const Counter counters[] = {
+            {"netmon_plugin_runs_total", "Checks run", &PluginStats::runs},
+            {"netmon_plugin_timeouts_total", "Checks that ran past their deadline",
+             &PluginStats::timeouts},
+            {"netmon_plugin_exceptions_total", "Checks that ended in a plugin exception",
+             &PluginStats::exceptions},
+            {"netmon_plugin_connections_total", "Connections opened by checks",
+             &PluginStats::connections},
+            {"netmon_plugin_read_bytes_total", "Bytes received by checks",
+             &PluginStats::bytesRead},
+            {"netmon_plugin_written_bytes_total", "Bytes sent by checks",
+             &PluginStats::bytesWritten},
+        };
+        for (const Counter& counter : counters) {
+            appendFamily(out, counter.family, "counter", counter.help);
+            for (const PluginStats& plugin : stats) {
+                appendSample(out, counter.family, plugin.plugin,
+                             std::to_string(plugin.*counter.field));
+            }
+        }
+
+        static const char* const statusLabels[] = {"status=\"OK\"", "status=\"WARNING\"",
+                                                   "status=\"CRITICAL\"", "status=\"UNKNOWN\""};
+        appendFamily(out, "netmon_plugin_results_total", "counter", "Check results by status");
+        for (const PluginStats& plugin : stats) {
+            for (size_t code = 0; code < plugin.byExitCode.size(); code++) {
+                appendSample(out, "netmon_plugin_results_total", plugin.plugin,
+                             std::to_string(plugin.byExitCode[code]), statusLabels[code]);
+            }
+        }
+
+        appendFamily(out, "netmon_plugin_rss_growth_bytes", "gauge",
+                     "Rise of the process peak RSS during runs of the plugin");
+        for (const PluginStats& plugin : stats) {
+            appendSample(out, "netmon_plugin_rss_growth_bytes", plugin.plugin,
+                         std::to_string(plugin.rssGrowthKb * 1024));
+        }
+
+        appendFamily(out, "netmon_plugin_duration_seconds", "summary", "Check run time");
+        for (const PluginStats& plugin : stats) {
+            appendSample(out, "netmon_plugin_duration_seconds", plugin.plugin,
+                         seconds(plugin.p50), "quantile=\"0.5\"");
+            appendSample(out, "netmon_plugin_duration_seconds", plugin.plugin,
+                         seconds(plugin.p90), "quantile=\"0.9\"");
+            appendSample(out, "netmon_plugin_duration_seconds", plugin.plugin,
+                         seconds(plugin.p99), "quantile=\"0.99\"");
+            appendSample(out, "netmon_plugin_duration_seconds", plugin.plugin,
+                         seconds(plugin.max), "quantile=\"1\"");
+            appendSample(out, "netmon_plugin_duration_seconds_sum", plugin.plugin,
+                         seconds(plugin.durationSum));
+            appendSample(out, "netmon_plugin_duration_seconds_count", plugin.plugin,
+                         std::to_string(plugin.runs));
+        }
+    }
+
+    const uint64_t peakRss = peakRssKilobytes();
+    if (peakRss > 0) {
+        appendFamily(out, "netmon_process_peak_rss_bytes", "gauge",
+                     "Peak resident set size of the process");
+        out += "netmon_process_peak_rss_bytes " + std::to_string(peakRss * 1024) + "\n";
+    }
+}
+
+ResultRecord statsRecord(const PluginStats& stats) {
+    ResultRecord record;
+    record.check = stats.plugin;
+    record.exitCode = 0;
+    char summary[160];
+    std::snprintf(summary, sizeof(summary),
+                  "%s: %llu runs, %llu timeouts, %llu exceptions, p99 %.3f ms",
+                  stats.plugin.c_str(), static_cast<unsigned long long>(stats.runs),
+                  static_cast<unsigned long long>(stats.timeouts),
+                  static_cast<unsigned long long>(stats.exceptions),
+                  static_cast<double>(stats.p99.count()) / 1000.0);
+    record.message = summary;
+
+    PerfMetrics& metrics = record.metrics;
+    metrics.emplace_back("runs", static_cast<double>(stats.runs), "c");
+    metrics.emplace_back("ok", static_cast<double>(stats.byExitCode[0]), "c");
+    metrics.emplace_back("warning", static_cast<double>(stats.byExitCode[1]), "c");
+    metrics.emplace_back("critical", static_cast<double>(stats.byExitCode[2]), "c");
+    metrics.emplace_back("unknown", static_cast<double>(stats.byExitCode[3]), "c");
+    metrics.emplace_back("timeouts", static_cast<double>(stats.timeouts), "c");
+    metrics.emplace_back("exceptions", static_cast<double>(stats.exceptions), "c");
+    metrics.emplace_back("connections", static_cast<double>(stats.connections), "c");
+    metrics.emplace_back("bytes_read", static_cast<double>(stats.bytesRead), "B");
+    metrics.emplace_back("bytes_written", static_cast<double>(stats.bytesWritten), "B");
+    metrics.emplace_back("rss_growth", static_cast<double>(stats.rssGrowthKb), "KB");
+    const std::pair<const char*, std::chrono::microseconds> durations[] = {
+        {"duration_p50", stats.p50}, {"duration_p90", stats.p90},
+        {"duration_p99", stats.p99}, {"duration_max", stats.max}};
+    for (const auto& duration : durations) {
+        metrics.emplace_back(duration.first, static_cast<double>(duration.second.count()) / 1e6,
+                             "s");
+    }
+    record.timestamp = std::chrono::system_clock::now();
+    return record;
+}
+
+} // namespace
+
+void LatencyHistogram::record(std::chrono::microseconds value) {
+    const uint64_t us = value.count() > 0 ? static_cast<uint64_t>(value.count()) : 0;
+    add(counts[bucketIndex(us)], 1);
+    add(sumUs, us);
+    uint64_t seen = maxUs.load(std::memory_order_relaxed);
+    while (us > seen && !maxUs.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+    }
+    add(total, 1);
+}
+
+std::chrono::microseconds LatencyHistogram::sum() const {
+    return std::chrono::microseconds(load(sumUs));
+}
+
+std::chrono::microseconds LatencyHistogram::max() const {
+    return std::chrono::microseconds(load(maxUs));
+}
+
+std::chrono::microseconds LatencyHistogram::quantile(double q) const {
+    const uint64_t recorded = count();
+    if (recorded == 0) {
+        return std::chrono::microseconds(0);
+    }
+    q = std::min(std::max(q, 0.0), 1.0);
+    const uint64_t rank =
+        std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(recorded))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += load(counts[i]);
+        if (seen >= rank) {
+            return std::chrono::microseconds(std::min(bucketUpperBound(i), load(maxUs)));
+        }
+    }
+    // Counts still being added by a concurrent record()
+    return max();
+}
+
+void PluginTelemetry::record(const RunSample& sample) {
+    add(runs, 1);
+    if (sample.exitCode >= 0 && sample.exitCode < static_cast<int>(byExitCode.size())) {
+        add(byExitCode[static_cast<size_t>(sample.exitCode)], 1);
+    }
+    add(timeouts, sample.timedOut ? 1 : 0);
+    add(exceptions, sample.threw ? 1 : 0);
+    add(connections, sample.connections);
+    add(bytesRead, sample.bytesRead);
+    add(bytesWritten, sample.bytesWritten);
+    add(rssGrowthKb, sample.rssGrowthKb);
+    duration.record(sample.duration);
+}
+
+ExecutionTelemetry& ExecutionTelemetry::global() {
+    // Never destroyed: a check abandoned past its deadline may still record
+    // its sample while the process exits
+    static ExecutionTelemetry* telemetry = new ExecutionTelemetry();
+    return *telemetry;
+}
+
+PluginTelemetry& ExecutionTelemetry::plugin(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<PluginTelemetry>& entry = plugins[name];
+    if (!entry) {
+        entry.reset(new PluginTelemetry());
+    }
+    return *entry;
+}
+
+std::vector<PluginStats> ExecutionTelemetry::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<PluginStats> stats;
+    for (const auto& entry : plugins) {
+        const PluginTelemetry& totals = *entry.second;
+        if (load(totals.runs) == 0) {
+            continue;
+        }
+        PluginStats plugin;
+        plugin.plugin = entry.first;
+        plugin.runs = load(totals.runs);
+        for (size_t code = 0; code < plugin.byExitCode.size(); code++) {
+            plugin.byExitCode[code] = load(totals.byExitCode[code]);
+        }
+        plugin.timeouts = load(totals.timeouts);
+        plugin.exceptions = load(totals.exceptions);
+        plugin.connections = load(totals.connections);
+        plugin.bytesRead = load(totals.bytesRead);
+        plugin.bytesWritten = load(totals.bytesWritten);
+        plugin.rssGrowthKb = load(totals.rssGrowthKb);
+        plugin.durationSum = totals.duration.sum();
+        plugin.p50 = totals.duration.quantile(0.5);
+        plugin.p90 = totals.duration.quantile(0.9);
+        plugin.p99 = totals.duration.quantile(0.99);
+        plugin.max = totals.duration.max();
+        stats.push_back(std::move(plugin));
+    }
+    return stats;
+}
+
+uint64_t peakRssKilobytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return static_cast<uint64_t>(counters.PeakWorkingSetSize) / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0 || usage.ru_maxrss < 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;   // Bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+void encodeTelemetry(OutputFormat format, const std::vector<PluginStats>& stats,
+                     std::string& out) {
+    if (format == OutputFormat::PROMETHEUS) {
+        encodePrometheus(stats, out);
+        return;
+    }
+    for (const PluginStats& plugin : stats) {
+        encodeResult(format, statsRecord(plugin), out);
+    }
+}
+
+} // namespace netmon_plugins
@@ -0,0 +1,188 @@
+// src/common/thread_pool.cpp
+// Fixed-size worker pool implementation
+
+#include "netmon/thread_pool.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace netmon_plugins {
+
+struct ThreadPool::State {
+    struct Task {
+        std::function<void()> run;
+        Clock::time_point deadline = Clock::time_point::max();
+    };
+
+    // One per worker thread; reused once its thread has left
+    struct Slot {
+        bool busy = false;
+        bool writtenOff = false;    // Stuck past its task's deadline and replaced
+        bool exited = false;
+        Clock::time_point deadline = Clock::time_point::max();
+    };
+
+    std::deque<Task> tasks;
+    std::vector<Slot> slots;
+    std::mutex mutex;
+    std::condition_variable available;   // Workers wait for tasks
+    std::condition_variable changed;     // Supervisor and shutdown() wait for workers
+    size_t maxQueued = 0;
+    size_t live = 0;                     // Workers not written off
+    uint64_t replacedCount = 0;
+    bool stopping = false;
+    bool stopped = false;                // Every live worker has left
+    std::thread supervisor;
+};
+
+ThreadPool::ThreadPool(size_t workerCount, size_t queueLimit)
+    : state(std::make_shared<State>()) {
+    if (workerCount == 0) {
+        workerCount = 1;
+    }
+    state->maxQueued = queueLimit;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    for (size_t i = 0; i < workerCount; i++) {
+        startWorker(state);
+    }
+    state->supervisor = std::thread([this]() { superviseLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+bool ThreadPool::submit(std::function<void()> task) {
+    return submit(std::move(task), Clock::time_point::max());
+}
+
+bool ThreadPool::submit(std::function<void()> task, Clock::time_point deadline) {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->stopping ||
+            (state->maxQueued > 0 && state->tasks.size() >= state->maxQueued)) {
+            return false;
+        }
+        state->tasks.push_back({std::move(task), deadline});
+    }
+    state->available.notify_one();
+    return true;
+}
+
+void ThreadPool::shutdown() {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (state->stopped) {
+        return;
+    }
+    state->stopping = true;
+    state->available.notify_all();
+    state->changed.notify_all();
+    state->changed.wait(lock, [this]() { return state->live == 0; });
+    state->stopped = true;
+    state->changed.notify_all();
+    lock.unlock();
+    state->supervisor.join();
+}
+
+size_t ThreadPool::size() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->live;
+}
+
+size_t ThreadPool::pending() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->tasks.size();
+}
+
+uint64_t ThreadPool::replaced() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->replacedCount;
+}
+
+// Called with state->mutex held
+void ThreadPool::startWorker(const std::shared_ptr<State>& state) {
+    size_t slot = 0;
+    while (slot < state->slots.size() && !state->slots[slot].exited) {
+        slot++;
+    }
+    if (slot == state->slots.size()) {
+        state->slots.emplace_back();
+    } else {
+        state->slots[slot] = State::Slot();
+    }
+    state->live++;
+    std::thread(workerLoop, state, slot).detach();
+}
+
+void ThreadPool::workerLoop(std::shared_ptr<State> state, size_t slot) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    for (;;) {
+        state->available.wait(lock, [&state]() {
+            return state->stopping || !state->tasks.empty();
+        });
+        if (state->tasks.empty()) {
+            break;
+        }
+        State::Task task = std::move(state->tasks.front());
+        state->tasks.pop_front();
+        state->slots[slot].busy = true;
+        state->slots[slot].deadline = task.deadline;
+        if (task.deadline != Clock::time_point::max()) {
+            state->changed.notify_all();
+        }
+        lock.unlock();
+        try {
+            task.run();
+        } catch (...) {
+            // Tasks report their own failures; never let one kill a worker
+        }
+        task.run = nullptr;
+        lock.lock();
+        state->slots[slot].busy = false;
+        // A replacement took over while this worker was stuck; step aside
+        if (state->slots[slot].writtenOff) {
+            state->slots[slot].exited = true;
+            return;
+        }
+    }
+    state->slots[slot].exited = true;
+    state->live--;
+    state->changed.notify_all();
+}
+
+void ThreadPool::superviseLoop() {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (!state->stopped) {
+        const Clock::time_point now = Clock::now();
+        Clock::time_point next = Clock::time_point::max();
+        for (size_t slot = 0; slot < state->slots.size(); slot++) {
+            State::Slot& worker = state->slots[slot];
+            if (!worker.busy || worker.writtenOff || worker.exited) {
+                continue;
+            }
+            if (worker.deadline > now) {
+                next = std::min(next, worker.deadline);
+                continue;
+            }
+            worker.writtenOff = true;
+            state->live--;
+            state->replacedCount++;
+            // Past shutdown a replacement is only needed to drain the queue
+            if (!state->stopping || !state->tasks.empty()) {
+                startWorker(state);
+            }
+            state->changed.notify_all();
+        }
+        if (next == Clock::time_point::max()) {
+            state->changed.wait(lock);
+        } else {
+            state->changed.wait_until(lock, next);
+        }
+    }
+}
+
+} // namespace netmon_plugins
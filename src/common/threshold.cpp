@@ -0,0 +1,139 @@
+// src/common/threshold.cpp
+// Nagios threshold range implementation
+
+#include "netmon/threshold.hpp"
+#include "netmon/perfdata.hpp"
+#include "netmon/plugin.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace netmon_plugins {
+
+namespace {
+
+// Parse all of text as a number without allocating
+bool parseBound(std::string_view text, double& value) {
+    char buffer[64];
+    if (text.empty() || text.size() >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    return end == buffer + text.size() && !std::isnan(value);
+}
+
+} // namespace
+
+bool ThresholdRange::tryParse(std::string_view text, ThresholdRange& range) {
+    ThresholdRange parsed;
+    parsed.set = true;
+    if (!text.empty() && text.front() == '@') {
+        parsed.inside = true;
+        text.remove_prefix(1);
+    }
+
+    const size_t colon = text.find(':');
+    if (colon == std::string_view::npos) {
+        // "10" is "0:10"
+        if (!parseBound(text, parsed.high)) {
+            return false;
+        }
+    } else {
+        std::string_view startText = text.substr(0, colon);
+        std::string_view endText = text.substr(colon + 1);
+        if (startText == "~") {
+            parsed.low = -std::numeric_limits<double>::infinity();
+        } else if (!startText.empty() && !parseBound(startText, parsed.low)) {
+            return false;
+        }
+        if (!endText.empty() && !parseBound(endText, parsed.high)) {
+            return false;
+        }
+    }
+    if (parsed.low > parsed.high) {
+        return false;
+    }
+    range = parsed;
+    return true;
+}
+
+ThresholdRange ThresholdRange::parse(std::string_view text) {
+    ThresholdRange range;
+    if (!tryParse(text, range)) {
+        throw std::invalid_argument("Invalid threshold range '" + std::string(text) + "'");
+    }
+    return range;
+}
+
+ThresholdRange ThresholdRange::above(double limit) {
+    ThresholdRange range;
+    range.set = true;
+    range.low = -std::numeric_limits<double>::infinity();
+    range.high = limit;
+    return range;
+}
+
+ThresholdRange ThresholdRange::below(double limit) {
+    ThresholdRange range;
+    range.set = true;
+    range.low = limit;
+    return range;
+}
+
+std::string ThresholdRange::toString() const {
+    if (!set) {
+        return "";
+    }
+    std::string text = inside ? "@" : "";
+    const bool openEnd = std::isinf(high);
+    if (low == 0.0 && !openEnd) {
+        return text + formatPerfValue(high);
+    }
+    text += std::isinf(low) ? "~" : formatPerfValue(low);
+    text += ':';
+    if (!openEnd) {
+        text += formatPerfValue(high);
+    }
+    return text;
+}
+
+ExitCode Thresholds::evaluate(double value) const {
+    if (critical.alerts(value)) {
+        return ExitCode::CRITICAL;
+    }
+    return warning.alerts(value) ? ExitCode::WARNING : ExitCode::OK;
+}
+
+ExitCode Thresholds::evaluate(const double* values, size_t count) const {
+    bool warned = false;
+    for (size_t i = 0; i < count; i++) {
+        if (critical.alerts(values[i])) {
+            return ExitCode::CRITICAL;
+        }
+        warned = warned || warning.alerts(values[i]);
+    }
+    return warned ? ExitCode::WARNING : ExitCode::OK;
+}
+
+size_t parseThresholdList(std::string_view text, ThresholdRange* ranges, size_t maxRanges) {
+    const std::string_view list = text;
+    size_t count = 0;
+    for (;;) {
+        const size_t comma = text.find(',');
+        std::string_view item = text.substr(0, comma);
+        if (count == maxRanges) {
+            throw std::invalid_argument("Too many thresholds in '" + std::string(list) + "'");
+        }
+        ranges[count++] = item.empty() ? ThresholdRange() : ThresholdRange::parse(item);
+        if (comma == std::string_view::npos) {
+            return count;
+        }
+        text.remove_prefix(comma + 1);
+    }
+}
+
+} // namespace netmon_plugins
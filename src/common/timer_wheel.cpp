@@ -0,0 +1,215 @@
+// src/common/timer_wheel.cpp
+// Hierarchical timer wheel implementation
+
+#include "netmon/timer_wheel.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace netmon_plugins {
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, CheckClock::time_point start)
+    : tickLength(std::max(tick, std::chrono::milliseconds(1))), origin(start) {
+    heads.fill(NIL);
+}
+
+uint64_t TimerWheel::tickOf(CheckClock::time_point when) const {
+    if (when <= origin) {
+        return 0;
+    }
+    // Round up: a timer never fires before its time
+    const auto elapsed = when - origin;
+    const auto ticks = (elapsed + tickLength - CheckClock::duration(1)) / tickLength;
+    return static_cast<uint64_t>(ticks);
+}
+
+CheckClock::time_point TimerWheel::timeOf(uint64_t tick) const {
+    return origin + tickLength * static_cast<int64_t>(tick);
+}
+
+void TimerWheel::link(uint32_t index, uint32_t list) {
+    Node& node = nodes[index];
+    node.list = list;
+    node.prev = NIL;
+    node.next = heads[list];
+    if (node.next != NIL) {
+        nodes[node.next].prev = index;
+    }
+    heads[list] = index;
+    if (list < OVERFLOW_LIST) {
+        perLevel[list / SLOTS]++;
+    } else if (list == OVERFLOW_LIST) {
+        perLevel[LEVELS]++;
+    }
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes[index];
+    if (node.prev != NIL) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.list] = node.next;
+    }
+    if (node.next != NIL) {
+        nodes[node.next].prev = node.prev;
+    }
+    if (node.list < OVERFLOW_LIST) {
+        perLevel[node.list / SLOTS]--;
+    } else if (node.list == OVERFLOW_LIST) {
+        perLevel[LEVELS]--;
+    }
+    node.prev = node.next = NIL;
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = nodes[index];
+    node.callback = nullptr;
+    node.list = FREE;
+    node.generation++;
+    freeNodes.push_back(index);
+    count--;
+}
+
+// A timer goes on the lowest level whose current block it falls in, so
+// its slot is always reached (and cascaded, or fired) before it is due
+void TimerWheel::place(uint32_t index) {
+    const uint64_t expires = nodes[index].expires;
+    for (unsigned level = 0; level < LEVELS; level++) {
+        const unsigned blockShift = LEVEL_BITS * (level + 1);
+        if ((expires >> blockShift) == (current >> blockShift)) {
+            const uint32_t slot = static_cast<uint32_t>((expires >> (LEVEL_BITS * level)) & (SLOTS - 1));
+            link(index, level * SLOTS + slot);
+            return;
+        }
+    }
+    link(index, OVERFLOW_LIST);
+}
+
+void TimerWheel::cascade(uint32_t list) {
+    uint32_t index = heads[list];
+    while (index != NIL) {
+        const uint32_t next = nodes[index].next;
+        unlink(index);
+        place(index);
+        index = next;
+    }
+}
+
+TimerId TimerWheel::schedule(CheckClock::time_point when, Callback callback) {
+    uint32_t index;
+    if (!freeNodes.empty()) {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    Node& node = nodes[index];
+    node.expires = std::max(tickOf(when), current);
+    node.callback = std::move(callback);
+    place(index);
+    count++;
+    return (static_cast<TimerId>(node.generation) << 32) | (index + 1u);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    const uint64_t low = id & 0xffffffffu;
+    if (low == 0 || low > nodes.size()) {
+        return false;
+    }
+    const uint32_t index = static_cast<uint32_t>(low - 1);
+    if (nodes[index].list == FREE || nodes[index].generation != static_cast<uint32_t>(id >> 32)) {
+        return false;
+    }
+    unlink(index);
+    release(index);
+    return true;
+}
+
+// The first tick at or after current at which a cascade could bring a
+// timer down to level 0; only meaningful while level 0 is empty
+uint64_t TimerWheel::nextBoundary() const {
+    for (unsigned level = 1; level <= LEVELS; level++) {
+        if (perLevel[level] > 0) {
+            const uint64_t mask = (uint64_t(1) << (LEVEL_BITS * level)) - 1;
+            return (current + mask) & ~mask;
+        }
+    }
+    return UINT64_MAX;
+}
+
+size_t TimerWheel::advance(CheckClock::time_point now) {
+    if (now < origin) {
+        return 0;
+    }
+    // Tick t is due once now has reached origin + t * tick
+    const uint64_t last = static_cast<uint64_t>((now - origin) / tickLength);
+
+    size_t fired = 0;
+    while (current <= last) {
+        if (count == 0) {
+            current = last + 1;
+            break;
+        }
+        if (perLevel[0] == 0) {
+            // Nothing can fire before the next cascade; jump straight there
+            const uint64_t boundary = nextBoundary();
+            if (boundary > last) {
+                current = last + 1;
+                break;
+            }
+            current = boundary;
+        }
+
+        // Spread the upper slots that start at this tick, highest first
+        if ((current & (SLOTS - 1)) == 0) {
+            if ((current & ((uint64_t(1) << (LEVEL_BITS * LEVELS)) - 1)) == 0) {
+                cascade(OVERFLOW_LIST);
+            }
+            for (unsigned level = LEVELS - 1; level >= 1; level--) {
+                const unsigned shift = LEVEL_BITS * level;
+                if ((current & ((uint64_t(1) << shift) - 1)) == 0) {
+                    cascade(level * SLOTS + static_cast<uint32_t>((current >> shift) & (SLOTS - 1)));
+                }
+            }
+        }
+
+        // Move this tick's timers aside so that callbacks scheduling "now"
+        // land on the next tick rather than in the list being walked
+        const uint32_t slot = static_cast<uint32_t>(current & (SLOTS - 1));
+        for (uint32_t index = heads[slot]; index != NIL; index = nodes[index].next) {
+            nodes[index].list = FIRING_LIST;
+            perLevel[0]--;
+        }
+        heads[FIRING_LIST] = heads[slot];
+        heads[slot] = NIL;
+        current++;
+
+        while (heads[FIRING_LIST] != NIL) {
+            const uint32_t index = heads[FIRING_LIST];
+            unlink(index);
+            Callback callback = std::move(nodes[index].callback);
+            release(index);
+            callback();
+            fired++;
+        }
+    }
+    return fired;
+}
+
+CheckClock::time_point TimerWheel::nextExpiry() const {
+    if (count == 0) {
+        return CheckClock::time_point::max();
+    }
+    if (perLevel[0] > 0) {
+        // Level 0 holds the rest of the current 256-tick block
+        const uint64_t block = current & ~uint64_t(SLOTS - 1);
+        for (uint32_t slot = static_cast<uint32_t>(current & (SLOTS - 1)); slot < SLOTS; slot++) {
+            if (heads[slot] != NIL) {
+                return timeOf(block + slot);
+            }
+        }
+    }
+    return timeOf(nextBoundary());
+}
+
+} // namespace netmon_plugins
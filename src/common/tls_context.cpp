@@ -0,0 +1,112 @@
+// src/common/tls_context.cpp
+// Process-wide TLS client contexts and session cache implementation
+
+#include "netmon/tls_context.hpp"
+
+#ifdef NETMON_SSL_ENABLED
+
+#include <algorithm>
+#include <utility>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+namespace netmon_plugins {
+namespace net {
+
+void TlsClientCache::ContextDeleter::operator()(SSL_CTX* context) const {
+    SSL_CTX_free(context);
+}
+
+TlsClientCache& TlsClientCache::shared() {
+    // Never destroyed: connections of abandoned checks may outlive exit
+    static TlsClientCache* cache = new TlsClientCache();
+    return *cache;
+}
+
+SSL_CTX* TlsClientCache::context(bool verifyPeer, const std::string& caFile) {
+    const std::string key = verifyPeer ? "verify:" + caFile : "none";
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = contexts.find(key);
+    if (found != contexts.end()) {
+        return found->second.get();
+    }
+
+    std::unique_ptr<SSL_CTX, ContextDeleter> context(SSL_CTX_new(TLS_client_method()));
+    if (!context) {
+        ERR_clear_error();
+        return nullptr;
+    }
+    // Sessions are kept per server below, not in OpenSSL's own cache,
+    // which a client cannot look up by server
+    SSL_CTX_set_session_cache_mode(context.get(),
+                                   SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    if (verifyPeer) {
+        const bool loaded = caFile.empty()
+                                ? SSL_CTX_set_default_verify_paths(context.get()) == 1
+                                : SSL_CTX_load_verify_locations(context.get(), caFile.c_str(),
+                                                                nullptr) == 1;
+        if (!loaded) {
+            ERR_clear_error();
+            return nullptr;
+        }
+        SSL_CTX_set_verify(context.get(), SSL_VERIFY_PEER, nullptr);
+    } else {
+        SSL_CTX_set_verify(context.get(), SSL_VERIFY_NONE, nullptr);
+    }
+    SSL_CTX* result = context.get();
+    contexts.emplace(key, std::move(context));
+    return result;
+}
+
+SSL_SESSION* TlsClientCache::session(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = sessions.find(key);
+    if (found == sessions.end()) {
+        return nullptr;
+    }
+    const unsigned char* der = reinterpret_cast<const unsigned char*>(found->second.der.data());
+    SSL_SESSION* copy = d2i_SSL_SESSION(nullptr, &der, static_cast<long>(found->second.der.size()));
+    if (!copy) {
+        ERR_clear_error();
+    }
+    return copy;
+}
+
+void TlsClientCache::storeSession(const std::string& key, SSL_SESSION* session) {
+    std::string der;
+    const int length = session ? i2d_SSL_SESSION(session, nullptr) : 0;
+    if (length > 0) {
+        der.resize(static_cast<size_t>(length));
+        unsigned char* out = reinterpret_cast<unsigned char*>(&der[0]);
+        if (i2d_SSL_SESSION(session, &out) != length) {
+            der.clear();
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    sessions.erase(key);
+    if (der.empty()) {
+        return;
+    }
+    if (sessions.size() >= MAX_SESSIONS) {
+        sessions.erase(std::min_element(sessions.begin(), sessions.end(),
+                                        [](const auto& a, const auto& b) {
+                                            return a.second.stored < b.second.stored;
+                                        }));
+    }
+    sessions.emplace(key, StoredSession{std::move(der), ++stores});
+}
+
+size_t TlsClientCache::sessionCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sessions.size();
+}
+
+void TlsClientCache::clearSessions() {
+    std::lock_guard<std::mutex> lock(mutex);
+    sessions.clear();
+}
+
+} // namespace net
+} // namespace netmon_plugins
+
+#endif // NETMON_SSL_ENABLED
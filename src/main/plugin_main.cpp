@@ -0,0 +1,8 @@
+// src/main/plugin_main.cpp
+// Entry point of the check_* executables and the netmon multicall binary
+
+#include "netmon/plugin.hpp"
+
+int main(int argc, char* argv[]) {
+    return netmon_plugins::runPluginMain(argc, argv);
+}
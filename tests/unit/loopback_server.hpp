@@ -0,0 +1,68 @@
+// tests/unit/loopback_server.hpp
+// Listening socket on 127.0.0.1 shared by the network tests' fake servers
+
+#ifndef NETMON_TESTS_LOOPBACK_SERVER_HPP
+#define NETMON_TESTS_LOOPBACK_SERVER_HPP
+
+#ifndef _WIN32
+
+#include <atomic>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace netmon_plugins {
+namespace testing {
+
+// Listens on an ephemeral loopback port. A test server owns one and keeps
+// only its own serve logic.
+class LoopbackListener {
+public:
+    explicit LoopbackListener(int backlog) {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        listen(listenFd, backlog);
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+        boundPort = ntohs(addr.sin_port);
+    }
+
+    ~LoopbackListener() { close(listenFd); }
+
+    LoopbackListener(const LoopbackListener&) = delete;
+    LoopbackListener& operator=(const LoopbackListener&) = delete;
+
+    int fd() const { return listenFd; }
+    int port() const { return boundPort; }
+
+    // Next client, waiting as long as it takes
+    int accept() { return ::accept(listenFd, nullptr, nullptr); }
+
+    // Next client, or -1 once stopping is set; checks it every 20ms
+    int accept(const std::atomic<bool>& stopping) {
+        struct pollfd pfd = {listenFd, POLLIN, 0};
+        while (!stopping) {
+            if (poll(&pfd, 1, 20) > 0) {
+                return accept();
+            }
+        }
+        return -1;
+    }
+
+private:
+    int listenFd = -1;
+    int boundPort = 0;
+};
+
+} // namespace testing
+} // namespace netmon_plugins
+
+#endif // _WIN32
+
+#endif // NETMON_TESTS_LOOPBACK_SERVER_HPP
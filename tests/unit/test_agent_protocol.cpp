@@ -0,0 +1,36 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "netmon/agent_protocol.hpp"
+
+TEST_CASE("agent requests round-trip", "[agent]") {
+    netmon_plugins::AgentRequest request;
+    request.timeoutSeconds = 15;
+    request.args = {"check_http", "-H", "example.com", "-s", "two words", ""};
+
+    netmon_plugins::AgentRequest decoded;
+    REQUIRE(netmon_plugins::decodeAgentRequest(
+        netmon_plugins::encodeAgentRequest(request), decoded));
+    REQUIRE(decoded.timeoutSeconds == 15);
+    REQUIRE(decoded.args == request.args);
+}
+
+TEST_CASE("malformed agent requests are rejected", "[agent]") {
+    netmon_plugins::AgentRequest decoded;
+
+    REQUIRE_FALSE(netmon_plugins::decodeAgentRequest("", decoded));
+    REQUIRE_FALSE(netmon_plugins::decodeAgentRequest(std::string("10\0check_tcp", 12), decoded));
+    REQUIRE_FALSE(netmon_plugins::decodeAgentRequest(std::string("ten\0check_tcp\0", 14), decoded));
+    REQUIRE_FALSE(netmon_plugins::decodeAgentRequest(std::string("10\0", 3), decoded));
+}
+
+TEST_CASE("agent responses round-trip", "[agent]") {
+    netmon_plugins::AgentResponse response;
+    response.exitCode = 2;
+    response.output = "CRITICAL: down | time=1s\n";
+
+    netmon_plugins::AgentResponse decoded;
+    REQUIRE(netmon_plugins::decodeAgentResponse(
+        netmon_plugins::encodeAgentResponse(response), decoded));
+    REQUIRE(decoded.exitCode == 2);
+    REQUIRE(decoded.output == response.output);
+}
@@ -0,0 +1,188 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "netmon/config.hpp"
+#include "netmon/plugin.hpp"
+#include "netmon/result_cache.hpp"
+
+using namespace netmon_plugins;
+
+namespace {
+
+void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream out(path);
+    out << content;
+}
+
+} // namespace
+
+TEST_CASE("parseIni reads sections, keys and comments", "[config]") {
+    std::istringstream input("top = 1\n"
+                             "# comment\n"
+                             "[defaults]\n"
+                             "  timeout =  15  \n"
+                             "; another comment\n"
+                             "[http\n"
+                             "no equals sign\n");
+    std::vector<std::string> errors;
+    IniSections sections = parseIni(input, errors);
+    REQUIRE(sections[""]["top"] == "1");
+    REQUIRE(sections["defaults"]["timeout"] == "15");
+    REQUIRE(errors.size() == 2);
+    REQUIRE(errors[0].compare(0, 7, "line 6:") == 0);
+    REQUIRE(errors[1].compare(0, 7, "line 7:") == 0);
+}
+
+TEST_CASE("readSettings applies the example file and rejects unknown keys", "[config]") {
+    std::istringstream input("[defaults]\n"
+                             "timeout = 20\n"
+                             "[http]\n"
+                             "timeout = 5\n"
+                             "[logging]\n"
+                             "enabled = yes\n"
+                             "log_file = /tmp/checks.log\n");
+    std::vector<std::string> errors;
+    std::vector<std::string> warnings;
+    Settings settings = readSettings(input, errors, warnings);
+    REQUIRE(errors.empty());
+    REQUIRE(warnings.empty());
+    REQUIRE(settings.timeoutSeconds == 20);
+    REQUIRE(settings.httpTimeoutSeconds == 5);
+    REQUIRE(settings.logEnabled);
+    REQUIRE(settings.logFile == "/tmp/checks.log");
+
+    std::istringstream bad("[defaults]\ntimeout = soon\n[defaults]\ncolour = blue\n");
+    settings = readSettings(bad, errors, warnings);
+    REQUIRE(errors.size() == 2);
+    REQUIRE(settings.timeoutSeconds == 10);
+
+    // Legacy settings no check honours are ignored with a warning
+    errors.clear();
+    std::istringstream unsupported("[defaults]\nverbose = 1\nplugin_dir = /opt\n"
+                                   "[http]\nverify_ssl = 1\n");
+    readSettings(unsupported, errors, warnings);
+    REQUIRE(errors.empty());
+    REQUIRE(warnings.size() == 3);
+    REQUIRE(warnings[2] == "ignoring unsupported setting [http] verify_ssl");
+
+    warnings.clear();
+    std::ifstream example(NETMON_SOURCE_DIR "/config/netmon-plugins.conf.example");
+    REQUIRE(example);
+    readSettings(example, errors, warnings);
+    REQUIRE(errors.empty());
+    REQUIRE(warnings.empty());
+}
+
+TEST_CASE("compileCheck prepares a check once and applies the http timeout", "[config]") {
+    Settings settings;
+    settings.httpTimeoutSeconds = 7;
+
+    ScheduledCheck check;
+    check.id = "warn";
+    check.args = {"check_dummy", "-w", "-m", "compiled"};
+    CompiledCheck compiled;
+    std::string error;
+    REQUIRE(compileCheck(check, settings, compiled, error));
+    REQUIRE(compiled.key == resultCacheKey(check.args));
+    REQUIRE(compiled.check.timeoutSeconds == 0);
+    const CheckOutcome first = compiled.prepared->run(CheckContext());
+    const CheckOutcome second = compiled.prepared->run(CheckContext());
+    REQUIRE(first.exitCode == 1);
+    REQUIRE(second.output == first.output);
+
+    // Only the dummy plugin is linked into the tests
+    if (PluginRegistry::instance().contains("http")) {
+        check.args = {"http", "-H", "localhost"};
+        REQUIRE(compileCheck(check, settings, compiled, error));
+        REQUIRE(compiled.check.timeoutSeconds == 7);
+    }
+
+    check.args = {"no_such_plugin"};
+    REQUIRE_FALSE(compileCheck(check, settings, compiled, error));
+    REQUIRE_FALSE(error.empty());
+    REQUIRE(error.find('\n') == std::string::npos);
+}
+
+TEST_CASE("loadConfiguration compiles an inventory and collects every error", "[config]") {
+    char dirTemplate[] = "/tmp/netmon-config-XXXXXX";
+    REQUIRE(mkdtemp(dirTemplate) != nullptr);
+    const std::string dir = dirTemplate;
+    writeFile(dir + "/netmon.conf", "[defaults]\ntimeout = 30\n");
+    writeFile(dir + "/inventory", "30s ok: dummy -m fine\n"
+                                  "5m bad: no_such_plugin\n"
+                                  "dummy -c\n");
+
+    auto config = loadConfiguration(dir + "/netmon.conf", dir + "/inventory");
+    REQUIRE(config->settings.timeoutSeconds == 30);
+    REQUIRE(config->checks.size() == 2);
+    REQUIRE(config->checks[0].check.id == "ok");
+    REQUIRE(config->checks[0].check.interval == std::chrono::seconds(30));
+    REQUIRE(config->checks[1].check.id == "3");
+    REQUIRE(config->errors.size() == 1);
+    REQUIRE(config->errors[0].find("inventory: bad: ") != std::string::npos);
+
+    // A config installed from an older example still loads
+    writeFile(dir + "/legacy.conf", "[defaults]\ntimeout = 10\nverbose = 0\n"
+                                    "[http]\nverify_ssl = 1\n");
+    config = loadConfiguration(dir + "/legacy.conf", "");
+    REQUIRE(config->ok());
+    REQUIRE(config->warnings.size() == 2);
+    REQUIRE(config->warnings[0].find("legacy.conf: ignoring") == dir.size() + 1);
+
+    config = loadConfiguration(dir + "/missing.conf", "");
+    REQUIRE_FALSE(config->ok());
+    REQUIRE(loadConfiguration("", "")->ok());
+}
+
+TEST_CASE("FileWatcher notices writes and replacements of watched files", "[config]") {
+    char dirTemplate[] = "/tmp/netmon-watch-XXXXXX";
+    REQUIRE(mkdtemp(dirTemplate) != nullptr);
+    const std::string dir = dirTemplate;
+    const std::string path = dir + "/inventory";
+    writeFile(path, "users\n");
+
+    FileWatcher watcher({path});
+    REQUIRE_FALSE(watcher.changed());
+
+    writeFile(dir + "/unrelated", "x\n");
+    REQUIRE_FALSE(watcher.changed());
+
+    // Replaced by rename, as editors save; mtimes only resolve to seconds
+    // on some systems, so give the fallback a distinct one
+    writeFile(path + ".new", "load\n");
+    const std::string renamed = path + ".new";
+    REQUIRE(std::system(("touch -d '+2 seconds' " + renamed + " && mv " + renamed + " " +
+                         path).c_str()) == 0);
+    REQUIRE(watcher.changed());
+    REQUIRE_FALSE(watcher.changed());
+}
+
+TEST_CASE("ResultLog appends one tab-separated line per result", "[config]") {
+    char dirTemplate[] = "/tmp/netmon-log-XXXXXX";
+    REQUIRE(mkdtemp(dirTemplate) != nullptr);
+    const std::string path = std::string(dirTemplate) + "/checks.log";
+
+    ResultRecord record;
+    record.check = "web1";
+    record.exitCode = 2;
+    record.message = "down\nsecond line";
+    record.latency = std::chrono::microseconds(1500);
+    record.timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+
+    ResultLog log;
+    log.write(record);   // Not open: dropped
+    REQUIRE(log.open(path));
+    log.write(record);
+    log.close();
+
+    std::ifstream in(path);
+    std::string line;
+    REQUIRE(std::getline(in, line));
+    REQUIRE(line == "2023-11-14T22:13:20Z\tweb1\t2\t1.500\tCRITICAL: down second line");
+    REQUIRE_FALSE(std::getline(in, line));
+}
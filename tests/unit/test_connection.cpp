@@ -0,0 +1,228 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "netmon/connection.hpp"
+
+#include "loopback_server.hpp"
+
+using namespace netmon_plugins;
+using std::chrono::milliseconds;
+
+namespace {
+
+ResolvedAddress fakeAddress(int family) {
+    ResolvedAddress address;
+    address.family = family;
+    return address;
+}
+
+#ifndef _WIN32
+// Loopback server that sends payload, in chunks of chunkSize with a short
+// pause between them, to one client and then closes
+class PayloadServer {
+public:
+    PayloadServer(const std::string& payload, size_t chunkSize) : listener(1) {
+        port = listener.port();
+        thread = std::thread([this, payload, chunkSize]() {
+            int client = listener.accept();
+            for (size_t offset = 0; offset < payload.size(); offset += chunkSize) {
+                std::string chunk = payload.substr(offset, chunkSize);
+                send(client, chunk.data(), chunk.size(), MSG_NOSIGNAL);
+                std::this_thread::sleep_for(milliseconds(2));
+            }
+            close(client);
+        });
+    }
+
+    ~PayloadServer() {
+        thread.join();
+    }
+
+    int port = 0;
+
+private:
+    testing::LoopbackListener listener;
+    std::thread thread;
+};
+#endif
+
+} // namespace
+
+TEST_CASE("interleaveFamilies alternates address families", "[connection]") {
+    AddressList addresses = {fakeAddress(10), fakeAddress(10), fakeAddress(10),
+                             fakeAddress(2), fakeAddress(2)};
+    AddressList ordered = interleaveFamilies(addresses);
+
+    REQUIRE(ordered.size() == 5);
+    REQUIRE(ordered[0].family == 10);
+    REQUIRE(ordered[1].family == 2);
+    REQUIRE(ordered[2].family == 10);
+    REQUIRE(ordered[3].family == 2);
+    REQUIRE(ordered[4].family == 10);
+}
+
+TEST_CASE("lookupAsync resolves on the shared threads and drops unwanted requests",
+          "[connection]") {
+    auto unwantedRan = std::make_shared<std::atomic<bool>>(false);
+    REQUIRE(lookupAsync("localhost", 80, []() { return false; },
+                        [unwantedRan](bool, AddressList&, const std::string&) {
+                            *unwantedRan = true;
+                        }));
+
+    auto result = std::make_shared<std::promise<size_t>>();
+    REQUIRE(lookupAsync("localhost", 80, nullptr,
+                        [result](bool ok, AddressList& addresses, const std::string&) {
+                            result->set_value(ok ? addresses.size() : 0);
+                        }));
+    std::future<size_t> found = result->get_future();
+    REQUIRE(found.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(found.get() > 0);
+    REQUIRE_FALSE(*unwantedRan);
+}
+
+#ifndef _WIN32
+TEST_CASE("Connection reads lines, delimiters and fixed sizes across chunks", "[connection][network]") {
+    PayloadServer server("+OK ready\r\nsecond line\n$5\r\nhelloEND-tail", 3);
+
+    net::Connection conn;
+    REQUIRE(conn.open("127.0.0.1", server.port,
+                      CheckContext(Deadline::afterSeconds(5), CancellationToken())));
+    REQUIRE(conn.isOpen());
+    REQUIRE_FALSE(conn.isTls());
+    REQUIRE(conn.peerAddress() == "127.0.0.1");
+
+    std::string line;
+    REQUIRE(conn.readLine(line) == IoStatus::OK);
+    REQUIRE(line == "+OK ready");
+    REQUIRE(conn.readLine(line) == IoStatus::OK);
+    REQUIRE(line == "second line");
+
+    std::string data;
+    REQUIRE(conn.readUntil("\r\n", data) == IoStatus::OK);
+    REQUIRE(data == "$5\r\n");
+
+    data.clear();
+    REQUIRE(conn.readExactly(5, data) == IoStatus::OK);
+    REQUIRE(data == "hello");
+
+    data.clear();
+    REQUIRE(conn.readAll(data) == IoStatus::OK);
+    REQUIRE(data == "END-tail");
+}
+
+TEST_CASE("Connection reports its phases to the check's recorder", "[connection][network]") {
+    PayloadServer server("+OK\r\n", 64);
+    auto recorder = std::make_shared<PhaseRecorder>();
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken(), recorder);
+
+    {
+        net::Connection conn;
+        REQUIRE(conn.open("127.0.0.1", server.port, context));
+        std::string line;
+        REQUIRE(conn.readLine(line) == IoStatus::OK);
+
+        PhaseTimings timings = conn.timings();
+        REQUIRE(timings.firstByte > std::chrono::microseconds(0));
+        REQUIRE(timings.total >= timings.connect + timings.firstByte);
+        REQUIRE(timings.recorded ==
+                (PhaseTimings::DNS | PhaseTimings::CONNECT | PhaseTimings::FIRST_BYTE));
+        REQUIRE(recorder->connections() == 0);   // Recorded on close
+    }
+    REQUIRE(recorder->connections() == 1);
+}
+
+TEST_CASE("Connection returns a final unterminated line with CLOSED", "[connection][network]") {
+    PayloadServer server("no newline", 64);
+
+    net::Connection conn;
+    REQUIRE(conn.open("127.0.0.1", server.port,
+                      CheckContext(Deadline::afterSeconds(5), CancellationToken())));
+    std::string line;
+    REQUIRE(conn.readLine(line) == IoStatus::CLOSED);
+    REQUIRE(line == "no newline");
+}
+
+TEST_CASE("Connection reports a refused connect", "[connection][network]") {
+    int port;
+    {
+        PayloadServer server("", 1);
+        port = server.port;
+        net::Connection once;   // The server accepts one client before closing
+        once.open("127.0.0.1", port, CheckContext(Deadline::afterSeconds(5), CancellationToken()));
+    }
+
+    net::Connection conn;
+    REQUIRE_FALSE(conn.open("127.0.0.1", port,
+                            CheckContext(Deadline::afterSeconds(5), CancellationToken())));
+    REQUIRE(conn.status() == IoStatus::FAILED);
+    REQUIRE(conn.error().find("127.0.0.1") != std::string::npos);
+    REQUIRE_FALSE(conn.isOpen());
+}
+
+TEST_CASE("connectAny falls through to the next address without waiting", "[connection][network]") {
+    PayloadServer server("", 1);
+
+    // 10.255.255.1 is unroutable: its attempt either hangs or fails at once
+    AddressList unreachable;
+    AddressList loopback;
+    REQUIRE(resolveNumeric("10.255.255.1", server.port, unreachable));
+    REQUIRE(resolveNumeric("127.0.0.1", server.port, loopback));
+    AddressList addresses = {unreachable[0], loopback[0]};
+
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+    auto start = CheckClock::now();
+    IoStatus status;
+    size_t winner = 99;
+    SocketFd fd = connectAny(addresses, context, 100, status, &winner);
+    auto elapsed = std::chrono::duration_cast<milliseconds>(CheckClock::now() - start).count();
+    closeSocket(fd);
+
+    REQUIRE(status == IoStatus::OK);
+    REQUIRE(winner == 1);
+    REQUIRE(elapsed < 1000);
+}
+
+TEST_CASE("connectAny starts the next address as soon as one attempt is refused",
+          "[connection][network]") {
+    PayloadServer server("", 1);
+    int closedPort;
+    {
+        testing::LoopbackListener gone(1);
+        closedPort = gone.port();
+    }
+
+    // A listener whose accept queue is full drops further SYNs, so the
+    // attempt on it stays pending while the refused one fails
+    testing::LoopbackListener full(0);
+    AddressList stalled;
+    REQUIRE(resolveNumeric("127.0.0.1", full.port(), stalled));
+    int queued = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(connect(queued, reinterpret_cast<const struct sockaddr*>(stalled[0].sockaddr.data()),
+                    static_cast<socklen_t>(stalled[0].sockaddr.size())) == 0);
+
+    AddressList refused;
+    AddressList loopback;
+    REQUIRE(resolveNumeric("127.0.0.1", closedPort, refused));
+    REQUIRE(resolveNumeric("127.0.0.1", server.port, loopback));
+    AddressList addresses = {stalled[0], refused[0], loopback[0]};
+
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+    auto start = CheckClock::now();
+    IoStatus status;
+    size_t winner = 99;
+    SocketFd fd = connectAny(addresses, context, 400, status, &winner);
+    auto elapsed = std::chrono::duration_cast<milliseconds>(CheckClock::now() - start).count();
+    closeSocket(fd);
+    close(queued);
+
+    REQUIRE(status == IoStatus::OK);
+    REQUIRE(winner == 2);
+    REQUIRE(elapsed < 700);   // One head start, not two
+}
+#endif
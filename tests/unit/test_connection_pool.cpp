@@ -0,0 +1,301 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "netmon/connection_pool.hpp"
+#include "netmon/http_api.hpp"
+
+#include "loopback_server.hpp"
+
+using namespace netmon_plugins;
+using std::chrono::milliseconds;
+
+#ifndef _WIN32
+namespace {
+
+// Loopback HTTP server answering every request on a connection with
+// response, closing the connection afterwards if closeAfter, and keeping
+// the requests it received
+class KeepAliveServer {
+public:
+    explicit KeepAliveServer(const std::string& response, bool closeAfter = false)
+        : listener(8) {
+        port = listener.port();
+        acceptor = std::thread([this, response, closeAfter]() {
+            int client;
+            while ((client = listener.accept(stopping)) >= 0) {
+                accepted++;
+                std::lock_guard<std::mutex> lock(mutex);
+                clients.emplace_back([this, client, response, closeAfter]() {
+                    serve(client, response, closeAfter);
+                });
+            }
+        });
+    }
+
+    ~KeepAliveServer() {
+        stopping = true;
+        acceptor.join();
+        for (std::thread& client : clients) {
+            client.join();
+        }
+    }
+
+    std::vector<std::string> received() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return messages;
+    }
+
+    int port = 0;
+    std::atomic<int> accepted{0};
+    std::atomic<int> requests{0};
+
+private:
+    void serve(int client, const std::string& response, bool closeAfter) {
+        std::string received;
+        char buffer[1024];
+        while (!stopping) {
+            struct pollfd pfd = {client, POLLIN, 0};
+            if (poll(&pfd, 1, 20) <= 0) {
+                continue;
+            }
+            ssize_t bytes = recv(client, buffer, sizeof(buffer), 0);
+            if (bytes <= 0) {
+                break;
+            }
+            received.append(buffer, static_cast<size_t>(bytes));
+            size_t end;
+            while ((end = received.find("\r\n\r\n")) != std::string::npos) {
+                size_t length = end + 4;
+                const size_t field = received.find("Content-Length: ");
+                if (field < end) {
+                    length += std::stoul(received.substr(field + 16));
+                }
+                if (received.size() < length) {
+                    break;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    messages.push_back(received.substr(0, length));
+                }
+                received.erase(0, length);
+                requests++;
+                send(client, response.data(), response.size(), MSG_NOSIGNAL);
+                if (closeAfter) {
+                    close(client);
+                    return;
+                }
+            }
+        }
+        close(client);
+    }
+
+    testing::LoopbackListener listener;
+    std::atomic<bool> stopping{false};
+    std::thread acceptor;
+    std::mutex mutex;
+    std::vector<std::thread> clients;
+    std::vector<std::string> messages;
+};
+
+const char* const HELLO = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+
+} // namespace
+
+TEST_CASE("httpGet reuses a kept-alive connection", "[pool][network]") {
+    KeepAliveServer server(HELLO);
+    int statusCode = 0;
+
+    REQUIRE(httpGet("127.0.0.1", server.port, "/a", false, 5, statusCode) == "hello");
+    REQUIRE(statusCode == 200);
+    REQUIRE(httpGet("127.0.0.1", server.port, "/b", false, 5, statusCode) == "hello");
+    REQUIRE(httpGet("127.0.0.1", server.port, "/c", false, 5, statusCode) == "hello");
+    REQUIRE(server.requests == 3);
+    REQUIRE(server.accepted == 1);
+}
+
+TEST_CASE("httpGet decodes chunked bodies and keeps the connection", "[pool][network]") {
+    KeepAliveServer server("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                           "5\r\nhello\r\n6;ext=1\r\n world\r\n0\r\nX-Trailer: 1\r\n\r\n");
+    int statusCode = 0;
+
+    REQUIRE(httpGet("127.0.0.1", server.port, "/", false, 5, statusCode) == "hello world");
+    REQUIRE(httpGet("127.0.0.1", server.port, "/", false, 5, statusCode) == "hello world");
+    REQUIRE(server.accepted == 1);
+}
+
+TEST_CASE("httpGet opens a new connection when the server closes its own", "[pool][network]") {
+    KeepAliveServer server("HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 5\r\n\r\nhello",
+                           true);
+    int statusCode = 0;
+
+    REQUIRE(httpGet("127.0.0.1", server.port, "/", false, 5, statusCode) == "hello");
+    REQUIRE(httpGet("127.0.0.1", server.port, "/", false, 5, statusCode) == "hello");
+    REQUIRE(server.accepted == 2);
+}
+
+TEST_CASE("ConnectionPool skips idle connections the peer has closed", "[pool][network]") {
+    // The server closes after answering but says nothing about it
+    KeepAliveServer server(HELLO, true);
+    net::ConnectionPool pool;
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+
+    auto first = pool.acquire("127.0.0.1", server.port, context);
+    REQUIRE(first);
+    REQUIRE_FALSE(first.reused());
+    std::string response;
+    REQUIRE(first->write("GET / HTTP/1.1\r\n\r\n") == IoStatus::OK);
+    REQUIRE(first->readExactly(std::string(HELLO).size(), response) == IoStatus::OK);
+    std::this_thread::sleep_for(milliseconds(50));
+    first.release(true);
+    REQUIRE(pool.idleCount() == 0);   // Already seen to be closed
+
+    auto second = pool.acquire("127.0.0.1", server.port, context);
+    REQUIRE(second);
+    REQUIRE_FALSE(second.reused());
+    REQUIRE(second->write("GET / HTTP/1.1\r\n\r\n") == IoStatus::OK);
+    REQUIRE(second->readExactly(std::string(HELLO).size(), response) == IoStatus::OK);
+    REQUIRE(server.accepted == 2);
+}
+
+TEST_CASE("ConnectionPool bounds connections per host and expires idle ones", "[pool][network]") {
+    KeepAliveServer server(HELLO);
+    net::PoolLimits limits;
+    limits.maxPerHost = 1;
+    limits.idleTimeout = std::chrono::seconds(60);
+    net::ConnectionPool pool(limits);
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+
+    auto first = pool.acquire("127.0.0.1", server.port, context);
+    REQUIRE(first);
+
+    // The only slot is taken: a second caller waits until its deadline
+    CheckContext hasty(Deadline::after(milliseconds(100)), CancellationToken());
+    auto start = CheckClock::now();
+    auto blocked = pool.acquire("127.0.0.1", server.port, hasty);
+    REQUIRE_FALSE(blocked);
+    REQUIRE(blocked.error().find("timed out") != std::string::npos);
+    REQUIRE(CheckClock::now() - start >= milliseconds(90));
+
+    // ...or until the slot is released
+    std::thread releaser([&first]() {
+        std::this_thread::sleep_for(milliseconds(50));
+        first.release(true);
+    });
+    auto second = pool.acquire("127.0.0.1", server.port, context);
+    releaser.join();
+    REQUIRE(second);
+    REQUIRE(second.reused());
+    second.release(true);
+    REQUIRE(pool.idleCount() == 1);
+    REQUIRE(server.accepted == 1);
+
+    pool.clear();
+    REQUIRE(pool.idleCount() == 0);
+
+    net::PoolLimits brief;
+    brief.idleTimeout = std::chrono::seconds(0);
+    net::ConnectionPool expiring(brief);
+    expiring.acquire("127.0.0.1", server.port, context).release(true);
+    REQUIRE(expiring.idleCount() == 1);
+    REQUIRE_FALSE(expiring.acquire("127.0.0.1", server.port, context).reused());
+}
+
+TEST_CASE("httpRequest sends methods, headers and bodies", "[pool][network][http]") {
+    KeepAliveServer server("HTTP/1.1 201 Created\r\nX-Request-Id: 42\r\n"
+                           "Content-Length: 2\r\n\r\n{}");
+
+    HttpRequest request;
+    request.method = "POST";
+    request.host = "127.0.0.1";
+    request.port = server.port;
+    request.path = "/v1/query";
+    request.body = "{\"q\":1}";
+    request.bearerToken("s3cret").header("X-Vault-Token", "abc").header("Content-Length", "999");
+    HttpResponse response = httpRequest(request);
+    REQUIRE(response.complete());
+    REQUIRE(response.statusCode == 201);
+    REQUIRE(response.reason == "Created");
+    REQUIRE(response.body == "{}");
+    REQUIRE(response.header("x-request-id") != nullptr);
+    REQUIRE(*response.header("x-request-id") == "42");
+
+    // The response went to the consumer instead
+    request.method = "GET";
+    request.body.clear();
+    std::string streamed;
+    response = httpRequest(request, [&streamed](const char* data, size_t length) {
+        streamed.append(data, length);
+        return true;
+    });
+    REQUIRE(response.complete());
+    REQUIRE(response.body.empty());
+    REQUIRE(streamed == "{}");
+
+    std::vector<std::string> received = server.received();
+    REQUIRE(received.size() == 2);
+    const std::string& post = received[0];
+    REQUIRE(post.compare(0, 30, "POST /v1/query HTTP/1.1\r\nHost:") == 0);
+    REQUIRE(post.find("\r\nAuthorization: Bearer s3cret\r\n") != std::string::npos);
+    REQUIRE(post.find("\r\nX-Vault-Token: abc\r\n") != std::string::npos);
+    REQUIRE(post.find("\r\nContent-Length: 7\r\n") != std::string::npos);
+    REQUIRE(post.find("999") == std::string::npos);
+    REQUIRE(post.substr(post.size() - 7) == "{\"q\":1}");
+    REQUIRE(received[1].find("Content-Length") == std::string::npos);
+    REQUIRE(server.accepted == 1);
+}
+
+TEST_CASE("httpRequest refuses fields that would break the framing", "[pool][http]") {
+    HttpRequest request;
+    request.host = "127.0.0.1";
+    request.port = 1;
+    request.header("X-Token", "a\r\nInjected: 1");
+    HttpResponse response = httpRequest(request);
+    REQUIRE_FALSE(response.complete());
+    REQUIRE(response.statusCode == 0);
+    REQUIRE(response.error.find("X-Token") != std::string::npos);
+
+    request.headers.clear();
+    request.path = "/ HTTP/1.0\r\n";
+    REQUIRE(httpRequest(request).error.find("invalid request line") != std::string::npos);
+}
+
+#ifdef NETMON_ZLIB_ENABLED
+TEST_CASE("httpRequest asks for and decodes gzip bodies", "[pool][network][http]") {
+    // "hello, compressed world", gzipped
+    const std::string gzip("\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\x03\xcb\x48\xcd\xc9\xc9\xd7\x51"
+                           "\x48\xce\xcf\x2d\x28\x4a\x2d\x2e\x4e\x4d\x51\x28\xcf\x2f\xca\x49\x01"
+                           "\x00\x08\x9e\x34\x35\x17\x00\x00\x00",
+                           43);
+    KeepAliveServer server("HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\n"
+                           "Content-Length: 43\r\n\r\n" + gzip);
+
+    HttpRequest request;
+    request.host = "127.0.0.1";
+    request.port = server.port;
+    HttpResponse response = httpRequest(request);
+    REQUIRE(response.complete());
+    REQUIRE(response.decompressed);
+    REQUIRE(response.body == "hello, compressed world");
+
+    // Left alone when not wanted
+    request.decompress = false;
+    response = httpRequest(request);
+    REQUIRE(response.complete());
+    REQUIRE_FALSE(response.decompressed);
+    REQUIRE(response.body == gzip);
+
+    std::vector<std::string> received = server.received();
+    REQUIRE(received.size() == 2);
+    REQUIRE(received[0].find("\r\nAccept-Encoding: gzip, deflate\r\n") != std::string::npos);
+    REQUIRE(received[1].find("Accept-Encoding") == std::string::npos);
+    REQUIRE(server.accepted == 1);
+}
+#endif
+#endif
@@ -0,0 +1,133 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <string>
+
+#include "netmon/content_decoder.hpp"
+
+#ifdef NETMON_ZLIB_ENABLED
+#include <zlib.h>
+#endif
+
+using namespace netmon_plugins;
+
+namespace {
+
+// Decode input fed in pieces of at most step bytes; false if the decoder
+// rejected it
+bool decode(ContentDecoder::Coding coding, const std::string& input, size_t step,
+            std::string& output, std::string* error = nullptr) {
+    ContentDecoder decoder(coding, [&output](const char* data, size_t length) {
+        output.append(data, length);
+        return true;
+    });
+    bool ok = true;
+    for (size_t offset = 0; ok && offset < input.size(); offset += step) {
+        ok = decoder.write(input.data() + offset, std::min(step, input.size() - offset));
+    }
+    ok = ok && decoder.finish();
+    if (error) {
+        *error = decoder.error();
+    }
+    return ok;
+}
+
+#ifdef NETMON_ZLIB_ENABLED
+// Compress text; windowBits picks the wrapping as for deflateInit2()
+std::string compress(const std::string& text, int windowBits) {
+    z_stream stream = {};
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&stream, text.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    stream.avail_in = static_cast<uInt>(text.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+std::string sampleText() {
+    std::string text;
+    for (int i = 0; i < 5000; i++) {
+        text += "{\"metadata\":{\"name\":\"pod-" + std::to_string(i) + "\"}},";
+    }
+    return text;
+}
+#endif
+
+} // namespace
+
+TEST_CASE("ContentDecoder names the codings it decodes", "[content_decoder]") {
+    REQUIRE(ContentDecoder::codingOf("") == ContentDecoder::Coding::IDENTITY);
+    REQUIRE(ContentDecoder::codingOf("identity") == ContentDecoder::Coding::IDENTITY);
+    REQUIRE(ContentDecoder::codingOf("br") == ContentDecoder::Coding::UNSUPPORTED);
+#ifdef NETMON_ZLIB_ENABLED
+    REQUIRE(ContentDecoder::codingOf("GZIP") == ContentDecoder::Coding::GZIP);
+    REQUIRE(ContentDecoder::codingOf(" x-gzip ") == ContentDecoder::Coding::GZIP);
+    REQUIRE(ContentDecoder::codingOf("deflate") == ContentDecoder::Coding::DEFLATE);
+    REQUIRE(ContentDecoder::codingOf("deflate, gzip") == ContentDecoder::Coding::UNSUPPORTED);
+    REQUIRE(std::string(ContentDecoder::acceptEncoding()) == "gzip, deflate");
+#else
+    REQUIRE(ContentDecoder::codingOf("gzip") == ContentDecoder::Coding::UNSUPPORTED);
+    REQUIRE(std::string(ContentDecoder::acceptEncoding()).empty());
+#endif
+
+    std::string output;
+    REQUIRE(decode(ContentDecoder::Coding::UNSUPPORTED, "as is", 2, output));
+    REQUIRE(output == "as is");
+}
+
+#ifdef NETMON_ZLIB_ENABLED
+TEST_CASE("ContentDecoder inflates gzip and deflate bodies in any split",
+          "[content_decoder]") {
+    const std::string text = sampleText();
+    const std::string gzip = compress(text, 15 + 16);
+    const std::string zlib = compress(text, 15);
+    const std::string raw = compress(text, -15);
+    REQUIRE(gzip.size() < text.size() / 10);
+
+    for (size_t step : {size_t(1), size_t(7), size_t(1000), gzip.size()}) {
+        std::string output;
+        REQUIRE(decode(ContentDecoder::Coding::GZIP, gzip, step, output));
+        REQUIRE(output == text);
+
+        output.clear();
+        REQUIRE(decode(ContentDecoder::Coding::DEFLATE, zlib, step, output));
+        REQUIRE(output == text);
+
+        output.clear();
+        REQUIRE(decode(ContentDecoder::Coding::DEFLATE, raw, step, output));
+        REQUIRE(output == text);
+    }
+
+    // Concatenated gzip members are one body
+    std::string output;
+    REQUIRE(decode(ContentDecoder::Coding::GZIP, compress("one ", 31) + compress("two", 31), 5,
+                   output));
+    REQUIRE(output == "one two");
+}
+
+TEST_CASE("ContentDecoder rejects corrupt and truncated bodies", "[content_decoder]") {
+    const std::string gzip = compress(sampleText(), 15 + 16);
+    std::string output;
+    std::string error;
+
+    REQUIRE_FALSE(decode(ContentDecoder::Coding::GZIP, "not gzip at all", 4, output, &error));
+    REQUIRE(error.find("corrupt gzip body") == 0);
+
+    output.clear();
+    REQUIRE_FALSE(decode(ContentDecoder::Coding::GZIP, gzip.substr(0, gzip.size() / 2), 64,
+                         output, &error));
+    REQUIRE(error == "compressed body ends early");
+
+    // An empty body is fine whatever it claims
+    REQUIRE(decode(ContentDecoder::Coding::GZIP, "", 1, output));
+
+    // A consumer that stops is not an error of the body
+    ContentDecoder decoder(ContentDecoder::Coding::GZIP, [](const char*, size_t) { return false; });
+    REQUIRE_FALSE(decoder.write(gzip.data(), gzip.size()));
+    REQUIRE_FALSE(decoder.failed());
+}
+#endif
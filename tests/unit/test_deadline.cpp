@@ -0,0 +1,216 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "netmon/deadline.hpp"
+#include "netmon/executor.hpp"
+#include "netmon/http_api.hpp"
+#include "netmon/socket_io.hpp"
+#include "netmon/thread_pool.hpp"
+
+#include "loopback_server.hpp"
+
+using namespace netmon_plugins;
+using std::chrono::milliseconds;
+
+namespace {
+
+long long elapsedMs(CheckClock::time_point start) {
+    return std::chrono::duration_cast<milliseconds>(CheckClock::now() - start).count();
+}
+
+#ifndef _WIN32
+// Loopback server that accepts one client, sends it head and then a byte
+// every interval (or nothing, if interval is zero) until stopped
+class TrickleServer {
+public:
+    explicit TrickleServer(milliseconds interval, const std::string& head = "")
+        : listener(1) {
+        port = listener.port();
+        thread = std::thread([this, interval, head]() {
+            int client = listener.accept(stopping);
+            if (client < 0) {
+                return;
+            }
+            send(client, head.data(), head.size(), MSG_NOSIGNAL);
+            while (!stopping) {
+                if (interval.count() > 0) {
+                    send(client, "x", 1, MSG_NOSIGNAL);
+                    std::this_thread::sleep_for(interval);
+                } else {
+                    std::this_thread::sleep_for(milliseconds(10));
+                }
+            }
+            close(client);
+        });
+    }
+
+    ~TrickleServer() {
+        stopping = true;
+        thread.join();
+    }
+
+    int port = 0;
+
+private:
+    testing::LoopbackListener listener;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+#endif
+
+} // namespace
+
+TEST_CASE("Deadline tracks remaining time", "[deadline]") {
+    Deadline never;
+    REQUIRE_FALSE(never.isSet());
+    REQUIRE_FALSE(never.expired());
+    REQUIRE(never.pollTimeout() == -1);
+    REQUIRE(never.pollTimeout(50) == 50);
+
+    Deadline now = Deadline::after(milliseconds(0));
+    REQUIRE(now.expired());
+    REQUIRE(now.remaining().count() == 0);
+    REQUIRE(now.pollTimeout(50) == 0);
+
+    Deadline later = Deadline::afterSeconds(10);
+    REQUIRE(later.budget() == std::chrono::seconds(10));
+    REQUIRE(later.pollTimeout(50) == 50);
+    REQUIRE(later.earliest(now).time() == now.time());
+    REQUIRE(never.earliest(later).time() == later.time());
+}
+
+TEST_CASE("CancellationToken copies share one flag", "[deadline]") {
+    CancellationToken token;
+    CancellationToken copy = token;
+    REQUIRE_FALSE(copy.cancelled());
+    token.cancel();
+    REQUIRE(copy.cancelled());
+    REQUIRE(CancellationToken().cancelled() == false);
+}
+
+TEST_CASE("ScopedCheckContext installs and restores the current context", "[deadline]") {
+    REQUIRE_FALSE(CheckContext::current().deadline.isSet());
+    {
+        CheckContext outer(Deadline::afterSeconds(5), CancellationToken());
+        ScopedCheckContext scope(outer);
+        REQUIRE(CheckContext::current().deadline.time() == outer.deadline.time());
+
+        // A per-call timeout can only shorten the ambient deadline
+        REQUIRE(CheckContext::current().within(60).deadline.time() == outer.deadline.time());
+        REQUIRE(CheckContext::current().within(1).deadline.time() < outer.deadline.time());
+    }
+    REQUIRE_FALSE(CheckContext::current().deadline.isSet());
+}
+
+#ifndef _WIN32
+TEST_CASE("A trickling peer cannot stretch the deadline", "[deadline][network]") {
+    TrickleServer server(milliseconds(20));
+
+    CheckContext context(Deadline::after(milliseconds(300)), CancellationToken());
+    ScopedCheckContext scope(context);
+
+    auto start = CheckClock::now();
+    int statusCode = -1;
+    httpGet("127.0.0.1", server.port, "/", false, 10, statusCode);
+    auto elapsed = elapsedMs(start);
+
+    REQUIRE(statusCode == 0);
+    REQUIRE(elapsed >= 250);
+    REQUIRE(elapsed < 2000);
+}
+
+TEST_CASE("A response cut off by the deadline is a failure", "[deadline][network]") {
+    const std::string head = "HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n";
+    {
+        TrickleServer server(milliseconds(20), head);
+        CheckContext context(Deadline::after(milliseconds(300)), CancellationToken());
+        ScopedCheckContext scope(context);
+
+        HttpRequest request;
+        request.host = "127.0.0.1";
+        request.port = server.port;
+        HttpResponse response = httpRequest(request);
+        REQUIRE(response.statusCode == 200);
+        REQUIRE(response.status == IoStatus::TIMED_OUT);
+        REQUIRE_FALSE(response.complete());
+    }
+
+    // The convenience forms report it like a failed connection
+    TrickleServer server(milliseconds(20), head);
+    CheckContext context(Deadline::after(milliseconds(300)), CancellationToken());
+    ScopedCheckContext scope(context);
+    int statusCode = -1;
+    REQUIRE(httpGet("127.0.0.1", server.port, "/", false, 10, statusCode).empty());
+    REQUIRE(statusCode == 0);
+}
+
+TEST_CASE("Cancelling the token interrupts a blocked read", "[deadline][network]") {
+    TrickleServer server(milliseconds(0));
+    CheckContext context(Deadline::afterSeconds(30), CancellationToken());
+
+    IoStatus status;
+    std::string error;
+    SocketFd fd = connectTcp("127.0.0.1", server.port, context, status, error);
+    REQUIRE(fd != INVALID_SOCKET_FD);
+
+    std::thread canceller([context]() {
+        std::this_thread::sleep_for(milliseconds(100));
+        context.token.cancel();
+    });
+
+    auto start = CheckClock::now();
+    char buffer[16];
+    size_t received = 0;
+    status = recvSome(fd, buffer, sizeof(buffer), received, context);
+    canceller.join();
+    closeSocket(fd);
+
+    REQUIRE(status == IoStatus::CANCELLED);
+    REQUIRE(elapsedMs(start) < 1000);
+}
+#endif
+
+TEST_CASE("checkAsync answers by the deadline even if the check never starts", "[deadline]") {
+    ThreadPool pool(1);
+    std::atomic<bool> release(false);
+    pool.submit([&release]() {
+        while (!release) {
+            std::this_thread::sleep_for(milliseconds(5));
+        }
+    });
+
+    CheckOutcome failure;
+    auto check = prepareCheck({"check_dummy", "-m", "late"}, failure);
+    REQUIRE(check != nullptr);
+
+    CheckContext context(Deadline::after(milliseconds(100)), CancellationToken());
+    auto start = CheckClock::now();
+    std::future<CheckOutcome> future = checkAsync(pool, check, context);
+    CheckOutcome outcome = future.get();
+
+    REQUIRE(outcome.exitCode == 3);
+    REQUIRE(outcome.output == "UNKNOWN: Check timed out after 0.1 seconds\n");
+    REQUIRE(context.token.cancelled());
+    REQUIRE(elapsedMs(start) < 1000);
+
+    release = true;
+    pool.shutdown();
+}
+
+TEST_CASE("checkAsync delivers the outcome of a check that finishes in time", "[deadline]") {
+    ThreadPool pool(2);
+    CheckOutcome failure;
+    auto check = prepareCheck({"check_dummy", "-w", "-m", "async"}, failure);
+    REQUIRE(check != nullptr);
+
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+    CheckOutcome outcome = checkAsync(pool, check, context).get();
+
+    REQUIRE(outcome.exitCode == 1);
+    REQUIRE(outcome.output == "WARNING: async\n");
+    REQUIRE_FALSE(context.token.cancelled());
+}
@@ -0,0 +1,72 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include "netmon/event_loop.hpp"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace netmon_plugins;
+
+#ifndef _WIN32
+TEST_CASE("EventLoop dispatches readiness and posted tasks", "[event_loop]") {
+    EventLoop loop;
+    int pair[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+
+    unsigned seen = 0;
+    loop.add(pair[0], EventLoop::READABLE, [&](unsigned events) { seen |= events; });
+    REQUIRE(write(pair[1], "x", 1) == 1);
+    bool ran = false;
+    loop.post([&]() { ran = true; });
+
+    REQUIRE(loop.runOnce(1000) == 2);
+    REQUIRE((seen & EventLoop::READABLE) != 0);
+    REQUIRE(ran);
+
+    loop.remove(pair[0]);
+    REQUIRE(loop.size() == 0);
+    close(pair[0]);
+    close(pair[1]);
+}
+
+TEST_CASE("EventLoop drops events of a descriptor reused in the same pass", "[event_loop]") {
+    EventLoop loop;
+    int first[2];
+    int second[2];
+    int idle[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, first) == 0);
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, second) == 0);
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, idle) == 0);
+
+    // Both ends are ready; whichever handler runs first closes the other
+    // descriptor and registers a quiet socket under the same number
+    int staleCalls = 0;
+    int handled = 0;
+    auto replaceOther = [&](int other) {
+        handled++;
+        if (handled > 1) {
+            return;
+        }
+        loop.remove(other);
+        close(other);
+        REQUIRE(dup2(idle[0], other) == other);
+        loop.add(other, EventLoop::READABLE, [&](unsigned) { staleCalls++; });
+    };
+    loop.add(first[0], EventLoop::READABLE, [&](unsigned) { replaceOther(second[0]); });
+    loop.add(second[0], EventLoop::READABLE, [&](unsigned) { replaceOther(first[0]); });
+    REQUIRE(write(first[1], "x", 1) == 1);
+    REQUIRE(write(second[1], "x", 1) == 1);
+
+    REQUIRE(loop.runOnce(1000) == 1);
+    REQUIRE(handled == 1);
+    REQUIRE(staleCalls == 0);
+
+    for (int fd : {first[0], first[1], second[0], second[1], idle[0], idle[1]}) {
+        close(fd);
+    }
+}
+#endif
@@ -0,0 +1,333 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "netmon/executor.hpp"
+#include "netmon/plugin.hpp"
+
+TEST_CASE("pluginNameFromCommand strips path, prefix and suffix", "[executor]") {
+    using netmon_plugins::pluginNameFromCommand;
+
+    REQUIRE(pluginNameFromCommand("check_tcp") == "tcp");
+    REQUIRE(pluginNameFromCommand("/usr/libexec/monitoring-plugins/check_http") == "http");
+    REQUIRE(pluginNameFromCommand("C:\\plugins\\check_disk.exe") == "disk");
+    REQUIRE(pluginNameFromCommand("dummy") == "dummy");
+}
+
+TEST_CASE("dummy plugin is registered with metadata", "[executor]") {
+    using netmon_plugins::PluginCategory;
+    const auto& registry = netmon_plugins::PluginRegistry::instance();
+
+    REQUIRE(registry.contains("dummy"));
+    REQUIRE(registry.create("dummy") != nullptr);
+    REQUIRE(registry.create("no_such_plugin") == nullptr);
+
+    const netmon_plugins::PluginInfo* info = registry.find("dummy");
+    REQUIRE(info != nullptr);
+    REQUIRE(info->category == PluginCategory::Utility);
+    REQUIRE(registry.list(PluginCategory::Utility).size() >= 1);
+    REQUIRE(registry.list(PluginCategory::Database).empty());
+    REQUIRE(netmon_plugins::formatPluginList().find("check_dummy\tutility\t") != std::string::npos);
+}
+
+TEST_CASE("runCheck reproduces standalone output and exit code", "[executor]") {
+    auto outcome = netmon_plugins::runCheck({"check_dummy", "-w", "-m", "in process"});
+
+    REQUIRE(outcome.exitCode == 1);
+    REQUIRE(outcome.output == "WARNING: in process\n");
+}
+
+TEST_CASE("runCheck reports unknown plugins and answers help", "[executor]") {
+    auto unknown = netmon_plugins::runCheck({"check_no_such_plugin"});
+    REQUIRE(unknown.exitCode == 3);
+    REQUIRE(unknown.output.find("Unknown plugin") != std::string::npos);
+
+    auto help = netmon_plugins::runCheck({"dummy", "--help"});
+    REQUIRE(help.exitCode == 0);
+    REQUIRE(help.output.find("Usage: check_dummy") == 0);
+}
+
+TEST_CASE("prepared checks run repeatedly and concurrently", "[executor]") {
+    netmon_plugins::CheckOutcome failure;
+    auto prepared = netmon_plugins::prepareCheck({"check_dummy", "-c", "-m", "shared"}, failure);
+    REQUIRE(prepared != nullptr);
+    REQUIRE(prepared->pluginName() == "dummy");
+    REQUIRE(prepared->isReentrant());
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches(0);
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 100; i++) {
+                auto outcome = prepared->run();
+                if (outcome.exitCode != 2 || outcome.output != "CRITICAL: shared\n") {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("prepareCheck turns help and unknown plugins into outcomes", "[executor]") {
+    netmon_plugins::CheckOutcome failure;
+    REQUIRE(netmon_plugins::prepareCheck({"dummy", "-h"}, failure) == nullptr);
+    REQUIRE(failure.exitCode == 0);
+    REQUIRE(failure.output.find("Usage: check_dummy") == 0);
+
+    REQUIRE(netmon_plugins::prepareCheck({"check_no_such_plugin"}, failure) == nullptr);
+    REQUIRE(failure.exitCode == 3);
+
+    REQUIRE_THROWS_AS(netmon_plugins::PreparedCheck({"dummy", "--help"}),
+                      netmon_plugins::HelpRequested);
+}
+
+TEST_CASE("re-entrant plugins keep configuration out of the instance", "[executor]") {
+    auto plugin = netmon_plugins::PluginRegistry::instance().create("dummy");
+    REQUIRE(plugin != nullptr);
+
+    auto warning = plugin->parseConfig({"check_dummy", "-w", "-m", "first"});
+    auto ok = plugin->parseConfig({"check_dummy", "-m", "second"});
+    REQUIRE(warning != nullptr);
+    REQUIRE(ok != nullptr);
+
+    REQUIRE(plugin->check(*warning).code == netmon_plugins::ExitCode::WARNING);
+    REQUIRE(plugin->check(*ok).message == "second");
+    REQUIRE(plugin->check(*warning).message == "first");
+}
+
+TEST_CASE("splitCommandLine honours quotes and escapes", "[executor]") {
+    using netmon_plugins::splitCommandLine;
+
+    REQUIRE(splitCommandLine("http -H example.com") ==
+            std::vector<std::string>{"http", "-H", "example.com"});
+    REQUIRE(splitCommandLine("dummy -m 'two words' -s \"a \\\"b\\\"\" c\\ d") ==
+            std::vector<std::string>{"dummy", "-m", "two words", "-s", "a \"b\"", "c d"});
+    REQUIRE(splitCommandLine("dummy -m ''") == std::vector<std::string>{"dummy", "-m", ""});
+    REQUIRE_THROWS_AS(splitCommandLine("dummy -m 'open"), std::invalid_argument);
+}
+
+TEST_CASE("parseBatchLine reads labels and skips comments", "[executor]") {
+    netmon_plugins::BatchCheck check;
+
+    REQUIRE_FALSE(netmon_plugins::parseBatchLine("   ", check));
+    REQUIRE_FALSE(netmon_plugins::parseBatchLine("# comment", check));
+
+    REQUIRE(netmon_plugins::parseBatchLine("web1: http -H web1", check));
+    REQUIRE(check.id == "web1");
+    REQUIRE(check.args == std::vector<std::string>{"http", "-H", "web1"});
+
+    REQUIRE(netmon_plugins::parseBatchLine("dummy -c", check));
+    REQUIRE(check.id.empty());
+}
+
+TEST_CASE("executeBatch reports every check once", "[executor]") {
+    std::vector<netmon_plugins::BatchCheck> checks;
+    for (int i = 0; i < 20; i++) {
+        netmon_plugins::BatchCheck check;
+        check.id = "check" + std::to_string(i);
+        check.args = {"dummy", i % 2 == 0 ? "-o" : "-w", "-m", check.id};
+        checks.push_back(check);
+    }
+
+    netmon_plugins::BatchOptions options;
+    options.concurrency = 4;
+
+    std::vector<int> seen(checks.size(), 0);
+    auto summary = netmon_plugins::executeBatch(
+        checks, options, [&](const netmon_plugins::BatchResult& result) {
+            seen[result.index]++;
+            REQUIRE(result.id == checks[result.index].id);
+            REQUIRE(result.outcome.exitCode == (result.index % 2 == 0 ? 0 : 1));
+            REQUIRE_FALSE(result.timedOut);
+        });
+
+    REQUIRE(summary.completed == checks.size());
+    REQUIRE(summary.timedOut == 0);
+    REQUIRE(summary.worstExitCode == 1);
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; }));
+}
+
+namespace {
+
+// Occupy a one-worker pool until release is set, so checks queue behind it
+void blockPool(netmon_plugins::ThreadPool& pool, std::atomic<bool>& release) {
+    pool.submit([&release]() {
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+}
+
+// check_test_wait MS: OK after MS milliseconds, CRITICAL if its context
+// stops it first
+class WaitPlugin : public netmon_plugins::Plugin {
+public:
+    void parseArguments(int argc, char* argv[]) override {
+        waitMs = argc > 1 ? std::stoi(argv[1]) : 0;
+    }
+
+    netmon_plugins::PluginResult check() override {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitMs);
+        while (std::chrono::steady_clock::now() < until) {
+            if (netmon_plugins::CheckContext::current().stopRequested()) {
+                return netmon_plugins::PluginResult(netmon_plugins::ExitCode::CRITICAL,
+                                                    "stopped");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return netmon_plugins::PluginResult(netmon_plugins::ExitCode::OK, "waited");
+    }
+
+    std::string getUsage() const override { return "check_test_wait MS"; }
+    std::string getDescription() const override { return "Wait, for executor tests"; }
+
+private:
+    int waitMs = 0;
+};
+
+} // namespace
+
+NETMON_REGISTER_PLUGIN("test_wait", WaitPlugin, Utility)
+
+TEST_CASE("ThreadPool replaces a worker stuck past its task's deadline", "[executor]") {
+    netmon_plugins::ThreadPool pool(1);
+    // Shared: the stuck worker outlives the pool
+    auto release = std::make_shared<std::atomic<bool>>(false);
+    pool.submit([release]() {
+        while (!*release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }, netmon_plugins::ThreadPool::Clock::now() + std::chrono::milliseconds(50));
+
+    // Queued behind the stuck task, yet run by its replacement
+    std::promise<void> ran;
+    pool.submit([&ran]() { ran.set_value(); });
+    REQUIRE(ran.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    REQUIRE(pool.replaced() == 1);
+    REQUIRE(pool.size() == 1);
+
+    // Shutting down does not wait for the written-off worker
+    auto start = std::chrono::steady_clock::now();
+    pool.shutdown();
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+    *release = true;
+}
+
+TEST_CASE("CheckCoalescer runs identical checks in flight once", "[executor]") {
+    netmon_plugins::ThreadPool pool(1);
+    std::atomic<bool> release(false);
+    blockPool(pool, release);
+
+    netmon_plugins::CheckOutcome failure;
+    auto check = netmon_plugins::prepareCheck({"check_dummy", "-w", "-m", "once"}, failure);
+    REQUIRE(check != nullptr);
+
+    netmon_plugins::CheckCoalescer coalescer;
+    netmon_plugins::CheckContext context(netmon_plugins::Deadline::afterSeconds(5),
+                                         netmon_plugins::CancellationToken());
+    std::vector<std::future<netmon_plugins::CheckOutcome>> results;
+    for (int i = 0; i < 3; i++) {
+        auto promise = std::make_shared<std::promise<netmon_plugins::CheckOutcome>>();
+        results.push_back(promise->get_future());
+        coalescer.checkAsync(pool, "dummy once", check, context,
+                             [promise](netmon_plugins::CheckOutcome outcome) {
+                                 promise->set_value(std::move(outcome));
+                             });
+    }
+    REQUIRE(coalescer.inFlight() == 1);
+
+    // A blocking caller joins the same flight
+    std::thread releaser([&release]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        release = true;
+    });
+    netmon_plugins::CheckOutcome joined = coalescer.run("dummy once", *check, context);
+    releaser.join();
+
+    REQUIRE(joined.output == "WARNING: once\n");
+    for (auto& result : results) {
+        REQUIRE(result.get().output == "WARNING: once\n");
+    }
+    REQUIRE(coalescer.started() == 1);
+    REQUIRE(coalescer.coalesced() == 3);
+    REQUIRE(coalescer.inFlight() == 0);
+}
+
+TEST_CASE("CheckCoalescer answers each caller by its own deadline", "[executor]") {
+    netmon_plugins::ThreadPool pool(1);
+    std::atomic<bool> release(false);
+    blockPool(pool, release);
+
+    netmon_plugins::CheckOutcome failure;
+    auto check = netmon_plugins::prepareCheck({"check_dummy", "-m", "slow"}, failure);
+    REQUIRE(check != nullptr);
+
+    netmon_plugins::CheckCoalescer coalescer;
+    netmon_plugins::CheckContext patient(netmon_plugins::Deadline::afterSeconds(5),
+                                         netmon_plugins::CancellationToken());
+    std::promise<netmon_plugins::CheckOutcome> leader;
+    coalescer.checkAsync(pool, "dummy slow", check, patient,
+                         [&leader](netmon_plugins::CheckOutcome outcome) {
+                             leader.set_value(std::move(outcome));
+                         });
+
+    netmon_plugins::CheckContext hasty(
+        netmon_plugins::Deadline::after(std::chrono::milliseconds(50)),
+        netmon_plugins::CancellationToken());
+    netmon_plugins::CheckOutcome timedOut = coalescer.run("dummy slow", *check, hasty);
+    REQUIRE(timedOut.exitCode == 3);
+    REQUIRE(timedOut.output == "UNKNOWN: Check timed out after 0.05 seconds\n");
+
+    // The shared run carries on for the caller still waiting
+    release = true;
+    REQUIRE(leader.get_future().get().output == "OK: slow\n");
+    pool.shutdown();
+}
+
+TEST_CASE("CheckCoalescer runs a blocking leader's check until the last caller gives up",
+          "[executor]") {
+    using std::chrono::milliseconds;
+    netmon_plugins::CheckOutcome failure;
+    auto check = netmon_plugins::prepareCheck({"check_test_wait", "300"}, failure);
+    REQUIRE(check != nullptr);
+
+    netmon_plugins::CheckCoalescer coalescer;
+    netmon_plugins::CheckContext hasty(netmon_plugins::Deadline::after(milliseconds(100)),
+                                       netmon_plugins::CancellationToken());
+    netmon_plugins::CheckContext patient(netmon_plugins::Deadline::afterSeconds(5),
+                                         netmon_plugins::CancellationToken());
+
+    // The leader's deadline passes mid-run; the later caller still gets
+    // the finished outcome rather than the leader's timeout
+    auto leader = std::async(std::launch::async, [&]() {
+        return coalescer.run("wait 300", *check, hasty);
+    });
+    while (coalescer.inFlight() == 0) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    netmon_plugins::CheckOutcome joined = coalescer.run("wait 300", *check, patient);
+    REQUIRE(joined.output == "OK: waited\n");
+    REQUIRE(leader.get().output == "UNKNOWN: Check timed out after 0.1 seconds\n");
+    REQUIRE(coalescer.coalesced() == 1);
+
+    // Once every caller, the leader included, has given up, the run is
+    // cancelled instead of going on to the end
+    auto endless = netmon_plugins::prepareCheck({"check_test_wait", "10000"}, failure);
+    netmon_plugins::CheckContext brief(netmon_plugins::Deadline::after(milliseconds(100)),
+                                       netmon_plugins::CancellationToken());
+    const auto start = std::chrono::steady_clock::now();
+    netmon_plugins::CheckOutcome abandoned = coalescer.run("wait 10000", *endless, brief);
+    REQUIRE(abandoned.exitCode == 3);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+    REQUIRE(coalescer.inFlight() == 0);
+}
@@ -0,0 +1,172 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <string>
+
+#include "netmon/http_parser.hpp"
+
+using namespace netmon_plugins;
+
+namespace {
+
+// Parse response fed in pieces of at most step bytes; returns the bytes
+// of input the parser did not take
+std::string parse(HttpResponseParser& parser, const std::string& response, size_t step) {
+    size_t offset = 0;
+    while (offset < response.size() && !parser.done()) {
+        const size_t length = std::min(step, response.size() - offset);
+        offset += parser.feed(response.data() + offset, length);
+    }
+    return response.substr(offset);
+}
+
+} // namespace
+
+TEST_CASE("HttpResponseParser reads a Content-Length body in any split", "[http_parser]") {
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n"
+                                 "Content-Length: 11\r\n\r\nhello worldHTTP/1.1 204";
+    for (size_t step = 1; step <= response.size(); step++) {
+        std::string body;
+        HttpResponseParser parser([&body](const char* data, size_t length) {
+            body.append(data, length);
+            return true;
+        });
+        // What follows the body is left for the next response
+        REQUIRE(parse(parser, response, step) == "HTTP/1.1 204");
+        REQUIRE(parser.complete());
+        REQUIRE(parser.statusCode() == 200);
+        REQUIRE(parser.reason() == "OK");
+        REQUIRE(body == "hello world");
+        REQUIRE(parser.bodyBytes() == 11);
+        REQUIRE(parser.keepAlive());
+        REQUIRE(parser.header("content-type") != nullptr);
+        REQUIRE(*parser.header("content-type") == "text/plain");
+        REQUIRE(parser.header("X-Missing") == nullptr);
+    }
+}
+
+TEST_CASE("HttpResponseParser decodes chunked bodies", "[http_parser]") {
+    const std::string response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, chunked\r\n"
+                                 "Content-Length: 999\r\n\r\n"
+                                 "5\r\nhello\r\n6;name=value\r\n world\r\nA \r\n0123456789\r\n"
+                                 "0\r\nX-Trailer: 1\r\n\r\nnext";
+    for (size_t step = 1; step <= response.size(); step++) {
+        std::string body;
+        HttpResponseParser parser([&body](const char* data, size_t length) {
+            body.append(data, length);
+            return true;
+        });
+        REQUIRE(parse(parser, response, step) == "next");
+        REQUIRE(parser.complete());
+        REQUIRE(parser.chunked());
+        REQUIRE(body == "hello world0123456789");
+        REQUIRE(parser.keepAlive());
+    }
+}
+
+TEST_CASE("HttpResponseParser hands out slices of its input", "[http_parser]") {
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nbody";
+    const char* slice = nullptr;
+    HttpResponseParser parser([&slice](const char* data, size_t length) {
+        slice = data;
+        return length == 4;
+    });
+    REQUIRE(parser.feed(response.data(), response.size()) == response.size());
+    REQUIRE(slice == response.data() + response.size() - 4);
+}
+
+TEST_CASE("HttpResponseParser knows responses without a body", "[http_parser]") {
+    HttpResponseParser parser;
+    const std::string interim = "HTTP/1.1 100 Continue\r\n\r\n"
+                                "HTTP/1.1 304 Not Modified\r\nContent-Length: 10\r\n\r\n";
+    REQUIRE(parser.feed(interim.data(), interim.size()) == interim.size());
+    REQUIRE(parser.complete());
+    REQUIRE(parser.statusCode() == 304);
+    REQUIRE(parser.bodyBytes() == 0);
+
+    parser.reset();
+    parser.expectNoBody();
+    const std::string head = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n";
+    REQUIRE(parser.feed(head.data(), head.size()) == head.size());
+    REQUIRE(parser.complete());
+    REQUIRE(parser.keepAlive());
+}
+
+TEST_CASE("HttpResponseParser reads to the end of the connection without a length",
+          "[http_parser]") {
+    std::string body;
+    HttpResponseParser parser([&body](const char* data, size_t length) {
+        body.append(data, length);
+        return true;
+    });
+    const std::string response = "HTTP/1.0 200 OK\r\n\r\nuntil close";
+    REQUIRE(parser.feed(response.data(), response.size()) == response.size());
+    REQUIRE_FALSE(parser.done());
+    parser.finish();
+    REQUIRE(parser.complete());
+    REQUIRE(body == "until close");
+    REQUIRE_FALSE(parser.keepAlive());
+}
+
+TEST_CASE("HttpResponseParser honours the Connection header", "[http_parser]") {
+    HttpResponseParser parser;
+    const std::string closing = "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    parser.feed(closing.data(), closing.size());
+    REQUIRE(parser.complete());
+    REQUIRE_FALSE(parser.keepAlive());
+
+    parser.reset();
+    const std::string http10 = "HTTP/1.0 200 OK\r\nConnection: Keep-Alive\r\n"
+                               "Content-Length: 0\r\n\r\n";
+    parser.feed(http10.data(), http10.size());
+    REQUIRE(parser.keepAlive());
+
+    parser.reset();
+    const std::string folded = "HTTP/1.1 200 OK\r\nX-Long: one\r\n  two\r\nContent-Length: 0\r\n\r\n";
+    parser.feed(folded.data(), folded.size());
+    REQUIRE(*parser.header("x-long") == "one two");
+}
+
+TEST_CASE("HttpResponseParser rejects malformed responses", "[http_parser]") {
+    const char* const malformed[] = {
+        "SSH-2.0-OpenSSH_9.6\r\n",
+        "HTTP/1.1 2000 OK\r\n\r\n",
+        "HTTP/1.1 200 OK\r\nno colon\r\n\r\n",
+        "HTTP/1.1 200 OK\r\nContent-Length: 5x\r\n\r\n",
+        "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nContent-Length: 6\r\n\r\n",
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nabc\r\n",
+    };
+    for (const char* response : malformed) {
+        HttpResponseParser parser;
+        const std::string text = response;
+        parser.feed(text.data(), text.size());
+        INFO(text);
+        REQUIRE(parser.failed());
+        REQUIRE_FALSE(parser.error().empty());
+    }
+
+    // Cut short
+    HttpResponseParser parser;
+    const std::string partial = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nabc";
+    parser.feed(partial.data(), partial.size());
+    parser.finish();
+    REQUIRE(parser.failed());
+    REQUIRE(parser.headComplete());
+
+    // A head that never ends
+    parser.reset();
+    const std::string huge = "HTTP/1.1 200 OK\r\nX-Filler: " +
+                             std::string(HttpResponseParser::MAX_HEAD_SIZE, 'x');
+    parser.feed(huge.data(), huge.size());
+    REQUIRE(parser.failed());
+}
+
+TEST_CASE("HttpResponseParser stops when the consumer does", "[http_parser]") {
+    HttpResponseParser parser([](const char*, size_t) { return false; });
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nbody";
+    parser.feed(response.data(), response.size());
+    REQUIRE(parser.failed());
+    REQUIRE(parser.statusCode() == 200);
+    REQUIRE_FALSE(parser.keepAlive());
+}
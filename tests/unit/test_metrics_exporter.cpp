@@ -0,0 +1,78 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <string>
+
+#include "netmon/metrics_exporter.hpp"
+#include "netmon/perfdata.hpp"
+
+using namespace netmon_plugins;
+
+namespace {
+
+ResultRecord record(const std::string& check, int exitCode, const std::string& perfdata) {
+    ResultRecord result;
+    result.check = check;
+    result.exitCode = exitCode;
+    parsePerfdata(perfdata, result.metrics);
+    result.latency = std::chrono::microseconds(1500);
+    return result;
+}
+
+size_t occurrences(const std::string& text, const std::string& part) {
+    size_t count = 0;
+    for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1)) {
+        count++;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST_CASE("MetricsExporter groups samples of every check by family", "[metrics]") {
+    MetricsExporter exporter;
+    exporter.update(record("web2", 2, "time=30ms"));
+    exporter.update(record("web1", 0, "time=20ms size=2KB"));
+    REQUIRE(exporter.checks() == 2);
+
+    const std::string page = exporter.render();
+    REQUIRE(page.find("# HELP netmon_check_status Plugin exit code") != std::string::npos);
+    REQUIRE(page.find("# TYPE netmon_check_status gauge\n"
+                      "netmon_check_status{check=\"web1\"} 0\n"
+                      "netmon_check_status{check=\"web2\"} 2\n") != std::string::npos);
+    REQUIRE(page.find("# TYPE netmon_perfdata_seconds gauge\n"
+                      "netmon_perfdata_seconds{check=\"web1\",label=\"time\"} 0.02\n"
+                      "netmon_perfdata_seconds{check=\"web2\",label=\"time\"} 0.03\n") !=
+            std::string::npos);
+    REQUIRE(page.find("netmon_perfdata_bytes{check=\"web1\",label=\"size\"} 2048\n") !=
+            std::string::npos);
+    REQUIRE(page.find("netmon_check_latency_seconds{check=\"web1\"} 0.0015\n") !=
+            std::string::npos);
+    REQUIRE(occurrences(page, "# TYPE ") == 4);
+}
+
+TEST_CASE("MetricsExporter replaces and removes a check's samples", "[metrics]") {
+    MetricsExporter exporter;
+    exporter.update(record("db1", 0, "conns=5 requests=10c"));
+    exporter.update(record("web1", 0, "time=20ms"));
+    REQUIRE(exporter.render().find("# TYPE netmon_perfdata_total counter\n") !=
+            std::string::npos);
+
+    // The new result drops metrics the old one had
+    exporter.update(record("db1", 1, "conns=7"));
+    std::string page = exporter.render();
+    REQUIRE(page.find("netmon_perfdata{check=\"db1\",label=\"conns\"} 7\n") !=
+            std::string::npos);
+    REQUIRE(page.find("requests") == std::string::npos);
+    REQUIRE(occurrences(page, "{check=\"db1\"") == 3);
+
+    REQUIRE(exporter.remove("web1"));
+    REQUIRE_FALSE(exporter.remove("web1"));
+    page = exporter.render();
+    REQUIRE(page.find("web1") == std::string::npos);
+    REQUIRE(page.find("netmon_perfdata_seconds") == std::string::npos);
+    REQUIRE(exporter.checks() == 1);
+
+    exporter.remove("db1");
+    REQUIRE(exporter.render().empty());
+}
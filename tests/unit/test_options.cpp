@@ -0,0 +1,167 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "netmon/options.hpp"
+#include "netmon/plugin.hpp"
+
+using namespace netmon_plugins;
+
+namespace {
+
+struct ProbeConfig {
+    std::string hostname;
+    int port = 80;
+    long long bytes = 0;
+    double ratio = 0.0;
+    bool verbose = false;
+    int mode = 0;
+    ThresholdRange warning;
+    std::vector<std::string> headers;
+    std::vector<std::string> paths;
+    std::string user;
+    std::string password;
+};
+
+// "user:password"
+bool parseCredentials(ProbeConfig& config, const char* text) {
+    const std::string credentials = text;
+    const size_t colon = credentials.find(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+    config.user = credentials.substr(0, colon);
+    config.password = credentials.substr(colon + 1);
+    return true;
+}
+
+constexpr Option<ProbeConfig> PROBE_OPTIONS[] = {
+    option<&ProbeConfig::hostname>('H', "hostname", "HOST", "Host to probe"),
+    option<&ProbeConfig::port>('p', "port", "PORT", "Port number"),
+    option<&ProbeConfig::bytes>('\0', "bytes", "N", "Bytes to read"),
+    option<&ProbeConfig::ratio>('r', "ratio", "R", "Sample ratio"),
+    flag<&ProbeConfig::verbose>('v', "verbose", "Verbose output"),
+    flag<&ProbeConfig::mode, 2>('f', "fast", "Fast mode"),
+    option<&ProbeConfig::warning>('w', "warning", "RANGE", "Warning range"),
+    option<&ProbeConfig::headers>('\0', "header", "H", "Extra header, repeatable"),
+    custom<parseCredentials>('a', "auth", "USER:PASS", "Credentials"),
+    positional<&ProbeConfig::paths>("PATH...", "Paths to probe"),
+};
+
+ProbeConfig parse(const std::vector<std::string>& args) {
+    ProbeConfig config;
+    parseOptions(PROBE_OPTIONS, args, config);
+    return config;
+}
+
+} // namespace
+
+TEST_CASE("parseOptions fills typed fields from every option form", "[options]") {
+    const ProbeConfig config =
+        parse({"check_probe", "-H", "web1", "--port=8080", "--bytes", "1099511627776", "-r0.5",
+               "-v", "--fast", "-w", "@10:20", "--header", "A: 1", "--header=B: 2",
+               "-a", "ops:s3cret", "/", "--", "-odd"});
+    REQUIRE(config.hostname == "web1");
+    REQUIRE(config.port == 8080);
+    REQUIRE(config.bytes == 1099511627776LL);
+    REQUIRE(config.ratio == 0.5);
+    REQUIRE(config.verbose);
+    REQUIRE(config.mode == 2);
+    REQUIRE(config.warning.isInside());
+    REQUIRE(config.warning.end() == 20);
+    REQUIRE(config.headers == std::vector<std::string>{"A: 1", "B: 2"});
+    REQUIRE(config.user == "ops");
+    REQUIRE(config.password == "s3cret");
+    REQUIRE(config.paths == std::vector<std::string>{"/", "-odd"});
+
+    // Untouched fields keep their defaults; negative values are values
+    const ProbeConfig defaults = parse({"check_probe", "-p", "-1"});
+    REQUIRE(defaults.port == -1);
+    REQUIRE(defaults.hostname.empty());
+    REQUIRE_FALSE(defaults.verbose);
+    REQUIRE_FALSE(defaults.warning.isSet());
+}
+
+TEST_CASE("parseOptions rejects what it does not understand", "[options]") {
+    REQUIRE_THROWS_AS(parse({"check_probe", "-x"}), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse({"check_probe", "--colour"}), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse({"check_probe", "-p", "80x"}), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse({"check_probe", "-p", "99999999999"}), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse({"check_probe", "-p", ""}), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse({"check_probe", "-r", "nan"}), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse({"check_probe", "-w", "20:10"}), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse({"check_probe", "-a", "nocolon"}), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse({"check_probe", "--verbose=yes"}), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse({"check_probe", "-H"}), std::invalid_argument);
+
+    try {
+        parse({"check_probe", "--port", "eighty"});
+        FAIL("no exception");
+    } catch (const std::invalid_argument& e) {
+        REQUIRE(std::string(e.what()) == "invalid value for --port: 'eighty'");
+    }
+
+    struct Bare {
+        int count = 0;
+    };
+    static constexpr Option<Bare> BARE_OPTIONS[] = {
+        option<&Bare::count>('n', "count", "N", "Count"),
+    };
+    Bare bare;
+    REQUIRE_THROWS_AS(parseOptions(BARE_OPTIONS, {"bare", "stray"}, bare), std::invalid_argument);
+}
+
+TEST_CASE("parseOptions answers -h and --help unless the table takes them", "[options]") {
+    REQUIRE_THROWS_AS(parse({"check_probe", "-h"}), HelpRequested);
+    REQUIRE_THROWS_AS(parse({"check_probe", "-H", "web1", "--help"}), HelpRequested);
+
+    struct Hosted {
+        std::string host;
+    };
+    static constexpr Option<Hosted> HOSTED_OPTIONS[] = {
+        option<&Hosted::host>('h', "host", "HOST", "Host"),
+    };
+    Hosted hosted;
+    parseOptions(HOSTED_OPTIONS, {"hosted", "-h", "db1"}, hosted);
+    REQUIRE(hosted.host == "db1");
+}
+
+TEST_CASE("canonicalOptions spells equivalent command lines alike", "[options]") {
+    const std::vector<std::string> canonical =
+        canonicalOptions(PROBE_OPTIONS, {"check_probe", "--port=8080", "-Hweb1", "-v", "/",
+                                         "--header", "A: 1", "--header=B: 2", "-f"});
+    REQUIRE(canonical == std::vector<std::string>{"check_probe", "--hostname", "web1", "--port",
+                                                  "8080", "--header", "A: 1", "--header",
+                                                  "B: 2", "--verbose", "--fast", "--", "/"});
+    REQUIRE(canonicalOptions(PROBE_OPTIONS, {"check_probe", "-f", "-v", "--header", "A: 1",
+                                             "-p", "8080", "--hostname", "web1",
+                                             "--header", "B: 2", "/"}) ==
+            std::vector<std::string>{"check_probe", "--hostname", "web1", "--port", "8080",
+                                     "--header", "A: 1", "--header", "B: 2", "--fast",
+                                     "--verbose", "--", "/"});
+
+    // Repeated values keep their order; so do flags, which may share a field
+    REQUIRE(canonicalOptions(PROBE_OPTIONS, {"p", "--header=B", "--header=A"}) !=
+            canonicalOptions(PROBE_OPTIONS, {"p", "--header=A", "--header=B"}));
+    REQUIRE(canonicalOptions(PROBE_OPTIONS, {"p", "-v", "-f"}) !=
+            canonicalOptions(PROBE_OPTIONS, {"p", "-f", "-v"}));
+
+    REQUIRE_THROWS_AS(canonicalOptions(PROBE_OPTIONS, {"check_probe", "-x"}),
+                      std::invalid_argument);
+}
+
+TEST_CASE("formatUsage aligns options and shows their defaults", "[options]") {
+    const std::string usage = formatUsage("check_probe -H HOST [options] [PATH...]", PROBE_OPTIONS);
+    const std::string head = "Usage: check_probe -H HOST [options] [PATH...]\nOptions:\n";
+    REQUIRE(usage.compare(0, head.size(), head) == 0);
+    REQUIRE(usage.find("\n  -H, --hostname HOST   Host to probe\n") != std::string::npos);
+    REQUIRE(usage.find("\n  -p, --port PORT       Port number (default: 80)\n") !=
+            std::string::npos);
+    REQUIRE(usage.find("\n      --bytes N         Bytes to read\n") != std::string::npos);
+    REQUIRE(usage.find("\n  -v, --verbose         Verbose output\n") != std::string::npos);
+    REQUIRE(usage.find("\n  PATH...               Paths to probe\n") != std::string::npos);
+    const std::string help = "\n  -h, --help            Show this help message";
+    REQUIRE(usage.compare(usage.size() - help.size(), help.size(), help) == 0);
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "netmon/output_format.hpp"
+#include "netmon/perfdata.hpp"
+
+using namespace netmon_plugins;
+
+namespace {
+
+ResultRecord sampleRecord() {
+    ResultRecord record;
+    record.check = "web1";
+    record.exitCode = 1;
+    record.message = "HTTP 200 \"slow\"";
+    parsePerfdata("time=250ms;100;500;0 size=2KB 'free space'=40%;;;0;100", record.metrics);
+    record.latency = std::chrono::microseconds(251000);
+    record.timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    return record;
+}
+
+} // namespace
+
+TEST_CASE("parsePerfdata splits labels, units and thresholds", "[perfdata]") {
+    PerfMetrics metrics;
+    REQUIRE(parsePerfdata("time=0.25s;1;5;0;10 'my label'=3c load=U", metrics));
+    REQUIRE(metrics.size() == 3);
+
+    REQUIRE(metrics[0].label == "time");
+    REQUIRE(metrics[0].value == 0.25);
+    REQUIRE(metrics[0].unit == "s");
+    REQUIRE(metrics[0].warn == "1");
+    REQUIRE(metrics[0].crit == "5");
+    REQUIRE(metrics[0].hasMin);
+    REQUIRE(metrics[0].hasMax);
+    REQUIRE(metrics[0].max == 10.0);
+
+    REQUIRE(metrics[1].label == "my label");
+    REQUIRE(metrics[1].unit == "c");
+    REQUIRE_FALSE(metrics[1].hasMin);
+
+    REQUIRE(std::isnan(metrics[2].value));
+}
+
+TEST_CASE("parsePerfdata skips malformed fields", "[perfdata]") {
+    PerfMetrics metrics;
+    REQUIRE_FALSE(parsePerfdata("good=1 bad novalue= worse=x1 also=2B", metrics));
+    REQUIRE(metrics.size() == 2);
+    REQUIRE(metrics[0].label == "good");
+    REQUIRE(metrics[1].label == "also");
+}
+
+TEST_CASE("formatPerfdata reads back as the same metrics", "[perfdata]") {
+    const std::string text = "time=0.25s;1;5;0;10 'it''s'=3 ratio=0.1%;;;0";
+    PerfMetrics metrics;
+    REQUIRE(parsePerfdata(text, metrics));
+    REQUIRE(formatPerfdata(metrics) == text);
+}
+
+TEST_CASE("parseOutputFormat knows every format", "[output_format]") {
+    OutputFormat format = OutputFormat::NAGIOS;
+    for (const char* name : {"nagios", "json", "prometheus", "influx", "binary"}) {
+        REQUIRE(parseOutputFormat(name, format));
+        REQUIRE(outputFormatToString(format) == name);
+    }
+    REQUIRE_FALSE(parseOutputFormat("xml", format));
+}
+
+TEST_CASE("Nagios encoding matches the plugin output line", "[output_format]") {
+    std::string out;
+    encodeResult(OutputFormat::NAGIOS, sampleRecord(), out);
+    REQUIRE(out == "WARNING: HTTP 200 \"slow\" | time=250ms;100;500;0 size=2KB "
+                   "'free space'=40%;;;0;100\n");
+}
+
+TEST_CASE("JSON encoding is one escaped object per line", "[output_format]") {
+    std::string out;
+    encodeResult(OutputFormat::JSON, sampleRecord(), out);
+    const std::string head = "{\"check\":\"web1\",\"status\":\"WARNING\",\"exit_code\":1,"
+                             "\"message\":\"HTTP 200 \\\"slow\\\"\",";
+    REQUIRE(out.compare(0, head.size(), head) == 0);
+    REQUIRE(out.find("\"latency_ms\":251,") != std::string::npos);
+    REQUIRE(out.find("{\"label\":\"time\",\"value\":250,\"unit\":\"ms\",\"warn\":\"100\","
+                     "\"crit\":\"500\",\"min\":0}") != std::string::npos);
+    REQUIRE(out.back() == '\n');
+    REQUIRE(out.find('\n') == out.size() - 1);
+}
+
+TEST_CASE("Prometheus encoding scales units and groups families", "[output_format]") {
+    std::string out;
+    encodeResult(OutputFormat::PROMETHEUS, sampleRecord(), out);
+    REQUIRE(out.find("netmon_check_status{check=\"web1\"} 1\n") != std::string::npos);
+    REQUIRE(out.find("netmon_perfdata_seconds{check=\"web1\",label=\"time\"} 0.25\n") !=
+            std::string::npos);
+    REQUIRE(out.find("netmon_perfdata_bytes{check=\"web1\",label=\"size\"} 2048\n") !=
+            std::string::npos);
+    REQUIRE(out.find("netmon_perfdata_percent{check=\"web1\",label=\"free space\"} 40\n") !=
+            std::string::npos);
+
+    // Labels that are paths or quote characters stay label values
+    ResultRecord disk = sampleRecord();
+    disk.metrics.clear();
+    disk.metrics.emplace_back("/tmp", 512, "B");
+    disk.metrics.emplace_back("say \"hi\"", 3, "");
+    disk.metrics.emplace_back("rate", 9, "req/s");
+    std::string escaped;
+    encodeResult(OutputFormat::PROMETHEUS, disk, escaped);
+    REQUIRE(escaped.find("netmon_perfdata_bytes{check=\"web1\",label=\"/tmp\"} 512\n") !=
+            std::string::npos);
+    REQUIRE(escaped.find("netmon_perfdata{check=\"web1\",label=\"say \\\"hi\\\"\"} 3\n") !=
+            std::string::npos);
+    REQUIRE(escaped.find("netmon_perfdata{check=\"web1\",label=\"rate\",unit=\"req/s\"} 9\n") !=
+            std::string::npos);
+
+    ResultRecord other = sampleRecord();
+    other.check = "web2";
+    std::string grouped;
+    encodeResults(OutputFormat::PROMETHEUS, {sampleRecord(), other}, grouped);
+    REQUIRE(grouped.find("netmon_check_status{check=\"web1\"} 1\n"
+                         "netmon_check_status{check=\"web2\"} 1\n") != std::string::npos);
+}
+
+TEST_CASE("Influx encoding is one line with a nanosecond timestamp", "[output_format]") {
+    std::string out;
+    encodeResult(OutputFormat::INFLUX, sampleRecord(), out);
+    REQUIRE(out == "netmon,check=web1 exit_code=1i,latency=0.251,"
+                   "message=\"HTTP 200 \\\"slow\\\"\",time=250,size=2,free\\ space=40 "
+                   "1700000000000000000\n");
+}
+
+TEST_CASE("Binary records decode back to the same result", "[output_format]") {
+    const ResultRecord record = sampleRecord();
+    std::string out;
+    encodeResults(OutputFormat::BINARY, {record, record}, out);
+
+    ResultRecord decoded;
+    size_t consumed = 0;
+    REQUIRE(decodeBinaryResult(out.data(), out.size(), decoded, consumed));
+    REQUIRE(consumed * 2 == out.size());
+    REQUIRE(decoded.check == record.check);
+    REQUIRE(decoded.exitCode == record.exitCode);
+    REQUIRE(decoded.message == record.message);
+    REQUIRE(decoded.latency == record.latency);
+    REQUIRE(decoded.timestamp == record.timestamp);
+    REQUIRE(formatPerfdata(decoded.metrics) == formatPerfdata(record.metrics));
+
+    REQUIRE_FALSE(decodeBinaryResult(out.data(), consumed - 1, decoded, consumed));
+}
@@ -0,0 +1,72 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include "netmon/perfdata.hpp"
+#include "netmon/small_vector.hpp"
+
+using namespace netmon_plugins;
+
+TEST_CASE("SmallVector stays inline up to its capacity", "[small_vector]") {
+    SmallVector<std::string, 2> values;
+    values.push_back("a");
+    values.emplace_back("b");
+    REQUIRE(values.isInline());
+    REQUIRE(values.size() == 2);
+
+    values.push_back("c");
+    REQUIRE_FALSE(values.isInline());
+    REQUIRE(values.size() == 3);
+    REQUIRE(values[0] == "a");
+    REQUIRE(values.back() == "c");
+
+    SmallVector<std::string, 2> copy = values;
+    SmallVector<std::string, 2> moved = std::move(values);
+    REQUIRE(values.empty());
+    REQUIRE(copy.size() == 3);
+    REQUIRE(moved.size() == 3);
+    REQUIRE(moved[1] == "b");
+
+    SmallVector<std::string, 2> small = {"x"};
+    moved = std::move(small);
+    REQUIRE(moved.size() == 1);
+    REQUIRE(moved.isInline());
+    REQUIRE(moved[0] == "x");
+}
+
+TEST_CASE("SmallVector grows from one of its own elements", "[small_vector]") {
+    const std::string first(40, 'a');
+    const std::string second(40, 'b');
+
+    SmallVector<std::string, 2> values = {first, second};
+    values.push_back(values[0]);
+    REQUIRE_FALSE(values.isInline());
+    REQUIRE(values.size() == 3);
+    REQUIRE(values[0] == first);
+    REQUIRE(values[2] == first);
+
+    SmallVector<std::string, 2> doubled = {first, second};
+    doubled.append(doubled);
+    REQUIRE(doubled.size() == 4);
+    REQUIRE(doubled[2] == first);
+    REQUIRE(doubled[3] == second);
+}
+
+TEST_CASE("PerfMetric builder fills thresholds and bounds", "[perfdata]") {
+    PerfMetrics metrics;
+    metrics.push_back(PerfMetric("time", 0.25, "s").thresholds(1, 5).range(0, 10));
+    metrics.push_back(PerfMetric("procs", 12).thresholds("5:", "2:"));
+    metrics.push_back(PerfMetric("used", 512, "MB").maximum(1024));
+
+    REQUIRE(formatPerfdata(metrics) ==
+            "time=0.25s;1;5;0;10 procs=12;5:;2: used=512MB;;;;1024");
+}
+
+TEST_CASE("formatPerfdata writes plain decimals", "[perfdata]") {
+    PerfMetrics metrics;
+    metrics.emplace_back("tiny", 0.0000125, "s");
+    metrics.emplace_back("big", 123456789012.0, "B");
+    metrics.emplace_back("neg", -0.5);
+
+    REQUIRE(formatPerfdata(metrics) == "tiny=0.000013s big=123456789012B neg=-0.5");
+}
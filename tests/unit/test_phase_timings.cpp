@@ -0,0 +1,69 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <string>
+
+#include "netmon/phase_timings.hpp"
+
+using namespace netmon_plugins;
+using std::chrono::microseconds;
+
+TEST_CASE("PhaseTimings reports every phase in seconds", "[phase_timings]") {
+    PhaseTimings timings;
+    timings.dns = microseconds(1500);
+    timings.connect = microseconds(250);
+    timings.tls = microseconds(4000);
+    timings.firstByte = microseconds(2000000);
+    timings.total = microseconds(2005750);
+    timings.recorded = PhaseTimings::DNS | PhaseTimings::CONNECT | PhaseTimings::TLS |
+                       PhaseTimings::FIRST_BYTE;
+
+    PerfMetrics metrics;
+    timings.appendMetrics(metrics);
+    REQUIRE(formatPerfdata(metrics) ==
+            "dns_time=0.0015s connect_time=0.00025s tls_time=0.004s "
+            "ttfb=2s total_time=2.00575s");
+
+    // A plaintext connection that failed before any reply
+    PhaseTimings refused;
+    refused.dns = microseconds(100);
+    refused.connect = microseconds(300);
+    refused.total = microseconds(400);
+    refused.recorded = PhaseTimings::DNS | PhaseTimings::CONNECT;
+    metrics.clear();
+    refused.appendMetrics(metrics);
+    REQUIRE(formatPerfdata(metrics) == "dns_time=0.0001s connect_time=0.0003s total_time=0.0004s");
+}
+
+TEST_CASE("PhaseRecorder sums connections and uses the check time as total", "[phase_timings]") {
+    PhaseRecorder recorder;
+    PerfMetrics perfdata;
+    perfdata.emplace_back("size", 10, "B");
+    appendPhasePerfdata(perfdata, recorder, microseconds(100));
+    REQUIRE(perfdata.size() == 1);   // No connection, nothing added
+
+    PhaseTimings first;
+    first.dns = microseconds(10);
+    first.connect = microseconds(20);
+    first.total = microseconds(500);
+    first.recorded = PhaseTimings::DNS | PhaseTimings::CONNECT;
+    PhaseTimings second;
+    second.connect = microseconds(5);
+    second.tls = microseconds(40);
+    second.total = microseconds(900);
+    second.recorded = PhaseTimings::CONNECT | PhaseTimings::TLS;
+    recorder.record(first);
+    recorder.record(second);
+
+    REQUIRE(recorder.connections() == 2);
+    PhaseTimings summary = recorder.summary(microseconds(1000));
+    REQUIRE(summary.dns == microseconds(10));
+    REQUIRE(summary.connect == microseconds(25));
+    REQUIRE(summary.tls == microseconds(40));
+    REQUIRE(summary.total == microseconds(1000));
+
+    appendPhasePerfdata(perfdata, recorder, microseconds(1000));
+    REQUIRE(formatPerfdata(perfdata) ==
+            "size=10B dns_time=0.00001s connect_time=0.000025s tls_time=0.00004s "
+            "total_time=0.001s");
+}
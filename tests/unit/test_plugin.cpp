@@ -21,5 +21,20 @@ TEST_CASE("PluginResult stores message and perfdata", "[plugin]") {
 
     REQUIRE(result.code == netmon_plugins::ExitCode::WARNING);
     REQUIRE(result.message == "disk warning");
-    REQUIRE(result.perfdata == "used=90%;80;95");
+    REQUIRE(result.perfdata.size() == 1);
+    REQUIRE(result.perfdata[0].label == "used");
+    REQUIRE(result.perfdata[0].value == 90.0);
+    REQUIRE(result.perfdata[0].unit == "%");
+    REQUIRE(netmon_plugins::formatResult(result) == "WARNING: disk warning | used=90%;80;95");
+}
+
+TEST_CASE("PluginResult takes typed metrics", "[plugin]") {
+    using netmon_plugins::PerfMetric;
+    netmon_plugins::PluginResult result(
+        netmon_plugins::ExitCode::OK,
+        "3 processes",
+        {PerfMetric("procs", 3).thresholds("1:10", "1:").minimum(0)}
+    );
+
+    REQUIRE(netmon_plugins::formatResult(result) == "OK: 3 processes | procs=3;1:10;1:;0");
 }
@@ -0,0 +1,198 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "netmon/result_cache.hpp"
+
+using namespace netmon_plugins;
+using std::chrono::seconds;
+
+namespace {
+
+CachePolicy policy(int ttl, int staleFor) {
+    CachePolicy result;
+    result.ttl = seconds(ttl);
+    result.staleFor = seconds(staleFor);
+    return result;
+}
+
+CheckOutcome okOutcome(const std::string& text) {
+    return CheckOutcome(0, "OK: " + text + "\n", PerfMetrics(), text);
+}
+
+} // namespace
+
+TEST_CASE("extractCacheOptions removes cache options from the arguments", "[result_cache]") {
+    std::vector<std::string> args = {"check_http", "--cache-ttl", "30", "-H", "web1",
+                                     "--cache-stale=60", "--cache-dir", "/tmp/x"};
+    CachePolicy parsed;
+    std::string dir;
+    extractCacheOptions(args, parsed, dir);
+    REQUIRE(args == std::vector<std::string>{"check_http", "-H", "web1"});
+    REQUIRE(parsed.ttl == seconds(30));
+    REQUIRE(parsed.staleFor == seconds(60));
+    REQUIRE(dir == "/tmp/x");
+
+    std::vector<std::string> bad = {"check_http", "--cache-ttl", "soon"};
+    REQUIRE_THROWS_AS(extractCacheOptions(bad, parsed, dir), std::invalid_argument);
+    std::vector<std::string> missing = {"check_http", "--cache-ttl"};
+    REQUIRE_THROWS_AS(extractCacheOptions(missing, parsed, dir), std::invalid_argument);
+}
+
+TEST_CASE("resultCacheKey ignores how the plugin was named", "[result_cache]") {
+    REQUIRE(resultCacheKey({"/usr/lib/nagios/check_http", "-H", "a"}) ==
+            resultCacheKey({"http", "-H", "a"}));
+    REQUIRE(resultCacheKey({"no_such_plugin", "-H", "a"}) !=
+            resultCacheKey({"no_such_plugin", "-Ha"}));
+}
+
+TEST_CASE("resultCacheKey ignores how a linked plugin's options are spelled", "[result_cache]") {
+    const std::string key = resultCacheKey({"check_dummy", "-m", "up", "-w"});
+    REQUIRE(resultCacheKey({"dummy", "-w", "--message=up"}) == key);
+    REQUIRE(resultCacheKey({"dummy", "-mup", "--warning"}) == key);
+    REQUIRE(resultCacheKey({"dummy", "-m", "down", "-w"}) != key);
+
+    // -o and -c set the same field, so their order matters
+    REQUIRE(resultCacheKey({"dummy", "-o", "-c"}) != resultCacheKey({"dummy", "-c", "-o"}));
+
+    // Arguments the plugin rejects are keyed as given
+    REQUIRE(resultCacheKey({"dummy", "-x"}) == std::string("dummy\0-x", 8));
+}
+
+TEST_CASE("ResultCache serves fresh, then stale, then nothing", "[result_cache]") {
+    ResultCache cache;
+    const auto start = ResultCache::Clock::now();
+    const CachePolicy limits = policy(10, 20);
+
+    CacheLookup miss = cache.lookup("k", limits, start);
+    REQUIRE(miss.state == CacheState::MISS);
+    REQUIRE(miss.refresh);
+
+    cache.store("k", okOutcome("up"), start);
+    CacheLookup fresh = cache.lookup("k", limits, start + seconds(5));
+    REQUIRE(fresh.state == CacheState::FRESH);
+    REQUIRE_FALSE(fresh.refresh);
+    REQUIRE(fresh.outcome.output == "OK: up\n");
+
+    // Only the first caller past the ttl refreshes
+    CacheLookup first = cache.lookup("k", limits, start + seconds(15));
+    CacheLookup second = cache.lookup("k", limits, start + seconds(16));
+    REQUIRE(first.state == CacheState::STALE);
+    REQUIRE(first.refresh);
+    REQUIRE(second.state == CacheState::STALE);
+    REQUIRE_FALSE(second.refresh);
+
+    // An abandoned refresh is handed to the next caller
+    cache.abandon("k");
+    REQUIRE(cache.lookup("k", limits, start + seconds(17)).refresh);
+
+    REQUIRE(cache.lookup("k", limits, start + seconds(31)).state == CacheState::MISS);
+    REQUIRE(cache.size() == 0);
+}
+
+TEST_CASE("ResultCache keeps UNKNOWN outcomes out", "[result_cache]") {
+    ResultCache cache;
+    cache.store("k", CheckOutcome(3, "UNKNOWN: timed out\n"));
+    REQUIRE(cache.size() == 0);
+}
+
+TEST_CASE("ResultCache drops the least recently used entry", "[result_cache]") {
+    ResultCache cache(2);
+    const auto now = ResultCache::Clock::now();
+    cache.store("a", okOutcome("a"), now);
+    cache.store("b", okOutcome("b"), now);
+    cache.lookup("a", policy(10, 0), now);
+    cache.store("c", okOutcome("c"), now);
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.lookup("a", policy(10, 0), now).state == CacheState::FRESH);
+    REQUIRE(cache.lookup("b", policy(10, 0), now).state == CacheState::MISS);
+}
+
+TEST_CASE("FileResultCache round-trips records through the directory", "[result_cache]") {
+    char dirTemplate[] = "/tmp/netmon-cache-XXXXXX";
+    REQUIRE(mkdtemp(dirTemplate) != nullptr);
+    const std::string dir = dirTemplate;
+    const std::string key = resultCacheKey({"check_http", "-H", "web1"});
+
+    ResultRecord record;
+    record.check = "http";
+    record.exitCode = 1;
+    record.message = "slow";
+    record.metrics.emplace_back("time", 2.5, "s");
+    record.timestamp = std::chrono::system_clock::now();
+
+    ResultRecord read;
+    bool refresh = false;
+    {
+        FileResultCache cache(dir);
+        REQUIRE(cache.lookup(key, policy(10, 0), read, refresh) == CacheState::MISS);
+        REQUIRE(cache.store(key, record));
+    }
+    {
+        FileResultCache cache(dir);
+        REQUIRE(cache.lookup(key, policy(10, 0), read, refresh) == CacheState::FRESH);
+        REQUIRE_FALSE(refresh);
+        REQUIRE(read.exitCode == 1);
+        REQUIRE(read.message == "slow");
+        REQUIRE(formatPerfdata(read.metrics) == "time=2.5s");
+
+        // Another key hashing elsewhere is a miss
+        REQUIRE(cache.lookup(key + "x", policy(10, 0), read, refresh) == CacheState::MISS);
+    }
+
+    // Stale: the first process to look takes the refresh lock
+    record.timestamp -= seconds(20);
+    {
+        FileResultCache writer(dir);
+        REQUIRE(writer.store(key, record));
+    }
+    FileResultCache first(dir);
+    FileResultCache second(dir);
+    REQUIRE(first.lookup(key, policy(10, 30), read, refresh) == CacheState::STALE);
+    REQUIRE(refresh);
+    REQUIRE(second.lookup(key, policy(10, 30), read, refresh) == CacheState::STALE);
+    REQUIRE_FALSE(refresh);
+    REQUIRE(first.lookup(key, policy(10, 5), read, refresh) == CacheState::MISS);
+
+    REQUIRE(std::system(("rm -rf " + dir).c_str()) == 0);
+}
+
+TEST_CASE("FileResultCache creates missing parents or says why it cannot", "[result_cache]") {
+    char dirTemplate[] = "/tmp/netmon-cache-XXXXXX";
+    REQUIRE(mkdtemp(dirTemplate) != nullptr);
+    const std::string dir = dirTemplate;
+    const std::string key = resultCacheKey({"check_dummy", "-m", "hi"});
+
+    ResultRecord record;
+    record.exitCode = 0;
+    record.message = "hi";
+    record.timestamp = std::chrono::system_clock::now();
+
+    ResultRecord read;
+    bool refresh = false;
+    {
+        FileResultCache cache(dir + "/run/netmon/cache");
+        REQUIRE(cache.error().empty());
+        REQUIRE(cache.store(key, record));
+        REQUIRE(cache.lookup(key, policy(10, 0), read, refresh) == CacheState::FRESH);
+    }
+    struct stat info;
+    REQUIRE(stat((dir + "/run").c_str(), &info) == 0);
+    REQUIRE((info.st_mode & 0777) == 0700);
+
+    // A parent that is a file cannot be created over
+    REQUIRE(std::system(("touch " + dir + "/file").c_str()) == 0);
+    FileResultCache broken(dir + "/file/cache");
+    REQUIRE(broken.error().find("cannot create " + dir + "/file") == 0);
+    REQUIRE(broken.lookup(key, policy(10, 0), read, refresh) == CacheState::MISS);
+    REQUIRE_FALSE(broken.store(key, record));
+
+    REQUIRE(std::system(("rm -rf " + dir).c_str()) == 0);
+}
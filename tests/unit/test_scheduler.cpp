@@ -0,0 +1,259 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "netmon/scheduler.hpp"
+#include "netmon/timer_wheel.hpp"
+
+using namespace netmon_plugins;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+TEST_CASE("TimerWheel fires timers in order once their tick has passed", "[scheduler]") {
+    const CheckClock::time_point start = CheckClock::now();
+    TimerWheel wheel(milliseconds(10), start);
+    std::vector<int> fired;
+    wheel.schedule(start + milliseconds(25), [&]() { fired.push_back(2); });
+    wheel.schedule(start + milliseconds(5), [&]() { fired.push_back(1); });
+    // Beyond the 256 slots of the first level
+    wheel.schedule(start + milliseconds(5000), [&]() { fired.push_back(3); });
+    REQUIRE(wheel.size() == 3);
+    REQUIRE(wheel.nextExpiry() == start + milliseconds(10));
+
+    REQUIRE(wheel.advance(start + milliseconds(9)) == 0);
+    REQUIRE(wheel.advance(start + milliseconds(30)) == 2);
+    REQUIRE(fired == std::vector<int>{1, 2});
+    // Still on level 1: the bound is where its slot cascades
+    REQUIRE(wheel.nextExpiry() == start + milliseconds(2560));
+
+    REQUIRE(wheel.advance(start + milliseconds(4999)) == 0);
+    REQUIRE(wheel.nextExpiry() == start + milliseconds(5000));
+    REQUIRE(wheel.advance(start + milliseconds(5000)) == 1);
+    REQUIRE(fired == std::vector<int>{1, 2, 3});
+    REQUIRE(wheel.empty());
+    REQUIRE(wheel.nextExpiry() == CheckClock::time_point::max());
+}
+
+TEST_CASE("TimerWheel callbacks can schedule further timers", "[scheduler]") {
+    const CheckClock::time_point start = CheckClock::now();
+    TimerWheel wheel(milliseconds(10), start);
+    int runs = 0;
+    std::function<void()> again = [&]() {
+        if (++runs < 3) {
+            wheel.schedule(start + milliseconds(10 * (runs + 1)), again);
+        }
+    };
+    wheel.schedule(start + milliseconds(10), again);
+    wheel.advance(start + milliseconds(100));
+    REQUIRE(runs == 3);
+}
+
+TEST_CASE("TimerWheel cancel drops pending timers and ignores stale handles", "[scheduler]") {
+    const CheckClock::time_point start = CheckClock::now();
+    TimerWheel wheel(milliseconds(1), start);
+    int fired = 0;
+    const TimerId first = wheel.schedule(start + milliseconds(5), [&]() { fired++; });
+    const TimerId second = wheel.schedule(start + milliseconds(5), [&]() { fired++; });
+    REQUIRE(first != NO_TIMER);
+    REQUIRE(wheel.cancel(first));
+    REQUIRE_FALSE(wheel.cancel(first));
+    REQUIRE_FALSE(wheel.cancel(NO_TIMER));
+    REQUIRE(wheel.size() == 1);
+
+    // The freed node is reused; the old handle must not reach the new timer
+    const TimerId third = wheel.schedule(start + milliseconds(6), [&]() { fired++; });
+    REQUIRE(third != first);
+    REQUIRE_FALSE(wheel.cancel(first));
+
+    // A callback may cancel a timer due on the same tick
+    wheel.schedule(start + milliseconds(6), [&]() { wheel.cancel(third); });
+    REQUIRE(wheel.advance(start + milliseconds(10)) >= 2);
+    REQUIRE(fired == 1);
+    REQUIRE_FALSE(wheel.cancel(second));
+    REQUIRE(wheel.empty());
+}
+
+TEST_CASE("TimerWheel cascades long timers down through every level", "[scheduler]") {
+    using std::chrono::hours;
+    const CheckClock::time_point start = CheckClock::now();
+    TimerWheel wheel(milliseconds(1), start);
+    std::vector<int> fired;
+    // Levels 1, 2 and 3, and beyond the wheel's span of about 49 days
+    wheel.schedule(start + milliseconds(300), [&]() { fired.push_back(1); });
+    wheel.schedule(start + seconds(70), [&]() { fired.push_back(2); });
+    wheel.schedule(start + hours(5), [&]() { fired.push_back(3); });
+    wheel.schedule(start + hours(24 * 60), [&]() { fired.push_back(4); });
+
+    const CheckClock::time_point due[] = {start + milliseconds(300), start + seconds(70),
+                                          start + hours(5), start + hours(24 * 60)};
+    for (size_t i = 0; i < 4; i++) {
+        REQUIRE(wheel.nextExpiry() <= due[i]);
+        REQUIRE(wheel.advance(due[i] - milliseconds(1)) == 0);
+        REQUIRE(wheel.advance(due[i]) == 1);
+        REQUIRE(fired.size() == i + 1);
+    }
+    REQUIRE(fired == std::vector<int>{1, 2, 3, 4});
+    REQUIRE(wheel.empty());
+}
+
+TEST_CASE("TimerWheel fires many timers on their tick, never early", "[scheduler]") {
+    const CheckClock::time_point start = CheckClock::now();
+    TimerWheel wheel(milliseconds(1), start);
+    const int count = 20000;
+    std::vector<CheckClock::time_point> due(count);
+    std::vector<CheckClock::time_point> firedAt(count);
+    CheckClock::time_point now = start;
+    uint32_t seed = 12345;
+    for (int i = 0; i < count; i++) {
+        seed = seed * 1103515245u + 12345u;
+        due[i] = start + milliseconds(seed % 200000);
+        wheel.schedule(due[i], [&, i]() { firedAt[i] = now; });
+    }
+    REQUIRE(wheel.size() == static_cast<size_t>(count));
+
+    size_t fired = 0;
+    while (!wheel.empty()) {
+        fired += wheel.advance(now);
+        now += milliseconds(7);
+    }
+    REQUIRE(fired == static_cast<size_t>(count));
+    int misfired = 0;
+    for (int i = 0; i < count; i++) {
+        if (firedAt[i] < due[i] || firedAt[i] - due[i] >= milliseconds(7)) {
+            misfired++;
+        }
+    }
+    REQUIRE(misfired == 0);
+}
+
+TEST_CASE("parseInterval takes seconds, minutes and hours", "[scheduler]") {
+    seconds interval;
+    REQUIRE(parseInterval("90", interval));
+    REQUIRE(interval == seconds(90));
+    REQUIRE(parseInterval("30s", interval));
+    REQUIRE(interval == seconds(30));
+    REQUIRE(parseInterval("5m", interval));
+    REQUIRE(interval == seconds(300));
+    REQUIRE(parseInterval("1h", interval));
+    REQUIRE(interval == seconds(3600));
+    REQUIRE_FALSE(parseInterval("0", interval));
+    REQUIRE_FALSE(parseInterval("5x", interval));
+    REQUIRE_FALSE(parseInterval("http", interval));
+}
+
+TEST_CASE("readInventory reads batch lines with optional intervals", "[scheduler]") {
+    std::istringstream input("# inventory\n"
+                             "30s web1: http -H web1\n"
+                             "\n"
+                             "tcp -H db1 -p 5432\n"
+                             "5m\n");
+    std::vector<std::string> errors;
+    std::vector<ScheduledCheck> checks = readInventory(input, errors);
+
+    REQUIRE(checks.size() == 2);
+    REQUIRE(checks[0].id == "web1");
+    REQUIRE(checks[0].interval == seconds(30));
+    REQUIRE(checks[0].args == std::vector<std::string>{"http", "-H", "web1"});
+    REQUIRE(checks[1].id == "4");
+    REQUIRE(checks[1].interval == seconds(0));
+    REQUIRE(errors.size() == 1);
+    REQUIRE(errors[0].compare(0, 7, "line 5:") == 0);
+}
+
+TEST_CASE("phaseOffset is stable and spreads checks across the interval", "[scheduler]") {
+    const seconds interval(60);
+    std::vector<int> buckets(6, 0);
+    for (int i = 0; i < 600; i++) {
+        ScheduledCheck check;
+        check.id = "host" + std::to_string(i);
+        check.args = {"tcp", "-H", check.id};
+        const milliseconds offset = phaseOffset(check, interval);
+        REQUIRE(offset == phaseOffset(check, interval));
+        REQUIRE(offset >= milliseconds(0));
+        REQUIRE(offset < interval);
+        buckets[static_cast<size_t>(offset.count() / 10000)]++;
+    }
+    // 100 expected per ten-second bucket
+    for (int count : buckets) {
+        REQUIRE(count > 60);
+        REQUIRE(count < 140);
+    }
+}
+
+TEST_CASE("alignedRun lands on the check's phase after now", "[scheduler]") {
+    using std::chrono::system_clock;
+    const system_clock::time_point now{seconds(1700000010)};   // :30 past a minute
+    REQUIRE(alignedRun(now, milliseconds(45000), seconds(60)) ==
+            system_clock::time_point{seconds(1700000025)});
+    REQUIRE(alignedRun(now, milliseconds(15000), seconds(60)) ==
+            system_clock::time_point{seconds(1700000055)});
+    // Exactly on the phase: the next run is one interval away
+    REQUIRE(alignedRun(now, milliseconds(30000), seconds(60)) ==
+            system_clock::time_point{seconds(1700000070)});
+}
+
+TEST_CASE("Scheduler dispatches due checks until stopped", "[scheduler]") {
+    ScheduledCheck check;
+    check.id = "fast";
+    check.args = {"dummy"};
+    check.interval = seconds(1);
+
+    std::atomic<int> runs(0);
+    std::atomic<bool> wrongCheck(false);
+    SchedulerOptions options;
+    options.tick = milliseconds(10);
+    // Catch2 assertions are not thread-safe; check on the test thread
+    Scheduler scheduler({check}, [&](size_t index, const ScheduledCheck& due) {
+        if (index != 0 || due.id != "fast") {
+            wrongCheck = true;
+        }
+        runs++;
+    }, options);
+    scheduler.start();
+
+    const auto deadline = CheckClock::now() + seconds(3);
+    while (runs < 2 && CheckClock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    scheduler.stop();
+    REQUIRE(runs >= 2);
+    REQUIRE_FALSE(wrongCheck);
+    REQUIRE(scheduler.dispatched() == static_cast<size_t>(runs.load()));
+}
+
+TEST_CASE("Scheduler restarted after stop() dispatches each run once", "[scheduler]") {
+    ScheduledCheck check;
+    check.id = "restarted";
+    check.args = {"dummy"};
+    check.interval = seconds(1);
+
+    std::mutex mutex;
+    std::vector<CheckClock::time_point> dispatched;
+    SchedulerOptions options;
+    options.tick = milliseconds(10);
+    Scheduler scheduler({check}, [&](size_t, const ScheduledCheck&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        dispatched.push_back(CheckClock::now());
+    }, options);
+    for (int i = 0; i < 3; i++) {
+        scheduler.start();
+        scheduler.stop();
+    }
+    scheduler.start();
+    std::this_thread::sleep_for(milliseconds(2200));
+    scheduler.stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    REQUIRE(dispatched.size() >= 2);
+    REQUIRE(dispatched.size() <= 3);
+    for (size_t i = 1; i < dispatched.size(); i++) {
+        REQUIRE(dispatched[i] - dispatched[i - 1] > milliseconds(500));
+    }
+}
@@ -0,0 +1,270 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "netmon/tcp_script.hpp"
+
+#include "loopback_server.hpp"
+
+using namespace netmon_plugins;
+using std::chrono::milliseconds;
+
+#ifndef _WIN32
+namespace {
+
+long long elapsedMs(CheckClock::time_point start) {
+    return std::chrono::duration_cast<milliseconds>(CheckClock::now() - start).count();
+}
+
+// Loopback server speaking a tiny FTP-like dialect to any number of
+// clients from one thread. A silent server accepts and never answers.
+class ScriptServer {
+public:
+    explicit ScriptServer(bool silent = false) : listener(512) {
+        port = listener.port();
+        thread = std::thread([this, silent]() { serve(silent); });
+    }
+
+    ~ScriptServer() {
+        stopping = true;
+        thread.join();
+    }
+
+    int port = 0;
+
+private:
+    void serve(bool silent) {
+        std::map<int, std::string> clients;
+        while (!stopping) {
+            std::vector<struct pollfd> fds;
+            fds.push_back({listener.fd(), POLLIN, 0});
+            for (const auto& client : clients) {
+                fds.push_back({client.first, POLLIN, 0});
+            }
+            if (poll(fds.data(), fds.size(), 20) <= 0) {
+                continue;
+            }
+            if (fds[0].revents & POLLIN) {
+                int client = listener.accept();
+                clients[client];
+                if (!silent) {
+                    reply(client, "220-Welcome\r\n220 Ready\r\n");
+                }
+            }
+            for (size_t i = 1; i < fds.size(); i++) {
+                if (fds[i].revents == 0) {
+                    continue;
+                }
+                char buffer[512];
+                ssize_t bytes = recv(fds[i].fd, buffer, sizeof(buffer), 0);
+                if (bytes <= 0) {
+                    close(fds[i].fd);
+                    clients.erase(fds[i].fd);
+                    continue;
+                }
+                std::string& pending = clients[fds[i].fd];
+                pending.append(buffer, static_cast<size_t>(bytes));
+                size_t end;
+                while ((end = pending.find("\r\n")) != std::string::npos) {
+                    std::string line = pending.substr(0, end);
+                    pending.erase(0, end + 2);
+                    if (line.compare(0, 4, "USER") == 0) {
+                        reply(fds[i].fd, "331 Password required\r\n");
+                    } else if (line.compare(0, 4, "PASS") == 0) {
+                        reply(fds[i].fd, "230 Logged in\r\n");
+                    } else if (line == "QUIT") {
+                        reply(fds[i].fd, "221 Bye\r\n");
+                    } else {
+                        reply(fds[i].fd, "500 Unknown command\r\n");
+                    }
+                }
+            }
+        }
+        for (const auto& client : clients) {
+            close(client.first);
+        }
+    }
+
+    static void reply(int fd, const std::string& text) {
+        send(fd, text.data(), text.size(), MSG_NOSIGNAL);
+    }
+
+    testing::LoopbackListener listener;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+
+TcpScript loginScript() {
+    TcpScript script;
+    script.expectReply({"2"})
+          .send("USER monitor\r\n").expectReply({"2", "3"})
+          .send("PASS secret\r\n").when("3")
+          .expectReply({"2"}).when("3")
+          .send("QUIT\r\n").expectReply({"221"});
+    return script;
+}
+
+} // namespace
+
+TEST_CASE("TcpScript runs a multi-step conversation", "[tcp_script][network]") {
+    ScriptServer server;
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+
+    TcpProbeResult result = runTcpScript("127.0.0.1", server.port, loginScript(), context);
+
+    REQUIRE(result.ok());
+    REQUIRE(result.connected);
+    REQUIRE(result.reply == "221 Bye");
+    REQUIRE(result.timings.total >= result.timings.connect);
+    REQUIRE(result.timings.firstByte > std::chrono::microseconds(0));
+}
+
+TEST_CASE("TcpScript skips conditional steps", "[tcp_script][network]") {
+    ScriptServer server;
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+
+    TcpScript script;
+    script.expectReply({"2"})
+          .send("NOOP\r\n").when("331")     // Last reply is the 220 banner
+          .send("QUIT\r\n").expectReply({"221"});
+
+    REQUIRE(runTcpScript("127.0.0.1", server.port, script, context).ok());
+}
+
+TEST_CASE("TcpScript keeps every line of a multi-line reply", "[tcp_script][network]") {
+    ScriptServer server;
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+
+    TcpScript script;
+    script.expectReply({"220"});
+
+    TcpProbeResult result = runTcpScript("127.0.0.1", server.port, script, context);
+    REQUIRE(result.ok());
+    REQUIRE(result.reply == "220-Welcome\n220 Ready");
+    REQUIRE(result.reply.find("Welcome") != std::string::npos);
+}
+
+TEST_CASE("TcpScript reports an unexpected reply", "[tcp_script][network]") {
+    ScriptServer server;
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+
+    TcpScript script;
+    script.expectReply({"2"}).send("HELP\r\n").expectReply({"2"});
+
+    TcpProbeResult result = runTcpScript("127.0.0.1", server.port, script, context);
+    REQUIRE(result.status == IoStatus::OK);
+    REQUIRE(result.connected);
+    REQUIRE_FALSE(result.matched);
+    REQUIRE(result.failedStep == 2);
+    REQUIRE(result.reply == "500 Unknown command");
+}
+
+TEST_CASE("TcpScript gives up at the deadline", "[tcp_script][network]") {
+    ScriptServer server(true);
+    CheckContext context(Deadline::after(milliseconds(200)), CancellationToken());
+
+    auto start = CheckClock::now();
+    TcpProbeResult result = runTcpScript("127.0.0.1", server.port, loginScript(), context);
+
+    REQUIRE(result.status == IoStatus::TIMED_OUT);
+    REQUIRE(result.connected);
+    REQUIRE(elapsedMs(start) >= 150);
+    REQUIRE(elapsedMs(start) < 1000);
+}
+
+TEST_CASE("TcpScript stops when the token is cancelled", "[tcp_script][network]") {
+    ScriptServer server(true);
+    CheckContext context(Deadline::afterSeconds(30), CancellationToken());
+
+    std::thread canceller([context]() {
+        std::this_thread::sleep_for(milliseconds(100));
+        context.token.cancel();
+    });
+    auto start = CheckClock::now();
+    TcpProbeResult result = runTcpScript("127.0.0.1", server.port, loginScript(), context);
+    canceller.join();
+
+    REQUIRE(result.status == IoStatus::CANCELLED);
+    REQUIRE(elapsedMs(start) < 1000);
+}
+
+TEST_CASE("TcpScript reports a refused connection", "[tcp_script][network]") {
+    int port;
+    {
+        ScriptServer server;
+        port = server.port;
+    }
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+
+    TcpProbeResult result = runTcpScript("127.0.0.1", port, loginScript(), context);
+    REQUIRE(result.status == IoStatus::FAILED);
+    REQUIRE_FALSE(result.connected);
+}
+
+TEST_CASE("TcpProbeEngine runs many probes on one thread", "[tcp_script][network]") {
+    ScriptServer server;
+    TcpProbeEngine engine;
+    const int probes = 200;
+
+    TcpProbe probe;
+    probe.host = "127.0.0.1";
+    probe.port = server.port;
+    probe.script = loginScript();
+
+    int succeeded = 0;
+    int finished = 0;
+    const std::thread::id caller = std::this_thread::get_id();
+    bool sameThread = true;
+    for (int i = 0; i < probes; i++) {
+        engine.add(probe, CheckContext(Deadline::afterSeconds(10), CancellationToken()),
+                   [&](const TcpProbeResult& result) {
+                       finished++;
+                       succeeded += result.ok() ? 1 : 0;
+                       sameThread = sameThread && std::this_thread::get_id() == caller;
+                   });
+    }
+    REQUIRE(engine.active() == static_cast<size_t>(probes));
+
+    engine.run();
+
+    REQUIRE(engine.active() == 0);
+    REQUIRE(finished == probes);
+    REQUIRE(succeeded == probes);
+    REQUIRE(sameThread);
+}
+
+TEST_CASE("TcpProbeEngine races the next address after a stalled connect",
+          "[tcp_script][network]") {
+    ScriptServer server;
+    TcpProbe probe;
+    probe.host = "example.invalid";
+    probe.port = server.port;
+    probe.script = loginScript();
+    // A non-routable address that never answers, then the server
+    REQUIRE(resolveNumeric("10.255.255.1", server.port, probe.addresses));
+    REQUIRE(resolveNumeric("127.0.0.1", server.port, probe.addresses));
+
+    TcpProbeEngine engine;
+    TcpProbeResult result;
+    auto start = CheckClock::now();
+    engine.add(probe, CheckContext(Deadline::afterSeconds(5), CancellationToken()),
+               [&result](const TcpProbeResult& finished) { result = finished; });
+    engine.run();
+
+    REQUIRE(result.ok());
+    REQUIRE(elapsedMs(start) < 2000);
+}
+
+TEST_CASE("TcpProbeEngine resolves host names off the loop", "[tcp_script][network]") {
+    ScriptServer server;
+    CheckContext context(Deadline::afterSeconds(5), CancellationToken());
+
+    TcpProbeResult result = runTcpScript("localhost", server.port, loginScript(), context);
+    // localhost may resolve to ::1 first; the engine falls through to 127.0.0.1
+    REQUIRE(result.ok());
+}
+#endif
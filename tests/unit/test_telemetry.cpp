@@ -0,0 +1,159 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "netmon/executor.hpp"
+#include "netmon/telemetry.hpp"
+
+using namespace netmon_plugins;
+using std::chrono::microseconds;
+
+namespace {
+
+const PluginStats* findStats(const std::vector<PluginStats>& stats, const std::string& name) {
+    for (const PluginStats& plugin : stats) {
+        if (plugin.plugin == name) {
+            return &plugin;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("LatencyHistogram quantiles stay within its precision", "[telemetry]") {
+    LatencyHistogram empty;
+    REQUIRE(empty.count() == 0);
+    REQUIRE(empty.quantile(0.99) == microseconds(0));
+    REQUIRE(empty.max() == microseconds(0));
+
+    LatencyHistogram histogram;
+    for (int us = 1; us <= 100000; us++) {
+        histogram.record(microseconds(us));
+    }
+    REQUIRE(histogram.count() == 100000);
+    REQUIRE(histogram.sum() == microseconds(5000050000LL));
+    REQUIRE(histogram.max() == microseconds(100000));
+    REQUIRE(histogram.quantile(1.0) == microseconds(100000));
+
+    const std::pair<double, long long> expected[] = {
+        {0.001, 100}, {0.5, 50000}, {0.9, 90000}, {0.99, 99000}};
+    for (const auto& point : expected) {
+        const long long value = histogram.quantile(point.first).count();
+        REQUIRE(value >= point.second);
+        REQUIRE(value <= point.second + point.second / 60);
+    }
+
+    // Small values are exact; huge ones are clamped rather than lost
+    LatencyHistogram small;
+    small.record(microseconds(7));
+    small.record(microseconds(-3));
+    REQUIRE(small.quantile(0.5) == microseconds(0));
+    REQUIRE(small.quantile(1.0) == microseconds(7));
+    LatencyHistogram huge;
+    huge.record(std::chrono::hours(48));
+    REQUIRE(huge.count() == 1);
+    REQUIRE(huge.max() == std::chrono::hours(48));
+}
+
+TEST_CASE("PluginTelemetry keeps totals per plugin", "[telemetry]") {
+    ExecutionTelemetry telemetry;
+    REQUIRE(telemetry.snapshot().empty());
+
+    PluginTelemetry& probe = telemetry.plugin("probe");
+    REQUIRE(&telemetry.plugin("probe") == &probe);
+    telemetry.plugin("idle");
+
+    RunSample ok;
+    ok.duration = std::chrono::milliseconds(20);
+    ok.exitCode = 0;
+    ok.connections = 1;
+    ok.bytesRead = 300;
+    ok.bytesWritten = 40;
+    RunSample late;
+    late.duration = std::chrono::milliseconds(500);
+    late.exitCode = 3;
+    late.timedOut = true;
+    late.threw = true;
+    late.rssGrowthKb = 12;
+    probe.record(ok);
+    probe.record(ok);
+    probe.record(late);
+
+    const std::vector<PluginStats> stats = telemetry.snapshot();
+    REQUIRE(stats.size() == 1);   // "idle" never ran
+    const PluginStats& totals = stats[0];
+    REQUIRE(totals.plugin == "probe");
+    REQUIRE(totals.runs == 3);
+    REQUIRE(totals.byExitCode[0] == 2);
+    REQUIRE(totals.byExitCode[3] == 1);
+    REQUIRE(totals.timeouts == 1);
+    REQUIRE(totals.exceptions == 1);
+    REQUIRE(totals.connections == 2);
+    REQUIRE(totals.bytesRead == 600);
+    REQUIRE(totals.bytesWritten == 80);
+    REQUIRE(totals.rssGrowthKb == 12);
+    REQUIRE(totals.durationSum == std::chrono::milliseconds(540));
+    REQUIRE(totals.p50 >= std::chrono::milliseconds(20));
+    REQUIRE(totals.p50 < std::chrono::milliseconds(21));
+    REQUIRE(totals.max == std::chrono::milliseconds(500));
+}
+
+TEST_CASE("PreparedCheck records every run in the global telemetry", "[telemetry]") {
+    CheckOutcome failure;
+    auto check = prepareCheck({"check_dummy", "-w", "-m", "counted"}, failure);
+    REQUIRE(check != nullptr);
+
+    auto before = findStats(ExecutionTelemetry::global().snapshot(), "dummy");
+    const uint64_t runs = before ? before->runs : 0;
+    const uint64_t warnings = before ? before->byExitCode[1] : 0;
+    check->run();
+    check->run();
+
+    const auto stats = ExecutionTelemetry::global().snapshot();
+    const PluginStats* after = findStats(stats, "dummy");
+    REQUIRE(after != nullptr);
+    REQUIRE(after->runs == runs + 2);
+    REQUIRE(after->byExitCode[1] == warnings + 2);
+}
+
+TEST_CASE("encodeTelemetry writes Prometheus families and per-plugin records", "[telemetry]") {
+    PluginStats stats;
+    stats.plugin = "tcp";
+    stats.runs = 4;
+    stats.byExitCode = {3, 0, 1, 0};
+    stats.timeouts = 1;
+    stats.connections = 4;
+    stats.bytesRead = 2048;
+    stats.durationSum = microseconds(1200000);
+    stats.p50 = microseconds(15000);
+    stats.p99 = microseconds(1100000);
+    stats.max = microseconds(1100000);
+
+    std::string prometheus;
+    encodeTelemetry(OutputFormat::PROMETHEUS, {stats}, prometheus);
+    REQUIRE(prometheus.find("# TYPE netmon_plugin_runs_total counter\n") != std::string::npos);
+    REQUIRE(prometheus.find("netmon_plugin_runs_total{plugin=\"tcp\"} 4\n") != std::string::npos);
+    REQUIRE(prometheus.find("netmon_plugin_results_total{plugin=\"tcp\",status=\"CRITICAL\"} 1\n") !=
+            std::string::npos);
+    REQUIRE(prometheus.find("netmon_plugin_read_bytes_total{plugin=\"tcp\"} 2048\n") !=
+            std::string::npos);
+    REQUIRE(prometheus.find("# TYPE netmon_plugin_duration_seconds summary\n") !=
+            std::string::npos);
+    REQUIRE(prometheus.find("netmon_plugin_duration_seconds{plugin=\"tcp\",quantile=\"0.99\"} 1.1\n") !=
+            std::string::npos);
+    REQUIRE(prometheus.find("netmon_plugin_duration_seconds_count{plugin=\"tcp\"} 4\n") !=
+            std::string::npos);
+
+    std::string nagios;
+    encodeTelemetry(OutputFormat::NAGIOS, {stats}, nagios);
+    REQUIRE(nagios.find("tcp: 4 runs, 1 timeouts, 0 exceptions, p99 1100.000 ms") !=
+            std::string::npos);
+    REQUIRE(nagios.find("bytes_read=2048B") != std::string::npos);
+
+    std::string json;
+    encodeTelemetry(OutputFormat::JSON, {stats}, json);
+    REQUIRE(json.find("\"check\":\"tcp\"") != std::string::npos);
+}
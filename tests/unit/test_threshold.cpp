@@ -0,0 +1,88 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+
+#include "netmon/plugin.hpp"
+#include "netmon/threshold.hpp"
+
+using namespace netmon_plugins;
+
+TEST_CASE("ThresholdRange follows Nagios range semantics", "[threshold]") {
+    ThresholdRange upTo = ThresholdRange::parse("10");
+    REQUIRE_FALSE(upTo.alerts(0));
+    REQUIRE_FALSE(upTo.alerts(10));
+    REQUIRE(upTo.alerts(10.5));
+    REQUIRE(upTo.alerts(-1));
+
+    ThresholdRange atLeast = ThresholdRange::parse("10:");
+    REQUIRE(atLeast.alerts(9.9));
+    REQUIRE_FALSE(atLeast.alerts(1e9));
+
+    ThresholdRange atMost = ThresholdRange::parse("~:10");
+    REQUIRE_FALSE(atMost.alerts(-1e9));
+    REQUIRE(atMost.alerts(11));
+
+    ThresholdRange between = ThresholdRange::parse("10:20");
+    REQUIRE(between.alerts(9));
+    REQUIRE_FALSE(between.alerts(15));
+    REQUIRE(between.alerts(21));
+
+    ThresholdRange inside = ThresholdRange::parse("@10:20");
+    REQUIRE_FALSE(inside.alerts(9));
+    REQUIRE(inside.alerts(10));
+    REQUIRE(inside.alerts(20));
+    REQUIRE_FALSE(inside.alerts(21));
+}
+
+TEST_CASE("ThresholdRange rejects malformed ranges", "[threshold]") {
+    ThresholdRange range;
+    REQUIRE_FALSE(ThresholdRange::tryParse("", range));
+    REQUIRE_FALSE(ThresholdRange::tryParse("abc", range));
+    REQUIRE_FALSE(ThresholdRange::tryParse("10:5", range));
+    REQUIRE_FALSE(ThresholdRange::tryParse("5:x", range));
+    REQUIRE_FALSE(ThresholdRange::tryParse("@", range));
+    REQUIRE_FALSE(range.isSet());
+    REQUIRE_THROWS_AS(ThresholdRange::parse("1:2:3"), std::invalid_argument);
+}
+
+TEST_CASE("Unset ranges never alert", "[threshold]") {
+    ThresholdRange unset;
+    REQUIRE_FALSE(unset.alerts(-1e300));
+    REQUIRE_FALSE(unset.alerts(1e300));
+    REQUIRE(unset.toString().empty());
+}
+
+TEST_CASE("ThresholdRange prints canonical range text", "[threshold]") {
+    REQUIRE(ThresholdRange::parse("10").toString() == "10");
+    REQUIRE(ThresholdRange::parse("0:10").toString() == "10");
+    REQUIRE(ThresholdRange::parse("2.5:").toString() == "2.5:");
+    REQUIRE(ThresholdRange::parse("~:10").toString() == "~:10");
+    REQUIRE(ThresholdRange::parse("@-5:5").toString() == "@-5:5");
+    REQUIRE(ThresholdRange::above(3).toString() == "~:3");
+    REQUIRE(ThresholdRange::below(3).toString() == "3:");
+}
+
+TEST_CASE("Thresholds report the worst state", "[threshold]") {
+    Thresholds limits{ThresholdRange::parse("80"), ThresholdRange::parse("95")};
+    REQUIRE(limits.evaluate(50) == ExitCode::OK);
+    REQUIRE(limits.evaluate(90) == ExitCode::WARNING);
+    REQUIRE(limits.evaluate(99) == ExitCode::CRITICAL);
+
+    const double values[] = {10, 85, 30};
+    REQUIRE(limits.evaluate(values, 3) == ExitCode::WARNING);
+    const double worse[] = {10, 85, 96, 30};
+    REQUIRE(limits.evaluate(worse, 4) == ExitCode::CRITICAL);
+    REQUIRE(limits.evaluate(values, 0) == ExitCode::OK);
+}
+
+TEST_CASE("parseThresholdList splits comma-separated ranges", "[threshold]") {
+    ThresholdRange ranges[3];
+    REQUIRE(parseThresholdList("5,~:4,", ranges, 3) == 3);
+    REQUIRE(ranges[0].alerts(6));
+    REQUIRE(ranges[1].alerts(5));
+    REQUIRE_FALSE(ranges[2].isSet());
+
+    REQUIRE(parseThresholdList("7", ranges, 3) == 1);
+    REQUIRE_THROWS_AS(parseThresholdList("1,2,3,4", ranges, 3), std::invalid_argument);
+    REQUIRE_THROWS_AS(parseThresholdList("1,x", ranges, 3), std::invalid_argument);
+}
@@ -0,0 +1,177 @@
+#include <catch2/catch_test_macros.hpp>
+
+#ifdef NETMON_SSL_ENABLED
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "netmon/connection.hpp"
+#include "netmon/tls_context.hpp"
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include "loopback_server.hpp"
+
+using namespace netmon_plugins;
+
+#ifndef _WIN32
+namespace {
+
+// Loopback TLS server with a fresh self-signed certificate for
+// "localhost", answering "ping" with "pong" on each of `clients`
+// connections and counting the handshakes it resumed
+class TlsServer {
+public:
+    explicit TlsServer(int clients) : listener(4) {
+        key = EVP_EC_gen("P-256");
+        cert = X509_new();
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+        X509_set_pubkey(cert, key);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                   reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+        X509_sign(cert, key, EVP_sha256());
+
+        context = SSL_CTX_new(TLS_server_method());
+        SSL_CTX_use_certificate(context, cert);
+        SSL_CTX_use_PrivateKey(context, key);
+
+        port = listener.port();
+
+        thread = std::thread([this, clients]() {
+            for (int i = 0; i < clients; i++) {
+                int client = listener.accept(stopping);
+                if (client < 0) {
+                    break;
+                }
+                SSL* ssl = SSL_new(context);
+                SSL_set_fd(ssl, client);
+                if (SSL_accept(ssl) == 1) {
+                    handshakes++;
+                    resumed += SSL_session_reused(ssl) == 1 ? 1 : 0;
+                    char buffer[16];
+                    if (SSL_read(ssl, buffer, sizeof(buffer)) > 0) {
+                        SSL_write(ssl, "pong", 4);
+                    }
+                    SSL_shutdown(ssl);
+                }
+                SSL_free(ssl);
+                close(client);
+            }
+        });
+    }
+
+    ~TlsServer() {
+        stopping = true;
+        thread.join();
+        SSL_CTX_free(context);
+        X509_free(cert);
+        EVP_PKEY_free(key);
+    }
+
+    // The certificate as a PEM file, to trust it
+    std::string writeCertificate() const {
+        const std::string path = "/tmp/netmon-test-ca-" + std::to_string(port) + ".pem";
+        FILE* file = std::fopen(path.c_str(), "w");
+        PEM_write_X509(file, cert);
+        std::fclose(file);
+        return path;
+    }
+
+    int port = 0;
+    std::atomic<int> handshakes{0};
+    std::atomic<int> resumed{0};
+
+private:
+    EVP_PKEY* key = nullptr;
+    X509* cert = nullptr;
+    SSL_CTX* context = nullptr;
+    testing::LoopbackListener listener;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+
+// One ping over TLS; "" if the connection or handshake failed
+std::string ping(int port, const net::ConnectOptions& options, bool* resumed = nullptr,
+                 std::string* error = nullptr) {
+    net::Connection conn;
+    if (!conn.open("127.0.0.1", port, CheckContext(Deadline::afterSeconds(5), CancellationToken()),
+                   options)) {
+        if (error) {
+            *error = conn.error();
+        }
+        return "";
+    }
+    if (resumed) {
+        *resumed = conn.tlsResumed();
+    }
+    std::string reply;
+    conn.write("ping");
+    conn.readAll(reply);
+    return reply;
+}
+
+} // namespace
+
+TEST_CASE("TlsClientCache shares one context per verification setting", "[tls]") {
+    net::TlsClientCache& cache = net::TlsClientCache::shared();
+    SSL_CTX* plain = cache.context(false, "");
+    REQUIRE(plain != nullptr);
+    REQUIRE(cache.context(false, "") == plain);
+    REQUIRE(cache.context(true, "") != plain);
+    REQUIRE(cache.context(true, "/nonexistent/ca.pem") == nullptr);
+}
+
+TEST_CASE("Connections resume the last session to the same server", "[tls][network]") {
+    TlsServer server(4);
+    net::ConnectOptions options;
+    options.tls = true;
+
+    bool resumed = true;
+    REQUIRE(ping(server.port, options, &resumed) == "pong");
+    REQUIRE_FALSE(resumed);
+    REQUIRE(ping(server.port, options, &resumed) == "pong");
+    REQUIRE(resumed);
+    REQUIRE(ping(server.port, options, &resumed) == "pong");
+    REQUIRE(resumed);
+
+    // Opting out gets a full handshake
+    options.resumeSession = false;
+    REQUIRE(ping(server.port, options, &resumed) == "pong");
+    REQUIRE_FALSE(resumed);
+    REQUIRE(server.resumed == 2);
+}
+
+TEST_CASE("verifyPeer checks the chain and the host name", "[tls][network]") {
+    TlsServer server(3);
+    net::ConnectOptions options;
+    options.tls = true;
+    options.verifyPeer = true;
+    options.serverName = "localhost";
+
+    // Self-signed, so not trusted by default
+    std::string error;
+    REQUIRE(ping(server.port, options, nullptr, &error).empty());
+    REQUIRE(error.find("TLS handshake with 127.0.0.1") != std::string::npos);
+    REQUIRE(error.find("certificate") != std::string::npos);
+
+    options.caFile = server.writeCertificate();
+    REQUIRE(ping(server.port, options) == "pong");
+
+    // Trusted, but issued for another name
+    options.serverName = "example.org";
+    REQUIRE(ping(server.port, options).empty());
+    std::remove(options.caFile.c_str());
+}
+#endif
+
+#endif // NETMON_SSL_ENABLED
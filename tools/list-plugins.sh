@@ -1,11 +1,25 @@
 #!/bin/bash
-# List all NetMon plugins defined in plugin_list.txt
+# List all NetMon plugins.
+# Prefers the plugin registry of a built multicall binary or agent, which
+# reports what is actually linked along with category and description;
+# falls back to plugin_list.txt when neither is available.
 
 set -euo pipefail
 
 ROOT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD_DIR="${BUILD_DIR:-${ROOT_DIR}/build}"
 LIST_FILE="${ROOT_DIR}/plugin_list.txt"
 
+for host in "${BUILD_DIR}/netmon" "${BUILD_DIR}/netmon-agent"; do
+    if [ -x "$host" ]; then
+        listing="$("$host" --list)"
+        printf "%s\n" "$listing"
+        echo "" >&2
+        echo "Total: $(printf "%s\n" "$listing" | grep -c .) plugins ($(basename "$host"))" >&2
+        exit 0
+    fi
+done
+
 if [ ! -f "$LIST_FILE" ]; then
     echo "Error: plugin_list.txt not found at $LIST_FILE" >&2
     exit 1